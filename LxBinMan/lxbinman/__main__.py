@@ -21,6 +21,22 @@ def main() -> int:
     p_fb.add_argument("--source-dir", required=True)
     p_fb.add_argument("--output-dir")
 
+    p_pf = sub.add_parser("perf-build")
+    p_pf.add_argument("--source-dir", required=True)
+    p_pf.add_argument("--isa", action="append", dest="isas", choices=["baseline", "avx2", "avx512"])
+    p_pf.add_argument("--name", action="append", dest="names")
+    p_pf.add_argument("--train-root")
+    p_pf.add_argument("--bench-dir")
+
+    p_bn = sub.add_parser("bench")
+    p_bn.add_argument("--source-dir", required=True)
+    p_bn.add_argument("--bench-dir")
+    p_bn.add_argument("--output-dir")
+    p_bn.add_argument("--name", action="append", dest="names")
+    p_bn.add_argument("--force", action="store_true")
+    p_bn.add_argument("--run", action="store_true")
+    p_bn.add_argument("bench_args", nargs=argparse.REMAINDER)
+
     p_t = sub.add_parser("toolchain")
     p_t.add_argument("--source-dir", required=True)
     p_t.add_argument("--compiler", default="g++")
@@ -64,6 +80,35 @@ def main() -> int:
         print(f"engines={len(out)}")
         return 0
 
+    if args.cmd == "perf-build":
+        out = builder.build_performance(
+            source_dir=args.source_dir,
+            names=args.names,
+            isas=args.isas,
+            train_root=args.train_root,
+            bench_dir=args.bench_dir,
+        )
+        for isa, engines in out.items():
+            print(f"{isa}: engines={len(engines)}")
+        return 0 if out and all(out.values()) else 1
+
+    if args.cmd == "bench":
+        bench_args = list(args.bench_args)
+        if bench_args[:1] == ["--"]:
+            bench_args = bench_args[1:]
+        out = builder.build_bench(
+            source_dir=args.source_dir,
+            bench_dir=args.bench_dir,
+            output_dir=args.output_dir,
+            names=args.names,
+            force=args.force,
+            run=args.run,
+            args=bench_args,
+        )
+        print(json.dumps(out, indent=2, ensure_ascii=False))
+        ok = bool(out) and all("error" not in e and e.get("returncode", 0) == 0 for e in out.values())
+        return 0 if ok else 1
+
     if args.cmd == "toolchain":
         out = builder.snapshot_toolchain(
             source_dir=args.source_dir,
@@ -12,8 +12,8 @@ import sysconfig
 from pathlib import Path
 from typing import Callable, Literal
 
+from .manifest import ISA_LEVELS, ISA_MARCH, is_manifest_compatible, read_manifest, runtime_info, supported_isas
 from .manifest import cache_key as _cache_key
-from .manifest import is_manifest_compatible, read_manifest, runtime_info
 
 
 class AutoBinError(RuntimeError):
@@ -21,6 +21,10 @@ class AutoBinError(RuntimeError):
 
 
 LoadPolicy = Literal["prefer_prebuilt", "prefer_cache", "build_only", "prebuilt_only"]
+# default: -O3 for any x86-64/arm64 (flat prebuilt dir)
+# performance: PGO-trained + LTO build per ISA level (prebuilt dir "performance-<isa>")
+# auto: best performance prebuilt this CPU can run, else default; never trains
+BuildProfile = Literal["default", "performance", "auto"]
 Logger = Callable[[str, str], None]
 
 
@@ -84,6 +88,32 @@ def _sha256_file(path: Path) -> str:
     return h.hexdigest()
 
 
+def _shared_headers(cpp_path: Path) -> list[Path]:
+    # Engines share header-only code from <source_dir>/common/; treat it as part of every source.
+    common = cpp_path.parent / "common"
+    if not common.is_dir():
+        return []
+    return sorted(p for p in common.rglob("*") if p.is_file() and p.suffix in {".h", ".hpp"})
+
+
+def _source_mtime(cpp_path: Path) -> float:
+    mtime = cpp_path.stat().st_mtime
+    for header in _shared_headers(cpp_path):
+        try:
+            mtime = max(mtime, header.stat().st_mtime)
+        except Exception:
+            continue
+    return mtime
+
+
+def _headers_sha256(cpp_path: Path) -> str:
+    h = hashlib.sha256()
+    for header in _shared_headers(cpp_path):
+        h.update(header.relative_to(cpp_path.parent).as_posix().encode("utf-8"))
+        h.update(_sha256_file(header).encode("ascii"))
+    return h.hexdigest()
+
+
 def _abi_sidecar_path(so_path: Path) -> Path:
     return so_path.with_name(f"{so_path.name}.abi.json")
 
@@ -142,6 +172,7 @@ def _build_signature(
 ) -> dict:
     return {
         "source_sha256": _sha256_file(cpp_path),
+        "headers_sha256": _headers_sha256(cpp_path),
         "compiler": str(compiler),
         "cxx_std": str(cxx_std),
         "extra_compile_args": list(extra_compile_args or []),
@@ -149,16 +180,31 @@ def _build_signature(
     }
 
 
+def _variant_signature(signature: dict, isa: str | None) -> dict:
+    # Default builds keep the plain signature, so sidecars written before build profiles stay valid.
+    if isa is None:
+        return signature
+    return {**signature, "profile": "performance", "isa": isa}
+
+
+def _variant_dir_name(isa: str) -> str:
+    return f"performance-{isa}"
+
+
 def _manifest_path(dir_path: Path) -> Path:
     return dir_path / "manifest.json"
 
 
-def _upsert_prebuilt_manifest(prebuilt_dir: Path, so_path: Path) -> None:
+def _upsert_prebuilt_manifest(prebuilt_dir: Path, so_path: Path, *, isa: str | None = None) -> None:
     manifest_path = _manifest_path(prebuilt_dir)
     data = read_manifest(manifest_path)
     rt = runtime_info()
     for key in ("python_version", "python_soabi", "system", "machine"):
         data[key] = rt[key]
+    if isa is not None:
+        # is_manifest_compatible() refuses the whole directory on CPUs below this level.
+        data["profile"] = "performance"
+        data["isa"] = isa
     hashes = data.get("hashes")
     if not isinstance(hashes, dict):
         hashes = {}
@@ -174,13 +220,14 @@ def _backup_prebuilt(
     target_sidecar: Path,
     prebuilt_so: Path,
     log: Logger,
+    isa: str | None = None,
 ) -> None:
     prebuilt_dir = prebuilt_so.parent
     prebuilt_dir.mkdir(parents=True, exist_ok=True)
     shutil.copy2(target_so, prebuilt_so)
     if target_sidecar.exists():
         shutil.copy2(target_sidecar, _abi_sidecar_path(prebuilt_so))
-    _upsert_prebuilt_manifest(prebuilt_dir, prebuilt_so)
+    _upsert_prebuilt_manifest(prebuilt_dir, prebuilt_so, isa=isa)
     log("INFO", f"Saved prebuilt backup for {target_so.stem} -> {prebuilt_so}")
 
 
@@ -227,6 +274,254 @@ def _build_module(
     log("SUCCESS", f"Built {engine_name} -> {out_so}")
 
 
+def _build_executable(
+    name: str,
+    cpp_path: Path,
+    out_bin: Path,
+    *,
+    include_dirs: list[Path],
+    compiler: str,
+    cxx_std: str,
+    extra_compile_args: list[str] | None,
+    extra_link_args: list[str] | None,
+    log: Logger,
+) -> None:
+    # Standalone tools (benchmarks) that include engine headers but not pybind11.
+    out_bin.parent.mkdir(parents=True, exist_ok=True)
+    tmp_bin = out_bin.with_name(out_bin.name + ".tmp")
+
+    cmd = [compiler, "-O2", f"-std={cxx_std}", "-pthread"]
+    cmd.extend(f"-I{d}" for d in include_dirs)
+    if extra_compile_args:
+        cmd.extend(extra_compile_args)
+    cmd.extend([str(cpp_path), "-o", str(tmp_bin)])
+    if extra_link_args:
+        cmd.extend(extra_link_args)
+
+    log("ENGINE", f"Compiling {name} with {compiler}...")
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        tmp_bin.unlink(missing_ok=True)
+        stderr = (result.stderr or "").strip()
+        raise AutoBinError(f"Build failed for '{name}': {stderr}")
+
+    os.replace(tmp_bin, out_bin)
+    log("SUCCESS", f"Built {name} -> {out_bin}")
+
+
+# Engine calls that make up the PGO training workload; engines.json "pgo_train" overrides them.
+DEFAULT_TRAIN_CALLS: tuple[str, ...] = (
+    "get_all",
+    "get_all_usage",
+    "get_all_stats",
+    "get_all_rates",
+    "get_usage",
+    "get_top",
+    "sample",
+)
+
+# Runs in a child interpreter: loads the instrumented module, samples an Engine(root=...) (or the
+# module-level functions of engines without one) and prints how many calls succeeded. The .gcda
+# files are written when the child exits.
+_TRAIN_SCRIPT = """
+import importlib.util, sys, time
+name, path, root, rounds = sys.argv[1], sys.argv[2], sys.argv[3], int(sys.argv[4])
+calls = sys.argv[5:]
+spec = importlib.util.spec_from_file_location(name, path)
+mod = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(mod)
+target = mod
+if hasattr(mod, "Engine"):
+    try:
+        target = mod.Engine(root=root)
+    except Exception:
+        target = mod
+fns = [getattr(target, c) for c in calls if callable(getattr(target, c, None))]
+done = 0
+for _ in range(rounds):
+    for fn in fns:
+        try:
+            fn()
+            done += 1
+        except Exception:
+            pass
+    time.sleep(0.002)
+print(done)
+"""
+
+_compiler_probe_cache: dict[tuple[str, ...], bool] = {}
+
+
+def _compiler_accepts(compiler: str, args: list[str]) -> bool:
+    key = (compiler, *args)
+    if key not in _compiler_probe_cache:
+        try:
+            result = subprocess.run(
+                [compiler, "-x", "c++", "-fsyntax-only", *args, "-"],
+                input="int main() { return 0; }\n",
+                capture_output=True,
+                text=True,
+                timeout=10.0,
+            )
+            _compiler_probe_cache[key] = result.returncode == 0
+        except Exception:
+            _compiler_probe_cache[key] = False
+    return _compiler_probe_cache[key]
+
+
+def _is_clang(compiler: str) -> bool:
+    try:
+        result = subprocess.run([compiler, "--version"], capture_output=True, text=True, timeout=3.0)
+        return "clang" in (result.stdout or "").lower()
+    except Exception:
+        return False
+
+
+def _run_compiler(engine_name: str, cmd: list[str], cleanup: Path | None = None) -> None:
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        if cleanup is not None:
+            cleanup.unlink(missing_ok=True)
+        stderr = (result.stderr or "").strip()
+        raise AutoBinError(f"Build failed for '{engine_name}': {stderr}")
+
+
+def _train(
+    engine_name: str,
+    instrumented_so: Path,
+    *,
+    work_dir: Path,
+    train_root: str | None,
+    train_calls: list[str],
+    rounds: int,
+    log: Logger,
+) -> int:
+    cmd = [
+        sys.executable or "python3",
+        "-c",
+        _TRAIN_SCRIPT,
+        engine_name,
+        str(instrumented_so),
+        train_root or "",
+        str(rounds),
+        *train_calls,
+    ]
+    log("ENGINE", f"Training {engine_name} ({rounds} rounds, root={train_root or 'host'})...")
+    try:
+        result = subprocess.run(cmd, cwd=str(work_dir), capture_output=True, text=True, timeout=300.0)
+    except subprocess.TimeoutExpired:
+        log("WARN", f"PGO training timed out for {engine_name}")
+        return 0
+    if result.returncode != 0:
+        log("WARN", f"PGO training failed for {engine_name}: {(result.stderr or '').strip()[-400:]}")
+        return 0
+    try:
+        return int((result.stdout or "0").strip().splitlines()[-1])
+    except Exception:
+        return 0
+
+
+def _build_performance(
+    engine_name: str,
+    cpp_path: Path,
+    out_so: Path,
+    *,
+    isa: str,
+    work_dir: Path,
+    compiler: str,
+    cxx_std: str,
+    extra_compile_args: list[str] | None,
+    extra_link_args: list[str] | None,
+    train_root: str | None,
+    train_calls: list[str] | None,
+    train_rounds: int,
+    log: Logger,
+) -> bool:
+    """
+    Performance profile for one ISA level; returns True when profile feedback was applied.
+    1. instrumented build (-fprofile-generate), object at a fixed path so the .gcda names match
+    2. training run of the instrumented module in a child interpreter
+    3. final build with -fprofile-use and -flto (LTO only when training produced nothing)
+    Higher levels are built with -march and no target_clones (-DLX_NO_MULTIVERSION): the whole
+    module already targets that CPU. The baseline level keeps the runtime-dispatched clones.
+    """
+    if isa not in ISA_LEVELS:
+        raise AutoBinError(f"unknown ISA level: {isa}")
+    if isa not in supported_isas():
+        # The instrumented build has to run here to be trained.
+        raise AutoBinError(f"cannot train the {isa} variant of '{engine_name}' on this CPU")
+    isa_args = ["-DLX_NO_MULTIVERSION", f"-march={ISA_MARCH[isa]}"] if ISA_MARCH[isa] else []
+    if isa_args and not _compiler_accepts(compiler, isa_args):
+        raise AutoBinError(f"{compiler} does not support -march={ISA_MARCH[isa]}")
+
+    includes = _pybind11_includes(log)
+    shutil.rmtree(work_dir, ignore_errors=True)  # stale .gcda from older sources fail -fprofile-use
+    profile_dir = work_dir / "profile"
+    profile_dir.mkdir(parents=True, exist_ok=True)
+    obj = work_dir / f"{engine_name}.o"
+    instrumented_so = work_dir / f"{engine_name}.instrumented.so"
+
+    compile_base = [
+        compiler,
+        "-O3",
+        f"-std={cxx_std}",
+        "-fPIC",
+        "-fvisibility=hidden",
+        "-fno-semantic-interposition",
+        *isa_args,
+        *includes,
+        *(extra_compile_args or []),
+    ]
+    link_base = [compiler, "-O3", "-shared", *isa_args]
+
+    trained = False
+    if _is_clang(compiler):
+        # Clang's .profraw files need llvm-profdata merging; only LTO is applied there.
+        log("WARN", f"PGO skipped for {engine_name}: {compiler} is clang, building with LTO only")
+    else:
+        gen = [f"-fprofile-generate={profile_dir}", "-fprofile-update=atomic"]
+        log("ENGINE", f"Compiling instrumented {engine_name} ({isa}) with {compiler}...")
+        _run_compiler(engine_name, [*compile_base, *gen, "-c", str(cpp_path), "-o", str(obj)])
+        _run_compiler(engine_name, [*link_base, *gen, str(obj), "-o", str(instrumented_so), *(extra_link_args or [])])
+        calls = _train(
+            engine_name,
+            instrumented_so,
+            work_dir=work_dir,
+            train_root=train_root,
+            train_calls=list(train_calls or DEFAULT_TRAIN_CALLS),
+            rounds=train_rounds,
+            log=log,
+        )
+        trained = calls > 0 and any(profile_dir.rglob("*.gcda"))
+        if not trained:
+            log("WARN", f"No training calls for {engine_name}, building with LTO only")
+
+    use = [
+        f"-fprofile-use={profile_dir}",
+        "-fprofile-partial-training",  # paths the fixture never hit keep -O3, not -Os
+        "-Wno-missing-profile",
+    ] if trained else []
+    out_so.parent.mkdir(parents=True, exist_ok=True)
+    tmp_so = out_so.with_suffix(out_so.suffix + ".tmp")
+    log("ENGINE", f"Compiling {engine_name} ({isa}, {'PGO+LTO' if trained else 'LTO'}) with {compiler}...")
+    _run_compiler(engine_name, [*compile_base, *use, "-flto=auto", "-c", str(cpp_path), "-o", str(obj)])
+    _run_compiler(
+        engine_name,
+        [*link_base, *use, "-flto=auto", str(obj), "-o", str(tmp_so), *(extra_link_args or [])],
+        cleanup=tmp_so,
+    )
+    os.replace(tmp_so, out_so)
+    log("SUCCESS", f"Built {engine_name} ({_variant_dir_name(isa)}) -> {out_so}")
+    return trained
+
+
+def _prebuilt_fresh(src: Path, cpp_path: Path) -> bool:
+    try:
+        return src.exists() and src.stat().st_mtime >= _source_mtime(cpp_path)
+    except Exception:
+        return False
+
+
 def _copy_if_fresh_verified(
     src: Path,
     dst: Path,
@@ -234,12 +529,7 @@ def _copy_if_fresh_verified(
     manifest_data: dict,
     log: Logger,
 ) -> bool:
-    if not src.exists():
-        return False
-    try:
-        if src.stat().st_mtime < cpp_path.stat().st_mtime:
-            return False
-    except Exception:
+    if not _prebuilt_fresh(src, cpp_path):
         return False
 
     hashes = manifest_data.get("hashes") if isinstance(manifest_data, dict) else None
@@ -281,6 +571,11 @@ def load(
     compile_only: bool = False,
     save_prebuilt: bool = True,
     policy: LoadPolicy = "prefer_prebuilt",
+    profile: BuildProfile = "default",
+    isa: str | None = None,
+    train_root: str | None = None,
+    train_calls: list[str] | None = None,
+    train_rounds: int = 200,
     log: Logger | None = None,
 ):
     """
@@ -291,6 +586,13 @@ def load(
     - prefer_cache: cache -> prebuilt -> build
     - build_only: build only
     - prebuilt_only: prebuilt only (no build)
+
+    Profiles:
+    - default: -O3, prebuilt in <prebuilt_root>/<key>/
+    - performance: PGO (trained on train_root, or the host when None) + LTO for one ISA level
+      (isa, default: the best this CPU runs), prebuilt in <prebuilt_root>/<key>/performance-<isa>/
+    - auto: the policy runs first for the best fresh performance prebuilt this CPU can run, then
+      for the default build; builds are always default (no training at boot)
     """
     logger = log or _default_log
     src_dir = Path(source_dir).resolve()
@@ -300,25 +602,33 @@ def load(
     cpp_path = src_dir / f"{engine_name}.cpp"
     if not cpp_path.exists():
         raise AutoBinError(f"source file not found: {cpp_path}")
+    if profile not in ("default", "performance", "auto"):
+        raise AutoBinError(f"unknown build profile: {profile}")
 
     suffix = ".so" if output_dir else _ext_suffix()
     key = _cache_key()
 
     pre_root = Path(prebuilt_root).resolve() if prebuilt_root else _default_prebuilt_root(src_dir)
     cache_base = Path(cache_root).resolve() if cache_root else _default_cache_root(src_dir)
-
     cache_dir = cache_base / key
-    cache_so = cache_dir / f"{engine_name}{_ext_suffix()}"
-    target_dir = Path(output_dir).resolve() if output_dir else cache_dir
-    target_so = target_dir / f"{engine_name}{suffix}"
 
-    logger("INFO", f"autobin.load('{engine_name}') key={key} policy={policy}")
+    # Variants tried in order; None is the default build.
+    variants: list[str | None] = [None]
+    if profile == "performance":
+        variants = [isa or supported_isas()[-1]]
+        if variants[0] not in ISA_LEVELS:
+            raise AutoBinError(f"unknown ISA level: {variants[0]}")
+    elif profile == "auto":
+        for level in reversed(supported_isas()):
+            variant_dir = pre_root / key / _variant_dir_name(level)
+            if _prebuilt_fresh(variant_dir / f"{engine_name}{suffix}", cpp_path) and _manifest_ok(variant_dir, logger)[0]:
+                variants.insert(0, level)
+                break
+
+    logger("INFO", f"autobin.load('{engine_name}') key={key} policy={policy} profile={profile}")
 
-    prebuilt_key_dir = pre_root / key
-    prebuilt_key_so = prebuilt_key_dir / f"{engine_name}{suffix}"
-    prebuilt_plain_so = pre_root / f"{engine_name}{suffix}"
     abi_guard_enabled = bool(output_dir)
-    signature = _build_signature(
+    base_signature = _build_signature(
         cpp_path,
         compiler=compiler,
         cxx_std=cxx_std,
@@ -326,6 +636,22 @@ def load(
         extra_link_args=extra_link_args,
     )
 
+    variant: str | None = None
+    target_so = Path()
+    prebuilt_key_dir = Path()
+    prebuilt_key_so = Path()
+    signature: dict = base_signature
+
+    def select(v: str | None) -> None:
+        nonlocal variant, target_so, prebuilt_key_dir, prebuilt_key_so, signature
+        variant = v
+        sub = _variant_dir_name(v) if v else ""
+        target_dir = Path(output_dir).resolve() if output_dir else (cache_dir / sub if sub else cache_dir)
+        target_so = target_dir / f"{engine_name}{suffix}"
+        prebuilt_key_dir = pre_root / key / sub if sub else pre_root / key
+        prebuilt_key_so = prebuilt_key_dir / f"{engine_name}{suffix}"
+        signature = _variant_signature(base_signature, v)
+
     def try_prebuilt() -> bool:
         ok_key, manifest_key = _manifest_ok(prebuilt_key_dir, logger)
         if ok_key and _copy_if_fresh_verified(prebuilt_key_so, target_so, cpp_path, manifest_key, logger):
@@ -333,6 +659,9 @@ def load(
                 _write_abi_sidecar(target_so, build_signature=signature)
             return True
 
+        if variant is not None:
+            return False
+        prebuilt_plain_so = pre_root / f"{engine_name}{suffix}"
         ok_plain, manifest_plain = _manifest_ok(pre_root, logger)
         if ok_plain and _copy_if_fresh_verified(prebuilt_plain_so, target_so, cpp_path, manifest_plain, logger):
             if abi_guard_enabled:
@@ -344,15 +673,64 @@ def load(
     def try_cache() -> bool:
         if not target_so.exists():
             return False
-        if target_so.stat().st_mtime < cpp_path.stat().st_mtime:
+        if target_so.stat().st_mtime < _source_mtime(cpp_path):
             return False
         if abi_guard_enabled and not _is_abi_compatible(target_so, expected_signature=signature):
-            logger("WARN", f"ABI guard: stale local binary for {engine_name}, forcing rebuild")
+            if variant == variants[-1]:  # auto: a default build in place of a performance one is no news
+                logger("WARN", f"ABI guard: stale local binary for {engine_name}, forcing rebuild")
             return False
         return True
 
-    build_status = "up_to_date"
-    if policy == "build_only":
+    def backup() -> None:
+        if abi_guard_enabled and save_prebuilt:
+            _backup_prebuilt(
+                target_so=target_so,
+                target_sidecar=_abi_sidecar_path(target_so),
+                prebuilt_so=prebuilt_key_so,
+                log=logger,
+                isa=variant,
+            )
+
+    def finish(status: str):
+        if compile_only:
+            return {"ok": True, "path": str(target_so), "status": status, "variant": _variant_dir_name(variant) if variant else "default"}
+        return _import_module_from_path(engine_name, target_so)
+
+    if policy != "build_only":
+        for v in variants:
+            select(v)
+            if policy == "prefer_cache" and try_cache():
+                logger("INFO", f"Using ABI cache for {engine_name}")
+                backup()
+                return finish("up_to_date")
+            if try_prebuilt():
+                return finish("restored")
+            if policy == "prefer_prebuilt" and try_cache():
+                logger("INFO", f"Using ABI cache for {engine_name}")
+                backup()
+                return finish("up_to_date")
+        if policy == "prebuilt_only":
+            raise AutoBinError(f"prebuilt_only: no compatible prebuilt for '{engine_name}'")
+
+    select(variants[-1])
+    if variant is not None:
+        project_root = _detect_project_root(src_dir)
+        _build_performance(
+            engine_name,
+            cpp_path,
+            target_so,
+            isa=variant,
+            work_dir=project_root / ".binman" / "pgo" / key / f"{engine_name}-{variant}",
+            compiler=compiler,
+            cxx_std=cxx_std,
+            extra_compile_args=extra_compile_args,
+            extra_link_args=extra_link_args,
+            train_root=train_root,
+            train_calls=train_calls,
+            train_rounds=train_rounds,
+            log=logger,
+        )
+    else:
         _build_module(
             engine_name,
             cpp_path,
@@ -363,88 +741,10 @@ def load(
             extra_link_args=extra_link_args,
             log=logger,
         )
-        if abi_guard_enabled:
-            _write_abi_sidecar(target_so, build_signature=signature)
-            if save_prebuilt:
-                _backup_prebuilt(
-                    target_so=target_so,
-                    target_sidecar=_abi_sidecar_path(target_so),
-                    prebuilt_so=prebuilt_key_so,
-                    log=logger,
-                )
-        build_status = "rebuilt"
-        if compile_only:
-            return {"ok": True, "path": str(target_so), "status": build_status}
-        return _import_module_from_path(engine_name, target_so)
-
-    if policy == "prebuilt_only":
-        if not try_prebuilt():
-            raise AutoBinError(f"prebuilt_only: no compatible prebuilt for '{engine_name}'")
-        build_status = "restored"
-        if compile_only:
-            return {"ok": True, "path": str(target_so), "status": build_status}
-        return _import_module_from_path(engine_name, target_so)
-
-    if policy == "prefer_cache":
-        if try_cache():
-            logger("INFO", f"Using ABI cache for {engine_name}")
-            if abi_guard_enabled and save_prebuilt:
-                _backup_prebuilt(
-                    target_so=target_so,
-                    target_sidecar=_abi_sidecar_path(target_so),
-                    prebuilt_so=prebuilt_key_so,
-                    log=logger,
-                )
-            if compile_only:
-                return {"ok": True, "path": str(target_so), "status": build_status}
-            return _import_module_from_path(engine_name, target_so)
-        if try_prebuilt():
-            build_status = "restored"
-            if compile_only:
-                return {"ok": True, "path": str(target_so), "status": build_status}
-            return _import_module_from_path(engine_name, target_so)
-    else:  # prefer_prebuilt
-        if try_prebuilt():
-            build_status = "restored"
-            if compile_only:
-                return {"ok": True, "path": str(target_so), "status": build_status}
-            return _import_module_from_path(engine_name, target_so)
-        if try_cache():
-            logger("INFO", f"Using ABI cache for {engine_name}")
-            if abi_guard_enabled and save_prebuilt:
-                _backup_prebuilt(
-                    target_so=target_so,
-                    target_sidecar=_abi_sidecar_path(target_so),
-                    prebuilt_so=prebuilt_key_so,
-                    log=logger,
-                )
-            if compile_only:
-                return {"ok": True, "path": str(target_so), "status": build_status}
-            return _import_module_from_path(engine_name, target_so)
-
-    _build_module(
-        engine_name,
-        cpp_path,
-        target_so,
-        compiler=compiler,
-        cxx_std=cxx_std,
-        extra_compile_args=extra_compile_args,
-        extra_link_args=extra_link_args,
-        log=logger,
-    )
     if abi_guard_enabled:
         _write_abi_sidecar(target_so, build_signature=signature)
-        if save_prebuilt:
-            _backup_prebuilt(
-                target_so=target_so,
-                target_sidecar=_abi_sidecar_path(target_so),
-                prebuilt_so=prebuilt_key_so,
-                log=logger,
-            )
-    build_status = "rebuilt"
-    if compile_only:
-        return {"ok": True, "path": str(target_so), "status": build_status}
-    return _import_module_from_path(engine_name, target_so)
+        backup()
+    return finish("rebuilt")
 
 
 def load_many(
@@ -461,6 +761,7 @@ def load_many(
     compile_only: bool = False,
     save_prebuilt: bool = True,
     policy: LoadPolicy = "prefer_prebuilt",
+    profile: BuildProfile = "default",
     log: Logger | None = None,
 ) -> dict[str, object]:
     out: dict[str, object] = {}
@@ -478,6 +779,7 @@ def load_many(
             compile_only=compile_only,
             save_prebuilt=save_prebuilt,
             policy=policy,
+            profile=profile,
             log=log,
         )
     return out
@@ -543,9 +845,12 @@ def healthcheck(
 
 __all__ = [
     "AutoBinError",
+    "BuildProfile",
+    "DEFAULT_TRAIN_CALLS",
     "LoadPolicy",
     "load",
     "load_many",
     "healthcheck",
     "runtime_info",
+    "supported_isas",
 ]
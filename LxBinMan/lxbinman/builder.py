@@ -363,6 +363,9 @@ def build_engine(
     save_prebuilt: bool = True,
     policy: autobin.LoadPolicy = "prefer_prebuilt",
     engine_config: EngineConfig | None = None,
+    profile: autobin.BuildProfile = "default",
+    isa: str | None = None,
+    train_root: str | Path | None = None,
 ):
     fb = _resolve_feedback(feedback)
     try:
@@ -372,6 +375,7 @@ def build_engine(
             extra_compile_args=extra_compile_args,
             extra_link_args=extra_link_args,
         )
+        train = (engine_config or {}).get(engine_name, {}).get("pgo_train")
         mod = autobin.load(
             engine_name,
             source_dir=str(source_dir),
@@ -385,6 +389,10 @@ def build_engine(
             compile_only=compile_only,
             save_prebuilt=save_prebuilt,
             policy=policy_override or policy,
+            profile=profile,
+            isa=isa,
+            train_root=str(train_root) if train_root else None,
+            train_calls=[str(x) for x in train] if isinstance(train, list) else None,
             log=_event_logger(fb),
         )
         fb.success("builder:engine", f"Engine ready: {engine_name}")
@@ -411,6 +419,9 @@ def build_all(
     policy: autobin.LoadPolicy = "prefer_prebuilt",
     engine_config: EngineConfig | None = None,
     config_path: str | Path | None = None,
+    profile: autobin.BuildProfile = "default",
+    isa: str | None = None,
+    train_root: str | Path | None = None,
 ) -> dict[str, object]:
     fb = _resolve_feedback(feedback)
     src = Path(source_dir).resolve()
@@ -422,7 +433,7 @@ def build_all(
     cfg = engine_config if engine_config is not None else load_engine_config(source_dir=src, config_path=config_path, feedback=fb)
     snapshot_toolchain(source_dir=src, feedback=fb, compiler=compiler, persist=True)
 
-    fb.info("builder:start", "Building/loading engines", count=len(engines), source_dir=str(src), policy=policy)
+    fb.info("builder:start", "Building/loading engines", count=len(engines), source_dir=str(src), policy=policy, profile=profile)
     result: dict[str, object] = {}
     failed: list[str] = []
     for name in engines:
@@ -442,6 +453,9 @@ def build_all(
                 save_prebuilt=save_prebuilt,
                 policy=policy,
                 engine_config=cfg,
+                profile=profile,
+                isa=isa,
+                train_root=train_root,
             )
         except Exception:
             failed.append(name)
@@ -469,6 +483,8 @@ def fast_boot_build_all(
     - compile_only=True (does not import modules)
     - prefer_cache policy
     - save_prebuilt=True for warm restore on next run
+    - profile="auto": the best performance-<isa> prebuilt this CPU runs wins over the default
+      build; nothing is trained or recompiled for it
     """
     return build_all(
         source_dir=source_dir,
@@ -482,9 +498,165 @@ def fast_boot_build_all(
         policy="prefer_cache",
         engine_config=engine_config,
         config_path=config_path,
+        profile="auto",
     )
 
 
+def build_performance(
+    *,
+    source_dir: str | Path,
+    feedback: FeedbackBus | None = None,
+    names: Iterable[str] | None = None,
+    isas: Iterable[str] | None = None,
+    train_root: str | Path | None = None,
+    bench_dir: str | Path | None = None,
+    compiler: str = "g++",
+    cxx_std: str = "c++17",
+    engine_config: EngineConfig | None = None,
+    config_path: str | Path | None = None,
+) -> dict[str, dict[str, object]]:
+    """
+    Performance profile for shipping prebuilts:
+    - training fixture: train_root, else the synthetic tree of engine_bench --generate
+    - every ISA level in isas (default: all this CPU runs; the instrumented build must run here)
+    - PGO + LTO per engine and level, saved to assets/binaries/<key>/performance-<isa>/
+    Returns {isa: build_all() result}.
+    """
+    fb = _resolve_feedback(feedback)
+    src = Path(source_dir).resolve()
+    project_root = _detect_project_root(src)
+    levels = list(isas) if isas is not None else autobin.supported_isas()
+
+    fixture = Path(train_root).resolve() if train_root else None
+    if fixture is None:
+        bench = build_bench(source_dir=src, feedback=fb, bench_dir=bench_dir, names=["engine_bench"], compiler=compiler)
+        entry = bench.get("engine_bench", {})
+        fixture = project_root / ".binman" / "pgo" / "fixture"
+        generated = False
+        if "error" not in entry:
+            shutil.rmtree(fixture, ignore_errors=True)
+            result = subprocess.run([str(entry["path"]), "--generate", str(fixture)], capture_output=True, text=True)
+            generated = result.returncode == 0
+        if not generated:
+            fb.warning("builder:pgo", "Training fixture unavailable, training on this machine")
+            fixture = None
+
+    out: dict[str, dict[str, object]] = {}
+    for level in levels:
+        if level not in autobin.supported_isas():
+            fb.warning("builder:pgo", f"Skipping {level}: this CPU cannot run the training build")
+            continue
+        fb.info("builder:pgo", f"Performance build for {level}", train_root=str(fixture or "host"))
+        out[level] = build_all(
+            source_dir=src,
+            feedback=fb,
+            names=names,
+            output_dir=project_root / ".binman" / "build" / f"performance-{level}",
+            compiler=compiler,
+            cxx_std=cxx_std,
+            compile_only=True,
+            save_prebuilt=True,
+            policy="build_only",
+            engine_config=engine_config,
+            config_path=config_path,
+            profile="performance",
+            isa=level,
+            train_root=fixture,
+        )
+    return out
+
+
+def discover_benches(bench_dir: str | Path) -> list[str]:
+    bench = Path(bench_dir).resolve()
+    if not bench.exists():
+        return []
+    return sorted(p.stem for p in bench.glob("*.cpp") if p.is_file())
+
+
+def _bench_is_fresh(cpp_path: Path, out_bin: Path, source_dir: Path) -> bool:
+    if not out_bin.exists():
+        return False
+    newest = cpp_path.stat().st_mtime
+    common = source_dir / "common"
+    if common.is_dir():
+        for header in common.rglob("*"):
+            if header.is_file() and header.suffix in {".h", ".hpp"}:
+                newest = max(newest, header.stat().st_mtime)
+    return out_bin.stat().st_mtime >= newest
+
+
+def build_bench(
+    *,
+    source_dir: str | Path,
+    feedback: FeedbackBus | None = None,
+    bench_dir: str | Path | None = None,
+    output_dir: str | Path | None = None,
+    names: Iterable[str] | None = None,
+    compiler: str = "g++",
+    cxx_std: str = "c++17",
+    extra_compile_args: list[str] | None = None,
+    extra_link_args: list[str] | None = None,
+    force: bool = False,
+    run: bool = False,
+    args: list[str] | None = None,
+) -> dict[str, dict[str, object]]:
+    """
+    Benchmark target, separate from the engine modules:
+    - every <bench_dir>/*.cpp (default: <source_dir>/../bench) becomes an executable
+    - compiled with -I<source_dir>, so benches include "common/..." like the engines do
+    - output in <project>/.binman/bench/, rebuilt when the source or a shared header is newer
+    - run=True executes each bench with args and records its exit code
+    """
+    fb = _resolve_feedback(feedback)
+    src = Path(source_dir).resolve()
+    bench = Path(bench_dir).resolve() if bench_dir else (src.parent / "bench")
+    out_dir = Path(output_dir).resolve() if output_dir else (_detect_project_root(src) / ".binman" / "bench")
+    benches = list(names) if names is not None else discover_benches(bench)
+    if not benches:
+        fb.warning("bench:empty", "No C++ benchmarks found", bench_dir=str(bench))
+        return {}
+
+    log = _event_logger(fb)
+    result: dict[str, dict[str, object]] = {}
+    failed: list[str] = []
+    for name in benches:
+        cpp = bench / f"{name}.cpp"
+        out_bin = out_dir / name
+        entry: dict[str, object] = {"path": str(out_bin), "built": False}
+        try:
+            if not cpp.is_file():
+                raise BuilderError(f"benchmark source not found: {cpp}")
+            if force or not _bench_is_fresh(cpp, out_bin, src):
+                autobin._build_executable(
+                    name,
+                    cpp,
+                    out_bin,
+                    include_dirs=[src],
+                    compiler=compiler,
+                    cxx_std=cxx_std,
+                    extra_compile_args=extra_compile_args,
+                    extra_link_args=extra_link_args,
+                    log=log,
+                )
+                entry["built"] = True
+            if run:
+                fb.info("bench:run", f"Running {name}", args=" ".join(args or []))
+                entry["returncode"] = subprocess.run([str(out_bin), *(args or [])]).returncode
+                if entry["returncode"] != 0:
+                    failed.append(name)
+        except Exception as e:
+            fb.error("bench:build", f"Benchmark failed: {name}", error=str(e))
+            entry["error"] = str(e)
+            failed.append(name)
+        result[name] = entry
+
+    if failed:
+        fb.warning("bench:partial", "Some benchmarks failed", failed=",".join(failed))
+    else:
+        fb.success("bench:done", "Benchmarks ready", count=len(result), output_dir=str(out_dir))
+    return result
+
+
 def clean_binaries(
     *,
     source_dir: str | Path,
@@ -612,6 +784,8 @@ def clean_binaries(
             for p in project_root.rglob(pattern):
                 _rm_path(p)
         _rm_path(project_root / "CMakeCache.txt")
+        _rm_path(project_root / ".binman" / "pgo")
+        _rm_path(project_root / ".binman" / "build")
 
     if remove_pycache:
         for d in project_root.rglob("__pycache__"):
@@ -8,6 +8,20 @@ from pathlib import Path
 from typing import Any
 
 
+# Instruction-set levels of engine variants, lowest first. Non-x86 machines only have "baseline".
+ISA_LEVELS: tuple[str, ...] = ("baseline", "avx2", "avx512")
+
+# -march per level (x86-64 psABI levels v3 and v4).
+ISA_MARCH: dict[str, str] = {"baseline": "", "avx2": "x86-64-v3", "avx512": "x86-64-v4"}
+
+_ISA_FLAGS: dict[str, frozenset[str]] = {
+    "avx2": frozenset({"avx", "avx2", "bmi1", "bmi2", "f16c", "fma", "abm", "movbe", "xsave"}),
+    "avx512": frozenset({"avx512f", "avx512bw", "avx512cd", "avx512dq", "avx512vl"}),
+}
+
+_cpu_flags_cache: frozenset[str] | None = None
+
+
 def runtime_info() -> dict[str, str]:
     return {
         "python_version": f"{sys.version_info.major}.{sys.version_info.minor}",
@@ -17,6 +31,46 @@ def runtime_info() -> dict[str, str]:
     }
 
 
+def cpu_flags() -> frozenset[str]:
+    # The kernel's view of CPUID (minus features it disabled, e.g. AVX-512 without XSAVE support).
+    global _cpu_flags_cache
+    if _cpu_flags_cache is None:
+        flags: frozenset[str] = frozenset()
+        try:
+            with open("/proc/cpuinfo", "r", encoding="utf-8", errors="replace") as f:
+                for line in f:
+                    if line.startswith("flags"):
+                        flags = frozenset(line.partition(":")[2].split())
+                        break
+        except Exception:
+            pass
+        _cpu_flags_cache = flags
+    return _cpu_flags_cache
+
+
+def supported_isas() -> list[str]:
+    """ISA levels this machine can run, lowest first."""
+    if runtime_info()["machine"] not in ("x86_64", "amd64"):
+        return ["baseline"]
+    flags = cpu_flags()
+    out = ["baseline"]
+    required: set[str] = set()
+    for level in ISA_LEVELS[1:]:
+        required |= _ISA_FLAGS[level]
+        if not required <= flags:
+            break
+        out.append(level)
+    return out
+
+
+def host_isa() -> str:
+    return supported_isas()[-1]
+
+
+def isa_supported(isa: str) -> bool:
+    return isa in supported_isas()
+
+
 def cache_key() -> str:
     info = runtime_info()
     raw = (
@@ -50,4 +104,7 @@ def is_manifest_compatible(manifest_data: dict[str, Any]) -> bool:
         got = str(info.get(key, "")).strip().lower()
         if expected != got:
             return False
+    isa = str(manifest_data.get("isa", "")).strip().lower()
+    if isa and not isa_supported(isa):
+        return False
     return True
@@ -0,0 +1,964 @@
+// Engine benchmark: every sampler engine's read/parse/compute path against /proc and /sys fixture trees,
+// plus the metrics recorder's append and seek paths, the OpenMetrics exporter's render and the shared
+// rate kernels.
+// Not an engine module (it lives outside core/engines, so autobin skips it). Built by LxBinMan:
+//
+//   python -m lxbinman bench --source-dir core/engines --run -- [options]   (binary in .binman/bench/)
+//
+// or by hand:
+//
+//   g++ -O2 -std=c++17 -pthread -I core/engines core/bench/engine_bench.cpp -o /tmp/engine_bench
+//   /tmp/engine_bench [--cpus N] [--ifaces N] [--disks N] [--hwmon N] [--gpus N] [--bt N] [--pids N]
+//                     [--cgroups N] [--iters N] [--fixture DIR | --capture DIR | --generate DIR | --live] [--keep]
+//                     [--filter STR] [--json FILE] [--baseline FILE] [--tolerance PCT]
+//
+// Engines read the fixture through SourceRoot::at() (source_root.h). Without --fixture a synthetic
+// tree of the requested size is generated in a temp dir; --capture DIR copies the files the engines
+// read on this machine into DIR for later --fixture runs; --generate DIR writes the synthetic tree
+// there and exits (LxBinMan's PGO training fixture); --live samples the host.
+// Reported per op: mean, p50 and p99 ns, heap allocations and bytes, PinnedFile reads and opens.
+// With --baseline the run fails (exit 1) when a case got slower than the baseline by more than
+// --tolerance percent (default 25) or allocates more per op. Every run also checks that PinnedFile reads
+// the host's multi-page /proc seq_files whole, and fails when it does not.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "common/bt_engine.h"
+#include "common/cgroup_engine.h"
+#include "common/cpu_engine.h"
+#include "common/disc_engine.h"
+#include "common/engine_stats.h"
+#include "common/gpu_others_engine.h"
+#include "common/gpu_temp_engine.h"
+#include "common/net_engine.h"
+#include "common/node_stream.h"
+#include "common/openmetrics.h"
+#include "common/pressure_engine.h"
+#include "common/process_engine.h"
+#include "common/psu_engine.h"
+#include "common/ram_engine.h"
+#include "common/rate_kernels.h"
+#include "common/recorder.h"
+#include "common/snapshot_shm.h"
+#include "common/source_root.h"
+#include "common/sysinfo_engine.h"
+
+// --- Allocation counting (every operator new of the process; the bench is single-threaded) ---
+
+namespace {
+unsigned long long g_allocs = 0;
+unsigned long long g_alloc_bytes = 0;
+
+void* counted_alloc(std::size_t n) {
+    ++g_allocs;
+    g_alloc_bytes += n;
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+}  // namespace
+
+void* operator new(std::size_t n) { return counted_alloc(n); }
+void* operator new[](std::size_t n) { return counted_alloc(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    ++g_allocs;
+    g_alloc_bytes += n;
+    return std::malloc(n ? n : 1);
+}
+void* operator new[](std::size_t n, const std::nothrow_t& t) noexcept { return operator new(n, t); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+volatile double g_sink = 0.0;
+
+struct Sizes {
+    int cpus = 256;
+    int ifaces = 1000;
+    int disks = 500;
+    int hwmon = 200;
+    int gpus = 4;
+    int bt = 2;
+    int pids = 5000;
+    int cgroups = 2000;
+};
+
+// --- Synthetic fixture tree ---
+
+void put(const fs::path& p, const std::string& text) {
+    fs::create_directories(p.parent_path());
+    std::ofstream f(p, std::ios::binary | std::ios::trunc);
+    f << text;
+}
+
+std::string sd_name(int i) {
+    // sda .. sdz, sdaa .. sdzz, ... (the kernel's base-26 scheme)
+    std::string suffix;
+    for (int n = i + 1; n > 0; n = (n - 1) / 26) suffix.insert(suffix.begin(), static_cast<char>('a' + (n - 1) % 26));
+    return "sd" + suffix;
+}
+
+void write_synthetic(const fs::path& root, const Sizes& sz) {
+    std::ostringstream st;
+    st << "cpu  4705949 13082 1234567 98765432 45678 0 23456 789 0 0\n";
+    for (int i = 0; i < sz.cpus; ++i) st << "cpu" << i << " 36888 102 9645 771604 357 0 183 6 0 0\n";
+    st << "intr 123456789 0 9 0 0 0 0 0 0 1 0 0 0 0 0 0 0\nctxt 987654321\nbtime 1700000000\n"
+       << "processes 123456\nprocs_running 2\nprocs_blocked 0\nsoftirq 12345 0 1 2 3 4 5 6 7 8 9\n";
+    put(root / "proc/stat", st.str());
+
+    put(root / "proc/meminfo",
+        "MemTotal:       32768000 kB\nMemFree:         8123456 kB\nMemAvailable:   20123456 kB\n"
+        "Buffers:          512000 kB\nCached:         10240000 kB\nSwapCached:            0 kB\n"
+        "Active:         12000000 kB\nInactive:        8000000 kB\nShmem:            640000 kB\n"
+        "SReclaimable:     700000 kB\nSUnreclaim:       200000 kB\nSwapTotal:       8388604 kB\n"
+        "SwapFree:        8388604 kB\nDirty:               128 kB\nHugePages_Total:       0\n");
+
+    put(root / "proc/loadavg", "0.52 0.58 0.59 3/1234 56789\n");
+    put(root / "proc/uptime", "123456.78 987654.32\n");
+    std::ostringstream ci;
+    for (int i = 0; i < sz.cpus; ++i) {
+        ci << "processor\t: " << i << "\nvendor_id\t: AuthenticAMD\nmodel name\t: AMD EPYC 9654 96-Core Processor\n"
+           << "physical id\t: " << i / 128 << "\ncore id\t\t: " << i % 128 << "\nflags\t\t: fpu vme de pse tsc msr pae mce\n\n";
+    }
+    put(root / "proc/cpuinfo", ci.str());
+
+    // PSI, and a vmstat with the ~190 lines of a 6.x kernel (the wanted keys scattered through it).
+    put(root / "proc/pressure/cpu",
+        "some avg10=2.30 avg60=1.09 avg300=1.11 total=66073710\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+    put(root / "proc/pressure/memory",
+        "some avg10=0.12 avg60=0.05 avg300=0.01 total=1234567\nfull avg10=0.04 avg60=0.02 avg300=0.00 total=456789\n");
+    put(root / "proc/pressure/io",
+        "some avg10=0.00 avg60=0.01 avg300=0.73 total=88526554\nfull avg10=0.00 avg60=0.01 avg300=0.59 total=86118616\n");
+    std::ostringstream vm;
+    for (int i = 0; i < 60; ++i) vm << "nr_counter_" << i << " " << 1000000 + i * 7919 << "\n";
+    vm << "pgpgin 123456789\npgpgout 98765432\npswpin 1234\npswpout 5678\n";
+    for (int i = 0; i < 40; ++i) vm << "pgalloc_zone_" << i << " " << 55555555 + i << "\n";
+    vm << "allocstall_dma 0\nallocstall_dma32 0\nallocstall_normal 17\nallocstall_movable 3\nallocstall_device 0\n"
+       << "pgfault 987654321\npgmajfault 4321\npgsteal_kswapd 111111\npgsteal_direct 2222\npgsteal_khugepaged 0\n"
+       << "pgsteal_proactive 0\npgscan_kswapd 222222\npgscan_direct 3333\npgscan_khugepaged 0\npgscan_proactive 0\n"
+       << "pgscan_direct_throttle 0\npgscan_anon 100000\npgscan_file 125555\n";
+    for (int i = 0; i < 30; ++i) vm << "slabs_scanned_" << i << " " << 4242 + i << "\n";
+    vm << "oom_kill 2\n";
+    for (int i = 0; i < 45; ++i) vm << "thp_counter_" << i << " " << i << "\n";
+    put(root / "proc/vmstat", vm.str());
+
+    std::ostringstream nd;
+    nd << "Inter-|   Receive                                                |  Transmit\n"
+       << " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+       << "    lo: 123456789 12345 0 0 0 0 0 0 123456789 12345 0 0 0 0 0 0\n";
+    for (int i = 0; i < sz.ifaces; ++i) {
+        nd << " enp" << i << "s0: 9876543210 7654321 0 12 0 0 0 345 1234567890 2345678 0 0 0 0 0 0\n";
+    }
+    put(root / "proc/net/dev", nd.str());
+
+    // Processes: stat with a comm containing ') ' (parsed from the last ')'), io for every other one.
+    for (int i = 0; i < sz.pids; ++i) {
+        const int pid = 1000 + i;
+        const fs::path dir = root / "proc" / std::to_string(pid);
+        std::ostringstream ps;
+        ps << pid << " (" << (i % 7 == 0 ? "web) worker" : "task") << i % 100 << ") S 1 " << pid << ' ' << pid
+           << " 0 -1 4194560 " << 1234 + i << " 0 12 0 " << 3000 + i * 7 << ' ' << 500 + i << " 0 0 20 0 "
+           << 1 + i % 8 << " 0 " << 170000 + i << ' ' << 200000000 + i * 4096 << ' ' << 2000 + i % 5000
+           << " 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 " << i % 256 << " 0 0 0 0 0\n";
+        put(dir / "stat", ps.str());
+        if (i % 2 == 0) {
+            put(dir / "io", "rchar: " + std::to_string(12345678 + i) + "\nwchar: 2345678\nsyscr: 1234\nsyscw: 567\nread_bytes: " +
+                                std::to_string(4096 * i) + "\nwrite_bytes: 8192\ncancelled_write_bytes: 0\n");
+        }
+    }
+
+    // cgroup v2: services under system.slice (depth 2) and, every 4th, container scopes three levels down.
+    const fs::path cg = root / "sys/fs/cgroup";
+    put(cg / "cgroup.controllers", "cpuset cpu io memory hugetlb pids rdma misc\n");
+    auto put_cgroup = [&](const fs::path& dir, int i) {
+        put(dir / "cpu.stat", "usage_usec " + std::to_string(123456789 + i * 1000) + "\nuser_usec " + std::to_string(100000000 + i * 700) +
+                                  "\nsystem_usec " + std::to_string(23456789 + i * 300) +
+                                  "\ncore_sched.force_idle_usec 0\nnr_periods 0\nnr_throttled 0\nthrottled_usec 0\n"
+                                  "nr_bursts 0\nburst_usec 0\n");
+        put(dir / "memory.current", std::to_string(4096ULL * (1000 + i * 37)) + "\n");
+        put(dir / "memory.pressure",
+            "some avg10=0.00 avg60=0.00 avg300=0.00 total=" + std::to_string(i * 11) + "\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+        put(dir / "io.stat", "259:0 rbytes=" + std::to_string(4096 * i) + " wbytes=8192 rios=" + std::to_string(i) +
+                                 " wios=2 dbytes=0 dios=0\n8:0 rbytes=1024 wbytes=0 rios=1 wios=0 dbytes=0 dios=0\n");
+    };
+    put_cgroup(cg / "system.slice", sz.cgroups);
+    put_cgroup(cg / "kubepods.slice", sz.cgroups + 1);
+    for (int i = 0; i < sz.cgroups; ++i) {
+        if (i % 4 == 3) {
+            const fs::path pod = cg / "kubepods.slice" / ("kubepods-pod" + std::to_string(i / 16) + ".slice");
+            if (!fs::exists(pod / "cpu.stat")) put_cgroup(pod, i);
+            put_cgroup(pod / ("cri-containerd-" + std::to_string(i) + ".scope"), i);
+        } else {
+            put_cgroup(cg / "system.slice" / ("unit" + std::to_string(i) + ".service"), i);
+        }
+    }
+
+    // Half SATA (vendor/model under /sys/block), half NVMe (model under /sys/class/nvme), 2 partitions each.
+    std::ostringstream ds;
+    std::ostringstream mounts;
+    mounts << "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0\nsysfs /sys sysfs rw,nosuid,nodev,noexec,relatime 0 0\n";
+    for (int i = 0; i < sz.disks; ++i) {
+        const bool nvme = i % 2 == 1;
+        const std::string disk = nvme ? "nvme" + std::to_string(i / 2) + "n1" : sd_name(i / 2);
+        const std::string part = nvme ? disk + "p" : disk;
+        ds << (nvme ? " 259 " : "   8 ") << i * 4 << " " << disk
+           << " 1234567 2345 98765432 456789 2345678 3456 87654321 567890 0 678901 1024680 0 0 0 0 12345 6789\n";
+        for (int p = 1; p <= 2; ++p) {
+            ds << (nvme ? " 259 " : "   8 ") << i * 4 + p << " " << part << p
+               << " 123456 234 9876543 45678 234567 345 8765432 56789 0 67890 102468 0 0 0 0 0 0\n";
+        }
+        if (nvme) {
+            fs::create_directories(root / "sys/block" / disk);
+            put(root / "sys/class/nvme" / ("nvme" + std::to_string(i / 2)) / "model", "Samsung SSD 990 PRO 2TB\n");
+        } else {
+            put(root / "sys/block" / disk / "device/vendor", "ATA     \n");
+            put(root / "sys/block" / disk / "device/model", "ST4000DM004-2CV1\n");
+        }
+        if (i < 8) mounts << "/dev/" << part << "1 /mnt/d" << i << " ext4 rw,relatime 0 0\n";
+    }
+    for (int i = 0; i < 8; ++i) ds << "   7 " << i << " loop" << i << " 12 0 24 0 0 0 0 0 0 4 0 0 0 0 0 0 0\n";
+    put(root / "proc/diskstats", ds.str());
+    put(root / "proc/self/mounts", mounts.str());
+
+    // Board chips with a power input, one V*I rail and a temperature; every 10th is a GPU chip without DRM.
+    for (int i = 0; i < sz.hwmon; ++i) {
+        const fs::path hw = root / "sys/class/hwmon" / ("hwmon" + std::to_string(i));
+        put(hw / "name", i % 10 == 9 ? "amdgpu\n" : (i % 2 ? "nct6798\n" : "k10temp\n"));
+        put(hw / "power1_input", std::to_string(12'000'000 + i * 1000) + "\n");
+        put(hw / "power1_label", "PPT\n");
+        put(hw / "in0_input", "1200\n");
+        put(hw / "in0_label", "Vcore\n");
+        put(hw / "curr0_input", "15000\n");
+        put(hw / "temp1_input", std::to_string(45000 + i * 10) + "\n");
+        put(hw / "temp1_label", "Tctl\n");
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        const fs::path z = root / "sys/class/powercap" / ("intel-rapl:" + std::to_string(i));
+        put(z / "name", "package-" + std::to_string(i) + "\n");
+        put(z / "energy_uj", "123456789012\n");
+        put(z / "max_energy_range_uj", "262143328850\n");
+    }
+
+    const fs::path bat = root / "sys/class/power_supply/BAT0";
+    put(bat / "type", "Battery\n");
+    put(bat / "status", "Discharging\n");
+    put(bat / "capacity", "87\n");
+    put(bat / "power_now", "9876000\n");
+    put(bat / "voltage_now", "12345000\n");
+    put(root / "sys/class/power_supply/AC/type", "Mains\n");
+    put(root / "sys/class/power_supply/AC/online", "0\n");
+
+    fs::create_directories(root / "sys/bus/pci/drivers/amdgpu");
+    for (int i = 0; i < sz.gpus; ++i) {
+        const fs::path dev = root / "sys/class/drm" / ("card" + std::to_string(i)) / "device";
+        char slot[32];
+        std::snprintf(slot, sizeof(slot), "0000:%02x:00.0", 3 + i);
+        put(dev / "uevent", std::string("DRIVER=amdgpu\nPCI_CLASS=30000\nPCI_SLOT_NAME=") + slot + "\n");
+        put(dev / "gpu_busy_percent", std::to_string(i * 7 % 100) + "\n");
+        put(dev / "hwmon/hwmon0/name", "amdgpu\n");
+        put(dev / "hwmon/hwmon0/temp1_input", "52000\n");
+        put(dev / "hwmon/hwmon0/temp2_input", "61000\n");
+        fs::create_directory_symlink("../../../../bus/pci/drivers/amdgpu", dev / "driver");
+        fs::create_directories(root / "sys/class/drm" / ("card" + std::to_string(i) + "-DP-1"));
+    }
+
+    for (int i = 0; i < sz.bt; ++i) {
+        const std::string hci = "hci" + std::to_string(i);
+        const fs::path base = root / "sys/class/bluetooth" / hci;
+        put(base / "address", "00:1A:7D:DA:71:1" + std::to_string(i % 10) + "\n");
+        put(base / "statistics/rx_bytes", "1234567\n");
+        put(base / "statistics/tx_bytes", "765432\n");
+        put(base / "device/name", "Intel AX210 Bluetooth\n");
+        put(base / "device/vendor", "0x8087\n");
+        put(base / "device/device", "0x0032\n");
+        put(base / "device/uevent", "DRIVER=btusb\n");
+        put(base / "device/modalias", "usb:v8087p0032d0000dcE0dsc01dp01icE0isc01ip01in00\n");
+        fs::create_directories(root / "sys/class/bluetooth" / (hci + ":256"));
+        const fs::path rf = root / "sys/class/rfkill" / ("rfkill" + std::to_string(i));
+        put(rf / "name", hci + "\n");
+        put(rf / "soft", "0\n");
+        put(rf / "hard", "0\n");
+    }
+}
+
+// --- Capture of this machine's files ---
+
+bool copy_bytes(const fs::path& src, const fs::path& dst) {
+    const int fd = ::open(src.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) return false;
+    std::string data;
+    char buf[16384];
+    ssize_t n = 0;
+    while (data.size() < (1u << 20) && (n = ::read(fd, buf, sizeof(buf))) > 0) data.append(buf, static_cast<size_t>(n));
+    ::close(fd);
+    if (n < 0) return false;
+    put(dst, data);
+    return true;
+}
+
+// Recreates host path p inside root with every symlink on the way (sysfs links are relative),
+// so fs::canonical() inside the fixture resolves the way it does on the host. Returns the fixture dir.
+fs::path mirror_dir(const fs::path& root, const fs::path& p) {
+    std::error_code ec;
+    fs::path cur = "/";
+    for (const auto& part : p.relative_path()) {
+        const fs::path next = cur / part;
+        if (fs::is_symlink(next, ec)) {
+            const fs::path target = fs::read_symlink(next, ec);
+            fs::create_directories((root / next.relative_path()).parent_path(), ec);
+            fs::create_directory_symlink(target, root / next.relative_path(), ec);
+            cur = fs::canonical(next, ec);
+            if (ec) return root / next.relative_path();
+        } else {
+            cur = next;
+        }
+        fs::create_directories(root / cur.relative_path(), ec);
+    }
+    return root / cur.relative_path();
+}
+
+// Regular files directly in dir (sysfs attributes); unreadable ones (write-only, EPERM) are skipped.
+void copy_attrs(const fs::path& root, const fs::path& dir) {
+    std::error_code ec;
+    const fs::path out = mirror_dir(root, dir);
+    for (const auto& e : fs::directory_iterator(dir, ec)) {
+        if (e.is_symlink(ec) || !e.is_regular_file(ec)) continue;
+        copy_bytes(e.path(), out / e.path().filename());
+    }
+}
+
+void copy_link(const fs::path& root, const fs::path& link) {
+    std::error_code ec;
+    const fs::path target = fs::read_symlink(link, ec);
+    if (ec) return;
+    mirror_dir(root, link.parent_path());
+    fs::create_directory_symlink(target, root / link.relative_path(), ec);
+}
+
+template <typename Fn>
+void for_each_entry(const fs::path& dir, Fn&& fn) {
+    std::error_code ec;
+    for (const auto& e : fs::directory_iterator(dir, ec)) fn(e.path());
+}
+
+void capture(const fs::path& root) {
+    for (const char* p : {"proc/stat", "proc/meminfo", "proc/net/dev", "proc/diskstats", "proc/self/mounts", "proc/vmstat",
+                          "proc/pressure/cpu", "proc/pressure/memory", "proc/pressure/io", "proc/loadavg", "proc/uptime",
+                          "proc/cpuinfo"}) {
+        if (!copy_bytes(fs::path("/") / p, root / p)) std::fprintf(stderr, "capture: cannot read /%s\n", p);
+    }
+    std::error_code ec;
+    for_each_entry("/proc", [&](const fs::path& pid) {
+        const std::string name = pid.filename().string();
+        if (name.empty() || name.find_first_not_of("0123456789") != std::string::npos) return;
+        for (const char* f : {"stat", "io"}) copy_bytes(pid / f, root / pid.relative_path() / f);
+    });
+    for_each_entry("/sys/block", [&](const fs::path& b) {
+        mirror_dir(root, b);
+        for (const char* f : {"vendor", "model"}) copy_bytes(b / "device" / f, root / b.relative_path() / "device" / f);
+    });
+    for_each_entry("/sys/class/nvme", [&](const fs::path& c) {
+        copy_attrs(root, c);
+        for_each_entry(c / "device/hwmon", [&](const fs::path& hw) { copy_attrs(root, hw); });
+    });
+    for (const char* cls : {"/sys/class/hwmon", "/sys/class/powercap", "/sys/class/power_supply"}) {
+        for_each_entry(cls, [&](const fs::path& e) { copy_attrs(root, e); });
+    }
+    for_each_entry("/sys/class/drm", [&](const fs::path& card) {
+        mirror_dir(root, card);
+        const fs::path dev = card / "device";
+        if (card.filename().string().find('-') != std::string::npos || !fs::exists(dev, ec)) return;
+        const fs::path out = mirror_dir(root, dev);
+        for (const char* f : {"uevent", "gpu_busy_percent", "usage"}) copy_bytes(dev / f, out / f);
+        copy_link(root, dev / "driver");
+        for_each_entry(dev / "hwmon", [&](const fs::path& hw) { copy_attrs(root, hw); });
+    });
+    for_each_entry("/sys/class/bluetooth", [&](const fs::path& hci) {
+        copy_attrs(root, hci);
+        copy_attrs(root, hci / "statistics");
+        const fs::path out = mirror_dir(root, hci / "device");
+        for (const char* f : {"name", "vendor", "device", "uevent"}) copy_bytes(hci / "device" / f, out / f);
+        copy_link(root, hci / "device/driver");
+    });
+    for_each_entry("/sys/class/rfkill", [&](const fs::path& rf) { copy_attrs(root, rf); });
+    // The cgroup v2 tree to CgroupEngine's default depth (the hybrid layout's unified/ included).
+    for (const char* mount : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) {
+        if (!copy_bytes(fs::path(mount) / "cgroup.controllers", root / fs::path(mount).relative_path() / "cgroup.controllers")) continue;
+        std::vector<std::pair<fs::path, uint32_t>> pending{{fs::path(mount), 0}};
+        while (!pending.empty()) {
+            const auto [dir, depth] = pending.back();
+            pending.pop_back();
+            for_each_entry(dir, [&](const fs::path& e) {
+                if (!fs::is_directory(e, ec) || depth >= CgroupEngine::kDefaultMaxDepth) return;
+                const fs::path out = mirror_dir(root, e);
+                for (const char* f : {"cpu.stat", "memory.current", "memory.pressure", "io.stat"}) copy_bytes(e / f, out / f);
+                pending.emplace_back(e, depth + 1);
+            });
+        }
+    }
+}
+
+// --- Measurement ---
+
+struct Result {
+    std::string name;
+    int iters = 0;
+    double ns_per_op = 0.0;
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    double allocs_per_op = 0.0;
+    double alloc_bytes_per_op = 0.0;
+    double reads_per_op = 0.0;
+    double opens_per_op = 0.0;
+};
+
+struct Case {
+    std::string name;
+    int iters;
+    std::chrono::microseconds gap;   // untimed wait before each op (engines skip windows shorter than this)
+    std::function<void()> prepare;   // untimed, before each op
+    std::function<void()> op;
+};
+
+Result run_case(Case& c) {
+    for (int i = 0; i < c.iters / 10 + 1; ++i) {  // warm-up: first-call discovery, buffer growth
+        if (c.prepare) c.prepare();
+        c.op();
+    }
+
+    LatencyHistogram hist;
+    unsigned long long allocs = 0, bytes = 0, reads = 0, opens = 0;
+    PinnedIoCounters& io = pinned_io_counters();
+    for (int i = 0; i < c.iters; ++i) {
+        if (c.gap.count() > 0) std::this_thread::sleep_for(c.gap);
+        if (c.prepare) c.prepare();
+        const unsigned long long a0 = g_allocs, b0 = g_alloc_bytes, r0 = io.reads, o0 = io.opens;
+        const auto t0 = std::chrono::steady_clock::now();
+        c.op();
+        const auto t1 = std::chrono::steady_clock::now();
+        allocs += g_allocs - a0;
+        bytes += g_alloc_bytes - b0;
+        reads += io.reads - r0;
+        opens += io.opens - o0;
+        hist.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+    }
+
+    const double n = static_cast<double>(std::max(1, c.iters));
+    Result r;
+    r.name = c.name;
+    r.iters = c.iters;
+    r.ns_per_op = hist.mean_ns();
+    r.p50_ns = static_cast<double>(hist.percentile_ns(0.50));
+    r.p99_ns = static_cast<double>(hist.percentile_ns(0.99));
+    r.allocs_per_op = static_cast<double>(allocs) / n;
+    r.alloc_bytes_per_op = static_cast<double>(bytes) / n;
+    r.reads_per_op = static_cast<double>(reads) / n;
+    r.opens_per_op = static_cast<double>(opens) / n;
+    return r;
+}
+
+// --- Recorder: a collected_data-shaped tick (mostly rounded gauges, some counters and raw doubles) ---
+
+struct RecorderTick {
+    std::vector<std::string> paths;
+    std::vector<double> gauges;
+    int64_t ts_ms = 1'700'000'000'000;
+    unsigned long long counter = 1'000'000;
+};
+
+std::string rec_path(const std::string& group, const std::string& leaf) {
+    std::string p;
+    for (const std::string* seg : {&group, &leaf}) {
+        p.push_back(kRecKey);
+        p.push_back(static_cast<char>(seg->size()));
+        p += *seg;
+    }
+    return p;
+}
+
+RecorderTick make_recorder_tick(int series) {
+    RecorderTick t;
+    for (int i = 0; i < series; ++i) {
+        t.paths.push_back(rec_path("group" + std::to_string(i / 10), "metric_" + std::to_string(i)));
+        t.gauges.push_back(10.0 + i % 80);
+    }
+    return t;
+}
+
+void write_recorder_tick(RecordWriter& w, RecorderTick& t, std::string& error) {
+    w.begin_tick(t.ts_ms);
+    t.ts_ms += 250 + static_cast<int64_t>(t.counter % 3);
+    t.counter += 4099;
+    for (size_t i = 0; i < t.paths.size(); ++i) {
+        double& g = t.gauges[i];
+        g += ((t.counter >> (i % 16)) & 7) * 0.1 - 0.35;
+        switch (i % 4) {
+            case 0: w.add_int(t.paths[i], kRecInt, static_cast<int64_t>(t.counter + i)); break;
+            case 1: w.add_float(t.paths[i], g * 1.000001); break;  // full precision
+            default: w.add_float(t.paths[i], std::round(g * 10.0) / 10.0); break;
+        }
+    }
+    w.end_tick(error);
+}
+
+// --- Exporter: a large box (256 cores, 128 disks, 128 interfaces), about 3500 series per render ---
+
+SamplerSnapshot make_export_snapshot() {
+    SamplerSnapshot s;
+    s.generation = 42;
+    s.timestamp_s = 1'700'000'000.25;
+    s.tick_ms = 0.8;
+    s.sampled = s.fresh = kSampleCpu | kSampleRam | kSampleDisc | kSampleNet | kSamplePsu | kSampleGpuOthers | kSampleGpuTemp |
+                          kSamplePressure;
+    s.cpu = 37.5;
+    s.cpu_cores.rows = 256;
+    s.cpu_cores.online.assign(256, 1);
+    for (size_t i = 0; i < 256 * kCoreColumns; ++i) s.cpu_cores.values.push_back(static_cast<double>(i % 97) * 1.03);
+    s.ram = 61.2;
+    for (int i = 0; i < 128; ++i) {
+        DiscActivityEngine::DiskRecord r;
+        r.disk = "nvme" + std::to_string(i) + "n1";
+        r.label = "Samsung SSD 990 PRO 2TB (" + r.disk + ")";
+        r.util_pct = 12.5 + i;
+        r.read_mib_s = 140.25 * i;
+        r.write_mib_s = 0.0625 * i;
+        r.read_iops = 1200.0 + i;
+        r.write_await_ms = 0.41;
+        r.queue_depth = 1.7;
+        r.in_flight = static_cast<unsigned long long>(i % 4);
+        s.disc_stats.push_back(r);
+    }
+    for (int i = 0; i < 128; ++i) {
+        NetActivityEngine::IfRates r;
+        r.name = "veth" + std::to_string(i * 7919);
+        r.rx_mbps = 93.7 * i;
+        r.tx_mbps = 1.25 * i;
+        r.rx_pps = 8100.0 + i;
+        s.net_ifaces.push_back(r);
+    }
+    s.net_rx = 5900.1;
+    s.net_tx = 81.3;
+    s.psu_all.total_w = 412.6;
+    for (int i = 0; i < 24; ++i) s.psu_all.sources_w.emplace_back("hwmon" + std::to_string(i) + ":power1", 11.5 + i);
+    for (int i = 0; i < 4; ++i) {
+        GpuCardReading c;
+        c.card = "card" + std::to_string(i);
+        c.slot = "0000:0" + std::to_string(i + 3) + ":00.0";
+        c.driver = "amdgpu";
+        c.busy_pct = 55.0 + i;
+        c.temp_c = 61.0 + i;
+        s.gpu_cards.push_back(c);
+    }
+    s.pressure_all.has_psi = true;
+    for (auto& res : s.pressure_all.resources) res.available = true;
+    return s;
+}
+
+std::vector<Result> run_all(const SourceRoot& root, int iters, const std::string& filter) {
+    using std::chrono::microseconds;
+    const int discover_iters = std::max(5, iters / 20);
+
+    CpuSensing cpu(root);
+    RamSensing ram(root);
+    NetActivityEngine net(root, NetActivityEngine::Backend::ProcText);
+    NetActivityEngine net_netlink(root, NetActivityEngine::Backend::Netlink);
+    DiscActivityEngine disc(root);
+    PowerTelemetryEngine psu(root);
+    GpuOthers gpu_busy(root);
+    GpuTempEngine gpu_temp(root);
+    BtActivityEngine bt(root);
+    ProcessActivityEngine procs(root);
+    PressureEngine pressure(root);
+    SysInfoEngine sysinfo(root);
+    CgroupEngine cgroups(root);
+
+    std::vector<Case> cases;
+    cases.push_back({"cpu.get_usage", iters, microseconds(0), nullptr, [&] { g_sink = cpu.get_usage(); }});
+    cases.push_back({"cpu.sample_cores", iters, microseconds(0), nullptr, [&] { g_sink = cpu.sample_cores(); }});
+    cases.push_back({"ram.get_usage", iters, microseconds(0), nullptr, [&] { g_sink = ram.get_usage(); }});
+    // compute_all_usage() returns early on windows of 100 us or less.
+    cases.push_back({"net.get_all_usage", iters, microseconds(150), nullptr,
+                     [&] { g_sink = static_cast<double>(net.get_all_usage().size()); }});
+    // Netlink sees the host's links whatever the fixture holds, so it only compares against text under --live.
+    if (root.is_host() && std::string_view(net_netlink.backend_name()) == "netlink") {
+        cases.push_back({"net.get_all_usage.netlink", iters, microseconds(150), nullptr,
+                         [&] { g_sink = static_cast<double>(net_netlink.get_all_usage().size()); }});
+    }
+    // Disc windows under 1 ms only zero the usage list.
+    cases.push_back({"disc.get_all_usage", iters, microseconds(1100), nullptr,
+                     [&] { g_sink = static_cast<double>(disc.get_all_usage().size()); }});
+    cases.push_back({"disc.discover", discover_iters, microseconds(0), nullptr,
+                     [&] { DiscActivityEngine fresh(root); g_sink = fresh.get_usage(); }});
+    cases.push_back({"psu.get_all_usage", iters, microseconds(0), [&] { psu.invalidate(); },
+                     [&] { g_sink = psu.get_all_usage().total_w; }});
+    cases.push_back({"psu.discover", discover_iters, microseconds(0), [&] { psu.rescan(); },
+                     [&] { g_sink = psu.get_all_usage().total_w; }});
+    cases.push_back({"gpu_others.get_all_usage", iters, microseconds(0), nullptr,
+                     [&] { g_sink = GpuOthers::busiest(gpu_busy.get_all_usage()); }});
+    cases.push_back({"gpu_temp.get_all_usage", iters, microseconds(0), nullptr,
+                     [&] { g_sink = GpuTempEngine::hottest(gpu_temp.get_all_usage()); }});
+    cases.push_back({"gpu_temp.discover", discover_iters, microseconds(0), [&] { gpu_temp.rescan(); },
+                     [&] { g_sink = GpuTempEngine::hottest(gpu_temp.get_all_usage()); }});
+    cases.push_back({"bt.get_all_usage", iters, microseconds(150), nullptr,
+                     [&] { g_sink = static_cast<double>(bt.get_all_usage().size()); }});
+    // Samples closer than 1 ms return the previous snapshot.
+    cases.push_back({"pressure.sample", iters, microseconds(1100), nullptr,
+                     [&] { g_sink = pressure.sample().resources[kPsiMemory].some_pct; }});
+    cases.push_back({"sysinfo.sample", iters, microseconds(0), nullptr,
+                     [&] { g_sink = static_cast<double>(sysinfo.sample().procs_running); }});
+    cases.push_back({"sysinfo.discover", discover_iters, microseconds(0), [&] { sysinfo.rescan(); },
+                     [&] { g_sink = sysinfo.sample().cpu_temp_c; }});
+    // Samples closer than 1 ms return the previous lists.
+    cases.push_back({"process.sample", discover_iters, microseconds(1100), nullptr,
+                     [&] { g_sink = static_cast<double>(procs.sample(10).processes); }});
+    // Bounded per tick: the previous winners plus scan_budget cgroups; discover re-walks the whole tree.
+    cases.push_back({"cgroup.sample", iters, microseconds(1100), nullptr,
+                     [&] { g_sink = static_cast<double>(cgroups.sample(10).read); }});
+    cases.push_back({"cgroup.discover", discover_iters, microseconds(1100), [&] { cgroups.rescan(); },
+                     [&] { g_sink = static_cast<double>(cgroups.sample(10).cgroups); }});
+
+    OpenMetricsWriter om_writer;
+    const SamplerSnapshot om_snap = make_export_snapshot();
+    cases.push_back({"openmetrics.render", iters, microseconds(0), nullptr,
+                     [&] { g_sink = static_cast<double>(om_writer.render(om_snap, om_snap.timestamp_s + 0.1).size()); }});
+
+    // Remote mode on the same box: one tick encoded as a delta (a tenth of the core and disk values moved),
+    // and the viewer applying it. The 64 ticks form a cycle, so the viewer's table always matches the stream.
+    constexpr int kStreamTicks = 64;
+    std::vector<SamplerSnapshot> stream_ticks(kStreamTicks, om_snap);
+    for (int t = 0; t < kStreamTicks; ++t) {
+        SamplerSnapshot& s = stream_ticks[t];
+        s.generation += static_cast<uint64_t>(t);
+        s.timestamp_s += 0.25 * t;
+        s.cpu += t % 7;
+        for (size_t i = static_cast<size_t>(t) % 10; i < s.cpu_cores.values.size(); i += 10) s.cpu_cores.values[i] += t % 3;
+        for (size_t i = static_cast<size_t>(t) % 10; i < s.disc_stats.size(); i += 10) s.disc_stats[i].read_mib_s += t;
+    }
+    SnapshotShmCodec stream_codec;
+    NodeStreamEncoder stream_encoder;
+    NodeTable stream_table;
+    std::vector<std::vector<uint8_t>> stream_messages;
+    for (int t = 0; t <= kStreamTicks; ++t) {
+        stream_codec.encode(stream_ticks[t % kStreamTicks], stream_encoder);
+        const auto& m = stream_encoder.message();
+        if (t == 0) {
+            lxrec::Reader r(m.data(), m.size());
+            const size_t head = lxnode::varint_size(r.varint());
+            stream_table.apply(m[head], m.data() + head + 1, m.size() - head - 1);
+        } else {
+            stream_messages.push_back(m);
+        }
+    }
+    size_t stream_next = 0;
+    cases.push_back({"stream.encode", iters, microseconds(0), nullptr, [&] {
+                         stream_codec.encode(stream_ticks[stream_next++ % kStreamTicks], stream_encoder);
+                         g_sink = static_cast<double>(stream_encoder.message().size());
+                     }});
+    size_t stream_applied = 0;
+    cases.push_back({"stream.decode", iters, microseconds(0), nullptr, [&] {
+                         const auto& m = stream_messages[stream_applied++ % stream_messages.size()];
+                         lxrec::Reader r(m.data(), m.size());
+                         const size_t head = lxnode::varint_size(r.varint());
+                         g_sink = stream_table.apply(m[head], m.data() + head + 1, m.size() - head - 1) ? stream_table.value("cpu") : -1.0;
+                     }});
+
+    // One tick of a 4000-veth node: 8 counters per interface (NetActivityEngine's layout), then the
+    // per-interface sum/max pass a dashboard total needs. Reports which ISA level the kernels run at.
+    constexpr size_t kRateItems = 4000 * 8;
+    std::vector<lxrate::Counter> rate_cur(kRateItems), rate_prev(kRateItems);
+    std::vector<double> rate_out(kRateItems);
+    for (size_t i = 0; i < kRateItems; ++i) {
+        rate_prev[i] = 1'000'000'000ULL * (i % 13) + i * 7919;
+        rate_cur[i] = rate_prev[i] + (i % 5 == 0 ? 0 : i * 31);
+    }
+    const std::string rate_case = std::string("rate.scaled_deltas.") + lxisa::level();
+    cases.push_back({rate_case, iters, microseconds(0), nullptr, [&] {
+                         lxrate::scaled_deltas(rate_cur.data(), rate_prev.data(), kRateItems, 1.0 / 0.25, rate_out.data());
+                         lxrate::clamp_all(rate_out.data(), kRateItems, 0.0, 1e12);
+                         g_sink = lxrate::reduce(rate_out.data(), kRateItems).max;
+                     }});
+
+    // 300 series per tick into 30 s chunks; seeks within 6 h of 100 series at 4 Hz (86400 ticks).
+    const fs::path rec_dir = fs::temp_directory_path() / ("lxbench-rec-" + std::to_string(::getpid()));
+    std::string rec_error;
+    RecordWriter rec_writer;
+    RecorderTick rec_tick = make_recorder_tick(300);
+    RecordReader rec_reader;
+    int64_t rec_first = 0;
+    unsigned long long rec_seed = 1;
+    const bool want_recorder = filter.empty() || std::string("recorder.append").find(filter) != std::string::npos ||
+                               std::string("recorder.seek").find(filter) != std::string::npos;
+    if (want_recorder) {
+        RecorderConfig rc;
+        rc.directory = (rec_dir / "append").string();
+        rec_writer.open(rc, rec_error);
+        RecorderConfig sc;
+        sc.directory = (rec_dir / "seek").string();
+        RecordWriter seed;
+        RecorderTick seed_tick = make_recorder_tick(100);
+        if (seed.open(sc, rec_error)) {
+            for (int i = 0; i < 6 * 3600 * 4; ++i) write_recorder_tick(seed, seed_tick, rec_error);
+            seed.close(rec_error);
+        }
+        if (rec_reader.open(sc.directory, sc.prefix, rec_error)) rec_first = rec_reader.first_ms();
+        cases.push_back({"recorder.append", iters, microseconds(0), nullptr,
+                         [&] { write_recorder_tick(rec_writer, rec_tick, rec_error); }});
+        cases.push_back({"recorder.seek", discover_iters, microseconds(0), nullptr, [&] {
+                             rec_seed = rec_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                             rec_reader.seek(rec_first + static_cast<int64_t>((rec_seed >> 33) % (6ULL * 3600 * 1000)));
+                             int64_t ts = 0;
+                             rec_reader.next(ts, [](const RecordReader::Value& v) { g_sink = v.f; });
+                         }});
+    }
+
+    std::vector<Result> out;
+    for (auto& c : cases) {
+        if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+        out.push_back(run_case(c));
+        const Result& r = out.back();
+        std::printf("%-26s %7d  %12.0f ns/op  p50 %10.0f  p99 %10.0f  %9.1f allocs/op %11.0f B/op  %7.1f reads/op %6.1f opens/op\n",
+                    r.name.c_str(), r.iters, r.ns_per_op, r.p50_ns, r.p99_ns, r.allocs_per_op, r.alloc_bytes_per_op,
+                    r.reads_per_op, r.opens_per_op);
+        std::fflush(stdout);
+    }
+    if (want_recorder) {
+        rec_writer.close(rec_error);
+        const RecorderStats rs = rec_writer.stats();
+        if (rs.values) {
+            std::printf("%-26s %llu values in %llu chunks, %.3f B/value\n", "recorder.append",
+                        static_cast<unsigned long long>(rs.values), static_cast<unsigned long long>(rs.chunks),
+                        static_cast<double>(rs.bytes) / static_cast<double>(rs.values));
+        }
+        rec_reader.close();
+        std::error_code ec;
+        fs::remove_all(rec_dir, ec);
+    }
+    return out;
+}
+
+// --- JSON report and baseline comparison (one case per line, so the reader needs no JSON library) ---
+
+void write_json(FILE* f, const std::string& fixture, const Sizes& sz, const std::vector<Result>& results) {
+    std::fprintf(f, "{\n  \"fixture\": \"%s\",\n", fixture.c_str());
+    std::fprintf(f, "  \"sizes\": {\"cpus\": %d, \"ifaces\": %d, \"disks\": %d, \"hwmon\": %d, \"gpus\": %d, \"bt\": %d},\n",
+                 sz.cpus, sz.ifaces, sz.disks, sz.hwmon, sz.gpus, sz.bt);
+    std::fprintf(f, "  \"cases\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f,
+                     "    {\"name\": \"%s\", \"iters\": %d, \"ns_per_op\": %.1f, \"p50_ns\": %.0f, \"p99_ns\": %.0f, "
+                     "\"allocs_per_op\": %.2f, \"alloc_bytes_per_op\": %.0f, \"reads_per_op\": %.2f, \"opens_per_op\": %.2f}%s\n",
+                     r.name.c_str(), r.iters, r.ns_per_op, r.p50_ns, r.p99_ns, r.allocs_per_op, r.alloc_bytes_per_op,
+                     r.reads_per_op, r.opens_per_op, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+struct BaselineEntry {
+    std::string name;
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+};
+
+double number_after(const std::string& line, const char* key) {
+    const size_t at = line.find(key);
+    return at == std::string::npos ? -1.0 : std::atof(line.c_str() + at + std::strlen(key));
+}
+
+std::vector<BaselineEntry> read_baseline(const std::string& path) {
+    std::vector<BaselineEntry> out;
+    std::ifstream f(path);
+    std::string line;
+    while (std::getline(f, line)) {
+        static constexpr char kName[] = "\"name\": \"";
+        const size_t at = line.find(kName);
+        if (at == std::string::npos) continue;
+        const size_t start = at + sizeof(kName) - 1;
+        BaselineEntry e;
+        e.name = line.substr(start, line.find('"', start) - start);
+        e.ns_per_op = number_after(line, "\"ns_per_op\": ");
+        e.allocs_per_op = number_after(line, "\"allocs_per_op\": ");
+        out.push_back(std::move(e));
+    }
+    return out;
+}
+
+// Returns the number of regressed cases. p50 would be steadier, but the baseline keeps the mean that is printed.
+int compare(const std::vector<Result>& results, const std::vector<BaselineEntry>& base, double tolerance_pct) {
+    int regressions = 0;
+    for (const Result& r : results) {
+        const auto it = std::find_if(base.begin(), base.end(), [&](const BaselineEntry& b) { return b.name == r.name; });
+        if (it == base.end() || it->ns_per_op <= 0.0) continue;
+        const double change = 100.0 * (r.ns_per_op - it->ns_per_op) / it->ns_per_op;
+        const bool slower = change > tolerance_pct;
+        const bool more_allocs = r.allocs_per_op > it->allocs_per_op + 0.5;
+        if (slower || more_allocs) ++regressions;
+        std::printf("%-26s %+7.1f%% time  %+8.1f allocs/op%s\n", r.name.c_str(), change, r.allocs_per_op - it->allocs_per_op,
+                    slower || more_allocs ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+// Fixtures are regular files, which come back whole from one read; live record-based seq_files return about
+// a page per pread(). Reads the host's multi-page seq_files through PinnedFile and compares their line count
+// with a plain sequential read. Line counts, since counter values move between the two reads.
+int check_seq_files() {
+    int failures = 0;
+    for (const char* path : {"/proc/self/mountinfo", "/proc/net/dev", "/proc/diskstats", "/proc/vmstat", "/proc/kallsyms"}) {
+        std::ifstream in(path);
+        if (!in) continue;
+        std::ostringstream whole;
+        whole << in.rdbuf();
+        const std::string expected = whole.str();
+        if (expected.size() <= 4096) continue;
+        PinnedFile f(path);
+        std::string_view got;
+        const bool ok = f.read(got);
+        const auto lines = [](std::string_view t) { return std::count(t.begin(), t.end(), '\n'); };
+        if (!ok || lines(got) != lines(expected)) {
+            std::printf("seq_file %s: PinnedFile read %zu of %zu bytes (%ld of %ld lines)  FAILED\n", path, got.size(),
+                        expected.size(), static_cast<long>(lines(got)), static_cast<long>(lines(expected)));
+            ++failures;
+        } else {
+            std::printf("seq_file %s: %zu bytes, %ld lines  ok\n", path, got.size(), static_cast<long>(lines(got)));
+        }
+    }
+    return failures;
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--cpus N] [--ifaces N] [--disks N] [--hwmon N] [--gpus N] [--bt N] [--pids N]\n"
+                 "          [--cgroups N] [--iters N] [--fixture DIR | --capture DIR | --generate DIR | --live] [--keep]\n"
+                 "          [--filter STR] [--json FILE] [--baseline FILE] [--tolerance PCT]\n",
+                 argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Sizes sz;
+    int iters = 2000;
+    bool live = false, keep = false;
+    std::string fixture, capture_dir, generate_dir, filter, json_path, baseline_path;
+    double tolerance = 25.0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        auto next_int = [&](int& out) {
+            if (has_value) out = std::max(0, std::atoi(argv[++i]));
+        };
+        auto next_str = [&](std::string& out) {
+            if (has_value) out = argv[++i];
+        };
+        if (arg == "--cpus") next_int(sz.cpus);
+        else if (arg == "--ifaces") next_int(sz.ifaces);
+        else if (arg == "--disks") next_int(sz.disks);
+        else if (arg == "--hwmon") next_int(sz.hwmon);
+        else if (arg == "--gpus") next_int(sz.gpus);
+        else if (arg == "--bt") next_int(sz.bt);
+        else if (arg == "--pids") next_int(sz.pids);
+        else if (arg == "--cgroups") next_int(sz.cgroups);
+        else if (arg == "--iters") next_int(iters);
+        else if (arg == "--fixture") next_str(fixture);
+        else if (arg == "--capture") next_str(capture_dir);
+        else if (arg == "--generate") next_str(generate_dir);
+        else if (arg == "--live") live = true;
+        else if (arg == "--keep") keep = true;
+        else if (arg == "--filter") next_str(filter);
+        else if (arg == "--json") next_str(json_path);
+        else if (arg == "--baseline") next_str(baseline_path);
+        else if (arg == "--tolerance" && has_value) tolerance = std::atof(argv[++i]);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    iters = std::max(1, iters);
+
+    if (!capture_dir.empty()) {
+        capture(fs::absolute(capture_dir));
+        std::printf("captured this machine's engine inputs into %s\n", capture_dir.c_str());
+        return 0;
+    }
+    if (!generate_dir.empty()) {
+        write_synthetic(fs::absolute(generate_dir), sz);
+        std::printf("wrote a synthetic fixture into %s\n", generate_dir.c_str());
+        return 0;
+    }
+
+    const std::vector<BaselineEntry> baseline = baseline_path.empty() ? std::vector<BaselineEntry>{} : read_baseline(baseline_path);
+    if (!baseline_path.empty() && baseline.empty()) {
+        std::fprintf(stderr, "baseline %s has no cases\n", baseline_path.c_str());
+        return 2;
+    }
+
+    fs::path root;
+    std::string label = "live";
+    bool generated = false;
+    if (live) {
+        std::printf("fixture: live system, %d iterations\n", iters);
+    } else if (!fixture.empty()) {
+        root = fs::absolute(fixture);
+        label = root.string();
+        std::printf("fixture: %s, %d iterations\n", label.c_str(), iters);
+    } else {
+        char tmpl[] = "/tmp/lxbench-XXXXXX";
+        if (!::mkdtemp(tmpl)) {
+            std::fprintf(stderr, "mkdtemp: %s\n", std::strerror(errno));
+            return 2;
+        }
+        root = tmpl;
+        generated = true;
+        write_synthetic(root, sz);
+        label = "synthetic";
+        std::printf("fixture: synthetic in %s, %d cpus, %d ifaces, %d disks, %d hwmon, %d gpus, %d bt, %d pids, %d cgroups, %d iterations\n",
+                    root.c_str(), sz.cpus, sz.ifaces, sz.disks, sz.hwmon, sz.gpus, sz.bt, sz.pids, sz.cgroups, iters);
+    }
+    std::fflush(stdout);
+
+    const int seq_failures = check_seq_files();
+    const std::vector<Result> results = run_all(live ? SourceRoot::host() : SourceRoot::at(root.string()), iters, filter);
+    if (generated && !keep) {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    } else if (generated) {
+        std::printf("kept fixture in %s\n", root.c_str());
+    }
+
+    if (!json_path.empty()) {
+        FILE* json = std::fopen(json_path.c_str(), "w");
+        if (!json) {
+            std::fprintf(stderr, "cannot write %s: %s\n", json_path.c_str(), std::strerror(errno));
+            return 2;
+        }
+        write_json(json, label, sz, results);
+        std::fclose(json);
+    }
+    if (seq_failures) std::printf("%d seq_file(s) read short\n", seq_failures);
+    if (baseline.empty()) return seq_failures ? 1 : 0;
+    const int regressions = compare(results, baseline, tolerance);
+    if (regressions) std::printf("%d case(s) regressed beyond %.0f%%\n", regressions, tolerance);
+    return regressions || seq_failures ? 1 : 0;
+}
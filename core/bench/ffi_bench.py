@@ -0,0 +1,86 @@
+"""
+Cost of Python -> C++ crossings per tick: per-engine calls (the perform_check loop) vs sampler.collect().
+
+Needs the compiled modules in core/engines (python -m lxbinman build --source-dir core/engines).
+Run from the project root:
+
+    python core/bench/ffi_bench.py [--iters N] [--engines cpu,ram,disc,net,...]
+"""
+
+import argparse
+import importlib
+import sys
+import time
+from pathlib import Path
+
+ENGINES_DIR = Path(__file__).resolve().parents[1] / "engines"
+
+# Calls perform_check makes per engine when the sampler is not used.
+PER_ENGINE_CALLS = {
+    "cpu": ("get_usage",),
+    "ram": ("get_usage",),
+    "disc": ("get_all_usage",),
+    "net": ("get_all_usage", "get_total_mbps", "get_rx_mbps", "get_tx_mbps"),
+    "bt": ("get_all_usage",),
+    "psu": ("get_all_usage", "get_usage"),
+    "gpu_others": ("get_usage",),
+    "gpu_temp": ("get_usage",),
+}
+
+
+def _load(name):
+    try:
+        return importlib.import_module(name)
+    except ImportError as exc:
+        print(f"skip {name}: {exc}")
+        return None
+
+
+def _ns_per_call(fn, iters):
+    for _ in range(max(1, iters // 10)):
+        fn()
+    t0 = time.perf_counter_ns()
+    for _ in range(iters):
+        fn()
+    return (time.perf_counter_ns() - t0) / iters
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--iters", type=int, default=2000)
+    parser.add_argument("--engines", default=",".join(PER_ENGINE_CALLS))
+    args = parser.parse_args()
+
+    sys.path.insert(0, str(ENGINES_DIR))
+    sampler = _load("sampler")
+    wanted = [e.strip() for e in args.engines.split(",") if e.strip() in PER_ENGINE_CALLS]
+    modules = {name: mod for name in wanted if (mod := _load(name)) is not None}
+
+    if sampler is not None and hasattr(sampler, "ffi_noop"):
+        noop_ns = _ns_per_call(sampler.ffi_noop, args.iters * 20)
+        print(f"empty crossing:            {noop_ns:10.0f} ns")
+
+    calls = [getattr(mod, method) for name, mod in modules.items() for method in PER_ENGINE_CALLS[name]]
+    if calls:
+        def per_engine_tick():
+            for call in calls:
+                call()
+
+        tick_ns = _ns_per_call(per_engine_tick, args.iters)
+        print(f"per-engine tick:           {tick_ns:10.0f} ns  ({len(calls)} crossings, {tick_ns / len(calls):.0f} ns each)")
+
+    if sampler is not None and hasattr(sampler, "collect"):
+        names = list(modules) or wanted
+        out = {}
+        collect_ns = _ns_per_call(lambda: sampler.collect(names, out), args.iters)
+        print(f"sampler.collect() tick:    {collect_ns:10.0f} ns  (1 crossing, {len(names)} engines)")
+
+        sampler.start(names, 250)
+        time.sleep(0.3)
+        snap_ns = _ns_per_call(lambda: sampler.collect(names, out), args.iters)
+        sampler.stop()
+        print(f"collect() w/ thread:       {snap_ns:10.0f} ns  (snapshot copy + dict refill only)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,357 @@
+// Microbenchmark: procfs parsers in core/engines/common/proc_parse.h vs the iostream parsers they replaced.
+// Not an engine module (it lives outside core/engines, so autobin skips it). Build and run:
+//
+//   g++ -O3 -std=c++17 -I core/engines core/bench/parse_bench.cpp -o /tmp/parse_bench
+//   /tmp/parse_bench [--live] [--cores N] [--ifaces N] [--disks N] [--iters N]
+//
+// Both sides parse the same in-memory text, so the numbers are parse cost only (no syscalls).
+// --live snapshots this machine's /proc files once; otherwise synthetic fixtures are generated.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/proc_parse.h"
+
+namespace {
+
+volatile unsigned long long g_sink = 0;
+
+struct Fixtures {
+    std::string stat;
+    std::string meminfo;
+    std::string net_dev;
+    std::string diskstats;
+    std::vector<std::string> tracked_disks;
+};
+
+std::string slurp(const char* path) {
+    std::ifstream f(path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+Fixtures synthetic(int cores, int ifaces, int disks) {
+    Fixtures fx;
+    std::ostringstream st;
+    st << "cpu  4705949 13082 1234567 98765432 45678 0 23456 789 0 0\n";
+    for (int i = 0; i < cores; ++i) {
+        st << "cpu" << i << " 36888 102 9645 771604 357 0 183 6 0 0\n";
+    }
+    st << "intr 123456789 0 9 0 0 0 0 0 0 1 0 0 0 0 0 0 0\nctxt 987654321\nbtime 1700000000\n"
+       << "processes 123456\nprocs_running 2\nprocs_blocked 0\nsoftirq 12345 0 1 2 3 4 5 6 7 8 9\n";
+    fx.stat = st.str();
+
+    static const char* kMem[] = {
+        "MemTotal", "MemFree", "MemAvailable", "Buffers", "Cached", "SwapCached", "Active", "Inactive",
+        "Active(anon)", "Inactive(anon)", "Active(file)", "Inactive(file)", "Unevictable", "Mlocked",
+        "SwapTotal", "SwapFree", "Zswap", "Zswapped", "Dirty", "Writeback", "AnonPages", "Mapped", "Shmem",
+        "KReclaimable", "Slab", "SReclaimable", "SUnreclaim", "KernelStack", "PageTables", "SecPageTables",
+        "NFS_Unstable", "Bounce", "WritebackTmp", "CommitLimit", "Committed_AS", "VmallocTotal", "VmallocUsed",
+        "VmallocChunk", "Percpu", "HardwareCorrupted", "AnonHugePages", "ShmemHugePages", "ShmemPmdMapped",
+        "FileHugePages", "FilePmdMapped", "Unaccepted", "HugePages_Total", "HugePages_Free", "HugePages_Rsvd",
+        "HugePages_Surp", "Hugepagesize", "Hugetlb", "DirectMap4k", "DirectMap2M", "DirectMap1G",
+    };
+    std::ostringstream mi;
+    unsigned long long v = 32'000'000;
+    for (const char* k : kMem) {
+        mi << k << ":" << std::string(16 - std::min<size_t>(15, std::strlen(k)), ' ') << v << " kB\n";
+        v = v / 2 + 1234;
+    }
+    fx.meminfo = mi.str();
+
+    std::ostringstream nd;
+    nd << "Inter-|   Receive                                                |  Transmit\n"
+       << " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+       << "    lo: 123456789 12345 0 0 0 0 0 0 123456789 12345 0 0 0 0 0 0\n";
+    for (int i = 0; i < ifaces; ++i) {
+        nd << "  eth" << i << ": 9876543210 7654321 0 12 0 0 0 345 1234567890 2345678 0 0 0 0 0 0\n";
+    }
+    fx.net_dev = nd.str();
+
+    std::ostringstream ds;
+    for (int i = 0; i < disks; ++i) {
+        const std::string disk = "nvme" + std::to_string(i) + "n1";
+        fx.tracked_disks.push_back(disk);
+        ds << " 259       " << i * 8 << " " << disk
+           << " 1234567 2345 98765432 456789 2345678 3456 87654321 567890 0 678901 1024680 0 0 0 0 12345 6789\n";
+        for (int p = 1; p <= 3; ++p) {
+            ds << " 259       " << i * 8 + p << " " << disk << "p" << p
+               << " 123456 234 9876543 45678 234567 345 8765432 56789 0 67890 102468 0 0 0 0 0 0\n";
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        ds << "   7       " << i << " loop" << i << " 12 0 24 0 0 0 0 0 0 4 0 0 0 0 0 0 0\n";
+    }
+    fx.diskstats = ds.str();
+    std::sort(fx.tracked_disks.begin(), fx.tracked_disks.end());
+    return fx;
+}
+
+void add_live_tracked_disks(Fixtures& fx) {
+    fx.tracked_disks.clear();
+    lxproc::for_each_diskstats(fx.diskstats, [&](const lxproc::DiskStats& d) {
+        if (d.name.rfind("loop", 0) == 0 || d.name.rfind("ram", 0) == 0 || d.name.rfind("zram", 0) == 0) return;
+        const char last = d.name.back();
+        if (d.name.rfind("nvme", 0) == 0 && d.name.find('p') != std::string_view::npos) return;
+        if (d.name.rfind("sd", 0) == 0 && std::isdigit(static_cast<unsigned char>(last))) return;
+        fx.tracked_disks.emplace_back(d.name);
+    });
+    std::sort(fx.tracked_disks.begin(), fx.tracked_disks.end());
+}
+
+// --- Legacy parsers (the pre-scan.h engine code, reading from a stream instead of /proc) ---
+
+bool legacy_stat(const std::string& text, unsigned long long& total, unsigned long long& idle_total) {
+    std::istringstream file(text);
+    std::string cpu_label;
+    unsigned long long user = 0, nice = 0, system = 0, idle = 0;
+    unsigned long long iowait = 0, irq = 0, softirq = 0, steal = 0;
+    if (!(file >> cpu_label >> user >> nice >> system >> idle)) return false;
+    file >> iowait >> irq >> softirq >> steal;
+    total = user + nice + system + idle + iowait + irq + softirq + steal;
+    idle_total = idle + iowait;
+    return total > 0;
+}
+
+long long legacy_parse_value(const std::string& line) {
+    std::stringstream ss;
+    for (char c : line) {
+        if (isdigit(c)) ss << c;
+        else if (ss.str().length() > 0 && !isdigit(c)) break;
+    }
+    long long val = 0;
+    ss >> val;
+    return val;
+}
+
+double legacy_meminfo(const std::string& text) {
+    std::istringstream file(text);
+    std::string line;
+    long long total = 0;
+    long long available = -1;
+    std::unordered_map<std::string, long long> mem;
+    while (std::getline(file, line)) {
+        auto key_end = line.find(':');
+        if (key_end == std::string::npos) continue;
+        std::string key = line.substr(0, key_end);
+        long long val = legacy_parse_value(line);
+        mem[key] = val;
+        if (key == "MemTotal") total = val;
+        else if (key == "MemAvailable") available = val;
+    }
+    if (total <= 0) return 0.0;
+    return 100.0 * static_cast<double>(total - available) / static_cast<double>(total);
+}
+
+std::string legacy_trim_copy(const std::string& s) {
+    size_t b = 0;
+    while (b < s.size() && std::isspace(static_cast<unsigned char>(s[b]))) b++;
+    size_t e = s.size();
+    while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1]))) e--;
+    return s.substr(b, e - b);
+}
+
+struct LegacyIf {
+    unsigned long long rx_bytes = 0;
+    unsigned long long tx_bytes = 0;
+};
+
+std::unordered_map<std::string, LegacyIf> legacy_net_dev(const std::string& text) {
+    std::unordered_map<std::string, LegacyIf> out;
+    std::istringstream f(text);
+    std::string line;
+    int line_no = 0;
+    while (std::getline(f, line)) {
+        line_no++;
+        if (line_no <= 2) continue;
+        auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string iface = legacy_trim_copy(line.substr(0, colon));
+        if (iface.empty() || iface.rfind("lo", 0) == 0) continue;
+        std::string rest = line.substr(colon + 1);
+        std::istringstream iss(rest);
+        unsigned long long rx_bytes = 0, tx_bytes = 0, tmp = 0;
+        if (!(iss >> rx_bytes)) continue;
+        for (int i = 0; i < 7; ++i) {
+            if (!(iss >> tmp)) break;
+        }
+        if (!(iss >> tx_bytes)) continue;
+        out[iface] = {rx_bytes, tx_bytes};
+    }
+    return out;
+}
+
+struct LegacyDisk {
+    long long io_ms = 0;
+    long long weighted_io_ms = 0;
+};
+
+std::string legacy_strip_partition_suffix(const std::string& name) {
+    auto ppos = name.rfind('p');
+    if (ppos != std::string::npos && ppos + 1 < name.size() && name.rfind("nvme", 0) == 0) {
+        return name.substr(0, ppos);
+    }
+    size_t i = name.size();
+    while (i > 0 && std::isdigit(static_cast<unsigned char>(name[i - 1]))) i--;
+    return name.substr(0, i);
+}
+
+std::unordered_map<std::string, LegacyDisk> legacy_diskstats(const std::string& text, const std::vector<std::string>& tracked) {
+    std::unordered_map<std::string, LegacyDisk> out;
+    std::unordered_set<std::string> tracked_set(tracked.begin(), tracked.end());
+    std::istringstream f(text);
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream iss(line);
+        int major = 0, minor = 0;
+        std::string name;
+        long long a = 0, b = 0, c = 0, d = 0, e = 0, g = 0, h = 0, i = 0, in_progress = 0, io = 0, weighted = 0;
+        if (!(iss >> major >> minor >> name >> a >> b >> c >> d >> e >> g >> h >> i >> in_progress >> io >> weighted)) continue;
+        std::string bucket;
+        if (tracked_set.count(name)) {
+            bucket = name;
+        } else {
+            std::string parent = legacy_strip_partition_suffix(name);
+            if (!tracked_set.count(parent)) continue;
+            bucket = parent;
+        }
+        auto& slot = out[bucket];
+        slot.io_ms = std::max(slot.io_ms, io);
+        slot.weighted_io_ms = std::max(slot.weighted_io_ms, weighted);
+    }
+    return out;
+}
+
+// --- New parsers, used the way the engines use them ---
+
+bool scan_stat(const std::string& text, unsigned long long& total, unsigned long long& idle_total) {
+    lxproc::CpuTimes t;
+    if (!lxproc::parse_stat_total(text, t)) return false;
+    total = t.total();
+    idle_total = t.idle_total();
+    return total > 0;
+}
+
+double scan_meminfo(const std::string& text) {
+    lxproc::MemInfo m;
+    if (!lxproc::parse_meminfo(text, m)) return 0.0;
+    return 100.0 * static_cast<double>(m.total - m.available) / static_cast<double>(m.total);
+}
+
+unsigned long long scan_net_dev(const std::string& text) {
+    unsigned long long sum = 0;
+    lxproc::for_each_net_dev(text, [&](std::string_view iface, const lxproc::NetDevCounters& n) {
+        if (iface.rfind("lo", 0) == 0) return;
+        sum += n.rx_bytes + n.tx_bytes;
+    });
+    return sum;
+}
+
+std::string_view scan_strip_partition_suffix(std::string_view name) {
+    auto ppos = name.rfind('p');
+    if (ppos != std::string_view::npos && ppos + 1 < name.size() && name.rfind("nvme", 0) == 0) {
+        return name.substr(0, ppos);
+    }
+    size_t i = name.size();
+    while (i > 0 && std::isdigit(static_cast<unsigned char>(name[i - 1]))) i--;
+    return name.substr(0, i);
+}
+
+unsigned long long scan_diskstats(const std::string& text, const std::vector<std::string>& tracked, std::vector<long long>& io_ms) {
+    io_ms.assign(tracked.size(), 0);
+    auto index_of = [&](std::string_view name) -> long {
+        auto it = std::lower_bound(tracked.begin(), tracked.end(), name,
+            [](const std::string& a, std::string_view b) { return std::string_view(a) < b; });
+        if (it == tracked.end() || *it != name) return -1;
+        return static_cast<long>(it - tracked.begin());
+    };
+    lxproc::for_each_diskstats(text, [&](const lxproc::DiskStats& d) {
+        long idx = index_of(d.name);
+        if (idx < 0) idx = index_of(scan_strip_partition_suffix(d.name));
+        if (idx < 0) return;
+        io_ms[idx] = std::max(io_ms[idx], static_cast<long long>(d.ms_doing_io));
+    });
+    unsigned long long sum = 0;
+    for (long long v : io_ms) sum += static_cast<unsigned long long>(v);
+    return sum;
+}
+
+template <typename Fn>
+double ns_per_op(int iters, Fn&& fn) {
+    for (int i = 0; i < iters / 10 + 1; ++i) fn();  // warm-up
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; ++i) fn();
+    const auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+}
+
+void report(const char* name, size_t bytes, double legacy_ns, double scan_ns) {
+    std::printf("%-16s %8zu B  legacy %10.1f ns  scan %10.1f ns  x%.1f\n",
+                name, bytes, legacy_ns, scan_ns, scan_ns > 0.0 ? legacy_ns / scan_ns : 0.0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool live = false;
+    int cores = 128, ifaces = 4, disks = 4, iters = 20000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto next_int = [&](int& out) {
+            if (i + 1 < argc) out = std::max(1, std::atoi(argv[++i]));
+        };
+        if (arg == "--live") live = true;
+        else if (arg == "--cores") next_int(cores);
+        else if (arg == "--ifaces") next_int(ifaces);
+        else if (arg == "--disks") next_int(disks);
+        else if (arg == "--iters") next_int(iters);
+        else {
+            std::fprintf(stderr, "usage: %s [--live] [--cores N] [--ifaces N] [--disks N] [--iters N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Fixtures fx;
+    if (live) {
+        fx.stat = slurp("/proc/stat");
+        fx.meminfo = slurp("/proc/meminfo");
+        fx.net_dev = slurp("/proc/net/dev");
+        fx.diskstats = slurp("/proc/diskstats");
+        add_live_tracked_disks(fx);
+        std::printf("fixtures: live /proc, %zu tracked disks, %d iterations\n", fx.tracked_disks.size(), iters);
+    } else {
+        fx = synthetic(cores, ifaces, disks);
+        std::printf("fixtures: synthetic, %d cores, %d ifaces, %d disks, %d iterations\n", cores, ifaces, disks, iters);
+    }
+
+    unsigned long long total = 0, idle = 0;
+    report("/proc/stat", fx.stat.size(),
+           ns_per_op(iters, [&] { legacy_stat(fx.stat, total, idle); g_sink = g_sink + total; }),
+           ns_per_op(iters, [&] { scan_stat(fx.stat, total, idle); g_sink = g_sink + total; }));
+
+    report("/proc/meminfo", fx.meminfo.size(),
+           ns_per_op(iters, [&] { g_sink = g_sink + static_cast<unsigned long long>(legacy_meminfo(fx.meminfo)); }),
+           ns_per_op(iters, [&] { g_sink = g_sink + static_cast<unsigned long long>(scan_meminfo(fx.meminfo)); }));
+
+    report("/proc/net/dev", fx.net_dev.size(),
+           ns_per_op(iters, [&] { g_sink = g_sink + legacy_net_dev(fx.net_dev).size(); }),
+           ns_per_op(iters, [&] { g_sink = g_sink + scan_net_dev(fx.net_dev); }));
+
+    std::vector<long long> io_ms;
+    report("/proc/diskstats", fx.diskstats.size(),
+           ns_per_op(iters, [&] { g_sink = g_sink + legacy_diskstats(fx.diskstats, fx.tracked_disks).size(); }),
+           ns_per_op(iters, [&] { g_sink = g_sink + scan_diskstats(fx.diskstats, fx.tracked_disks, io_ms); }));
+    return 0;
+}
@@ -151,7 +151,7 @@ class ConsoleLogic:
             return "clear"
             
         elif cmd == "help":
-            return "Commands: help, clear, engines, compile, logs, sys, crash, turbo <on/off>, exit"
+            return "Commands: help, clear, engines, compile, logs, sys, stats [dump|reset], top [cpu|rss|io] [N], cgtop [cpu|mem|io] [N] [depth D], psi, rec [on|off], replay <path|stop> [speed], metrics [on [port]|off], nodes [on [port]|off], crash, turbo <on/off>, exit"
 
         elif cmd == "engines":
             # Nowa komenda specyficzna dla Monitora
@@ -175,6 +175,213 @@ class ConsoleLogic:
             return (f"OS: {platform.system()} | Py: {sys.version.split()[0]} | "
                     f"Arch: {platform.machine()}")
 
+        elif cmd == "stats":
+            # Koszt własny monitora (histogramy opóźnień silników, RSS, CPU)
+            h2 = getattr(self.main_window, "h2", None)
+            if h2 is None:
+                return "Stats unavailable: engines not initialized."
+            action = args[0].lower() if args else "show"
+            if action == "reset":
+                h2.worker.overhead.reset()
+                return "Overhead stats reset."
+            report = h2.overhead_report()
+            if action == "dump":
+                ts = datetime.datetime.now().strftime("%Y%m%d-%H%M%S")
+                path = args[1] if len(args) > 1 else os.path.join(self.logs_dir, f"overhead-{ts}.json")
+                try:
+                    h2.worker.overhead.write_dump(report, path)
+                except OSError as e:
+                    return f"Stats dump failed: {e}"
+                return f"Overhead stats written to {path}"
+            return h2.worker.overhead.format(report)
+
+        elif cmd == "top":
+            # Najcięższe procesy z natywnego silnika 'process' (bez uruchamiania top)
+            h1 = getattr(self.main_window, "h1", None)
+            if h1 is None:
+                return "Top unavailable: engines not initialized."
+            key = args[0].lower() if args and not args[0].isdigit() else "cpu"
+            if key not in ("cpu", "rss", "io"):
+                return "Usage: top [cpu|rss|io] [N]"
+            count = next((int(a) for a in args if a.isdigit()), 10)
+            report = h1.invoke_method("process", "get_top", max(1, count))
+            if not isinstance(report, dict):
+                return "Top unavailable: 'process' engine not loaded."
+            lines = [f"{report.get('processes', 0)} processes, {report.get('threads', 0)} threads (by {key})"]
+            for p in report.get(key) or []:
+                lines.append(
+                    f"{p['pid']:>7} {p['name']:<16} {p['state']} cpu {p['cpu_pct']:6.1f}% "
+                    f"rss {p['rss_bytes'] / 1048576.0:9.1f} MiB io {(p['read_bps'] + p['write_bps']) / 1048576.0:7.2f} MiB/s"
+                )
+            return "\n".join(lines)
+
+        elif cmd == "cgtop":
+            # Najcięższe cgroupy (usługi systemd, kontenery) z natywnego silnika 'cgroup'
+            h1 = getattr(self.main_window, "h1", None)
+            if h1 is None:
+                return "Cgtop unavailable: engines not initialized."
+            rest = [a.lower() for a in args]
+            if "depth" in rest:
+                i = rest.index("depth")
+                if i + 1 >= len(rest) or not rest[i + 1].isdigit():
+                    return "Usage: cgtop [cpu|mem|io] [N] [depth D]"
+                h1.invoke_method("cgroup", "set_max_depth", int(rest[i + 1]))
+                del rest[i:i + 2]
+            key = next((a for a in rest if not a.isdigit()), "cpu")
+            if key not in ("cpu", "mem", "io"):
+                return "Usage: cgtop [cpu|mem|io] [N] [depth D]"
+            count = next((int(a) for a in rest if a.isdigit()), 10)
+            report = h1.invoke_method("cgroup", "get_top", max(1, count))
+            if not isinstance(report, dict):
+                return "Cgtop unavailable: 'cgroup' engine not loaded."
+            if not report.get("available"):
+                return "Cgtop unavailable: no cgroup v2 hierarchy."
+            depth = h1.invoke_method("cgroup", "get_max_depth")
+            lines = [f"{report.get('cgroups', 0)} cgroups to depth {depth}, {report.get('read', 0)} read this call (by {key})"]
+            for c in report.get("memory" if key == "mem" else key) or []:
+                lines.append(
+                    f"{c['cpu_pct']:6.1f}% cpu {c['memory_bytes'] / 1048576.0:9.1f} MiB "
+                    f"io {(c['read_bps'] + c['write_bps']) / 1048576.0:7.2f} MiB/s "
+                    f"psi {c['memory_some_pct']:4.1f}%  {c['path']}"
+                )
+            return "\n".join(lines)
+
+        elif cmd == "psi":
+            # Presja (PSI) i liczniki vmstat z ostatniej klatki workera
+            window = self.main_window
+            pressure = (getattr(window, "latest_sensor_values", None) or {}).get("pressure_all")
+            if not isinstance(pressure, dict):
+                return "PSI unavailable: 'pressure' engine not loaded or no frame yet."
+            lines = []
+            for resource in ("cpu", "memory", "io"):
+                item = pressure.get(resource)
+                if not isinstance(item, dict):
+                    lines.append(f"{resource:<7} n/a")
+                    continue
+                lines.append(
+                    f"{resource:<7} some {item.get('some', 0.0):5.1f}% full {item.get('full', 0.0):5.1f}%  "
+                    f"avg10/60/300 {item.get('some_avg10', 0.0):.2f}/{item.get('some_avg60', 0.0):.2f}/{item.get('some_avg300', 0.0):.2f}"
+                )
+            vm = pressure.get("vm")
+            if isinstance(vm, dict):
+                lines.append(
+                    f"majfault {vm.get('majfault_ps', 0.0):.0f}/s  swap in/out {vm.get('swapin_ps', 0.0):.0f}/{vm.get('swapout_ps', 0.0):.0f} "
+                    f"pages/s  scan {vm.get('pgscan_ps', 0.0):.0f}/s  oom_kill {vm.get('oom_kill', 0)}"
+                )
+            if "trigger_events" in pressure:
+                fired = ", ".join(pressure.get("fired") or []) or "-"
+                lines.append(f"trigger wakeups {pressure['trigger_events']} (last: {fired})")
+            return "\n".join(lines)
+
+        elif cmd == "rec":
+            # Nagrywanie klatek do assets/logs/recordings (odtwarzanie: 'replay')
+            h2 = getattr(self.main_window, "h2", None)
+            if h2 is None:
+                return "Recorder unavailable: engines not initialized."
+            action = args[0].lower() if args else "status"
+            if action == "on":
+                cfg = getattr(self.main_window, "user_config", {}) or {}
+                ok = h2.start_recording(max_total_mb=int(cfg.get("record_max_mb", 512) or 512))
+                return "Recording started." if ok else "Recording unavailable (see log)."
+            if action == "off":
+                h2.stop_recording()
+                return "Recording stopped."
+            stats = h2.recording_status()
+            if not stats:
+                return "Recording off. Use 'rec on'."
+            return (
+                f"Recording to {stats['segment']}: {stats['ticks']} ticks, {stats['series']} series, "
+                f"{stats['bytes'] / 1048576.0:.2f} MiB ({stats['bytes_per_value']:.2f} B/value), "
+                f"{stats['segments_written']} segment(s), {stats['segments_deleted']} rotated out"
+            )
+
+        elif cmd == "replay":
+            # Odtwarzanie nagrania w dashboardzie: replay <plik|katalog> [prędkość], replay stop
+            h2 = getattr(self.main_window, "h2", None)
+            if h2 is None:
+                return "Replay unavailable: engines not initialized."
+            if not args:
+                status = h2.replay_status()
+                if not status:
+                    return "Usage: replay <file.lxrec|dir> [speed] | replay stop"
+                pos = status["position"]
+                where = datetime.datetime.fromtimestamp(pos).strftime("%Y-%m-%d %H:%M:%S") if pos else "-"
+                return f"Replaying {status['path']} at {status['speed']:g}x, now at {where}"
+            if args[0].lower() == "stop":
+                h2.stop_replay()
+                return "Replay stopped; live data resumed."
+            path = os.path.expanduser(args[0])
+            try:
+                speed = float(args[1]) if len(args) > 1 else 1.0
+            except ValueError:
+                return "Usage: replay <file.lxrec|dir> [speed] | replay stop"
+            return "Replay started." if h2.start_replay(path, speed) else "Replay failed (see log)."
+
+        elif cmd == "metrics":
+            # Endpoint OpenMetrics natywnego samplera: metrics on [port], metrics off, samo 'metrics' = status
+            h1 = getattr(self.main_window, "h1", None)
+            sampler = getattr(h1, "loaded_engines", {}).get("sampler") if h1 is not None else None
+            if sampler is None or not hasattr(sampler, "metrics_status"):
+                return "Metrics endpoint unavailable: native sampler not loaded."
+            action = args[0].lower() if args else "status"
+            cfg = getattr(self.main_window, "user_config", {}) or {}
+            if action == "on":
+                try:
+                    port = int(args[1]) if len(args) > 1 else int(cfg.get("metrics_port", 0) or 9464)
+                except ValueError:
+                    return "Usage: metrics [on [port]|off]"
+                bound = h1.serve_metrics(port, str(cfg.get("metrics_address") or "127.0.0.1"))
+                return f"Serving /metrics on port {bound}." if bound else "Metrics endpoint failed (see log)."
+            if action == "off":
+                h1.stop_metrics()
+                return "Metrics endpoint stopped."
+            st = sampler.metrics_status()
+            if not st.get("running"):
+                return "Metrics endpoint off. Use 'metrics on [port]'."
+            return (
+                f"Serving http://{st['address']}:{st['port']}/metrics: {st['scrapes']} scrapes, "
+                f"last {st['last_series']} series / {st['last_bytes'] / 1024.0:.1f} KiB in {st['last_render_us']:.0f} us, "
+                f"{st['bad_requests']} bad requests"
+            )
+
+        elif cmd == "nodes":
+            # Tryb zdalny: nodes on [port], nodes off, samo 'nodes' = lista kolektorów
+            h2 = getattr(self.main_window, "h2", None)
+            if h2 is None:
+                return "Remote mode unavailable: engines not initialized."
+            action = args[0].lower() if args else "status"
+            cfg = getattr(self.main_window, "user_config", {}) or {}
+            if action == "on":
+                try:
+                    port = int(args[1]) if len(args) > 1 else int(cfg.get("remote_listen_port", 0) or 9470)
+                except ValueError:
+                    return "Usage: nodes [on [port]|off]"
+                bound = h2.start_remote(
+                    port, str(cfg.get("remote_listen_address") or "127.0.0.1"), str(cfg.get("remote_token") or "")
+                )
+                return f"Accepting collectors on port {bound}." if bound else "Remote mode failed (see log)."
+            if action == "off":
+                h2.stop_remote()
+                return "Remote mode stopped."
+            st = h2.remote_status()
+            if not st:
+                return "Remote mode off. Use 'nodes on [port]'."
+            lines = [
+                f"Listening on {st['address']}:{st['port']}: {st['online']}/{st['nodes']} nodes online, "
+                f"{st['messages']} messages, {st['bytes'] / 1024.0:.1f} KiB, "
+                f"{st['rejected']} rejected, {st['malformed']} malformed"
+            ]
+            for node in st["nodes_list"]:
+                state = "stale" if node["stale"] else ("online" if node["online"] else "offline")
+                cpu = node.get("cpu")
+                ram = node.get("ram")
+                lines.append(
+                    f"{node['name']:<20} {node['address']:<24} {state:<8} "
+                    f"cpu {'-' if cpu is None else f'{cpu:.1f}%'} ram {'-' if ram is None else f'{ram:.1f}%'} "
+                    f"{node['rx_bytes_per_s'] / 1024.0:.2f} KiB/s, age {node['age_s']:.1f}s"
+                )
+            return "\n".join(lines)
+
         elif cmd == "crash":
             self.log("Manual crash test triggered.", "WARN")
             try:
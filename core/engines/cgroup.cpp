@@ -0,0 +1,40 @@
+#include <pybind11/pybind11.h>
+
+#include "common/cgroup_engine.h"
+#include "common/py_convert.h"
+
+namespace py = pybind11;
+
+static CgroupEngine& host_cgroups() { return lxpy::default_engine<CgroupEngine>(); }
+
+PYBIND11_MODULE(cgroup, m) {
+    m.doc() = "Per-cgroup CPU, memory, memory pressure and I/O: top-N lists over the cgroup v2 hierarchy";
+    lxpy::start_default_engine<CgroupEngine>();
+    lxpy::def_ready<CgroupEngine>(m);
+    py::class_<CgroupEngine>(m, "Engine", "Cgroups of one source root (pid=N: that process' cgroup namespace)")
+        .def(py::init(&lxpy::make_engine<CgroupEngine>), py::arg("root") = "", py::arg("pid") = 0)
+        .def("get_top", [](CgroupEngine& e, size_t n) { return lxpy::cgroup_top_to_dict(e.sample(n)); }, py::arg("n") = 10,
+             "Returns {'cpu', 'memory', 'io': [cgroup dicts], 'cgroups', 'read', 'pinned_fds', 'available'}")
+        .def("get_last", [](const CgroupEngine& e) { return lxpy::cgroup_top_to_dict(e.last()); }, "Returns the last get_top() result")
+        .def("set_max_depth", &CgroupEngine::set_max_depth, py::arg("depth"), "Deepest level tracked (1 = top-level slices)")
+        .def("get_max_depth", &CgroupEngine::max_depth)
+        .def("set_scan_budget", &CgroupEngine::set_scan_budget, py::arg("budget"), "Cgroups read round-robin per get_top()")
+        .def("get_scan_budget", &CgroupEngine::scan_budget)
+        .def("set_fd_budget", &CgroupEngine::set_fd_budget, py::arg("budget"), "Caps the cgroup fds kept open between samples")
+        .def("get_fd_budget", &CgroupEngine::fd_budget)
+        .def("rescan", &CgroupEngine::rescan, "Re-walks the hierarchy on the next get_top()");
+
+    m.def("get_top", [](size_t n) { return lxpy::cgroup_top_to_dict(host_cgroups().sample(n)); }, py::arg("n") = 10,
+          "Returns {'cpu', 'memory', 'io': [cgroup dicts], 'cgroups', 'read', 'pinned_fds', 'available'}");
+    m.def("get_last", []() { return lxpy::cgroup_top_to_dict(host_cgroups().last()); }, "Returns the last get_top() result");
+    m.def("set_max_depth", [](uint32_t depth) { host_cgroups().set_max_depth(depth); }, py::arg("depth"),
+          "Deepest level tracked (1 = top-level slices)");
+    m.def("get_max_depth", []() { return host_cgroups().max_depth(); });
+    m.def("set_scan_budget", [](size_t budget) { host_cgroups().set_scan_budget(budget); }, py::arg("budget"),
+          "Cgroups read round-robin per get_top()");
+    m.def("get_scan_budget", []() { return host_cgroups().scan_budget(); });
+    m.def("set_fd_budget", [](size_t budget) { host_cgroups().set_fd_budget(budget); }, py::arg("budget"),
+          "Caps the cgroup fds kept open between samples");
+    m.def("get_fd_budget", []() { return host_cgroups().fd_budget(); });
+    m.def("rescan", []() { host_cgroups().rescan(); }, "Re-walks the hierarchy on the next get_top()");
+}
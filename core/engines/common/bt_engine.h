@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/rfkill.h>
+#include <unistd.h>
+
+#include "pinned_file.h"
+#include "rate_kernels.h"
+#include "source_root.h"
+#include "topology_watch.h"
+
+namespace fs = std::filesystem;
+
+class BtActivityEngine {
+public:
+    explicit BtActivityEngine(const SourceRoot& root = SourceRoot::host())
+        : bluetooth_root_(root.resolve("/sys/class/bluetooth")),
+          rfkill_root_(root.resolve("/sys/class/rfkill")),
+          topology_(std::vector<std::string>{"bluetooth", "rfkill"}, std::chrono::seconds(5), root) {
+        // /dev/rfkill is host-wide; other roots (fixtures, containers) poll their rfkill state instead.
+        if (root.is_host()) rfkill_fd_ = ::open("/dev/rfkill", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        last_time_ = std::chrono::steady_clock::now();
+        reindex();
+        read_rfkill_events();  // the initial RFKILL_OP_ADD burst describes the state reindex() just read
+        rfkill_at_ = last_time_;
+        for (auto& a : adapters_) read_bytes(a);
+    }
+
+    BtActivityEngine(const BtActivityEngine&) = delete;
+    BtActivityEngine& operator=(const BtActivityEngine&) = delete;
+
+    ~BtActivityEngine() {
+        if (rfkill_fd_ >= 0) ::close(rfkill_fd_);
+    }
+
+    struct AdapterMeta {
+        std::string name;
+        std::string address;
+        std::string driver;
+        std::string slot;
+        std::string vendor_id;
+        std::string device_id;
+        std::string chipset;  // "usb:<vendor>:<product>" / "pci:<vendor>:<device>" from modalias
+        bool rfkill_blocked = false;
+        int connected_devices = 0;  // live links (hciN:<handle> children in sysfs)
+    };
+
+    struct AdapterSample {
+        std::string adapter;
+        AdapterMeta meta;
+        double rx_mbps = 0.0;
+        double tx_mbps = 0.0;
+    };
+
+    // Per tick: two pread()s per adapter. Metadata, links and rfkill state are re-read only when a
+    // uevent (bluetooth/rfkill add/remove) or an rfkill event says they changed.
+    std::vector<AdapterSample> get_all_usage() {
+        std::vector<AdapterSample> out;
+        auto now = std::chrono::steady_clock::now();
+        double elapsed_s = std::chrono::duration<double>(now - last_time_).count();
+        if (elapsed_s <= 0.0001) elapsed_s = 0.0;
+
+        if (topology_.changed() || rescan_requested_) reindex();
+        if (read_rfkill_events() || (rfkill_fd_ < 0 && now - rfkill_at_ >= kRfkillRefresh)) {
+            for (auto& a : adapters_) a.meta.rfkill_blocked = rfkill_blocked(a);
+            rfkill_at_ = now;
+        }
+
+        out.reserve(adapters_.size());
+        for (auto& a : adapters_) {
+            const Bytes prev = a.bytes;
+            const bool had_prev = a.has_bytes;
+            read_bytes(a);
+            AdapterSample item;
+            item.adapter = a.adapter;
+            item.meta = a.meta;
+            if (had_prev && elapsed_s > 0.0) {
+                const double rx_bps = lxrate::rate(a.bytes.rx_bytes, prev.rx_bytes, elapsed_s);
+                const double tx_bps = lxrate::rate(a.bytes.tx_bytes, prev.tx_bytes, elapsed_s);
+                item.rx_mbps = std::max(0.0, (rx_bps * 8.0) / 1'000'000.0);
+                item.tx_mbps = std::max(0.0, (tx_bps * 8.0) / 1'000'000.0);
+            }
+            out.push_back(std::move(item));
+        }
+        last_time_ = now;
+        counter_files_.sweep();
+        return out;
+    }
+
+    // Forces the next get_all_usage() to re-read adapter metadata and links (privilege unlock, tests).
+    void rescan() { rescan_requested_ = true; }
+
+private:
+    struct Bytes {
+        unsigned long long rx_bytes = 0;
+        unsigned long long tx_bytes = 0;
+    };
+
+    // Without /dev/rfkill the block state is polled; adapters and links come from uevents either way,
+    // with TopologyWatch's periodic fallback when netlink is unavailable.
+    static constexpr auto kRfkillRefresh = std::chrono::seconds(2);
+
+    struct Adapter {
+        std::string adapter;
+        std::string rx_path;
+        std::string tx_path;
+        fs::path rfkill_dir;  // empty when the adapter has no rfkill switch
+        AdapterMeta meta;
+        Bytes bytes;
+        bool has_bytes = false;
+    };
+
+    fs::path bluetooth_root_;
+    fs::path rfkill_root_;
+    TopologyWatch topology_;
+    int rfkill_fd_ = -1;
+    bool rescan_requested_ = false;
+    std::chrono::steady_clock::time_point last_time_;
+    std::chrono::steady_clock::time_point rfkill_at_;
+    std::vector<Adapter> adapters_;  // sorted by name
+    PinnedFileSet counter_files_;    // statistics/{rx,tx}_bytes per adapter
+
+    static std::string read_text(const fs::path& p) {
+        std::ifstream f(p);
+        if (!f.is_open()) return {};
+        std::string s;
+        std::getline(f, s);
+        return s;
+    }
+
+    static std::string read_all_text(const fs::path& p) {
+        std::ifstream f(p);
+        if (!f.is_open()) return {};
+        std::ostringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    void read_bytes(Adapter& a) {
+        Bytes b;
+        if (!counter_files_.read_u64(a.rx_path, b.rx_bytes)) b.rx_bytes = 0ULL;
+        if (!counter_files_.read_u64(a.tx_path, b.tx_bytes)) b.tx_bytes = 0ULL;
+        a.bytes = b;
+        a.has_bytes = true;
+    }
+
+    // True when /dev/rfkill reported anything (ops on other radios too: the events are cheap to drain).
+    bool read_rfkill_events() {
+        if (rfkill_fd_ < 0) return false;
+        bool any = false;
+        rfkill_event ev[16];
+        for (;;) {
+            const ssize_t n = ::read(rfkill_fd_, ev, sizeof(ev));
+            if (n > 0) {
+                any = true;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            break;
+        }
+        return any;
+    }
+
+    // Rebuilds the adapter list, keeping byte counters of adapters that stay so rates do not reset.
+    void reindex() {
+        rescan_requested_ = false;
+        std::vector<Adapter> next;
+        std::unordered_map<std::string, int> links;
+        std::error_code ec;
+        for (fs::directory_iterator it(bluetooth_root_, ec), end; !ec && it != end; it.increment(ec)) {
+            const std::string name = it->path().filename().string();
+            if (name.rfind("hci", 0) != 0) continue;
+            const size_t colon = name.find(':');
+            if (colon != std::string::npos) {
+                ++links[name.substr(0, colon)];
+                continue;
+            }
+            const fs::path stat_dir = it->path() / "statistics";
+            if (!fs::exists(stat_dir)) continue;
+            Adapter a;
+            a.adapter = name;
+            a.rx_path = (stat_dir / "rx_bytes").string();
+            a.tx_path = (stat_dir / "tx_bytes").string();
+            a.rfkill_dir = find_rfkill(name);
+            a.meta = read_adapter_meta(a);
+            next.push_back(std::move(a));
+        }
+        std::sort(next.begin(), next.end(), [](const Adapter& x, const Adapter& y) { return x.adapter < y.adapter; });
+        for (auto& a : next) {
+            auto l = links.find(a.adapter);
+            a.meta.connected_devices = l == links.end() ? 0 : l->second;
+            for (const auto& old : adapters_) {
+                if (old.adapter != a.adapter) continue;
+                a.bytes = old.bytes;
+                a.has_bytes = old.has_bytes;
+                break;
+            }
+        }
+        adapters_ = std::move(next);
+    }
+
+    fs::path find_rfkill(const std::string& adapter) const {
+        std::error_code ec;
+        for (fs::directory_iterator it(rfkill_root_, ec), end; !ec && it != end; it.increment(ec)) {
+            if (read_text(it->path() / "name").find(adapter) != std::string::npos) return it->path();
+        }
+        return {};
+    }
+
+    static bool rfkill_blocked(const Adapter& a) {
+        if (a.rfkill_dir.empty()) return false;
+        const auto soft = read_text(a.rfkill_dir / "soft");
+        const auto hard = read_text(a.rfkill_dir / "hard");
+        return (soft == "1" || hard == "1");
+    }
+
+    // usb:v0A12p0001d... -> usb:0a12:0001, pci:v00008086d00002725... -> pci:8086:2725
+    static std::string chipset_from_modalias(std::string m) {
+        std::transform(m.begin(), m.end(), m.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (m.rfind("usb:v", 0) == 0 && m.size() >= 5 + 4 + 1 + 4 && m[9] == 'p') {
+            return "usb:" + m.substr(5, 4) + ":" + m.substr(10, 4);
+        }
+        if (m.rfind("pci:v", 0) == 0 && m.size() >= 5 + 8 + 1 + 8 && m[13] == 'd') {
+            return "pci:" + m.substr(9, 4) + ":" + m.substr(18, 4);
+        }
+        return {};
+    }
+
+    AdapterMeta read_adapter_meta(const Adapter& a) const {
+        AdapterMeta m;
+        const fs::path base = bluetooth_root_ / a.adapter;
+        const fs::path dev = base / "device";
+
+        m.name = read_text(dev / "name");
+        m.address = read_text(base / "address");
+        m.vendor_id = read_text(dev / "vendor");
+        m.device_id = read_text(dev / "device");
+        m.chipset = chipset_from_modalias(read_text(dev / "modalias"));
+        m.rfkill_blocked = rfkill_blocked(a);
+
+        try {
+            const fs::path driver_link = dev / "driver";
+            if (fs::is_symlink(driver_link)) {
+                m.driver = fs::read_symlink(driver_link).filename().string();
+            }
+        } catch (...) {
+        }
+
+        const auto uevent = read_all_text(dev / "uevent");
+        std::istringstream iss(uevent);
+        std::string line;
+        while (std::getline(iss, line)) {
+            if (line.rfind("PCI_SLOT_NAME=", 0) == 0) {
+                m.slot = line.substr(std::string("PCI_SLOT_NAME=").size());
+            } else if (m.driver.empty() && line.rfind("DRIVER=", 0) == 0) {
+                m.driver = line.substr(std::string("DRIVER=").size());
+            }
+        }
+
+        return m;
+    }
+};
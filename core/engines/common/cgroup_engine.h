@@ -0,0 +1,606 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "pinned_file.h"
+#include "proc_parse.h"
+#include "rate_kernels.h"
+#include "scan.h"
+#include "source_root.h"
+
+// Per-cgroup CPU, memory, memory pressure and I/O from the cgroup v2 hierarchy, for "which service or
+// container is it". The tree under /sys/fs/cgroup (or the hybrid layout's unified/) is walked down to
+// max_depth once; after that, inotify's mkdir, rmdir and rename events on the tracked directories add or
+// drop just those subtrees. A full walk runs again only on a queue overflow, a depth change or
+// rescan(), and every few seconds when inotify is unavailable or out of watches.
+//
+// Each cgroup keeps its cpu.stat, memory.current, memory.pressure and io.stat fds open while the fd
+// budget lasts, and its rates are taken against its own previous read. So a cgroup need not be read
+// every tick: a sample reads the previous winners of every list, cgroups that appeared since the last
+// sample, and the next scan_budget cgroups round-robin, then ranks all of them on their latest rates.
+// Thousands of cgroups cost at most 3 * n + scan_budget cgroup reads per tick; a full cycle takes
+// cgroups / scan_budget ticks. Counters are hierarchical, so a slice includes its services.
+class CgroupEngine {
+public:
+    struct CgroupSample {
+        std::string path;         // relative to the cgroup root, e.g. system.slice/sshd.service
+        uint32_t depth = 0;       // 1 for top-level slices
+        double cpu_pct = 0.0;     // of one core, like top (a cgroup keeping 4 cores busy shows 400)
+        double user_pct = 0.0;
+        double system_pct = 0.0;
+        double throttled_pct = 0.0;         // share of the window spent throttled by cpu.max
+        uint64_t memory_bytes = 0;          // memory.current
+        double memory_some_pct = 0.0;       // memory.pressure: share of the window with a stalled task
+        double memory_full_pct = 0.0;       // ... with every task stalled
+        double read_bps = 0.0;              // io.stat, summed over devices; 0 without the io controller
+        double write_bps = 0.0;
+        double read_iops = 0.0;
+        double write_iops = 0.0;
+        double age_s = 0.0;  // since the read these figures come from (0 for cgroups read by this sample)
+    };
+
+    struct TopLists {
+        std::vector<CgroupSample> by_cpu;
+        std::vector<CgroupSample> by_memory;
+        std::vector<CgroupSample> by_io;
+        size_t cgroups = 0;  // tracked, i.e. depth 1..max_depth
+        size_t read = 0;     // cgroups read by this sample
+        size_t pinned_fds = 0;
+        bool available = false;  // false without a cgroup v2 hierarchy under the root
+    };
+
+    static constexpr uint32_t kDefaultMaxDepth = 3;  // like systemd-cgtop: slice/service and container scopes
+    static constexpr size_t kDefaultScanBudget = 128;
+
+    explicit CgroupEngine(const SourceRoot& root = SourceRoot::host()) {
+        for (const char* mount : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) {
+            const std::string path = root.resolve(mount);
+            if (::access((path + "/cgroup.controllers").c_str(), F_OK) == 0) {
+                root_path_ = path;
+                break;
+            }
+        }
+        fd_budget_ = pinned_fd_budget();
+        buf_.resize(4096);
+        if (root_path_.empty()) return;
+        ++pinned_io_counters().opens;
+        dir_fd_ = ::open(root_path_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd_ < 0) return;
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        top_.available = true;
+        last_time_ = std::chrono::steady_clock::now();
+        ++gen_;
+        discover();
+    }
+
+    CgroupEngine(const CgroupEngine&) = delete;
+    CgroupEngine& operator=(const CgroupEngine&) = delete;
+
+    ~CgroupEngine() {
+        for (auto& s : slots_) close_slot(s);
+        if (inotify_fd_ >= 0) ::close(inotify_fd_);
+        if (dir_fd_ >= 0) ::close(dir_fd_);
+    }
+
+    // Returns the n heaviest cgroups by CPU, memory and I/O, each on the rates of its latest read
+    // (see age_s). The first call after construction diffs against the constructor's baseline reads.
+    // Valid until the next call.
+    const TopLists& sample(size_t n) {
+        if (!top_.available) return top_;
+        try {
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last_time_ <= std::chrono::milliseconds(1)) return top_;
+            last_time_ = now;
+            ++gen_;
+            top_.read = 0;
+            apply_tree_events();
+
+            for (uint32_t i : hot_) read_slot(i, now);
+            // Cgroups found by a walk in this very sample only have their baseline; they wait for the next.
+            size_t budget = scan_budget_;
+            size_t waiting = 0;
+            for (uint32_t i : warm_) {
+                if (budget > 0 && slots_[i].read_gen != gen_) {
+                    read_slot(i, now);
+                    --budget;
+                } else {
+                    warm_[waiting++] = i;
+                }
+            }
+            warm_.resize(waiting);
+            for (size_t k = std::min(budget, ring_.size()); k > 0; --k) {
+                if (cursor_ >= ring_.size()) cursor_ = 0;
+                read_slot(ring_[cursor_++], now);
+            }
+            select(n, now);
+        } catch (...) {
+            clear_top();
+        }
+        return top_;
+    }
+
+    const TopLists& last() const { return top_; }
+
+    // Deepest level tracked (1 = top-level slices only). Changing it re-walks the tree on the next sample.
+    void set_max_depth(uint32_t depth) {
+        depth = std::max<uint32_t>(1, depth);
+        if (depth == max_depth_) return;
+        max_depth_ = depth;
+        dirty_ = true;
+    }
+
+    uint32_t max_depth() const { return max_depth_; }
+
+    // Cgroups read round-robin per sample, beyond the previous winners and new cgroups.
+    void set_scan_budget(size_t budget) { scan_budget_ = std::max<size_t>(1, budget); }
+
+    size_t scan_budget() const { return scan_budget_; }
+
+    // How many cgroup fds may stay open between samples (four per cgroup at most). The default is a
+    // quarter of the RLIMIT_NOFILE soft limit left after a reserve, next to the process engine's half.
+    // Lowering it closes the excess now.
+    void set_fd_budget(size_t budget) {
+        fd_budget_ = budget;
+        for (auto& s : slots_) {
+            if (pinned_ <= fd_budget_) break;
+            close_slot(s);
+        }
+    }
+
+    size_t fd_budget() const { return fd_budget_; }
+
+    // Re-walks the tree on the next sample (missing inotify events, controllers enabled later).
+    void rescan() { dirty_ = true; }
+
+private:
+    static constexpr size_t kFdBudgetCap = 16384;
+    static constexpr auto kFallbackPeriod = std::chrono::seconds(5);
+    static constexpr uint32_t kWatchEvents = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    enum File : size_t { kCpuStat = 0, kMemoryCurrent, kMemoryPressure, kIoStat, kFiles };
+    static constexpr const char* kFileNames[kFiles] = {"cpu.stat", "memory.current", "memory.pressure", "io.stat"};
+
+    struct Counters {
+        unsigned long long usage_usec = 0;
+        unsigned long long user_usec = 0;
+        unsigned long long system_usec = 0;
+        unsigned long long throttled_usec = 0;
+        unsigned long long memory_some_usec = 0;
+        unsigned long long memory_full_usec = 0;
+        unsigned long long rbytes = 0;
+        unsigned long long wbytes = 0;
+        unsigned long long rios = 0;
+        unsigned long long wios = 0;
+    };
+
+    struct Slot {
+        std::string path;
+        uint32_t depth = 0;
+        int fds[kFiles] = {-1, -1, -1, -1};
+        bool missing[kFiles] = {};  // not there (controller off, root-only file); retried after a re-walk
+        bool live = false;
+        bool has_prev = false;
+        bool has_rates = false;
+        uint32_t seen_walk = 0;
+        uint32_t read_gen = 0;
+        uint64_t memory_bytes = 0;
+        Counters prev;
+        std::chrono::steady_clock::time_point prev_time;
+        CgroupSample rates;  // figures of the latest read pair; path and age_s are filled on output
+    };
+
+    std::string root_path_;
+    int dir_fd_ = -1;
+    int inotify_fd_ = -1;
+    bool watching_ = false;  // every tracked parent has a watch; otherwise the periodic walk runs
+    bool dirty_ = false;
+    uint32_t max_depth_ = kDefaultMaxDepth;
+    uint32_t watched_depth_ = 0;  // max_depth_ of the walk that placed the current watches
+    size_t scan_budget_ = kDefaultScanBudget;
+    size_t fd_budget_ = 0;
+    size_t pinned_ = 0;
+    uint32_t gen_ = 0;
+    uint32_t walk_ = 0;
+    size_t cursor_ = 0;
+    std::chrono::steady_clock::time_point last_time_;
+    std::chrono::steady_clock::time_point last_walk_;
+    std::vector<char> buf_;
+    std::vector<char> events_;
+    std::string rel_;  // "<cgroup>/<file>" scratch for openat()
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_;
+    std::unordered_map<std::string, uint32_t> index_;  // path -> slot
+    std::unordered_map<int, std::pair<std::string, uint32_t>> watches_;  // inotify wd -> (cgroup, depth)
+    std::vector<uint32_t> ring_;                       // live slots, read round-robin
+    std::vector<uint32_t> warm_;                       // new cgroups with a baseline read only
+    std::vector<uint32_t> hot_;                        // winners of the last sample
+    std::vector<uint32_t> order_;                      // selection scratch
+    std::vector<double> key_;                          // per-slot sort key for the current pass
+    TopLists top_;
+
+    // A quarter of what is left under the soft limit after a reserve for everything else in the process.
+    static size_t pinned_fd_budget() {
+        rlimit rl{};
+        if (::getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY) return 512;
+        if (rl.rlim_cur <= 512) return 0;
+        return std::min<size_t>((static_cast<size_t>(rl.rlim_cur) - 256) / 4, kFdBudgetCap);
+    }
+
+    void clear_top() {
+        top_.by_cpu.clear();
+        top_.by_memory.clear();
+        top_.by_io.clear();
+        top_.read = 0;
+    }
+
+    void close_slot(Slot& s) {
+        for (int& fd : s.fds) {
+            if (fd < 0) continue;
+            ::close(fd);
+            fd = -1;
+            --pinned_;
+        }
+    }
+
+    // Applies the queued mkdir/rmdir/rename events of watched directories to the slot table. A queue
+    // overflow, an unknown watch or the fallback period without working watches asks for a full walk.
+    // Returns true when the set of cgroups changed.
+    bool apply_tree_events() {
+        bool changed = false;
+        if (inotify_fd_ >= 0) {
+            if (events_.empty()) events_.resize(16 * 1024);
+            for (;;) {
+                const ssize_t n = ::read(inotify_fd_, events_.data(), events_.size());
+                if (n <= 0) break;  // EAGAIN: drained
+                for (ssize_t off = 0; off < n;) {
+                    const auto* ev = reinterpret_cast<const inotify_event*>(events_.data() + off);
+                    off += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+                    if (ev->mask & IN_Q_OVERFLOW) dirty_ = true;
+                    const auto it = watches_.find(ev->wd);
+                    if (it == watches_.end()) continue;
+                    if (ev->mask & IN_IGNORED) {  // the watched directory itself is gone
+                        watches_.erase(it);
+                        continue;
+                    }
+                    if (!(ev->mask & IN_ISDIR) || ev->len == 0) continue;
+                    const std::string& parent = it->second.first;
+                    const uint32_t depth = it->second.second + 1;
+                    std::string child = parent.empty() ? std::string(ev->name) : parent + "/" + ev->name;
+                    if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        track(child, depth);
+                        if (depth < max_depth_) walk(child, depth);
+                    } else {
+                        untrack(child);
+                    }
+                    changed = true;
+                }
+            }
+        }
+        if (!watching_ && std::chrono::steady_clock::now() - last_walk_ >= kFallbackPeriod) dirty_ = true;
+        if (dirty_) {
+            discover();
+            return true;
+        }
+        if (changed) rebuild_ring();
+        return changed;
+    }
+
+    Slot& slot_for(const std::string& path, bool& created) {
+        const auto it = index_.find(path);
+        created = it == index_.end();
+        if (!created) return slots_[it->second];
+        uint32_t i;
+        if (!free_.empty()) {
+            i = free_.back();
+            free_.pop_back();
+        } else {
+            i = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        Slot& s = slots_[i];
+        s = Slot{};
+        s.path = path;
+        s.live = true;
+        index_.emplace(path, i);
+        return s;
+    }
+
+    // Full walk to max_depth: every slot is re-tracked (missing files retried), cgroups not found any
+    // more are released, and the watches are placed again.
+    void discover() {
+        dirty_ = false;
+        last_walk_ = std::chrono::steady_clock::now();
+        ++walk_;
+        if (max_depth_ < watched_depth_ && inotify_fd_ >= 0) {
+            // Watches below the new depth would keep firing; start over with a fresh instance.
+            ::close(inotify_fd_);
+            inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        }
+        watched_depth_ = max_depth_;
+        watching_ = inotify_fd_ >= 0;
+        watches_.clear();
+
+        walk(std::string(), 0);
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].live && slots_[i].seen_walk != walk_) release(i);
+        }
+        rebuild_ring();
+    }
+
+    // Tracks the subdirectories of rel (a cgroup at depth, "" for the root) and recurses while
+    // above max_depth. Each directory walked gets a watch first, so a mkdir racing the listing
+    // is either listed or queued.
+    void walk(const std::string& rel, uint32_t depth) {
+        namespace fs = std::filesystem;
+        std::vector<std::pair<std::string, uint32_t>> pending{{rel, depth}};
+        while (!pending.empty()) {
+            const auto [dir, level] = std::move(pending.back());
+            pending.pop_back();
+            const fs::path full = dir.empty() ? fs::path(root_path_) : fs::path(root_path_) / dir;
+            if (watching_) {
+                const int wd = ::inotify_add_watch(inotify_fd_, full.c_str(), kWatchEvents);
+                if (wd >= 0) watches_[wd] = {dir, level};
+                else if (errno != ENOENT && errno != ENOTDIR) watching_ = false;  // ENOSPC: out of watches
+            }
+            std::error_code ec;
+            for (fs::directory_iterator it(full, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+                if (!it->is_directory(ec) || ec) continue;
+                const std::string name = it->path().filename().string();
+                std::string child = dir.empty() ? name : dir + "/" + name;
+                track(child, level + 1);
+                if (level + 1 < max_depth_) pending.emplace_back(std::move(child), level + 1);
+            }
+        }
+    }
+
+    // A new cgroup gets its baseline read now and its first rates in the next sample (warm_).
+    void track(const std::string& path, uint32_t depth) {
+        bool created = false;
+        Slot& s = slot_for(path, created);
+        const uint32_t i = static_cast<uint32_t>(&s - slots_.data());
+        s.seen_walk = walk_;
+        s.depth = depth;
+        for (bool& m : s.missing) m = false;
+        if (created) {
+            read_slot(i, std::chrono::steady_clock::now());
+            warm_.push_back(i);
+        }
+    }
+
+    // Drops path and every cgroup below it.
+    void untrack(const std::string& path) {
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            const Slot& s = slots_[i];
+            if (!s.live) continue;
+            if (s.path == path || (s.path.size() > path.size() && s.path.compare(0, path.size(), path) == 0 && s.path[path.size()] == '/')) {
+                release(i);
+            }
+        }
+    }
+
+    void release(uint32_t i) {
+        Slot& s = slots_[i];
+        index_.erase(s.path);
+        close_slot(s);
+        s.live = false;
+        free_.push_back(i);
+    }
+
+    void rebuild_ring() {
+        ring_.clear();
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].live) ring_.push_back(i);
+        }
+        auto gone = [this](uint32_t i) { return !slots_[i].live; };
+        hot_.erase(std::remove_if(hot_.begin(), hot_.end(), gone), hot_.end());
+        warm_.erase(std::remove_if(warm_.begin(), warm_.end(), gone), warm_.end());
+        if (cursor_ >= ring_.size()) cursor_ = 0;
+        top_.cgroups = ring_.size();
+    }
+
+    // Reads the file into buf_ through fd (opened relative to the root when closed). err is 0 on success,
+    // even for an empty file (io.stat of an idle group), else the errno of the failing openat()/pread().
+    // The fd is kept while the budget lasts. A pinned fd of a removed cgroup fails with ENODEV.
+    std::string_view read_file(const Slot& s, File f, int& fd, int& err) {
+        err = 0;
+        bool opened_now = false;
+        if (fd < 0) {
+            rel_.assign(s.path).append("/").append(kFileNames[f]);
+            ++pinned_io_counters().opens;
+            fd = ::openat(dir_fd_, rel_.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                err = errno;
+                return {};
+            }
+            opened_now = true;
+        }
+        size_t used = 0;
+        ssize_t n;
+        for (;;) {
+            const size_t room = buf_.size() - used - 1;
+            ++pinned_io_counters().reads;
+            do {
+                n = ::pread(fd, buf_.data() + used, room, static_cast<off_t>(used));
+            } while (n < 0 && errno == EINTR);
+            if (n < 0) {
+                err = errno;
+                break;
+            }
+            used += static_cast<size_t>(n);
+            if (static_cast<size_t>(n) < room) break;  // io.stat of a box with many disks outgrows 4 KiB
+            buf_.resize(buf_.size() * 2);
+        }
+        if (opened_now && n >= 0 && pinned_ < fd_budget_) {
+            ++pinned_;
+        } else if (opened_now || n < 0) {
+            if (!opened_now) --pinned_;
+            ::close(fd);
+            fd = -1;
+        }
+        if (n < 0 || used == 0) return {};
+        return std::string_view(buf_.data(), used);
+    }
+
+    // Reads one cgroup (at most once per sample) and turns the counters into rates against its previous read.
+    void read_slot(uint32_t i, std::chrono::steady_clock::time_point now) {
+        Slot& s = slots_[i];
+        if (!s.live || s.read_gen == gen_) return;
+        s.read_gen = gen_;
+        ++top_.read;
+
+        Counters cur;
+        int err = 0;
+        std::string_view text = read_file(s, kCpuStat, s.fds[kCpuStat], err);
+        if (err != 0 || text.empty()) {
+            // Removed between the walk and this read; its parent's watch has queued the rmdir.
+            s.has_prev = s.has_rates = false;
+            close_slot(s);
+            if (!watching_) dirty_ = true;
+            return;
+        }
+        parse_cpu_stat(text, cur);
+
+        if (!s.missing[kMemoryCurrent]) {
+            text = read_file(s, kMemoryCurrent, s.fds[kMemoryCurrent], err);
+            unsigned long long bytes = 0;
+            if (err != 0) s.missing[kMemoryCurrent] = err == ENOENT;
+            else if (lxscan::Cursor(text).number(bytes)) s.memory_bytes = bytes;
+        }
+        if (!s.missing[kMemoryPressure]) {
+            text = read_file(s, kMemoryPressure, s.fds[kMemoryPressure], err);
+            lxproc::PsiInfo psi;
+            if (err != 0) {
+                s.missing[kMemoryPressure] = err == ENOENT;
+            } else if (lxproc::parse_psi(text, psi)) {
+                cur.memory_some_usec = psi.some.total_us;
+                cur.memory_full_usec = psi.full.total_us;
+            }
+        }
+        if (!s.missing[kIoStat]) {
+            text = read_file(s, kIoStat, s.fds[kIoStat], err);
+            if (err != 0) s.missing[kIoStat] = err == ENOENT;
+            else parse_io_stat(text, cur);
+        }
+
+        if (s.has_prev) {
+            const double elapsed_s = std::chrono::duration<double>(now - s.prev_time).count();
+            if (elapsed_s <= 0.001) return;  // keep the older baseline for a real window
+            compute_rates(s, cur, elapsed_s);
+        }
+        s.prev = cur;
+        s.prev_time = now;
+        s.has_prev = true;
+    }
+
+    static void parse_cpu_stat(std::string_view text, Counters& c) {
+        lxscan::Cursor cur(text);
+        std::string_view line;
+        while (cur.line(line)) {
+            lxscan::Cursor lc(line);
+            const std::string_view key = lc.token();
+            if (key == "usage_usec") lc.number(c.usage_usec);
+            else if (key == "user_usec") lc.number(c.user_usec);
+            else if (key == "system_usec") lc.number(c.system_usec);
+            else if (key == "throttled_usec") lc.number(c.throttled_usec);
+        }
+    }
+
+    // "MAJ:MIN rbytes=N wbytes=N rios=N wios=N dbytes=N dios=N", one line per device.
+    static void parse_io_stat(std::string_view text, Counters& c) {
+        lxscan::Cursor cur(text);
+        std::string_view line;
+        while (cur.line(line)) {
+            lxscan::Cursor lc(line);
+            lc.token();  // device
+            while (!lc.eof()) {
+                lc.skip_blanks();
+                const std::string_view key = lc.until('=');
+                unsigned long long v = 0;
+                if (!lc.number(v)) break;
+                if (key == "rbytes") c.rbytes += v;
+                else if (key == "wbytes") c.wbytes += v;
+                else if (key == "rios") c.rios += v;
+                else if (key == "wios") c.wios += v;
+            }
+        }
+    }
+
+    static void compute_rates(Slot& s, const Counters& cur, double elapsed_s) {
+        constexpr double kUsecPct = 100.0 / 1'000'000.0;
+        const Counters& p = s.prev;
+        CgroupSample& r = s.rates;
+        r.depth = s.depth;
+        r.cpu_pct = lxrate::rate(cur.usage_usec, p.usage_usec, elapsed_s) * kUsecPct;
+        r.user_pct = lxrate::rate(cur.user_usec, p.user_usec, elapsed_s) * kUsecPct;
+        r.system_pct = lxrate::rate(cur.system_usec, p.system_usec, elapsed_s) * kUsecPct;
+        r.throttled_pct = lxrate::clamp(lxrate::rate(cur.throttled_usec, p.throttled_usec, elapsed_s) * kUsecPct, 0.0, 100.0);
+        r.memory_some_pct = lxrate::clamp(lxrate::rate(cur.memory_some_usec, p.memory_some_usec, elapsed_s) * kUsecPct, 0.0, 100.0);
+        r.memory_full_pct = lxrate::clamp(lxrate::rate(cur.memory_full_usec, p.memory_full_usec, elapsed_s) * kUsecPct, 0.0, 100.0);
+        r.read_bps = lxrate::rate(cur.rbytes, p.rbytes, elapsed_s);
+        r.write_bps = lxrate::rate(cur.wbytes, p.wbytes, elapsed_s);
+        r.read_iops = lxrate::rate(cur.rios, p.rios, elapsed_s);
+        r.write_iops = lxrate::rate(cur.wios, p.wios, elapsed_s);
+        s.has_rates = true;
+    }
+
+    void fill(CgroupSample& out, const Slot& s, std::chrono::steady_clock::time_point now) const {
+        std::string path = std::move(out.path);  // keep the buffer across samples
+        out = s.rates;
+        out.path = std::move(path);
+        if (out.path != s.path) out.path.assign(s.path);
+        out.depth = s.depth;
+        out.memory_bytes = s.memory_bytes;
+        out.age_s = s.read_gen == gen_ ? 0.0 : std::chrono::duration<double>(now - s.prev_time).count();
+    }
+
+    // The n largest key_ entries of order_, descending; entries with key 0 are left out.
+    void pick(size_t n, std::vector<CgroupSample>& out, std::chrono::steady_clock::time_point now) {
+        size_t k = std::min(n, order_.size());
+        auto heavier = [this](uint32_t a, uint32_t b) { return key_[a] > key_[b]; };
+        if (k < order_.size()) std::nth_element(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(k), order_.end(), heavier);
+        std::sort(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(k), heavier);
+        while (k > 0 && key_[order_[k - 1]] <= 0.0) --k;
+        out.resize(k);
+        for (size_t i = 0; i < k; ++i) {
+            fill(out[i], slots_[order_[i]], now);
+            hot_.push_back(order_[i]);
+        }
+    }
+
+    void select(size_t n, std::chrono::steady_clock::time_point now) {
+        key_.resize(slots_.size());
+        order_.clear();
+        hot_.clear();
+        for (uint32_t i : ring_) {
+            if (slots_[i].live && slots_[i].has_prev) order_.push_back(i);
+        }
+        top_.pinned_fds = pinned_;
+
+        for (uint32_t i : order_) key_[i] = slots_[i].has_rates ? slots_[i].rates.cpu_pct : 0.0;
+        pick(n, top_.by_cpu, now);
+
+        for (uint32_t i : order_) key_[i] = static_cast<double>(slots_[i].memory_bytes);
+        pick(n, top_.by_memory, now);
+
+        for (uint32_t i : order_) {
+            const CgroupSample& r = slots_[i].rates;
+            key_[i] = slots_[i].has_rates ? r.read_bps + r.write_bps : 0.0;
+        }
+        pick(n, top_.by_io, now);
+    }
+};
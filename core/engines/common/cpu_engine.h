@@ -0,0 +1,183 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "pinned_file.h"
+#include "proc_parse.h"
+#include "rate_kernels.h"
+#include "source_root.h"
+
+// Columns of the per-core table, in percent of the core's time since the previous sample.
+enum CpuCoreColumn : size_t {
+    kCoreUsage = 0,  // everything except idle + iowait (same formula as get_usage())
+    kCoreUser,       // user + nice
+    kCoreSystem,     // system + irq + softirq
+    kCoreIowait,
+    kCoreSteal,
+    kCoreColumns,
+};
+
+// Row-major per-core table indexed by cpu id: values[id * kCoreColumns + column].
+// Ids that are offline (or never appeared) have online[id] == 0 and a zero row.
+struct CpuCoreTable {
+    size_t rows = 0;
+    std::vector<double> values;
+    std::vector<uint8_t> online;
+};
+
+class CpuSensing {
+public:
+    explicit CpuSensing(const SourceRoot& root = SourceRoot::host())
+        : stat_file(root.resolve("/proc/stat"), PinnedFile::kSingleShow) {
+        // Pierwszy pomiar przy starcie
+        read_stats(last_sample.total, last_sample.idle_total);
+    }
+
+    double get_usage() {
+        unsigned long long total = 0, idle_total = 0;
+        if (!read_stats(total, idle_total)) return last_sample.value;
+        return last_sample.update(total, idle_total);
+    }
+
+    // Per-core mode: one pass over the "cpu" and "cpuN" lines of /proc/stat.
+    // Refreshes core_table() and cores_total_usage(). It keeps its own baselines,
+    // so mixing it with get_usage() does not shorten either sampling window.
+    bool sample_cores() {
+        std::string_view text;
+        if (!stat_file.read(text)) return false;
+
+        for (auto& o : cores_.online) o = 0;
+        bool have_total = false;
+        lxscan::Cursor c(text);
+        std::string_view line;
+        while (c.line(line)) {
+            lxscan::Cursor lc(line);
+            const std::string_view label = lc.token();
+            // cpu lines come first; the rest of the file (intr, softirq, ...) is never parsed.
+            if (!lxscan::starts_with(label, "cpu")) break;
+
+            lxproc::CpuTimes t;
+            if (!lxproc::parse_cpu_times(lc, t)) continue;
+            if (label.size() == 3) {
+                cores_total_.update(t.total(), t.idle_total());
+                have_total = true;
+                continue;
+            }
+
+            size_t id = 0;
+            const char* first = label.data() + 3;
+            const char* end = label.data() + label.size();
+            const auto res = std::from_chars(first, end, id);
+            if (res.ec != std::errc() || res.ptr != end) continue;
+            update_core(id, t);
+        }
+
+        compute_cores();
+        return have_total || cores_.rows > 0;
+    }
+
+    const CpuCoreTable& core_table() const { return cores_; }
+    double cores_total_usage() const { return cores_total_.value; }
+
+private:
+    // Previous aggregate counters and the usage they produced.
+    struct Baseline {
+        unsigned long long total = 0;
+        unsigned long long idle_total = 0;
+        double value = 0.0;
+
+        double update(unsigned long long now_total, unsigned long long now_idle_total) {
+            // Obliczamy różnice między pomiarami
+            unsigned long long total_diff = lxrate::delta(now_total, total);
+            unsigned long long idle_diff = lxrate::delta(now_idle_total, idle_total);
+
+            // Zabezpieczenie przed dzieleniem przez zero
+            double usage = 0.0;
+            if (total_diff > 0) {
+                usage = 100.0 * (1.0 - static_cast<double>(idle_diff) / total_diff);
+            }
+
+            // Zapisujemy obecne wartości jako "poprzednie" dla następnego ticku
+            total = now_total;
+            idle_total = now_idle_total;
+            value = lxrate::clamp(usage, 0.0, 100.0);
+            return value;
+        }
+    };
+
+    Baseline last_sample;
+    PinnedFile stat_file;
+
+    // Raw counters per cpu id, one row of kCounterFields each (grown on hotplug, never shrunk). Rows
+    // are filled while /proc/stat is parsed; the deltas of every core then come from one kernel pass.
+    enum CounterField : size_t { kTotal = 0, kIdle, kUser, kSystem, kIowait, kSteal, kCounterFields };
+    std::vector<lxrate::Counter> cur_;
+    std::vector<lxrate::Counter> prev_;
+    std::vector<lxrate::Counter> deltas_;
+    std::vector<uint8_t> has_prev_;
+    CpuCoreTable cores_;
+    Baseline cores_total_;
+
+    bool read_stats(unsigned long long &total, unsigned long long &idle_total) {
+        std::string_view text;
+        lxproc::CpuTimes t;
+        if (!stat_file.read(text) || !lxproc::parse_stat_total(text, t)) return false;
+        total = t.total();
+        idle_total = t.idle_total();
+        return total > 0;
+    }
+
+    void grow_to(size_t rows) {
+        if (rows <= cores_.rows) return;
+        cur_.resize(rows * kCounterFields, 0);
+        prev_.resize(rows * kCounterFields, 0);
+        deltas_.resize(rows * kCounterFields, 0);
+        has_prev_.resize(rows, 0);
+        cores_.values.resize(rows * kCoreColumns, 0.0);
+        cores_.online.resize(rows, 0);
+        cores_.rows = rows;
+    }
+
+    void update_core(size_t id, const lxproc::CpuTimes& t) {
+        grow_to(id + 1);
+        cores_.online[id] = 1;
+        lxrate::Counter* c = &cur_[id * kCounterFields];
+        c[kTotal] = t.total();
+        c[kIdle] = t.idle_total();
+        c[kUser] = t.user + t.nice;
+        c[kSystem] = t.system + t.irq + t.softirq;
+        c[kIowait] = t.iowait;
+        c[kSteal] = t.steal;
+    }
+
+    void compute_cores() {
+        lxrate::deltas(cur_.data(), prev_.data(), cores_.rows * kCounterFields, deltas_.data());
+        for (size_t id = 0; id < cores_.rows; ++id) {
+            double* row = &cores_.values[id * kCoreColumns];
+            if (!cores_.online[id] || !has_prev_[id]) {
+                // First sample for this core, or it went offline: zero row, and a fresh baseline
+                // when it comes back.
+                for (size_t k = 0; k < kCoreColumns; ++k) row[k] = 0.0;
+                has_prev_[id] = cores_.online[id];
+                continue;
+            }
+            const lxrate::Counter* d = &deltas_[id * kCounterFields];
+            if (d[kTotal] == 0) continue;  // no tick elapsed on this core: keep the previous row
+            const double scale = 100.0 / static_cast<double>(d[kTotal]);
+            row[kCoreUsage] = 100.0 - static_cast<double>(d[kIdle]) * scale;
+            row[kCoreUser] = static_cast<double>(d[kUser]) * scale;
+            row[kCoreSystem] = static_cast<double>(d[kSystem]) * scale;
+            row[kCoreIowait] = static_cast<double>(d[kIowait]) * scale;
+            row[kCoreSteal] = static_cast<double>(d[kSteal]) * scale;
+        }
+        lxrate::clamp_all(cores_.values.data(), cores_.values.size(), 0.0, 100.0);
+        // Rows of offline cores hold stale counters after the swap; has_prev_ == 0 keeps them unused
+        // until the core's next line rewrites them.
+        prev_.swap(cur_);
+    }
+};
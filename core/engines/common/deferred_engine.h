@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+
+// An engine whose constructor (device discovery, first counter read) runs on its own thread, so
+// several engines discover concurrently and the caller can keep going until it needs the result.
+//
+//   DeferredEngine<DiscActivityEngine> disc;
+//   disc.start([root] { return std::make_unique<DiscActivityEngine>(root); });
+//   ...
+//   if (disc.ready()) use(disc.get());   // or get() to wait
+//
+// get() rethrows a constructor exception; a later start() retries. Not thread-safe: callers on several
+// threads serialize (the GIL, the sampler thread) and wait on their own copy of future().
+template <typename Engine>
+class DeferredEngine {
+public:
+    using Factory = std::function<std::unique_ptr<Engine>()>;
+
+    DeferredEngine() = default;
+    DeferredEngine(const DeferredEngine&) = delete;
+    DeferredEngine& operator=(const DeferredEngine&) = delete;
+
+    // The last reference to an std::async state joins a construction still in flight.
+    ~DeferredEngine() = default;
+
+    // Starts construction unless it is already running or done. on_done (optional) runs on the
+    // construction thread right after the engine exists, e.g. to wake a waiting loop.
+    void start(Factory factory, std::function<void()> on_done = {}) {
+        if (engine_ || pending_.valid()) return;
+        pending_ = std::async(std::launch::async, [factory = std::move(factory), on_done = std::move(on_done)] {
+            std::shared_ptr<Engine> e = factory();
+            if (on_done) on_done();
+            return e;
+        }).share();
+    }
+
+    // Constructs on the calling thread; for engines too cheap to be worth a thread.
+    void start_now(const Factory& factory) {
+        if (engine_ || pending_.valid()) return;
+        engine_ = factory();
+    }
+
+    bool started() const { return engine_ || pending_.valid(); }
+
+    // True once get() will not block.
+    bool ready() const {
+        return engine_ || (pending_.valid() && pending_.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    }
+
+    // Waits for a started construction.
+    Engine& get() {
+        if (!engine_) {
+            std::shared_future<std::shared_ptr<Engine>> pending = std::move(pending_);
+            pending_ = {};
+            engine_ = pending.get();
+        }
+        return *engine_;
+    }
+
+    // A copy of the construction in flight to wait on, e.g. with the GIL released.
+    std::shared_future<std::shared_ptr<Engine>> future() const { return pending_; }
+
+    Engine* get_if_ready() { return ready() ? &get() : nullptr; }
+
+    // Drops the engine (waiting for a construction in flight); the next start() builds a new one.
+    void reset() {
+        if (pending_.valid()) pending_.wait();
+        pending_ = {};
+        engine_.reset();
+    }
+
+private:
+    std::shared_ptr<Engine> engine_;
+    std::shared_future<std::shared_ptr<Engine>> pending_;
+};
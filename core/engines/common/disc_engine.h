@@ -0,0 +1,486 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "pinned_file.h"
+#include "proc_parse.h"
+#include "rate_kernels.h"
+#include "source_root.h"
+#include "topology_watch.h"
+
+namespace fs = std::filesystem;
+
+class DiscActivityEngine {
+public:
+    explicit DiscActivityEngine(const SourceRoot& root = SourceRoot::host())
+        : root_(root), diskstats_file(root.resolve("/proc/diskstats")), topology_("block", std::chrono::seconds(5), root) {
+        tracked_disks = detect_physical_disks(root_);
+        rebuild_display_names();
+        last_time = std::chrono::steady_clock::now();
+        collect_counters(last_counters);
+    }
+
+    using UsageList = std::vector<std::pair<std::string, double>>;
+
+    double get_usage() {
+        try {
+            compute_all_usage();
+            if (usage_.empty()) return last_avg_value;
+
+            double sum = 0.0;
+            for (const auto& [_, v] : usage_) sum += v;
+            last_avg_value = sum / static_cast<double>(usage_.size());
+            return last_avg_value;
+        } catch (...) {
+            return last_avg_value;
+        }
+    }
+
+    // Usage per disk keyed by readable model name. Valid until the next call.
+    const UsageList& get_all_usage() {
+        try {
+            compute_all_usage();
+        } catch (...) {
+            usage_.clear();
+        }
+        return usage_;
+    }
+
+    // Per-disk performance over the last sample window (the iostat -x columns).
+    struct DiskRecord {
+        std::string disk;            // kernel name, e.g. nvme0n1
+        std::string label;           // same label as get_all_usage()
+        double util_pct = 0.0;       // busy time share (iostat %util)
+        double read_mib_s = 0.0;     // MiB/s (diskstats sectors are always 512 B)
+        double write_mib_s = 0.0;
+        double read_iops = 0.0;
+        double write_iops = 0.0;
+        double read_await_ms = 0.0;  // avg time per completed read, queueing included
+        double write_await_ms = 0.0;
+        double await_ms = 0.0;       // same over reads + writes
+        double queue_depth = 0.0;    // avg requests in flight over the window (iostat aqu-sz)
+        unsigned long long in_flight = 0;  // requests in flight at sample time
+    };
+
+    // Computed in the same diskstats pass as get_all_usage(); read both after one call.
+    // Valid until the next get_usage()/get_all_usage()/get_all_stats() call.
+    const std::vector<DiskRecord>& last_stats() const { return stats_; }
+
+    const std::vector<DiskRecord>& get_all_stats() {
+        try {
+            compute_all_usage();
+        } catch (...) {
+            stats_.clear();
+        }
+        return stats_;
+    }
+
+private:
+    // Counters of disk i at [i * kFields, (i + 1) * kFields) so one kernel pass gives every
+    // disk's deltas; in-flight (a gauge) and validity are kept beside them.
+    enum Field : size_t {
+        kIoMs = 0,
+        kWeightedIoMs,
+        kReads,
+        kWrites,
+        kSectorsRead,
+        kSectorsWritten,
+        kMsReading,
+        kMsWriting,
+        kFields
+    };
+
+    struct Counters {
+        std::vector<lxrate::Counter> values;
+        std::vector<unsigned long long> in_flight;
+        std::vector<char> valid;
+
+        void reset(size_t disks) {
+            values.assign(disks * kFields, 0);
+            in_flight.assign(disks, 0);
+            valid.assign(disks, 0);
+        }
+    };
+
+    // tracked_disks is sorted; display names and counters are indexed the same way.
+    std::vector<std::string> tracked_disks;
+    std::vector<std::string> disk_display_names;
+    std::chrono::steady_clock::time_point last_time;
+    Counters last_counters;
+    Counters cur_counters;
+    std::vector<lxrate::Counter> deltas_;
+    UsageList usage_;
+    std::vector<DiskRecord> stats_;
+    double last_avg_value = 0.0;
+    SourceRoot root_;
+    PinnedFile diskstats_file;
+    TopologyWatch topology_;
+
+    static bool is_physical_disk_name(const std::string& name) {
+        // SATA / HDD / SSD
+        if (name.rfind("sd", 0) == 0) return true;      // sda
+        if (name.rfind("hd", 0) == 0) return true;      // hda
+        if (name.rfind("vd", 0) == 0) return true;      // vda
+        if (name.rfind("xvd", 0) == 0) return true;     // xvda
+        // NVMe
+        if (name.rfind("nvme", 0) == 0 && name.find('p') == std::string::npos) return true; // nvme0n1
+        // eMMC / similar
+        if (name.rfind("mmcblk", 0) == 0 && name.find('p') == std::string::npos) return true;
+        // USB mass storage often appears as sdX (already covered)
+        return false;
+    }
+
+    static std::string basename_from_dev_path(const std::string& src) {
+        auto pos = src.find_last_of('/');
+        if (pos == std::string::npos) return src;
+        return src.substr(pos + 1);
+    }
+
+    static std::string_view strip_partition_suffix(std::string_view name) {
+        // nvme0n1p3 -> nvme0n1
+        auto ppos = name.rfind('p');
+        if (ppos != std::string::npos && ppos + 1 < name.size()) {
+            bool tail_digits = true;
+            for (size_t i = ppos + 1; i < name.size(); ++i) {
+                if (!std::isdigit(static_cast<unsigned char>(name[i]))) {
+                    tail_digits = false;
+                    break;
+                }
+            }
+            if (tail_digits && name.rfind("nvme", 0) == 0) return name.substr(0, ppos);
+            if (tail_digits && name.rfind("mmcblk", 0) == 0) return name.substr(0, ppos);
+        }
+
+        // sda1 -> sda, vda2 -> vda, xvda3 -> xvda, hda1 -> hda
+        if (name.rfind("sd", 0) == 0 || name.rfind("vd", 0) == 0 || name.rfind("xvd", 0) == 0 || name.rfind("hd", 0) == 0) {
+            size_t i = name.size();
+            while (i > 0 && std::isdigit(static_cast<unsigned char>(name[i - 1]))) i--;
+            if (i < name.size()) return name.substr(0, i);
+        }
+        return name;
+    }
+
+    static std::vector<std::string> detect_physical_disks(const SourceRoot& root) {
+        std::unordered_set<std::string> set;
+
+        // 1) Najpierw bierzemy zamontowane urządzenia, bo to najlepiej odzwierciedla realny I/O użytkownika.
+        std::ifstream mounts(root.resolve("/proc/self/mounts"));
+        std::string line;
+        while (std::getline(mounts, line)) {
+            std::istringstream iss(line);
+            std::string source, mount_point, fs_type;
+            if (!(iss >> source >> mount_point >> fs_type)) continue;
+            if (source.rfind("/dev/", 0) != 0) continue;
+
+            std::string base = basename_from_dev_path(source);
+            if (!base.empty()) {
+                // dm-* trzymamy bezpośrednio (LUKS/LVM może nie mieć prostego parenta).
+                if (base.rfind("dm-", 0) == 0) {
+                    set.insert(base);
+                } else {
+                    std::string parent(strip_partition_suffix(base));
+                    if (!parent.empty()) set.insert(parent);
+                }
+            }
+
+            // Dla /dev/mapper/* często realne urządzenie to dm-*; spróbujmy resolve.
+            try {
+                fs::path p(root.resolve(source));
+                if (fs::exists(p)) {
+                    fs::path resolved = fs::canonical(p);
+                    std::string rbase = resolved.filename().string();
+                    if (!rbase.empty()) {
+                        if (rbase.rfind("dm-", 0) == 0) {
+                            set.insert(rbase);
+                        } else {
+                            std::string rparent(strip_partition_suffix(rbase));
+                            if (!rparent.empty()) set.insert(rparent);
+                        }
+                    }
+                }
+            } catch (...) {
+                // ignore
+            }
+        }
+
+        // 2) Zawsze dołączamy /sys/block, żeby wykrywać także nośniki bez aktywnego mountu
+        // (np. świeżo podpięty pendrive/USB, który jeszcze nie ma filesystem mountu).
+        // A foreign root may deny access (another user's container); that only leaves the mounted disks.
+        fs::path sys_block(root.resolve("/sys/block"));
+        std::error_code ec;
+        if (fs::exists(sys_block, ec)) {
+            for (const auto& entry : fs::directory_iterator(sys_block, ec)) {
+                if (!entry.is_directory(ec)) continue;
+                std::string name = entry.path().filename().string();
+                if (is_physical_disk_name(name)) {
+                    set.insert(name);
+                }
+            }
+        }
+
+        std::unordered_set<std::string> normalized;
+        for (const auto& n : set) {
+            if (n.rfind("dm-", 0) == 0) {
+                normalized.insert(n);
+            } else {
+                normalized.emplace(strip_partition_suffix(n));
+            }
+        }
+
+        std::vector<std::string> out(normalized.begin(), normalized.end());
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    static std::string trim_copy(const std::string& input) {
+        size_t start = 0;
+        while (start < input.size() && std::isspace(static_cast<unsigned char>(input[start]))) start++;
+        size_t end = input.size();
+        while (end > start && std::isspace(static_cast<unsigned char>(input[end - 1]))) end--;
+        return input.substr(start, end - start);
+    }
+
+    static std::string collapse_spaces(const std::string& input) {
+        std::string out;
+        out.reserve(input.size());
+        bool prev_space = false;
+        for (char c : input) {
+            bool is_space = std::isspace(static_cast<unsigned char>(c)) != 0;
+            if (is_space) {
+                if (!prev_space) out.push_back(' ');
+                prev_space = true;
+            } else {
+                out.push_back(c);
+                prev_space = false;
+            }
+        }
+        return trim_copy(out);
+    }
+
+    static std::string read_first_line(const fs::path& p) {
+        std::ifstream f(p);
+        if (!f.is_open()) return {};
+        std::string line;
+        if (!std::getline(f, line)) return {};
+        return collapse_spaces(line);
+    }
+
+    static std::string human_name_for_disk(const SourceRoot& root, const std::string& disk) {
+        // Generic block device attributes.
+        const fs::path base = fs::path(root.resolve("/sys/block")) / disk / "device";
+        std::string vendor = read_first_line(base / "vendor");
+        std::string model = read_first_line(base / "model");
+
+        // NVMe sometimes exposes cleaner metadata in /sys/class/nvme/<controller>/.
+        if (disk.rfind("nvme", 0) == 0) {
+            // nvme0n1 -> nvme0 (bierzemy 'n' po prefiksie "nvme")
+            size_t npos = std::string::npos;
+            for (size_t i = 4; i < disk.size(); ++i) {
+                if (disk[i] == 'n') {
+                    npos = i;
+                    break;
+                }
+            }
+            if (npos != std::string::npos && npos > 0) {
+                std::string ctrl = disk.substr(0, npos);
+                fs::path nvme_base = fs::path(root.resolve("/sys/class/nvme")) / ctrl;
+                std::string nvme_model = read_first_line(nvme_base / "model");
+                std::string nvme_vendor = read_first_line(nvme_base / "vendor");
+                if (!nvme_model.empty()) model = nvme_model;
+                if (!nvme_vendor.empty()) vendor = nvme_vendor;
+            }
+        }
+
+        std::string label;
+        if (!vendor.empty() && !model.empty()) {
+            std::string vendor_low = vendor;
+            std::string model_low = model;
+            std::transform(vendor_low.begin(), vendor_low.end(), vendor_low.begin(), ::tolower);
+            std::transform(model_low.begin(), model_low.end(), model_low.begin(), ::tolower);
+            if (model_low.find(vendor_low) != std::string::npos) {
+                label = model;
+            } else {
+                label = vendor + " " + model;
+            }
+        } else if (!model.empty()) {
+            label = model;
+        } else if (!vendor.empty()) {
+            label = vendor;
+        } else {
+            label = disk;
+        }
+
+        if (label != disk) {
+            label += " (" + disk + ")";
+        }
+        return label;
+    }
+
+    void rebuild_display_names() {
+        disk_display_names.clear();
+        disk_display_names.reserve(tracked_disks.size());
+        std::unordered_map<std::string, int> seen_labels;
+        for (const auto& disk : tracked_disks) {
+            std::string label = human_name_for_disk(root_, disk);
+            int& count = seen_labels[label];
+            count++;
+            if (count > 1) {
+                label += " #" + std::to_string(count);
+            }
+            disk_display_names.push_back(std::move(label));
+        }
+    }
+
+    static constexpr size_t kNoDisk = static_cast<size_t>(-1);
+
+    size_t tracked_index(std::string_view name) const {
+        auto it = std::lower_bound(tracked_disks.begin(), tracked_disks.end(), name,
+            [](const std::string& a, std::string_view b) { return std::string_view(a) < b; });
+        if (it == tracked_disks.end() || *it != name) return kNoDisk;
+        return static_cast<size_t>(it - tracked_disks.begin());
+    }
+
+    // Fills out in tracked_disks order; returns false when no tracked disk was found.
+    bool collect_counters(Counters& out) {
+        out.reset(tracked_disks.size());
+        std::string_view text;
+        if (!diskstats_file.read(text)) return false;
+
+        bool any = false;
+        lxproc::for_each_diskstats(text, [&](const lxproc::DiskStats& d) {
+            size_t idx = tracked_index(d.name);
+            if (idx == kNoDisk) {
+                // Próbujemy przypisać partycję do bazowego dysku z tracked_disks.
+                idx = tracked_index(strip_partition_suffix(d.name));
+                if (idx == kNoDisk) return;
+            }
+
+            const lxrate::Counter line[kFields] = {
+                d.ms_doing_io, d.weighted_ms_doing_io, d.reads_completed, d.writes_completed,
+                d.sectors_read, d.sectors_written, d.ms_reading, d.ms_writing,
+            };
+            lxrate::Counter* c = &out.values[idx * kFields];
+            if (!out.valid[idx]) {
+                std::copy_n(line, kFields, c);
+                out.in_flight[idx] = d.ios_in_progress;
+                out.valid[idx] = 1;
+            } else {
+                // Bierzemy max, żeby nie zaniżać i nie dublować parent/partition.
+                for (size_t f = 0; f < kFields; ++f) c[f] = std::max(c[f], line[f]);
+                out.in_flight[idx] = std::max<unsigned long long>(out.in_flight[idx], d.ios_in_progress);
+            }
+            any = true;
+        });
+        return any;
+    }
+
+    // Overwrites usage_[slot] in place so steady ticks reuse the label strings.
+    void set_usage(size_t slot, size_t disk, double value) {
+        if (slot < usage_.size()) {
+            usage_[slot].first = disk_display_names[disk];
+            usage_[slot].second = value;
+        } else {
+            usage_.emplace_back(disk_display_names[disk], value);
+        }
+    }
+
+    // Like set_usage(): reuses stats_[slot] so the name strings keep their buffers.
+    DiskRecord& record_slot(size_t slot, size_t disk) {
+        if (slot >= stats_.size()) stats_.emplace_back();
+        DiskRecord& r = stats_[slot];
+        r.disk = tracked_disks[disk];
+        r.label = disk_display_names[disk];
+        return r;
+    }
+
+    // d is the disk's row of deltas_.
+    static void fill_record(DiskRecord& r, const lxrate::Counter* d, unsigned long long in_flight, double elapsed_ms) {
+        constexpr double kSectorMiB = 512.0 / (1024.0 * 1024.0);
+        const double elapsed_s = elapsed_ms / 1000.0;
+        const unsigned long long d_reads = d[kReads];
+        const unsigned long long d_writes = d[kWrites];
+        const double d_read_ms = static_cast<double>(d[kMsReading]);
+        const double d_write_ms = static_cast<double>(d[kMsWriting]);
+        const double d_io_ms = static_cast<double>(d[kIoMs]);
+        const double d_weighted_ms = static_cast<double>(d[kWeightedIoMs]);
+
+        r.util_pct = std::clamp((d_io_ms / elapsed_ms) * 100.0, 0.0, 100.0);
+        r.read_mib_s = static_cast<double>(d[kSectorsRead]) * kSectorMiB / elapsed_s;
+        r.write_mib_s = static_cast<double>(d[kSectorsWritten]) * kSectorMiB / elapsed_s;
+        r.read_iops = static_cast<double>(d_reads) / elapsed_s;
+        r.write_iops = static_cast<double>(d_writes) / elapsed_s;
+        r.read_await_ms = d_reads ? d_read_ms / static_cast<double>(d_reads) : 0.0;
+        r.write_await_ms = d_writes ? d_write_ms / static_cast<double>(d_writes) : 0.0;
+        const unsigned long long d_ops = d_reads + d_writes;
+        r.await_ms = d_ops ? (d_read_ms + d_write_ms) / static_cast<double>(d_ops) : 0.0;
+        r.queue_depth = d_weighted_ms / elapsed_ms;
+        r.in_flight = in_flight;
+    }
+
+    void compute_all_usage() {
+        // Jeśli w locie zmienił się zestaw dysków, odśwież listę.
+        // Skan (mounts + canonical + /sys/block) tylko po uevencie block albo zmianie tablicy mountów.
+        if (topology_.changed()) {
+            auto fresh_disks = detect_physical_disks(root_);
+            if (fresh_disks != tracked_disks) {
+                tracked_disks = std::move(fresh_disks);
+                rebuild_display_names();
+                collect_counters(last_counters);
+                last_time = std::chrono::steady_clock::now();
+                zero_usage();
+                return;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed_ms = std::chrono::duration<double, std::milli>(now - last_time).count();
+        if (elapsed_ms <= 1.0 || !collect_counters(cur_counters)) {
+            zero_usage();
+            return;
+        }
+
+        deltas_.resize(cur_counters.values.size());
+        lxrate::deltas(cur_counters.values.data(), last_counters.values.data(), deltas_.size(), deltas_.data());
+
+        size_t n = 0;
+        for (size_t i = 0; i < tracked_disks.size(); ++i) {
+            if (!cur_counters.valid[i] || !last_counters.valid[i]) continue;
+            const lxrate::Counter* d = &deltas_[i * kFields];
+
+            // Używamy większej z wartości: zwykły busy time i weighted busy time.
+            double basis = static_cast<double>(std::max(d[kIoMs], d[kWeightedIoMs]));
+            double util = (basis / elapsed_ms) * 100.0;
+            fill_record(record_slot(n, i), d, cur_counters.in_flight[i], elapsed_ms);
+            set_usage(n++, i, std::clamp(util, 0.0, 100.0));
+        }
+        usage_.resize(n);
+        stats_.resize(n);
+
+        last_time = now;
+        std::swap(last_counters, cur_counters);
+        if (n == 0) zero_usage();
+    }
+
+    void zero_usage() {
+        for (size_t i = 0; i < tracked_disks.size(); ++i) {
+            set_usage(i, i, 0.0);
+            DiskRecord& r = record_slot(i, i);
+            r.util_pct = r.read_mib_s = r.write_mib_s = r.read_iops = r.write_iops = 0.0;
+            r.read_await_ms = r.write_await_ms = r.await_ms = r.queue_depth = 0.0;
+            r.in_flight = 0;
+        }
+        usage_.resize(tracked_disks.size());
+        stats_.resize(tracked_disks.size());
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+
+#include "pinned_file.h"
+
+// Log-linear latency histogram in nanoseconds (HDR style): 16 linear sub-buckets per power of two,
+// so any recorded value lands in a bucket at most 6.25% wide. Covers 1 ns .. ~18 min in 5 KiB.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBits;
+    static constexpr int kMaxMsb = 40;
+    static constexpr size_t kBuckets = static_cast<size_t>(kMaxMsb - kSubBits + 2) << kSubBits;
+
+    void record(uint64_t ns) {
+        ++counts_[index_of(ns)];
+        ++count_;
+        sum_ns_ += ns;
+        if (count_ == 1 || ns < min_ns_) min_ns_ = ns;
+        if (ns > max_ns_) max_ns_ = ns;
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t min_ns() const { return count_ ? min_ns_ : 0; }
+    uint64_t max_ns() const { return max_ns_; }
+    double mean_ns() const { return count_ ? static_cast<double>(sum_ns_) / static_cast<double>(count_) : 0.0; }
+    uint64_t sum_ns() const { return sum_ns_; }
+
+    // Upper edge of the bucket holding quantile q (0..1), clamped to the recorded max.
+    uint64_t percentile_ns(double q) const {
+        if (count_ == 0) return 0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(count_) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(upper_edge(i), max_ns_);
+        }
+        return max_ns_;
+    }
+
+private:
+    uint64_t counts_[kBuckets] = {};
+    uint64_t count_ = 0;
+    uint64_t sum_ns_ = 0;
+    uint64_t min_ns_ = 0;
+    uint64_t max_ns_ = 0;
+
+    static size_t index_of(uint64_t v) {
+        if (v < kSubBuckets) return static_cast<size_t>(v);
+        int msb = 63 - __builtin_clzll(v);
+        if (msb > kMaxMsb) {
+            msb = kMaxMsb;
+            v = (2ull << kMaxMsb) - 1;
+        }
+        const int shift = msb - kSubBits;
+        return (static_cast<size_t>(shift + 1) << kSubBits) + static_cast<size_t>((v >> shift) & (kSubBuckets - 1));
+    }
+
+    static uint64_t upper_edge(size_t i) {
+        if (i < kSubBuckets) return i;
+        const int shift = static_cast<int>(i >> kSubBits) - 1;
+        const uint64_t sub = i & (kSubBuckets - 1);
+        return ((kSubBuckets + sub + 1) << shift) - 1;
+    }
+};
+
+// Cost of one engine (or of a whole tick): latency plus the file I/O it caused.
+struct EngineCost {
+    LatencyHistogram latency;
+    uint64_t failures = 0;
+    uint64_t file_reads = 0;  // pread() calls through PinnedFile
+    uint64_t file_opens = 0;  // open() calls through PinnedFile
+    uint64_t syscalls = 0;    // read+write syscalls of the thread (tick entries only, from /proc/thread-self/io)
+    uint64_t cpu_ns = 0;      // thread CPU time (tick entries only)
+};
+
+// Name-keyed costs shared by the sampler thread and Python-timed engine calls.
+// Entries are created on first record and live until reset().
+class EngineStatsRegistry {
+public:
+    void record(std::string_view name, uint64_t ns, bool ok, uint64_t reads = 0, uint64_t opens = 0) {
+        std::lock_guard<std::mutex> lk(mu_);
+        EngineCost& c = entry(name);
+        c.latency.record(ns);
+        if (!ok) ++c.failures;
+        c.file_reads += reads;
+        c.file_opens += opens;
+    }
+
+    void record_tick(std::string_view name, uint64_t ns, uint64_t reads, uint64_t opens, uint64_t syscalls, uint64_t cpu_ns) {
+        std::lock_guard<std::mutex> lk(mu_);
+        EngineCost& c = entry(name);
+        c.latency.record(ns);
+        c.file_reads += reads;
+        c.file_opens += opens;
+        c.syscalls += syscalls;
+        c.cpu_ns += cpu_ns;
+    }
+
+    std::vector<std::pair<std::string, EngineCost>> snapshot() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return {entries_.begin(), entries_.end()};
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lk(mu_);
+        entries_.clear();
+        started_ = std::chrono::steady_clock::now();
+    }
+
+    // Wall time covered by the current entries (since construction or the last reset()).
+    double elapsed_s() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    }
+
+private:
+    std::mutex mu_;
+    std::map<std::string, EngineCost, std::less<>> entries_;
+    std::chrono::steady_clock::time_point started_ = std::chrono::steady_clock::now();
+
+    EngineCost& entry(std::string_view name) {
+        auto it = entries_.find(name);
+        if (it == entries_.end()) it = entries_.emplace(std::string(name), EngineCost{}).first;
+        return it->second;
+    }
+};
+
+// Read/write syscall counter of the calling thread. The probe itself costs one pread per sample.
+class ThreadSyscallCounter {
+public:
+    // Returns false when /proc/thread-self/io is unavailable (old kernels, restricted procfs).
+    bool sample(uint64_t& syscalls) {
+        std::string_view text;
+        if (!file_.read(text)) return false;
+        uint64_t total = 0;
+        int found = 0;
+        for (std::string_view key : {"syscr: ", "syscw: "}) {
+            const size_t at = text.find(key);
+            if (at == std::string_view::npos) continue;
+            unsigned long long v = 0;
+            const char* first = text.data() + at + key.size();
+            const auto res = std::from_chars(first, text.data() + text.size(), v);
+            if (res.ec != std::errc()) continue;
+            total += v;
+            ++found;
+        }
+        syscalls = total;
+        return found > 0;
+    }
+
+private:
+    PinnedFile file_{"/proc/thread-self/io", PinnedFile::kSingleShow};
+};
+
+inline uint64_t thread_cpu_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// The monitor's own footprint: resident memory and process CPU time.
+struct SelfUsage {
+    uint64_t rss_bytes = 0;
+    double cpu_s = 0.0;          // process CPU time (all threads) since exec
+    double window_s = 0.0;       // wall time since the previous SelfUsageProbe::sample()
+    double window_cpu_pct = 0.0; // share of one core over that window
+};
+
+class SelfUsageProbe {
+public:
+    SelfUsage sample() {
+        std::lock_guard<std::mutex> lk(mu_);
+        SelfUsage out;
+        std::string_view text;
+        unsigned long long pages = 0;
+        if (statm_.read(text)) {
+            // statm: size resident shared ...
+            const size_t sp = text.find(' ');
+            if (sp != std::string_view::npos) {
+                std::from_chars(text.data() + sp + 1, text.data() + text.size(), pages);
+            }
+        }
+        out.rss_bytes = static_cast<uint64_t>(pages) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+        timespec ts{};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        out.cpu_s = static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (have_prev_) {
+            out.window_s = std::chrono::duration<double>(now - prev_wall_).count();
+            if (out.window_s > 0.0) out.window_cpu_pct = 100.0 * (out.cpu_s - prev_cpu_s_) / out.window_s;
+        }
+        have_prev_ = true;
+        prev_wall_ = now;
+        prev_cpu_s_ = out.cpu_s;
+        return out;
+    }
+
+private:
+    std::mutex mu_;
+    PinnedFile statm_{"/proc/self/statm", PinnedFile::kSingleShow};
+    bool have_prev_ = false;
+    std::chrono::steady_clock::time_point prev_wall_;
+    double prev_cpu_s_ = 0.0;
+};
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+
+#include "pinned_file.h"
+#include "source_root.h"
+#include "topology_watch.h"
+
+namespace fs = std::filesystem;
+
+// Latest values of one GPU. NaN marks a value the card does not expose.
+struct GpuCardReading {
+    std::string card;    // card0 ... or hwmonN for a GPU hwmon chip outside /sys/class/drm
+    std::string slot;    // PCI slot, e.g. 0000:03:00.0
+    std::string driver;  // amdgpu, i915, nouveau, ...
+    double busy_pct = std::numeric_limits<double>::quiet_NaN();
+    double temp_c = std::numeric_limits<double>::quiet_NaN();  // hottest temp*_input of the card
+};
+
+// Busy-percent and temperature files of every GPU, resolved once and kept open.
+// Discovery runs on first use, on drm/hwmon add/remove/move uevents (driver reload, hotplug),
+// on rescan(), and at most every 2 s while an indexed file is gone (GPU reset, unbind).
+class GpuCardIndex {
+public:
+    enum Want : unsigned {
+        kBusy = 1u << 0,
+        kTemp = 1u << 1,
+    };
+
+    explicit GpuCardIndex(unsigned want, const SourceRoot& root = SourceRoot::host())
+        : want_(want),
+          drm_root_(root.resolve("/sys/class/drm")),
+          hwmon_root_(root.resolve("/sys/class/hwmon")),
+          topology_(std::vector<std::string>{"drm", "hwmon"}, std::chrono::seconds(30), root) {}
+
+    GpuCardIndex(const GpuCardIndex&) = delete;
+    GpuCardIndex& operator=(const GpuCardIndex&) = delete;
+
+    // One reading per card, DRM cards first in card-number order.
+    const std::vector<GpuCardReading>& sample() {
+        const auto now = std::chrono::steady_clock::now();
+        const bool topology_changed = topology_.changed();
+        if (!indexed_ || rescan_requested_ || topology_changed ||
+            (read_failed_ && now - last_discovery_ >= kFailureRediscoverGap)) {
+            discover(now);
+        }
+        for (size_t i = 0; i < cards_.size(); ++i) read_card(cards_[i], readings_[i]);
+        return readings_;
+    }
+
+    void rescan() { rescan_requested_ = true; }
+
+    size_t discoveries() const { return discoveries_; }
+
+private:
+    static constexpr auto kFailureRediscoverGap = std::chrono::seconds(2);
+
+    struct Card {
+        PinnedFile busy;
+        std::vector<PinnedFile> temps;
+    };
+
+    unsigned want_;
+    std::string drm_root_;
+    std::string hwmon_root_;
+    std::vector<Card> cards_;
+    std::vector<GpuCardReading> readings_;  // parallel to cards_
+    TopologyWatch topology_;
+    bool indexed_ = false;
+    bool rescan_requested_ = false;
+    bool read_failed_ = false;
+    std::chrono::steady_clock::time_point last_discovery_;
+    size_t discoveries_ = 0;
+
+    static std::string read_line_once(const fs::path& p) {
+        PinnedFile f(p.string());
+        std::string_view line;
+        return f.read_line(line) ? std::string(line) : std::string();
+    }
+
+    static std::string to_lower(std::string s) {
+        for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return s;
+    }
+
+    // card0, card1, ... but not connectors (card0-DP-1) or render nodes.
+    static int card_number(const std::string& name) {
+        if (name.rfind("card", 0) != 0 || name.size() == 4) return -1;
+        for (size_t i = 4; i < name.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(name[i]))) return -1;
+        }
+        return std::atoi(name.c_str() + 4);
+    }
+
+    static bool is_temp_input(const std::string& name) {
+        return name.rfind("temp", 0) == 0 && name.find("_input") != std::string::npos;
+    }
+
+    static std::string canonical(const fs::path& p) {
+        std::error_code ec;
+        const fs::path c = fs::canonical(p, ec);
+        return ec ? p.string() : c.string();
+    }
+
+    void add_temps(const fs::path& hwmon, Card& card) {
+        std::vector<std::string> files;
+        std::error_code ec;
+        for (const auto& f : fs::directory_iterator(hwmon, ec)) {
+            const std::string name = f.path().filename().string();
+            if (is_temp_input(name)) files.push_back(f.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        for (auto& f : files) card.temps.emplace_back(std::move(f), PinnedFile::kSingleShow);
+    }
+
+    void discover(std::chrono::steady_clock::time_point now) {
+        cards_.clear();
+        readings_.clear();
+        std::unordered_set<std::string> card_hwmons;  // canonical hwmon dirs already attached to a card
+        std::error_code ec;
+
+        std::vector<std::pair<int, fs::path>> drm;
+        for (const auto& e : fs::directory_iterator(drm_root_, ec)) {
+            const int n = card_number(e.path().filename().string());
+            if (n >= 0) drm.emplace_back(n, e.path());
+        }
+        std::sort(drm.begin(), drm.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        for (const auto& [n, path] : drm) {
+            const fs::path dev = path / "device";
+            if (!fs::exists(dev, ec)) continue;
+            Card card;
+            GpuCardReading r;
+            r.card = path.filename().string();
+            const std::string uevent = [&] {
+                PinnedFile f((dev / "uevent").string());
+                std::string_view text;
+                return f.read(text) ? std::string(text) : std::string();
+            }();
+            const size_t at = uevent.find("PCI_SLOT_NAME=");
+            if (at != std::string::npos) {
+                const size_t start = at + 14;
+                r.slot = uevent.substr(start, uevent.find('\n', start) - start);
+            }
+            const fs::path drv = fs::read_symlink(dev / "driver", ec);
+            if (!ec) r.driver = drv.filename().string();
+
+            if (want_ & kBusy) {
+                for (const char* name : {"gpu_busy_percent", "usage"}) {
+                    if (fs::exists(dev / name, ec)) {
+                        card.busy = PinnedFile((dev / name).string(), PinnedFile::kSingleShow);
+                        break;
+                    }
+                }
+            }
+            std::vector<fs::path> hwmons;
+            for (const auto& hw : fs::directory_iterator(dev / "hwmon", ec)) hwmons.push_back(hw.path());
+            std::sort(hwmons.begin(), hwmons.end());
+            for (const auto& hw : hwmons) {
+                card_hwmons.insert(canonical(hw));
+                if (want_ & kTemp) add_temps(hw, card);
+            }
+            if (card.busy.path().empty() && card.temps.empty()) continue;
+            cards_.push_back(std::move(card));
+            readings_.push_back(std::move(r));
+        }
+
+        // GPU hwmon chips not reachable through a DRM card (e.g. proprietary drivers without DRM hwmon).
+        if (want_ & kTemp) {
+            std::vector<fs::path> hwmons;
+            for (const auto& hw : fs::directory_iterator(hwmon_root_, ec)) hwmons.push_back(hw.path());
+            std::sort(hwmons.begin(), hwmons.end());
+            for (const auto& hw : hwmons) {
+                if (card_hwmons.count(canonical(hw))) continue;
+                const std::string driver = to_lower(read_line_once(hw / "name"));
+                const bool looks_like_gpu = driver.find("amdgpu") != std::string::npos || driver.find("nouveau") != std::string::npos ||
+                                            driver.find("nvidia") != std::string::npos || driver.find("xe") != std::string::npos ||
+                                            driver.find("i915") != std::string::npos;
+                if (!looks_like_gpu) continue;
+                Card card;
+                add_temps(hw, card);
+                if (card.temps.empty()) continue;
+                GpuCardReading r;
+                r.card = hw.filename().string();
+                r.driver = driver;
+                cards_.push_back(std::move(card));
+                readings_.push_back(std::move(r));
+            }
+        }
+
+        indexed_ = true;
+        rescan_requested_ = false;
+        read_failed_ = false;
+        last_discovery_ = now;
+        ++discoveries_;
+    }
+
+    // A runtime-suspended GPU fails reads with EPERM/EINVAL; only a vanished node needs a rescan.
+    void note_failure() {
+        if (errno == ENOENT || errno == ENODEV || errno == ESTALE) read_failed_ = true;
+    }
+
+    static bool parse_number(std::string_view text, double& out) {
+        std::string cleaned;
+        for (char c : text) {
+            if (std::isdigit(static_cast<unsigned char>(c)) || c == '.' || c == '-') cleaned.push_back(c);
+            else if (!cleaned.empty()) break;
+        }
+        if (cleaned.empty()) return false;
+        char* end = nullptr;
+        out = std::strtod(cleaned.c_str(), &end);
+        return end != cleaned.c_str();
+    }
+
+    void read_card(Card& card, GpuCardReading& r) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        r.busy_pct = nan;
+        if (!card.busy.path().empty()) {
+            std::string_view text;
+            double v = 0.0;
+            if (!card.busy.read_line(text)) note_failure();
+            else if (parse_number(text, v)) r.busy_pct = std::clamp(v, 0.0, 100.0);
+        }
+
+        r.temp_c = nan;
+        for (auto& f : card.temps) {
+            double v = 0.0;
+            if (!f.read_double(v)) {
+                note_failure();
+                continue;
+            }
+            // Najczęściej millicelsius
+            if (v > 1000.0) v /= 1000.0;
+            if (v <= 0.0 || v > 150.0) continue;
+            if (std::isnan(r.temp_c) || v > r.temp_c) r.temp_c = v;
+        }
+    }
+};
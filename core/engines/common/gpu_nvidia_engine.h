@@ -0,0 +1,398 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <nvml.h>
+
+// Multi-GPU NVML engine. Handles and static properties are cached at init. Per tick, power, energy,
+// memory temperature and PCIe byte counters come from one nvmlDeviceGetFieldValues() batch per device;
+// utilization, memory, core temperature and clocks have no field ids and keep their per-metric calls.
+// Fields the driver rejects leave the batch after the first tick (falling back to the per-metric call
+// where one exists), and NOT_SUPPORTED metrics are never queried again.
+class NvidiaSensing {
+public:
+    // NaN marks a metric the device does not report.
+    struct DeviceRecord {
+        unsigned int index = 0;
+        std::string name;
+        std::string uuid;
+        std::string pci_bus_id;  // sysfs form, e.g. 0000:01:00.0
+        double util_gpu = kNaN;
+        double util_mem = kNaN;
+        double mem_used_mib = kNaN;
+        double mem_total_mib = kNaN;
+        double temp_c = kNaN;
+        double mem_temp_c = kNaN;
+        double power_w = kNaN;
+        double power_limit_w = kNaN;
+        double energy_j = kNaN;  // since driver load
+        double clock_graphics_mhz = kNaN;
+        double clock_sm_mhz = kNaN;
+        double clock_mem_mhz = kNaN;
+        double pcie_tx_mib_s = kNaN;
+        double pcie_rx_mib_s = kNaN;
+    };
+
+    struct ProcessRecord {
+        unsigned int device = 0;
+        unsigned int pid = 0;
+        bool graphics = false;     // false: compute context
+        double used_mib = kNaN;
+        double sm_util = kNaN;     // % over the last sampling window
+        double mem_util = kNaN;
+        double enc_util = kNaN;
+        double dec_util = kNaN;
+    };
+
+    static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+    NvidiaSensing() {
+        // Inicjalizacja biblioteki NVML
+        initialized_ = nvmlInit_v2() == NVML_SUCCESS;
+        if (!initialized_) return;
+        unsigned int count = 0;
+        if (nvmlDeviceGetCount_v2(&count) != NVML_SUCCESS) count = 0;
+        devices_.reserve(count);
+        for (unsigned int i = 0; i < count; ++i) {
+            Device d;
+            if (nvmlDeviceGetHandleByIndex_v2(i, &d.handle) != NVML_SUCCESS) continue;
+            d.record.index = i;
+            init_static(d);
+            devices_.push_back(std::move(d));
+        }
+        records_.resize(devices_.size());
+    }
+
+    ~NvidiaSensing() {
+        if (initialized_) nvmlShutdown();
+    }
+
+    NvidiaSensing(const NvidiaSensing&) = delete;
+    NvidiaSensing& operator=(const NvidiaSensing&) = delete;
+
+    bool initialized() const { return initialized_; }
+    size_t device_count() const { return devices_.size(); }
+
+    // Load of the busiest device (0-100).
+    double get_usage() {
+        double best = 0.0;
+        for (const auto& r : sample()) {
+            if (std::isfinite(r.util_gpu)) best = std::max(best, r.util_gpu);
+        }
+        return std::min(best, 100.0);
+    }
+
+    // One record per device, in NVML index order; memoized for kMemoWindow.
+    const std::vector<DeviceRecord>& sample() {
+        const auto now = std::chrono::steady_clock::now();
+        if (has_memo_ && now - memo_time_ < kMemoWindow) return records_;
+        for (size_t i = 0; i < devices_.size(); ++i) {
+            sample_device(devices_[i], now);
+            records_[i] = devices_[i].record;
+        }
+        memo_time_ = now;
+        has_memo_ = true;
+        return records_;
+    }
+
+    // Running compute/graphics processes with their memory and recent utilization.
+    // Not part of the tick: process lists cost several driver round trips per device.
+    std::vector<ProcessRecord> processes(int device = -1) {
+        std::vector<ProcessRecord> out;
+        for (auto& d : devices_) {
+            if (device >= 0 && d.record.index != static_cast<unsigned int>(device)) continue;
+            const size_t first = out.size();
+            append_processes(d, false, out);
+            append_processes(d, true, out);
+            apply_process_utilization(d, out, first);
+        }
+        return out;
+    }
+
+private:
+    static constexpr auto kMemoWindow = std::chrono::milliseconds(15);
+    // nvmlDeviceGetPcieThroughput() blocks for ~20 ms, so the fallback path is rate-limited.
+    static constexpr auto kPcieFallbackPeriod = std::chrono::seconds(2);
+
+    enum Metric : unsigned {
+        kUtilization = 1u << 0,
+        kMemory = 1u << 1,
+        kTemperature = 1u << 2,
+        kPower = 1u << 3,
+        kClocks = 1u << 4,
+        kPcie = 1u << 5,
+        kEnergy = 1u << 6,
+        kMemTemp = 1u << 7,
+    };
+
+    // Which metric a batched field feeds and how to scale it.
+    struct FieldSpec {
+        unsigned int id;
+        Metric metric;
+        double DeviceRecord::*target;
+        double scale;
+    };
+
+    struct Device {
+        nvmlDevice_t handle{};
+        DeviceRecord record;
+        std::vector<FieldSpec> fields;         // still in the batch
+        std::vector<nvmlFieldValue_t> values;  // reused request/response buffer
+        unsigned batched = 0;                  // metrics currently served by the batch
+        unsigned unsupported = 0;              // metrics neither path can read
+        bool first_batch = true;
+        // PCIe byte counters (when batched) for rates.
+        double pcie_tx_bytes = kNaN;
+        double pcie_rx_bytes = kNaN;
+        std::chrono::steady_clock::time_point pcie_ts;
+        std::chrono::steady_clock::time_point pcie_fallback_ts;
+        unsigned long long last_process_sample = 0;
+    };
+
+    bool initialized_ = false;
+    std::vector<Device> devices_;
+    std::vector<DeviceRecord> records_;
+    std::chrono::steady_clock::time_point memo_time_;
+    bool has_memo_ = false;
+
+    // Only fields this nvml.h defines take part; older drivers reject new ids per field, not per call.
+    static std::vector<FieldSpec> default_fields() {
+        std::vector<FieldSpec> f;
+#ifdef NVML_FI_DEV_POWER_INSTANT
+        f.push_back({NVML_FI_DEV_POWER_INSTANT, kPower, &DeviceRecord::power_w, 1e-3});
+#endif
+#ifdef NVML_FI_DEV_TOTAL_ENERGY_CONSUMPTION
+        f.push_back({NVML_FI_DEV_TOTAL_ENERGY_CONSUMPTION, kEnergy, &DeviceRecord::energy_j, 1e-3});
+#endif
+#ifdef NVML_FI_DEV_MEMORY_TEMP
+        f.push_back({NVML_FI_DEV_MEMORY_TEMP, kMemTemp, &DeviceRecord::mem_temp_c, 1.0});
+#endif
+#if defined(NVML_FI_DEV_PCIE_COUNT_TX_BYTES) && defined(NVML_FI_DEV_PCIE_COUNT_RX_BYTES)
+        f.push_back({NVML_FI_DEV_PCIE_COUNT_TX_BYTES, kPcie, &DeviceRecord::pcie_tx_mib_s, 1.0});
+        f.push_back({NVML_FI_DEV_PCIE_COUNT_RX_BYTES, kPcie, &DeviceRecord::pcie_rx_mib_s, 1.0});
+#endif
+        return f;
+    }
+
+    static double field_to_double(const nvmlFieldValue_t& v) {
+        switch (v.valueType) {
+            case NVML_VALUE_TYPE_DOUBLE: return v.value.dVal;
+            case NVML_VALUE_TYPE_UNSIGNED_INT: return static_cast<double>(v.value.uiVal);
+            case NVML_VALUE_TYPE_UNSIGNED_LONG: return static_cast<double>(v.value.ulVal);
+            case NVML_VALUE_TYPE_UNSIGNED_LONG_LONG: return static_cast<double>(v.value.ullVal);
+            case NVML_VALUE_TYPE_SIGNED_LONG_LONG: return static_cast<double>(v.value.sllVal);
+            default: return kNaN;
+        }
+    }
+
+    // NVML reports 00000000:01:00.0; sysfs and the Python side use a 4-digit domain.
+    static std::string sysfs_bus_id(const char* bus_id) {
+        std::string s(bus_id);
+        for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        const size_t colon = s.find(':');
+        if (colon != std::string::npos && colon > 4) s.erase(0, colon - 4);
+        return s;
+    }
+
+    static void init_static(Device& d) {
+        char name[NVML_DEVICE_NAME_V2_BUFFER_SIZE] = {};
+        if (nvmlDeviceGetName(d.handle, name, sizeof(name)) == NVML_SUCCESS) d.record.name = name;
+        char uuid[NVML_DEVICE_UUID_V2_BUFFER_SIZE] = {};
+        if (nvmlDeviceGetUUID(d.handle, uuid, sizeof(uuid)) == NVML_SUCCESS) d.record.uuid = uuid;
+        nvmlPciInfo_t pci{};
+        if (nvmlDeviceGetPciInfo_v3(d.handle, &pci) == NVML_SUCCESS) d.record.pci_bus_id = sysfs_bus_id(pci.busId);
+        unsigned int limit_mw = 0;
+        if (nvmlDeviceGetEnforcedPowerLimit(d.handle, &limit_mw) == NVML_SUCCESS) d.record.power_limit_w = limit_mw / 1000.0;
+
+        d.fields = default_fields();
+        for (const auto& f : d.fields) d.batched |= f.metric;
+        d.values.resize(d.fields.size());
+    }
+
+    void sample_device(Device& d, std::chrono::steady_clock::time_point now) {
+        DeviceRecord& r = d.record;
+        if (!d.fields.empty()) run_batch(d, now);
+
+        const unsigned legacy = ~(d.batched | d.unsupported);
+        if (legacy & kUtilization) {
+            nvmlUtilization_t u{};
+            if (ok(d, kUtilization, nvmlDeviceGetUtilizationRates(d.handle, &u))) {
+                r.util_gpu = std::min(100.0, static_cast<double>(u.gpu));
+                r.util_mem = std::min(100.0, static_cast<double>(u.memory));
+            } else {
+                r.util_gpu = r.util_mem = kNaN;
+            }
+        }
+        if (legacy & kMemory) {
+            nvmlMemory_t m{};
+            if (ok(d, kMemory, nvmlDeviceGetMemoryInfo(d.handle, &m))) {
+                r.mem_used_mib = static_cast<double>(m.used) / (1024.0 * 1024.0);
+                r.mem_total_mib = static_cast<double>(m.total) / (1024.0 * 1024.0);
+            } else {
+                r.mem_used_mib = r.mem_total_mib = kNaN;
+            }
+        }
+        if (legacy & kTemperature) {
+            unsigned int t = 0;
+            r.temp_c = ok(d, kTemperature, nvmlDeviceGetTemperature(d.handle, NVML_TEMPERATURE_GPU, &t)) ? t : kNaN;
+        }
+        if (legacy & kPower) {
+            unsigned int mw = 0;
+            r.power_w = ok(d, kPower, nvmlDeviceGetPowerUsage(d.handle, &mw)) ? mw / 1000.0 : kNaN;
+        }
+        if (legacy & kEnergy) {
+            unsigned long long mj = 0;
+            r.energy_j = ok(d, kEnergy, nvmlDeviceGetTotalEnergyConsumption(d.handle, &mj)) ? static_cast<double>(mj) / 1000.0 : kNaN;
+        }
+        if (legacy & kClocks) {
+            unsigned int gr = 0, sm = 0, mem = 0;
+            r.clock_graphics_mhz = ok(d, kClocks, nvmlDeviceGetClockInfo(d.handle, NVML_CLOCK_GRAPHICS, &gr)) ? gr : kNaN;
+            r.clock_sm_mhz = nvmlDeviceGetClockInfo(d.handle, NVML_CLOCK_SM, &sm) == NVML_SUCCESS ? sm : kNaN;
+            r.clock_mem_mhz = nvmlDeviceGetClockInfo(d.handle, NVML_CLOCK_MEM, &mem) == NVML_SUCCESS ? mem : kNaN;
+        }
+        if ((legacy & kPcie) && (d.pcie_fallback_ts == std::chrono::steady_clock::time_point{} ||
+                                 now - d.pcie_fallback_ts >= kPcieFallbackPeriod)) {
+            d.pcie_fallback_ts = now;
+            unsigned int tx_kb = 0, rx_kb = 0;
+            if (ok(d, kPcie, nvmlDeviceGetPcieThroughput(d.handle, NVML_PCIE_UTIL_TX_BYTES, &tx_kb)) &&
+                ok(d, kPcie, nvmlDeviceGetPcieThroughput(d.handle, NVML_PCIE_UTIL_RX_BYTES, &rx_kb))) {
+                r.pcie_tx_mib_s = tx_kb / 1024.0;
+                r.pcie_rx_mib_s = rx_kb / 1024.0;
+            } else {
+                r.pcie_tx_mib_s = r.pcie_rx_mib_s = kNaN;
+            }
+        }
+        // kMemTemp has no per-metric call; it is batch-only.
+        d.unsupported |= legacy & kMemTemp;
+    }
+
+    // Only NOT_SUPPORTED is permanent; other errors (GPU busy resetting, lost) just blank the value.
+    static bool ok(Device& d, Metric m, nvmlReturn_t rc) {
+        if (rc == NVML_ERROR_NOT_SUPPORTED) d.unsupported |= m;
+        return rc == NVML_SUCCESS;
+    }
+
+    void run_batch(Device& d, std::chrono::steady_clock::time_point now) {
+        for (size_t i = 0; i < d.fields.size(); ++i) {
+            d.values[i] = nvmlFieldValue_t{};
+            d.values[i].fieldId = d.fields[i].id;
+        }
+        if (nvmlDeviceGetFieldValues(d.handle, static_cast<int>(d.values.size()), d.values.data()) != NVML_SUCCESS) {
+            // The whole call is unsupported (old driver): serve everything through the classic calls.
+            d.fields.clear();
+            d.values.clear();
+            d.batched = 0;
+            return;
+        }
+
+        DeviceRecord& r = d.record;
+        double tx_bytes = kNaN;
+        double rx_bytes = kNaN;
+        bool dropped = false;
+        for (size_t i = 0; i < d.fields.size(); ++i) {
+            const FieldSpec& f = d.fields[i];
+            const nvmlFieldValue_t& v = d.values[i];
+            if (v.nvmlReturn != NVML_SUCCESS) {
+                if (d.first_batch) {
+                    d.fields[i].metric = static_cast<Metric>(0);  // marked for removal below
+                    dropped = true;
+                }
+                continue;
+            }
+            const double value = field_to_double(v);
+            if (f.metric == kPcie) {
+                (f.target == &DeviceRecord::pcie_tx_mib_s ? tx_bytes : rx_bytes) = value;
+            } else {
+                r.*f.target = value * f.scale;
+            }
+        }
+
+        if (dropped) {
+            std::vector<FieldSpec> kept;
+            for (const auto& f : d.fields) {
+                if (f.metric != 0) kept.push_back(f);
+            }
+            d.fields = std::move(kept);
+            d.values.resize(d.fields.size());
+            d.batched = 0;
+            for (const auto& f : d.fields) d.batched |= f.metric;
+            // Both PCIe counters are needed for rates.
+            const bool tx = std::any_of(d.fields.begin(), d.fields.end(), [](const FieldSpec& f) { return f.target == &DeviceRecord::pcie_tx_mib_s; });
+            const bool rx = std::any_of(d.fields.begin(), d.fields.end(), [](const FieldSpec& f) { return f.target == &DeviceRecord::pcie_rx_mib_s; });
+            if (tx != rx) {
+                d.fields.erase(std::remove_if(d.fields.begin(), d.fields.end(), [](const FieldSpec& f) { return f.metric == kPcie; }), d.fields.end());
+                d.values.resize(d.fields.size());
+                d.batched &= ~static_cast<unsigned>(kPcie);
+            }
+        }
+        d.first_batch = false;
+
+        if (std::isfinite(tx_bytes) && std::isfinite(rx_bytes) && (d.batched & kPcie)) {
+            if (std::isfinite(d.pcie_tx_bytes)) {
+                const double dt = std::chrono::duration<double>(now - d.pcie_ts).count();
+                if (dt > 0.0) {
+                    const double mib = 1024.0 * 1024.0;
+                    r.pcie_tx_mib_s = std::max(0.0, tx_bytes - d.pcie_tx_bytes) / mib / dt;
+                    r.pcie_rx_mib_s = std::max(0.0, rx_bytes - d.pcie_rx_bytes) / mib / dt;
+                }
+            }
+            d.pcie_tx_bytes = tx_bytes;
+            d.pcie_rx_bytes = rx_bytes;
+            d.pcie_ts = now;
+        }
+    }
+
+    static void append_processes(Device& d, bool graphics, std::vector<ProcessRecord>& out) {
+        std::vector<nvmlProcessInfo_t> infos(16);
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            unsigned int count = static_cast<unsigned int>(infos.size());
+            const nvmlReturn_t rc = graphics ? nvmlDeviceGetGraphicsRunningProcesses(d.handle, &count, infos.data())
+                                             : nvmlDeviceGetComputeRunningProcesses(d.handle, &count, infos.data());
+            if (rc == NVML_ERROR_INSUFFICIENT_SIZE) {
+                infos.resize(static_cast<size_t>(count) + 8);  // processes may start in between
+                continue;
+            }
+            if (rc != NVML_SUCCESS) return;
+            for (unsigned int i = 0; i < count; ++i) {
+                ProcessRecord p;
+                p.device = d.record.index;
+                p.pid = infos[i].pid;
+                p.graphics = graphics;
+                // NVML_VALUE_NOT_AVAILABLE without per-process memory accounting (e.g. Windows WDDM, some vGPUs).
+                if (infos[i].usedGpuMemory != NVML_VALUE_NOT_AVAILABLE) {
+                    p.used_mib = static_cast<double>(infos[i].usedGpuMemory) / (1024.0 * 1024.0);
+                }
+                out.push_back(p);
+            }
+            return;
+        }
+    }
+
+    static void apply_process_utilization(Device& d, std::vector<ProcessRecord>& out, size_t first) {
+        if (first == out.size()) return;
+        unsigned int count = 0;
+        nvmlReturn_t rc = nvmlDeviceGetProcessUtilization(d.handle, nullptr, &count, d.last_process_sample);
+        if (rc != NVML_ERROR_INSUFFICIENT_SIZE || count == 0) return;
+        std::vector<nvmlProcessUtilizationSample_t> samples(count);
+        rc = nvmlDeviceGetProcessUtilization(d.handle, samples.data(), &count, d.last_process_sample);
+        if (rc != NVML_SUCCESS) return;
+        for (unsigned int i = 0; i < count; ++i) {
+            const auto& s = samples[i];
+            d.last_process_sample = std::max(d.last_process_sample, s.timeStamp);
+            for (size_t j = first; j < out.size(); ++j) {
+                if (out[j].pid != s.pid) continue;
+                out[j].sm_util = s.smUtil;
+                out[j].mem_util = s.memUtil;
+                out[j].enc_util = s.encUtil;
+                out[j].dec_util = s.decUtil;
+            }
+        }
+    }
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "gpu_cards.h"
+
+class GpuOthers {
+public:
+    explicit GpuOthers(const SourceRoot& root = SourceRoot::host()) : index_(GpuCardIndex::kBusy, root) {}
+
+    double get_usage() { return busiest(index_.sample()); }
+
+    // Per-card busy percent, one sysfs pass per call.
+    const std::vector<GpuCardReading>& get_all_usage() { return index_.sample(); }
+
+    void rescan() { index_.rescan(); }
+
+    // Load of the busiest card (0-100).
+    static double busiest(const std::vector<GpuCardReading>& cards) {
+        double best = 0.0;
+        for (const auto& r : cards) {
+            if (!std::isnan(r.busy_pct) && r.busy_pct > best) best = r.busy_pct;
+        }
+        return best;
+    }
+
+private:
+    GpuCardIndex index_;
+};
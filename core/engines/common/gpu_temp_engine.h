@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "gpu_cards.h"
+
+class GpuTempEngine {
+public:
+    explicit GpuTempEngine(const SourceRoot& root = SourceRoot::host()) : index_(GpuCardIndex::kTemp, root) {}
+
+    double get_usage() { return hottest(index_.sample()); }
+
+    // Per-card temperatures, one sysfs pass per call.
+    const std::vector<GpuCardReading>& get_all_usage() { return index_.sample(); }
+
+    void rescan() { index_.rescan(); }
+
+    // GPU hwmon chips outside /sys/class/drm only count when no DRM card reports a temperature.
+    static double hottest(const std::vector<GpuCardReading>& cards) {
+        double drm = 0.0;
+        double other = 0.0;
+        for (const auto& r : cards) {
+            if (std::isnan(r.temp_c)) continue;
+            double& best = r.card.rfind("card", 0) == 0 ? drm : other;
+            if (r.temp_c > best) best = r.temp_c;
+        }
+        return drm > 0.0 ? drm : other;
+    }
+
+private:
+    GpuCardIndex index_;
+};
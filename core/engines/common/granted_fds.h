@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Read-only fds of protected files (gpu_busy_percent, RAPL energy_uj, hwmon temps) opened by the
+// privileged helper (privilege.cpp) and handed to each engine module with adopt_fds(). PinnedFile
+// falls back to a dup() from here when its own open() fails with EACCES, so engines keep reading
+// their usual paths without the files being made world-readable. Keys are the path as requested and
+// its canonical form, since engines reach sysfs attributes through class symlinks.
+class GrantedFds {
+public:
+    GrantedFds() = default;
+    GrantedFds(const GrantedFds&) = delete;
+    GrantedFds& operator=(const GrantedFds&) = delete;
+
+    ~GrantedFds() { clear(); }
+
+    // Keeps a duplicate of fd for path (the caller's fd stays its own). False when fd is not valid.
+    bool adopt(const std::string& path, int fd) {
+        const int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 3);
+        if (own < 0) return false;
+        std::lock_guard<std::mutex> lk(mu_);
+        put(path, own);
+        char real[PATH_MAX];
+        if (::realpath(path.c_str(), real) && path != real) {
+            const int second = ::fcntl(own, F_DUPFD_CLOEXEC, 3);
+            if (second >= 0) put(real, second);
+        }
+        any_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // A new fd for path (the caller closes it), or -1 when none was granted.
+    int dup(const std::string& path) {
+        if (!any_.load(std::memory_order_acquire)) return -1;
+        std::lock_guard<std::mutex> lk(mu_);
+        auto it = fds_.find(path);
+        if (it == fds_.end()) {
+            char real[PATH_MAX];
+            if (!::realpath(path.c_str(), real)) return -1;
+            it = fds_.find(real);
+            if (it == fds_.end()) return -1;
+        }
+        return ::fcntl(it->second, F_DUPFD_CLOEXEC, 3);
+    }
+
+    bool has(const std::string& path) {
+        const int fd = dup(path);
+        if (fd < 0) return false;
+        ::close(fd);
+        return true;
+    }
+
+    std::vector<std::string> paths() {
+        std::lock_guard<std::mutex> lk(mu_);
+        std::vector<std::string> out;
+        out.reserve(fds_.size());
+        for (const auto& [path, _] : fds_) out.push_back(path);
+        return out;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lk(mu_);
+        for (const auto& [_, fd] : fds_) ::close(fd);
+        fds_.clear();
+        any_.store(false, std::memory_order_release);
+    }
+
+private:
+    std::mutex mu_;
+    std::unordered_map<std::string, int> fds_;
+    std::atomic<bool> any_{false};  // lets every failed open skip the lock until something was granted
+
+    void put(const std::string& path, int fd) {
+        auto [it, inserted] = fds_.emplace(path, fd);
+        if (!inserted) {
+            ::close(it->second);
+            it->second = fd;
+        }
+    }
+};
+
+// One registry per engine module (each .so has its own copy of this inline function).
+inline GrantedFds& granted_fds() {
+    static GrantedFds fds;
+    return fds;
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Resolution tiers of every series. Raw keeps each sample with its timestamp;
+// the others are fixed-period buckets (min/max/avg), each fed by the tier below it.
+enum HistoryTier : size_t {
+    kTierRaw = 0,
+    kTier1s,
+    kTier10s,
+    kTier1m,
+    kTierCount,
+};
+
+struct HistoryTierInfo {
+    const char* name;
+    double period_s;  // 0 for raw
+};
+
+inline constexpr HistoryTierInfo kHistoryTiers[kTierCount] = {
+    {"raw", 0.0},
+    {"1s", 1.0},
+    {"10s", 10.0},
+    {"1m", 60.0},
+};
+
+// Slots per tier. Defaults: 1 min of 250 ms samples, 5 min of 1 s, 1 h of 10 s, 12 h of 1 min (~39 KB per series).
+struct HistoryConfig {
+    size_t capacity[kTierCount] = {240, 300, 360, 720};
+    size_t max_series = 1024;  // interface/disk names can churn (veth, loop); later names are dropped
+};
+
+// Newest points of one tier, oldest first. Pointers stay valid for the store's lifetime and the
+// points stay intact for the next (capacity - points) appends to that tier; nothing is copied.
+struct HistoryWindow {
+    HistoryTier tier = kTierRaw;
+    size_t points = 0;
+    double period_s = 0.0;
+    double first_time = 0.0;     // raw: time of the first sample, otherwise start of the first bucket
+    const double* time = nullptr;  // raw only
+    const float* min = nullptr;    // raw: same array as avg
+    const float* max = nullptr;
+    const float* avg = nullptr;    // NaN marks buckets without samples
+};
+
+// Fixed-size 64-byte aligned array that never reallocates, so views into it stay valid.
+template <typename T>
+class AlignedArray {
+public:
+    AlignedArray() = default;
+    explicit AlignedArray(size_t size) : size_(size) {
+        if (size_ == 0) return;
+        const size_t bytes = (size_ * sizeof(T) + 63) / 64 * 64;
+        data_ = static_cast<T*>(std::aligned_alloc(64, bytes));
+        if (!data_) throw std::bad_alloc();
+        for (size_t i = 0; i < size_; ++i) data_[i] = T{};
+    }
+
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+    AlignedArray(AlignedArray&& other) noexcept : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+    AlignedArray& operator=(AlignedArray&& other) noexcept {
+        if (this != &other) {
+            std::free(data_);
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~AlignedArray() { std::free(data_); }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    T& operator[](size_t i) { return data_[i]; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Time-series store for every metric/device the sampler produces.
+// Each tier is a mirrored ring: slot i is also written at i + capacity, so the newest
+// n <= capacity points are one contiguous run and can be exported as a buffer without a copy.
+// All methods are thread-safe; appends and window lookups take one mutex for a few hundred ns.
+class HistoryStore {
+public:
+    explicit HistoryStore(HistoryConfig config = HistoryConfig{}) : config_(config) {
+        for (auto& c : config_.capacity) {
+            if (c < 2) c = 2;
+        }
+    }
+
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    // Appends a group of samples that share one timestamp under a single lock (one sampler tick).
+    class Batch {
+    public:
+        Batch(HistoryStore& store, double timestamp_s) : store_(store), lock_(store.mu_), time_(timestamp_s) {}
+        void add(std::string_view name, double value) { store_.append_locked(name, time_, value); }
+
+    private:
+        HistoryStore& store_;
+        std::lock_guard<std::mutex> lock_;
+        double time_;
+    };
+
+    void record(std::string_view name, double timestamp_s, double value) {
+        std::lock_guard<std::mutex> lk(mu_);
+        append_locked(name, timestamp_s, value);
+    }
+
+    // points == 0 means everything the tier holds.
+    bool window(std::string_view name, HistoryTier tier, size_t points, HistoryWindow& out) const {
+        if (tier >= kTierCount) return false;
+        std::lock_guard<std::mutex> lk(mu_);
+        const auto it = index_.find(name);
+        if (it == index_.end()) return false;
+        series_[it->second]->tiers[tier].window(tier, points, out);
+        return true;
+    }
+
+    std::vector<std::string> names() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        std::vector<std::string> out;
+        out.reserve(index_.size());
+        for (const auto& [name, _] : index_) out.push_back(name);
+        return out;
+    }
+
+    size_t series_count() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        return series_.size();
+    }
+
+    size_t capacity(HistoryTier tier) const { return tier < kTierCount ? config_.capacity[tier] : 0; }
+
+    // Bytes held by ring storage (excluding the name index).
+    size_t memory_bytes() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        size_t per_series = 0;
+        for (size_t t = 0; t < kTierCount; ++t) {
+            const size_t slots = 2 * config_.capacity[t];
+            per_series += t == kTierRaw ? slots * (sizeof(double) + sizeof(float)) : slots * 3 * sizeof(float);
+        }
+        return per_series * series_.size();
+    }
+
+private:
+    struct Tier {
+        size_t capacity = 0;
+        double period_s = 0.0;
+        uint64_t pushed = 0;  // total slots written
+        AlignedArray<double> time;  // raw only
+        AlignedArray<float> min;
+        AlignedArray<float> max;
+        AlignedArray<float> avg;
+
+        // Open (not yet published) bucket of an aggregated tier.
+        bool has_open = false;
+        int64_t open_bucket = 0;
+        int64_t newest_bucket = 0;  // bucket id of the newest published slot
+        float open_min = 0.0f;
+        float open_max = 0.0f;
+        double open_sum = 0.0;
+        uint64_t open_count = 0;
+
+        Tier(size_t cap, double period) : capacity(cap), period_s(period) {
+            if (period_s == 0.0) {
+                time = AlignedArray<double>(2 * cap);
+                avg = AlignedArray<float>(2 * cap);
+            } else {
+                min = AlignedArray<float>(2 * cap);
+                max = AlignedArray<float>(2 * cap);
+                avg = AlignedArray<float>(2 * cap);
+            }
+        }
+
+        void push_raw(double t, float v) {
+            const size_t p = static_cast<size_t>(pushed % capacity);
+            time[p] = time[p + capacity] = t;
+            avg[p] = avg[p + capacity] = v;
+            ++pushed;
+        }
+
+        void push_bucket(int64_t bucket, float mn, float mx, float av) {
+            const size_t p = static_cast<size_t>(pushed % capacity);
+            min[p] = min[p + capacity] = mn;
+            max[p] = max[p + capacity] = mx;
+            avg[p] = avg[p + capacity] = av;
+            newest_bucket = bucket;
+            ++pushed;
+        }
+
+        void window(HistoryTier tier, size_t points, HistoryWindow& out) const {
+            const size_t held = static_cast<size_t>(pushed < capacity ? pushed : capacity);
+            const size_t n = (points == 0 || points > held) ? held : points;
+            // Start of the newest n slots inside the doubled array.
+            const size_t end = static_cast<size_t>(pushed % capacity) + capacity;
+            const size_t start = end - n;
+
+            out = HistoryWindow{};
+            out.tier = tier;
+            out.points = n;
+            out.period_s = period_s;
+            out.avg = avg.data() + start;
+            if (period_s == 0.0) {
+                out.time = time.data() + start;
+                out.min = out.max = out.avg;
+                out.first_time = n ? out.time[0] : 0.0;
+            } else {
+                out.min = min.data() + start;
+                out.max = max.data() + start;
+                out.first_time = static_cast<double>(newest_bucket - static_cast<int64_t>(n) + 1) * period_s;
+            }
+        }
+    };
+
+    struct Series {
+        std::vector<Tier> tiers;
+    };
+
+    HistoryConfig config_;
+    mutable std::mutex mu_;
+    std::map<std::string, size_t, std::less<>> index_;
+    std::vector<std::unique_ptr<Series>> series_;  // never shrinks: windows point into it
+
+    Series* series_locked(std::string_view name) {
+        const auto it = index_.find(name);
+        if (it != index_.end()) return series_[it->second].get();
+        if (series_.size() >= config_.max_series) return nullptr;
+
+        auto s = std::make_unique<Series>();
+        s->tiers.reserve(kTierCount);
+        for (size_t t = 0; t < kTierCount; ++t) s->tiers.emplace_back(config_.capacity[t], kHistoryTiers[t].period_s);
+        index_.emplace(std::string(name), series_.size());
+        series_.push_back(std::move(s));
+        return series_.back().get();
+    }
+
+    void append_locked(std::string_view name, double t, double value) {
+        if (!std::isfinite(t)) return;
+        Series* s = series_locked(name);
+        if (!s) return;
+        const float v = static_cast<float>(value);
+        s->tiers[kTierRaw].push_raw(t, v);
+        if (!std::isfinite(value)) return;
+        feed(*s, kTier1s, t, v, v, value, 1);
+    }
+
+    // Adds a sample/bucket summary to tier's open bucket; a bucket closes when time moves past it
+    // and is then fed into the next tier, so averages stay exact (sum and count travel along).
+    void feed(Series& s, size_t tier, double t, float mn, float mx, double sum, uint64_t count) {
+        Tier& tr = s.tiers[tier];
+        int64_t bucket = static_cast<int64_t>(std::floor(t / tr.period_s));
+
+        if (!tr.has_open) {
+            tr.has_open = true;
+            tr.open_bucket = bucket;
+            tr.open_count = 0;
+        } else if (bucket < tr.open_bucket) {
+            bucket = tr.open_bucket;  // clock stepped back: fold into the open bucket
+        } else if (bucket > tr.open_bucket) {
+            close(s, tier);
+            // Buckets with no samples are published as NaN, so a window is evenly spaced in time.
+            const int64_t gap = bucket - tr.open_bucket - 1;
+            const int64_t fill = gap < static_cast<int64_t>(tr.capacity) ? gap : static_cast<int64_t>(tr.capacity);
+            const float nan = std::numeric_limits<float>::quiet_NaN();
+            for (int64_t b = bucket - fill; b < bucket; ++b) tr.push_bucket(b, nan, nan, nan);
+            tr.open_bucket = bucket;
+            tr.open_count = 0;
+        }
+
+        if (tr.open_count == 0) {
+            tr.open_min = mn;
+            tr.open_max = mx;
+            tr.open_sum = 0.0;
+        } else {
+            if (mn < tr.open_min) tr.open_min = mn;
+            if (mx > tr.open_max) tr.open_max = mx;
+        }
+        tr.open_sum += sum;
+        tr.open_count += count;
+    }
+
+    void close(Series& s, size_t tier) {
+        Tier& tr = s.tiers[tier];
+        if (tr.open_count == 0) return;
+        const float avg = static_cast<float>(tr.open_sum / static_cast<double>(tr.open_count));
+        tr.push_bucket(tr.open_bucket, tr.open_min, tr.open_max, avg);
+        if (tier + 1 < kTierCount) {
+            feed(s, tier + 1, static_cast<double>(tr.open_bucket) * tr.period_s, tr.open_min, tr.open_max, tr.open_sum, tr.open_count);
+        }
+        tr.open_count = 0;
+    }
+};
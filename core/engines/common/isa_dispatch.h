@@ -0,0 +1,43 @@
+#pragma once
+
+// Runtime ISA dispatch for hot kernels. LX_MULTIVERSION on a function definition compiles it for
+// x86-64 baseline, v3 (AVX2/FMA/BMI2) and v4 (AVX-512 F/BW/CD/DQ/VL); an ifunc resolver picks one
+// from CPUID when the module is loaded, so a default (baseline) build still runs the wide loops
+// on CPUs that have them. Only for leaf loops over plain arrays: each clone is a separate body and
+// none of them can be inlined into the caller.
+//
+// LxBinMan's performance-avx2/avx512 variants are built with -march for the whole module and
+// define LX_NO_MULTIVERSION, which turns the macro off. Needs GCC 12+ (arch= targets); elsewhere
+// the functions are compiled once for the build's own -march.
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12 && !defined(LX_NO_MULTIVERSION)
+#define LX_MULTIVERSION __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+#else
+#define LX_MULTIVERSION
+#endif
+
+namespace lxisa {
+
+// Level the LX_MULTIVERSION kernels run at in this process: "avx512", "avx2" or "baseline".
+inline const char* level() {
+#if defined(__x86_64__) && defined(__GNUC__)
+#if defined(LX_NO_MULTIVERSION)
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VL__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#else
+    return "baseline";
+#endif
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("x86-64-v4")) return "avx512";
+    if (__builtin_cpu_supports("x86-64-v3")) return "avx2";
+    return "baseline";
+#endif
+#else
+    return "baseline";
+#endif
+}
+
+}  // namespace lxisa
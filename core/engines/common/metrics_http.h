@@ -0,0 +1,305 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "openmetrics.h"
+#include "sampler_snapshot.h"
+
+// Minimal HTTP/1.1 endpoint for scrapers: GET /metrics renders the latest published snapshot with
+// OpenMetricsWriter; nothing on the path samples an engine or touches Python. One connection at a
+// time on its own thread (a scrape is a few hundred microseconds, scrapers come every 15-60 s), the
+// response is header + body in one sendmsg, and the connection is closed after it.
+class MetricsHttpServer {
+public:
+    // Copies the snapshot to export into out (same object every scrape, so its lists keep their capacity).
+    using Source = std::function<void(SamplerSnapshot& out)>;
+
+    struct Stats {
+        uint64_t scrapes = 0;
+        uint64_t bad_requests = 0;  // 404/405/400 and connections that timed out or reset
+        double last_render_us = 0.0;
+        size_t last_bytes = 0;
+        size_t last_series = 0;
+        size_t label_renders = 0;
+    };
+
+    explicit MetricsHttpServer(Source source) : source_(std::move(source)) {}
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    ~MetricsHttpServer() { stop(); }
+
+    // Binds address:port (numeric IPv4/IPv6; port 0 picks a free one) and starts serving. Restarts
+    // when already running. On failure returns false with the reason in error.
+    bool start(const std::string& address, int port, std::string& error) {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        stop_locked();
+        if (port < 0 || port > 65535) {
+            error = "port out of range";
+            return false;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV | AI_PASSIVE;
+        addrinfo* res = nullptr;
+        const std::string service = std::to_string(port);
+        const int gai = ::getaddrinfo(address.empty() ? nullptr : address.c_str(), service.c_str(), &hints, &res);
+        if (gai != 0) {
+            error = address + ": " + ::gai_strerror(gai);
+            return false;
+        }
+        const int fd = ::socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            error = std::string("socket: ") + std::strerror(errno);
+            ::freeaddrinfo(res);
+            return false;
+        }
+        const int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, res->ai_addr, res->ai_addrlen) != 0 || ::listen(fd, 16) != 0) {
+            error = address + ":" + service + ": " + std::strerror(errno);
+            ::close(fd);
+            ::freeaddrinfo(res);
+            return false;
+        }
+        ::freeaddrinfo(res);
+
+        sockaddr_storage bound{};
+        socklen_t len = sizeof(bound);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &len);
+        port_ = ntohs(bound.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                                                  : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+        address_ = address;
+        listen_fd_ = fd;
+        wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        stop_.store(false, std::memory_order_relaxed);
+        worker_ = std::thread([this] { serve(); });
+        return true;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        stop_locked();
+    }
+
+    bool running() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        return worker_.joinable();
+    }
+
+    // Bound port, 0 when stopped.
+    int port() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        return worker_.joinable() ? port_ : 0;
+    }
+
+    std::string address() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        return address_;
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lk(render_mu_);
+        return stats_;
+    }
+
+    // The /metrics body as a scrape would get it now, rendered on the calling thread (safe while serving).
+    std::string render_text() {
+        std::lock_guard<std::mutex> lk(render_mu_);
+        return render_locked();
+    }
+
+private:
+    static constexpr int kRequestTimeoutMs = 2000;
+    static constexpr size_t kMaxRequestBytes = 8192;
+
+    Source source_;
+    std::mutex control_mu_;  // start/stop
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;
+    int port_ = 0;
+    std::string address_;
+
+    std::mutex render_mu_;  // snapshot_, writer_, stats_: the server thread vs render_text()
+    SamplerSnapshot snapshot_;
+    OpenMetricsWriter writer_;
+    Stats stats_;
+    std::string request_;   // server thread only
+    std::string header_;
+
+    void stop_locked() {
+        if (worker_.joinable()) {
+            stop_.store(true, std::memory_order_relaxed);
+            const uint64_t one = 1;
+            while (::write(wake_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+            }
+            worker_.join();
+        }
+        if (listen_fd_ >= 0) ::close(listen_fd_);
+        if (wake_fd_ >= 0) ::close(wake_fd_);
+        listen_fd_ = wake_fd_ = -1;
+    }
+
+    const std::string& render_locked() {
+        const auto t0 = std::chrono::steady_clock::now();
+        source_(snapshot_);
+        const double now_s = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const std::string& body = writer_.render(snapshot_, now_s);
+        stats_.last_render_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        stats_.last_bytes = body.size();
+        stats_.last_series = writer_.series();
+        stats_.label_renders = writer_.label_renders();
+        return body;
+    }
+
+    void serve() {
+        pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        while (!stop_.load(std::memory_order_relaxed)) {
+            fds[0].revents = fds[1].revents = 0;
+            const int n = ::poll(fds, 2, -1);
+            if (n < 0 && errno != EINTR) return;
+            if (n <= 0 || !(fds[0].revents & POLLIN)) continue;
+            const int conn = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (conn < 0) continue;
+            handle(conn);
+            ::close(conn);
+        }
+    }
+
+    // Waits for events on fd until the request deadline; false on timeout, error or stop().
+    bool wait_fd(int fd, short events, std::chrono::steady_clock::time_point deadline) {
+        pollfd fds[2] = {{fd, events, 0}, {wake_fd_, POLLIN, 0}};
+        for (;;) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) return false;
+            const int n = ::poll(fds, 2, static_cast<int>(left));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0 || (fds[1].revents & POLLIN)) return false;
+            return (fds[0].revents & events) != 0;
+        }
+    }
+
+    // Reads up to the end of the request head; the body (none for GET) is never needed.
+    bool read_request(int fd, std::chrono::steady_clock::time_point deadline) {
+        request_.clear();
+        char buf[2048];
+        while (request_.find("\r\n\r\n") == std::string::npos) {
+            if (request_.size() >= kMaxRequestBytes || !wait_fd(fd, POLLIN, deadline)) return false;
+            const ssize_t got = ::recv(fd, buf, sizeof(buf), 0);
+            if (got < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            if (got <= 0) return false;
+            request_.append(buf, static_cast<size_t>(got));
+        }
+        return true;
+    }
+
+    bool send_all(int fd, std::string_view head, std::string_view body, std::chrono::steady_clock::time_point deadline) {
+        iovec iov[2] = {{const_cast<char*>(head.data()), head.size()}, {const_cast<char*>(body.data()), body.size()}};
+        int first = 0;
+        while (first < 2) {
+            msghdr msg{};
+            msg.msg_iov = iov + first;
+            msg.msg_iovlen = static_cast<size_t>(2 - first);
+            const ssize_t sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN || !wait_fd(fd, POLLOUT, deadline)) return false;
+                continue;
+            }
+            size_t left = static_cast<size_t>(sent);
+            while (first < 2 && left >= iov[first].iov_len) left -= iov[first++].iov_len;
+            if (first < 2) {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+                iov[first].iov_len -= left;
+            }
+        }
+        return true;
+    }
+
+    void respond(int fd, int status, const char* reason, const char* content_type, std::string_view body, bool head_only,
+                 std::chrono::steady_clock::time_point deadline) {
+        header_.clear();
+        header_ += "HTTP/1.1 ";
+        lxom::append_uint(header_, static_cast<uint64_t>(status));
+        header_.push_back(' ');
+        header_ += reason;
+        header_ += "\r\nContent-Type: ";
+        header_ += content_type;
+        header_ += "\r\nContent-Length: ";
+        lxom::append_uint(header_, body.size());
+        header_ += "\r\nCache-Control: no-store\r\nConnection: close\r\n";
+        if (status == 405) header_ += "Allow: GET, HEAD\r\n";
+        header_ += "\r\n";
+        send_all(fd, header_, head_only ? std::string_view() : body, deadline);
+    }
+
+    void handle(int fd) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kRequestTimeoutMs);
+        if (!read_request(fd, deadline)) {
+            std::lock_guard<std::mutex> lk(render_mu_);
+            ++stats_.bad_requests;
+            return;
+        }
+        const std::string_view req(request_);
+        const std::string_view line = req.substr(0, req.find("\r\n"));
+        const size_t sp1 = line.find(' ');
+        const size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+        if (sp2 == std::string_view::npos) {
+            bad(fd, 400, "Bad Request", deadline);
+            return;
+        }
+        const std::string_view method = line.substr(0, sp1);
+        std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        target = target.substr(0, target.find('?'));
+        const bool head_only = method == "HEAD";
+        if (method != "GET" && !head_only) {
+            bad(fd, 405, "Method Not Allowed", deadline);
+            return;
+        }
+        if (target == "/") {
+            respond(fd, 200, "OK", "text/plain; charset=utf-8", "LxMonitor exporter: /metrics\n", head_only, deadline);
+            return;
+        }
+        if (target != "/metrics") {
+            bad(fd, 404, "Not Found", deadline);
+            return;
+        }
+        // Prometheus asks for application/openmetrics-text in Accept; curl and older scrapers get 0.0.4 text.
+        const bool openmetrics = req.find("application/openmetrics-text") != std::string_view::npos;
+        std::lock_guard<std::mutex> lk(render_mu_);
+        const std::string& body = render_locked();
+        ++stats_.scrapes;
+        respond(fd, 200, "OK", openmetrics ? OpenMetricsWriter::kContentType : OpenMetricsWriter::kPrometheusContentType, body,
+                head_only, deadline);
+    }
+
+    void bad(int fd, int status, const char* reason, std::chrono::steady_clock::time_point deadline) {
+        {
+            std::lock_guard<std::mutex> lk(render_mu_);
+            ++stats_.bad_requests;
+        }
+        respond(fd, status, reason, "text/plain; charset=utf-8", std::string_view(reason), false, deadline);
+    }
+};
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "netlink_links.h"
+#include "pinned_file.h"
+#include "proc_parse.h"
+#include "rate_kernels.h"
+#include "source_root.h"
+
+// Per-interface traffic from RTM_GETLINK (binary counters, host root) or /proc/net/dev (any other root,
+// or when netlink is unavailable). Both report the same kernel counters.
+class NetActivityEngine {
+public:
+    using UsageList = std::vector<std::pair<std::string, double>>;
+
+    enum class Backend {
+        Auto,      // netlink for the host root, /proc/net/dev text otherwise
+        Netlink,   // netlink even for another root (the caller already entered its network namespace)
+        ProcText,  // always /proc/net/dev
+    };
+
+    // Per-second rates of one interface over the last sample.
+    struct IfRates {
+        std::string name;
+        double rx_mbps = 0.0;
+        double tx_mbps = 0.0;
+        double rx_pps = 0.0;
+        double tx_pps = 0.0;
+        double rx_errs = 0.0;
+        double tx_errs = 0.0;
+        double rx_drops = 0.0;
+        double tx_drops = 0.0;
+    };
+
+    explicit NetActivityEngine(const SourceRoot& root = SourceRoot::host(), Backend backend = Backend::Auto)
+        : dev_file(root.resolve("/proc/net/dev")), skip_prefixes_(default_skip_prefixes()) {
+        if (backend == Backend::Netlink || (backend == Backend::Auto && root.is_host())) {
+            netlink_ = std::make_unique<NetlinkLinkDump>();
+            if (!netlink_->ok()) netlink_.reset();
+        }
+        last_time = std::chrono::steady_clock::now();
+        if (read_counters()) commit_counters();
+    }
+
+    double get_usage() {
+        try {
+            compute_all_usage();
+            double total = 0.0;
+            for (const auto& [_, mbps] : usage_) total += mbps;
+            last_total_mbps = total;
+            return total;
+        } catch (...) {
+            return 0.0;
+        }
+    }
+
+    // Traffic per interface in Mbps (rx + tx), in kernel link order. Valid until the next call.
+    const UsageList& get_all_usage() {
+        try {
+            compute_all_usage();
+        } catch (...) {
+            usage_.clear();
+            rates_.clear();
+        }
+        return usage_;
+    }
+
+    // Samples like get_all_usage() but returns each direction, packets, errors and drops separately.
+    const std::vector<IfRates>& get_all_rates() {
+        get_all_usage();
+        return rates_;
+    }
+
+    // Per-interface rates of the last get_usage()/get_all_usage() call.
+    const std::vector<IfRates>& last_rates() const { return rates_; }
+
+    double get_total_mbps() const { return last_total_mbps; }
+    double get_rx_mbps() const { return last_rx_mbps; }
+    double get_tx_mbps() const { return last_tx_mbps; }
+
+    // "netlink" or "procfs": the source the last sample came from.
+    const char* backend_name() const { return netlink_ ? "netlink" : "procfs"; }
+
+    // Interfaces whose name starts with any of these are not reported (loopback, bridges, veth, VPNs by default).
+    // An empty list reports every interface. Takes effect from the next sample.
+    static const std::vector<std::string>& default_skip_prefixes() {
+        static const std::vector<std::string> prefixes = {
+            "lo", "docker", "veth", "br-", "virbr", "vmnet", "tun", "tap", "zt", "tailscale"
+        };
+        return prefixes;
+    }
+
+    void set_skip_prefixes(std::vector<std::string> prefixes) {
+        skip_prefixes_ = std::move(prefixes);
+        for (auto& s : slots_) s.skip = is_skipped(s.name);
+    }
+
+    const std::vector<std::string>& skip_prefixes() const { return skip_prefixes_; }
+
+private:
+    // Interfaces persist across ticks so names are only allocated on hotplug, and the skip verdict
+    // is taken once per interface instead of once per line.
+    struct IfSlot {
+        std::string name;
+        bool has_prev = false;
+        bool seen = false;
+        bool skip = false;
+    };
+
+    // Counters of slot i at [i * kFields, (i + 1) * kFields), in NetDevCounters field order, so one
+    // kernel pass turns every interface's counters into rates.
+    enum Field : size_t { kRxBytes = 0, kRxPackets, kRxErrs, kRxDrop, kTxBytes, kTxPackets, kTxErrs, kTxDrop, kFields };
+
+    std::chrono::steady_clock::time_point last_time;
+    std::vector<IfSlot> slots_;
+    std::vector<lxrate::Counter> cur_;
+    std::vector<lxrate::Counter> prev_;
+    std::vector<double> per_s_;
+    size_t next_slot_ = 0;  // where the next interface most likely sits (the kernel keeps link order)
+    UsageList usage_;
+    std::vector<IfRates> rates_;
+    double last_total_mbps = 0.0;
+    double last_rx_mbps = 0.0;
+    double last_tx_mbps = 0.0;
+    PinnedFile dev_file;
+    std::unique_ptr<NetlinkLinkDump> netlink_;
+    std::vector<std::string> skip_prefixes_;
+
+    bool is_skipped(std::string_view iface) const {
+        for (const auto& p : skip_prefixes_) {
+            if (lxscan::starts_with(iface, p)) return true;
+        }
+        return false;
+    }
+
+    // Links arrive in the same order every sample, so the hint hits and a k8s node with thousands
+    // of veth pairs stays linear; the scan only runs after hotplug.
+    size_t slot_for(std::string_view iface) {
+        size_t i = next_slot_;
+        if (i >= slots_.size() || slots_[i].name != iface) {
+            i = 0;
+            while (i < slots_.size() && slots_[i].name != iface) ++i;
+            if (i == slots_.size()) {
+                slots_.push_back(IfSlot{std::string(iface), false, false, is_skipped(iface)});
+                cur_.resize(slots_.size() * kFields, 0);
+                prev_.resize(slots_.size() * kFields, 0);
+            }
+        }
+        next_slot_ = i + 1;
+        return i;
+    }
+
+    void store(size_t slot, const lxproc::NetDevCounters& n) {
+        lxrate::Counter* c = &cur_[slot * kFields];
+        c[kRxBytes] = n.rx_bytes;
+        c[kRxPackets] = n.rx_packets;
+        c[kRxErrs] = n.rx_errs;
+        c[kRxDrop] = n.rx_drop;
+        c[kTxBytes] = n.tx_bytes;
+        c[kTxPackets] = n.tx_packets;
+        c[kTxErrs] = n.tx_errs;
+        c[kTxDrop] = n.tx_drop;
+    }
+
+    // Fills cur for every interface; returns false when no reported interface was read.
+    bool read_counters() {
+        for (auto& s : slots_) s.seen = false;
+        next_slot_ = 0;
+        bool any = false;
+        auto record = [&](std::string_view iface, const lxproc::NetDevCounters& n) {
+            const size_t i = slot_for(iface);
+            store(i, n);
+            slots_[i].seen = true;
+            any |= !slots_[i].skip;
+        };
+
+        if (netlink_) {
+            if (netlink_->for_each_link(record)) return any;
+            netlink_.reset();  // seccomp, or a kernel without rtnetlink stats; /proc/net/dev has the same counters
+            for (auto& s : slots_) s.seen = false;
+            any = false;
+        }
+
+        std::string_view text;
+        if (!dev_file.read(text)) return false;
+        next_slot_ = 0;
+        lxproc::for_each_net_dev(text, record);
+        return any;
+    }
+
+    // cur becomes prev; interfaces that disappeared are dropped (their counter rows with them).
+    void commit_counters() {
+        size_t kept = 0;
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (!slots_[i].seen) continue;
+            if (kept != i) {
+                slots_[kept] = std::move(slots_[i]);
+                std::copy_n(&cur_[i * kFields], kFields, &cur_[kept * kFields]);
+            }
+            slots_[kept].has_prev = true;
+            ++kept;
+        }
+        slots_.resize(kept);
+        cur_.resize(kept * kFields);
+        prev_.assign(cur_.begin(), cur_.end());
+    }
+
+    void compute_all_usage() {
+        usage_.clear();
+        rates_.clear();
+        auto now = std::chrono::steady_clock::now();
+        double elapsed_s = std::chrono::duration<double>(now - last_time).count();
+        if (elapsed_s <= 0.0001) return;
+
+        if (!read_counters()) return;
+
+        // Interfaces that appeared this tick have a zero prev row; they are skipped below.
+        per_s_.resize(cur_.size());
+        lxrate::scaled_deltas(cur_.data(), prev_.data(), cur_.size(), 1.0 / elapsed_s, per_s_.data());
+
+        constexpr double kMbps = 8.0 / 1'000'000.0;
+        double total_rx_bps = 0.0;
+        double total_tx_bps = 0.0;
+
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            const IfSlot& s = slots_[i];
+            if (!s.seen || !s.has_prev || s.skip) continue;
+
+            const double* v = &per_s_[i * kFields];
+            IfRates r;
+            r.name = s.name;
+            r.rx_mbps = v[kRxBytes] * kMbps;
+            r.tx_mbps = v[kTxBytes] * kMbps;
+            r.rx_pps = v[kRxPackets];
+            r.tx_pps = v[kTxPackets];
+            r.rx_errs = v[kRxErrs];
+            r.tx_errs = v[kTxErrs];
+            r.rx_drops = v[kRxDrop];
+            r.tx_drops = v[kTxDrop];
+
+            total_rx_bps += v[kRxBytes];
+            total_tx_bps += v[kTxBytes];
+            usage_.emplace_back(s.name, r.rx_mbps + r.tx_mbps);
+            rates_.push_back(std::move(r));
+        }
+
+        last_rx_mbps = total_rx_bps * kMbps;
+        last_tx_mbps = total_tx_bps * kMbps;
+        last_total_mbps = last_rx_mbps + last_tx_mbps;
+
+        commit_counters();
+        last_time = now;
+    }
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "pinned_file.h"
+#include "proc_parse.h"
+#include "topology_watch.h"
+
+// Binary per-link counters over a NETLINK_ROUTE socket kept open between ticks, instead of the
+// /proc/net/dev text the kernel formats from the same counters. Each sample is one RTM_GETSTATS dump
+// filtered to IFLA_STATS_LINK_64 (ifindex + rtnl_link_stats64, ~200 bytes a link); names come from an
+// RTM_GETLINK dump that only runs when links were added, removed or renamed. Kernels before 4.7 have
+// no RTM_GETSTATS and get RTM_GETLINK (IFLA_STATS64) every sample.
+// The socket sees the monitor's own network namespace only.
+class NetlinkLinkDump {
+public:
+    NetlinkLinkDump() : topology_("net", std::chrono::seconds(5)) {
+        fd_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+        if (fd_ < 0) return;
+        sockaddr_nl addr{};
+        addr.nl_family = AF_NETLINK;
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+            return;
+        }
+        ++pinned_io_counters().opens;
+        buf_.resize(kBufferSize);
+    }
+
+    NetlinkLinkDump(const NetlinkLinkDump&) = delete;
+    NetlinkLinkDump& operator=(const NetlinkLinkDump&) = delete;
+
+    ~NetlinkLinkDump() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool ok() const { return fd_ >= 0; }
+
+    // Calls fn(std::string_view iface, const lxproc::NetDevCounters&) for every link, like
+    // lxproc::for_each_net_dev. Returns false when the dump failed or was cut short.
+    template <typename Fn>
+    bool for_each_link(Fn&& fn) {
+        if (fd_ < 0) return false;
+        if (topology_.changed()) names_stale_ = true;
+        if (!has_getstats_ || names_stale_) return dump_links(fn);
+
+        bool unknown = false;
+        const int rc = dump(RTM_GETSTATS, [&](nlmsghdr* h) {
+            if (h->nlmsg_type != RTM_NEWSTATS || h->nlmsg_len < NLMSG_LENGTH(sizeof(if_stats_msg))) return;
+            auto* st = static_cast<if_stats_msg*>(NLMSG_DATA(h));
+            const auto it = names_.find(static_cast<int>(st->ifindex));
+            if (it == names_.end()) {
+                unknown = true;  // created since the last name dump; it has no previous sample anyway
+                return;
+            }
+            auto* a = reinterpret_cast<rtattr*>(reinterpret_cast<char*>(st) + NLMSG_ALIGN(sizeof(if_stats_msg)));
+            int len = static_cast<int>(h->nlmsg_len - NLMSG_LENGTH(sizeof(if_stats_msg)));
+            for (; RTA_OK(a, len); a = RTA_NEXT(a, len)) {
+                if (a->rta_type != IFLA_STATS_LINK_64 || RTA_PAYLOAD(a) < sizeof(rtnl_link_stats64)) continue;
+                lxproc::NetDevCounters n;
+                fill(n, load<rtnl_link_stats64>(a));
+                fn(std::string_view(it->second), n);
+            }
+        });
+        if (rc == -EOPNOTSUPP || rc == -EINVAL) {
+            has_getstats_ = false;
+            return dump_links(fn);
+        }
+        if (unknown) names_stale_ = true;
+        return rc == 0;
+    }
+
+private:
+    // The kernel packs at most 32 KiB of dump messages into one datagram; one buffer holds any of them.
+    static constexpr size_t kBufferSize = 64 * 1024;
+
+    int fd_ = -1;
+    uint32_t seq_ = 0;
+    std::vector<char> buf_;
+    TopologyWatch topology_;
+    std::unordered_map<int, std::string> names_;  // ifindex -> name, as of the last RTM_GETLINK dump
+    bool names_stale_ = true;
+    bool has_getstats_ = true;
+
+    // Sends one dump request and hands every reply message of it to on_msg. Returns 0, the kernel's
+    // -errno from NLMSG_ERROR, or -EIO when the socket failed.
+    template <typename OnMsg>
+    int dump(uint16_t type, OnMsg&& on_msg) {
+        struct {
+            nlmsghdr h;
+            union {
+                ifinfomsg link;
+                if_stats_msg stats;
+            } body;
+        } req{};
+        const size_t body_len = type == RTM_GETSTATS ? sizeof(if_stats_msg) : sizeof(ifinfomsg);
+        req.h.nlmsg_len = NLMSG_LENGTH(body_len);
+        req.h.nlmsg_type = type;
+        req.h.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        req.h.nlmsg_seq = ++seq_;
+        if (type == RTM_GETSTATS) {
+            req.body.stats.family = AF_UNSPEC;
+            req.body.stats.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+        } else {
+            req.body.link.ifi_family = AF_UNSPEC;
+        }
+
+        sockaddr_nl kernel{};
+        kernel.nl_family = AF_NETLINK;
+        ssize_t n;
+        do {
+            n = ::sendto(fd_, &req, req.h.nlmsg_len, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel));
+        } while (n < 0 && errno == EINTR);
+        if (n != static_cast<ssize_t>(req.h.nlmsg_len)) return -EIO;
+
+        for (;;) {
+            do {
+                n = ::recv(fd_, buf_.data(), buf_.size(), 0);
+            } while (n < 0 && errno == EINTR);
+            ++pinned_io_counters().reads;
+            if (n <= 0) return -EIO;
+
+            size_t len = static_cast<size_t>(n);
+            for (auto* h = reinterpret_cast<nlmsghdr*>(buf_.data()); NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+                if (h->nlmsg_seq != seq_) continue;  // late reply to an earlier, abandoned dump
+                if (h->nlmsg_type == NLMSG_DONE) return 0;
+                if (h->nlmsg_type == NLMSG_ERROR) {
+                    const auto* err = static_cast<nlmsgerr*>(NLMSG_DATA(h));
+                    return err->error ? err->error : -EIO;
+                }
+                on_msg(h);
+            }
+        }
+    }
+
+    // RTM_GETLINK carries names and counters; the name table is rebuilt from it.
+    template <typename Fn>
+    bool dump_links(Fn& fn) {
+        names_.clear();
+        const int rc = dump(RTM_GETLINK, [&](nlmsghdr* h) {
+            if (h->nlmsg_type != RTM_NEWLINK || h->nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg))) return;
+            auto* ifi = static_cast<ifinfomsg*>(NLMSG_DATA(h));
+            int len = static_cast<int>(h->nlmsg_len - NLMSG_LENGTH(sizeof(ifinfomsg)));
+
+            std::string_view name;
+            const rtattr* stats64 = nullptr;
+            const rtattr* stats32 = nullptr;
+            for (auto* a = IFLA_RTA(ifi); RTA_OK(a, len); a = RTA_NEXT(a, len)) {
+                switch (a->rta_type) {
+                    case IFLA_IFNAME: {
+                        const char* s = static_cast<const char*>(RTA_DATA(a));
+                        name = std::string_view(s, ::strnlen(s, RTA_PAYLOAD(a)));
+                        break;
+                    }
+                    case IFLA_STATS64: stats64 = a; break;
+                    case IFLA_STATS: stats32 = a; break;
+                    default: break;
+                }
+            }
+            if (name.empty()) return;
+            names_.emplace(ifi->ifi_index, std::string(name));
+
+            lxproc::NetDevCounters n;
+            if (stats64 && RTA_PAYLOAD(stats64) >= sizeof(rtnl_link_stats64)) {
+                fill(n, load<rtnl_link_stats64>(stats64));
+            } else if (stats32 && RTA_PAYLOAD(stats32) >= sizeof(rtnl_link_stats)) {
+                fill(n, load<rtnl_link_stats>(stats32));
+            } else {
+                return;
+            }
+            fn(name, n);
+        });
+        names_stale_ = rc != 0;
+        return rc == 0;
+    }
+
+    // Attribute payloads are only 4-byte aligned.
+    template <typename Stats>
+    static Stats load(const rtattr* a) {
+        Stats s;
+        std::memcpy(&s, RTA_DATA(a), sizeof(s));
+        return s;
+    }
+
+    // Same fields /proc/net/dev prints: its drop column adds rx_missed_errors into rx_dropped.
+    template <typename Stats>
+    static void fill(lxproc::NetDevCounters& n, const Stats& s) {
+        n.rx_bytes = s.rx_bytes;
+        n.rx_packets = s.rx_packets;
+        n.rx_errs = s.rx_errors;
+        n.rx_drop = s.rx_dropped + s.rx_missed_errors;
+        n.tx_bytes = s.tx_bytes;
+        n.tx_packets = s.tx_packets;
+        n.tx_errs = s.tx_errors;
+        n.tx_drop = s.tx_dropped;
+    }
+};
@@ -0,0 +1,1242 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "recorder.h"
+#include "shm_segment.h"
+
+// Remote mode: a collector streams its sampler ticks to one viewer over TCP, which merges any number
+// of nodes. The stream carries the shared-memory entries of SnapshotShmCodec (same keys and values),
+// delta-encoded against the previous tick, one message per tick.
+//
+// Message: varint length, then u8 type and the payload (integers are LEB128 varints, signed ones
+// zigzag, strings a varint length and the bytes):
+//   hello    (1)  version, node name, token; first message of every connection
+//   keyframe (2)  generation, zigzag timestamp_ms, tick_us, sampled, change count, changes
+//   delta    (3)  generation - previous, zigzag timestamp_ms - previous, tick_us, sampled, change count, changes
+// A change is varint (id << 2 | op) followed by:
+//   0 values  count of changed values, then per value: index - next index, zigzag delta
+//   1 define  key, text, value count, the values
+//   2 replace text, value count, the values (text or count changed)
+//   3 drop    the key was not in this tick; its id is free again
+// Values are fixed point (1/1000 of the unit, NaN as INT64_MIN) and deltas wrap in 64 bits, so the
+// viewer rebuilds the values bit for bit. An unchanged tick is about 8 bytes. Every connection starts
+// with a keyframe; the viewer drops a connection on any malformed message and the collector reconnects.
+
+inline constexpr uint32_t kNodeStreamVersion = 1;
+inline constexpr int kNodeStreamDefaultPort = 9470;
+inline constexpr size_t kNodeMaxMessage = 4u << 20;
+inline constexpr uint32_t kNodeMaxEntries = 1u << 16;
+inline constexpr uint32_t kNodeMaxValues = 1u << 16;
+inline constexpr size_t kNodeMaxString = 4096;
+
+enum : uint8_t { kNodeHello = 1, kNodeKeyframe = 2, kNodeDelta = 3 };
+enum : uint32_t { kNodeOpValues = 0, kNodeOpDefine = 1, kNodeOpReplace = 2, kNodeOpDrop = 3 };
+
+// Headline figures the viewer keeps per node (summary and history ring), taken from the entries.
+enum NodeField : int {
+    kNodeCpu,
+    kNodeRam,
+    kNodeDisc,
+    kNodeNet,
+    kNodeNetRx,
+    kNodeNetTx,
+    kNodePsu,
+    kNodeGpu,
+    kNodeGpuTemp,
+    kNodePressure,
+    kNodeFieldCount
+};
+
+struct NodeFieldInfo {
+    const char* name;
+    const char* key;  // SnapshotShmCodec entry
+    size_t index;
+};
+
+inline constexpr NodeFieldInfo kNodeFields[kNodeFieldCount] = {
+    {"cpu", "cpu", 0},     {"ram", "ram", 0},       {"disc", "disc", 0},       {"net", "net", 0},
+    {"net_rx", "net", 1},  {"net_tx", "net", 2},    {"psu", "psu", 0},         {"gpu", "gpu_others", 0},
+    {"gpu_temp", "gpu_temp", 0}, {"pressure", "pressure", 0},
+};
+
+inline int node_field_from_name(std::string_view name) {
+    for (int f = 0; f < kNodeFieldCount; ++f) {
+        if (name == kNodeFields[f].name) return f;
+    }
+    return -1;
+}
+
+namespace lxnode {
+
+inline constexpr double kScale = 1000.0;
+inline constexpr int64_t kNaN = std::numeric_limits<int64_t>::min();
+inline constexpr double kLimit = 4e18;
+
+inline int64_t quantize(double v) {
+    if (std::isnan(v)) return kNaN;
+    const double s = v * kScale;
+    if (s >= kLimit) return static_cast<int64_t>(kLimit);
+    if (s <= -kLimit) return -static_cast<int64_t>(kLimit);
+    return std::llround(s);
+}
+
+inline double dequantize(int64_t q) {
+    return q == kNaN ? std::numeric_limits<double>::quiet_NaN() : static_cast<double>(q) / kScale;
+}
+
+inline int64_t wrap_sub(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+inline int64_t wrap_add(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+
+inline void put_string(std::vector<uint8_t>& out, std::string_view s) {
+    lxrec::put_varint(out, s.size());
+    lxrec::put_bytes(out, s.data(), s.size());
+}
+
+inline bool get_string(lxrec::Reader& r, std::string& out) {
+    const uint64_t n = r.varint();
+    if (n > kNodeMaxString) return false;
+    const uint8_t* p = r.bytes(static_cast<size_t>(n));
+    if (!p) return false;
+    out.assign(reinterpret_cast<const char*>(p), static_cast<size_t>(n));
+    return true;
+}
+
+// Frames one message: varint length, type, head, body.
+inline void frame_message(std::vector<uint8_t>& out, uint8_t type, const std::vector<uint8_t>& head, const std::vector<uint8_t>& body) {
+    lxrec::put_varint(out, 1 + head.size() + body.size());
+    out.push_back(type);
+    out.insert(out.end(), head.begin(), head.end());
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+inline int64_t to_ms(double timestamp_s) { return std::llround(timestamp_s * 1000.0); }
+
+inline size_t varint_size(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+// "host:port" of a peer or target ("[v6]:port" for IPv6).
+inline std::string endpoint_text(const sockaddr* addr, socklen_t len) {
+    char host[NI_MAXHOST] = {};
+    char serv[NI_MAXSERV] = {};
+    if (::getnameinfo(addr, len, host, sizeof(host), serv, sizeof(serv), NI_NUMERICHOST | NI_NUMERICSERV) != 0) return "?";
+    const bool v6 = addr->sa_family == AF_INET6;
+    return (v6 ? "[" : "") + std::string(host) + (v6 ? "]:" : ":") + serv;
+}
+
+// Token check whose time depends only on the lengths, not on where the first mismatch is.
+inline bool token_equal(std::string_view a, std::string_view b) {
+    const size_t n = std::max(a.size(), b.size());
+    unsigned diff = a.size() == b.size() ? 0u : 1u;
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned char x = i < a.size() ? static_cast<unsigned char>(a[i]) : 0;
+        const unsigned char y = i < b.size() ? static_cast<unsigned char>(b[i]) : 0;
+        diff |= static_cast<unsigned>(x ^ y);
+    }
+    return diff == 0;
+}
+
+// 127.0.0.0/8, ::1 and v4-mapped 127.x; the wildcard addresses are not loopback.
+inline bool is_loopback(const sockaddr* addr) {
+    if (addr->sa_family == AF_INET) {
+        return (ntohl(reinterpret_cast<const sockaddr_in*>(addr)->sin_addr.s_addr) >> 24) == 127;
+    }
+    if (addr->sa_family == AF_INET6) {
+        const in6_addr& a = reinterpret_cast<const sockaddr_in6*>(addr)->sin6_addr;
+        return IN6_IS_ADDR_LOOPBACK(&a) || (IN6_IS_ADDR_V4MAPPED(&a) && a.s6_addr[12] == 127);
+    }
+    return false;
+}
+
+// Ticks go out at once (no Nagle delay); keepalive notices a peer that vanished without a FIN.
+inline void tune_socket(int fd) {
+    const int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef TCP_KEEPIDLE
+    const int idle = 10, interval = 5, count = 3;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    ::setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+    ::setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+#endif
+}
+
+}  // namespace lxnode
+
+// Collector side: the ShmWriter interface (begin, add, commit), so SnapshotShmCodec::encode fills it
+// like the segment. Keeps the last sent values per key; message() is the framed tick after commit().
+class NodeStreamEncoder {
+public:
+    // The next commit() is a keyframe: every key is defined again from an empty table.
+    void reset() {
+        slots_.clear();
+        ids_.clear();
+        free_.clear();
+        keyframe_ = true;
+    }
+
+    void begin() {
+        body_.clear();
+        changes_ = 0;
+        ++epoch_;
+    }
+
+    bool add(std::string_view key, const double* values, size_t count, std::string_view text = {}) {
+        if (count > kNodeMaxValues || key.size() > kNodeMaxString || text.size() > kNodeMaxString) return false;
+        key_.assign(key);
+        auto it = ids_.find(key_);
+        if (it == ids_.end()) {
+            if (free_.empty() && slots_.size() >= kNodeMaxEntries) return false;
+            uint32_t id;
+            if (!free_.empty()) {
+                id = free_.back();
+                free_.pop_back();
+            } else {
+                id = static_cast<uint32_t>(slots_.size());
+                slots_.emplace_back();
+            }
+            ids_.emplace(key_, id);
+            Slot& s = slots_[id];
+            s.key = key_;
+            s.text.assign(text);
+            s.live = true;
+            s.epoch = epoch_;
+            put_tag(id, kNodeOpDefine);
+            lxnode::put_string(body_, key);
+            lxnode::put_string(body_, text);
+            put_absolute(s, values, count);
+            return true;
+        }
+        Slot& s = slots_[it->second];
+        s.epoch = epoch_;
+        if (s.q.size() != count || s.text != text) {
+            s.text.assign(text);
+            put_tag(it->second, kNodeOpReplace);
+            lxnode::put_string(body_, text);
+            put_absolute(s, values, count);
+            return true;
+        }
+        q_.resize(count);
+        size_t changed = 0;
+        for (size_t i = 0; i < count; ++i) {
+            q_[i] = lxnode::quantize(values[i]);
+            changed += q_[i] != s.q[i];
+        }
+        if (changed == 0) return true;
+        put_tag(it->second, kNodeOpValues);
+        lxrec::put_varint(body_, changed);
+        size_t next = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (q_[i] == s.q[i]) continue;
+            lxrec::put_varint(body_, i - next);
+            lxrec::put_varint(body_, lxrec::zigzag(lxnode::wrap_sub(q_[i], s.q[i])));
+            s.q[i] = q_[i];
+            next = i + 1;
+        }
+        return true;
+    }
+
+    bool add(std::string_view key, double value, std::string_view text = {}) { return add(key, &value, 1, text); }
+
+    void commit(uint64_t generation, double timestamp_s, double tick_ms, uint32_t sampled) {
+        for (uint32_t id = 0; id < slots_.size(); ++id) {
+            Slot& s = slots_[id];
+            if (!s.live || s.epoch == epoch_) continue;
+            put_tag(id, kNodeOpDrop);
+            ids_.erase(s.key);
+            s = Slot{};
+            free_.push_back(id);
+        }
+        const int64_t ts_ms = lxnode::to_ms(timestamp_s);
+        head_.clear();
+        if (keyframe_) {
+            lxrec::put_varint(head_, generation);
+            lxrec::put_varint(head_, lxrec::zigzag(ts_ms));
+        } else {
+            lxrec::put_varint(head_, generation - last_generation_);
+            lxrec::put_varint(head_, lxrec::zigzag(ts_ms - last_ts_ms_));
+        }
+        lxrec::put_varint(head_, static_cast<uint64_t>(std::max(0.0, tick_ms) * 1000.0 + 0.5));
+        lxrec::put_varint(head_, sampled);
+        lxrec::put_varint(head_, changes_);
+        message_.clear();
+        lxnode::frame_message(message_, keyframe_ ? kNodeKeyframe : kNodeDelta, head_, body_);
+        was_keyframe_ = keyframe_;
+        keyframe_ = false;
+        last_generation_ = generation;
+        last_ts_ms_ = ts_ms;
+    }
+
+    // Framed message of the last commit().
+    const std::vector<uint8_t>& message() const { return message_; }
+    bool was_keyframe() const { return was_keyframe_; }
+    size_t entries() const { return ids_.size(); }
+
+    static void hello(std::vector<uint8_t>& out, std::string_view node, std::string_view token) {
+        std::vector<uint8_t> head;
+        lxrec::put_varint(head, kNodeStreamVersion);
+        lxnode::put_string(head, node);
+        lxnode::put_string(head, token);
+        lxnode::frame_message(out, kNodeHello, head, {});
+    }
+
+private:
+    struct Slot {
+        std::string key;
+        std::string text;
+        std::vector<int64_t> q;  // last sent, fixed point
+        uint64_t epoch = 0;      // tick of the last add()
+        bool live = false;
+    };
+
+    std::vector<Slot> slots_;  // by id
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<uint32_t> free_;
+    std::vector<uint8_t> head_;
+    std::vector<uint8_t> body_;
+    std::vector<uint8_t> message_;
+    std::vector<int64_t> q_;
+    std::string key_;
+    uint64_t epoch_ = 0;
+    uint64_t changes_ = 0;
+    uint64_t last_generation_ = 0;
+    int64_t last_ts_ms_ = 0;
+    bool keyframe_ = true;
+    bool was_keyframe_ = false;
+
+    void put_tag(uint32_t id, uint32_t op) {
+        lxrec::put_varint(body_, (static_cast<uint64_t>(id) << 2) | op);
+        ++changes_;
+    }
+
+    void put_absolute(Slot& s, const double* values, size_t count) {
+        lxrec::put_varint(body_, count);
+        s.q.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            s.q[i] = lxnode::quantize(values[i]);
+            lxrec::put_varint(body_, lxrec::zigzag(s.q[i]));
+        }
+    }
+};
+
+// Viewer side: the entry table of one node, rebuilt from its keyframe and deltas.
+class NodeTable {
+public:
+    struct Entry {
+        std::string key;
+        std::string text;
+        std::vector<int64_t> q;
+        bool live = false;
+    };
+
+    uint64_t generation = 0;
+    double timestamp_s = 0.0;
+    double tick_ms = 0.0;
+    uint32_t sampled = 0;
+    uint64_t ticks = 0;
+
+    void clear() {
+        entries_.clear();
+        ids_.clear();
+        synced_ = false;
+        generation = 0;
+        ticks = 0;
+    }
+
+    bool synced() const { return synced_; }
+    size_t entries() const { return ids_.size(); }
+
+    // Applies the payload of a keyframe or delta message (after the type byte). False when it is
+    // malformed or a delta arrives without a keyframe; the table then waits for the next keyframe.
+    bool apply(uint8_t type, const uint8_t* p, size_t n) {
+        lxrec::Reader r(p, n);
+        if (type == kNodeKeyframe) {
+            clear();
+            generation = r.varint();
+            ts_ms_ = lxrec::unzigzag(r.varint());
+        } else if (type == kNodeDelta && synced_) {
+            generation += r.varint();
+            ts_ms_ += lxrec::unzigzag(r.varint());
+        } else {
+            return false;
+        }
+        tick_ms = static_cast<double>(r.varint()) / 1000.0;
+        sampled = static_cast<uint32_t>(r.varint());
+        const uint64_t changes = r.varint();
+        for (uint64_t c = 0; c < changes && r.ok(); ++c) {
+            const uint64_t tag = r.varint();
+            const uint64_t id = tag >> 2;
+            if (id >= kNodeMaxEntries) return fail();
+            if (id >= entries_.size()) entries_.resize(static_cast<size_t>(id) + 1);
+            Entry& e = entries_[static_cast<size_t>(id)];
+            switch (static_cast<uint32_t>(tag & 3)) {
+                case kNodeOpDefine:
+                    if (e.live) ids_.erase(e.key);
+                    if (!lxnode::get_string(r, e.key) || !lxnode::get_string(r, e.text) || !read_absolute(r, e)) return fail();
+                    e.live = true;
+                    ids_[e.key] = static_cast<uint32_t>(id);
+                    break;
+                case kNodeOpReplace:
+                    if (!e.live || !lxnode::get_string(r, e.text) || !read_absolute(r, e)) return fail();
+                    break;
+                case kNodeOpValues: {
+                    if (!e.live) return fail();
+                    const uint64_t count = r.varint();
+                    uint64_t idx = 0;
+                    for (uint64_t k = 0; k < count && r.ok(); ++k) {
+                        idx += r.varint();
+                        if (idx >= e.q.size()) return fail();
+                        e.q[idx] = lxnode::wrap_add(e.q[idx], lxrec::unzigzag(r.varint()));
+                        ++idx;
+                    }
+                    break;
+                }
+                default:  // kNodeOpDrop
+                    if (!e.live) return fail();
+                    ids_.erase(e.key);
+                    e = Entry{};
+                    break;
+            }
+        }
+        if (!r.ok()) return fail();
+        synced_ = true;
+        timestamp_s = static_cast<double>(ts_ms_) / 1000.0;
+        ++ticks;
+        return true;
+    }
+
+    const Entry* find(std::string_view key) const {
+        const auto it = ids_.find(std::string(key));
+        return it == ids_.end() ? nullptr : &entries_[it->second];
+    }
+
+    // Value i of key; NaN when the key or the value is missing.
+    double value(std::string_view key, size_t i = 0) const {
+        const Entry* e = find(key);
+        if (!e || i >= e->q.size()) return std::numeric_limits<double>::quiet_NaN();
+        return lxnode::dequantize(e->q[i]);
+    }
+
+    // The table as a segment copy, for SnapshotShmCodec::decode.
+    void to_frame(ShmFrame& out) const {
+        size_t bytes = 0;
+        for (const Entry& e : entries_) {
+            if (e.live) bytes += sizeof(ShmEntryHeader) + shm_align8(e.key.size() + e.text.size()) + e.q.size() * sizeof(double);
+        }
+        out.writer_pid = 0;
+        out.flags = 0;
+        out.generation = generation;
+        out.timestamp_s = timestamp_s;
+        out.tick_ms = tick_ms;
+        out.sampled = sampled;
+        out.entry_count = 0;
+        out.payload.assign(bytes / 8, 0);
+        out.payload_size = bytes;
+        char* p = reinterpret_cast<char*>(out.payload.data());
+        for (const Entry& e : entries_) {
+            if (!e.live) continue;
+            const ShmEntryHeader eh{static_cast<uint32_t>(e.key.size()), static_cast<uint32_t>(e.text.size()),
+                                    static_cast<uint32_t>(e.q.size()), 0};
+            std::memcpy(p, &eh, sizeof(eh));
+            std::memcpy(p + sizeof(eh), e.key.data(), e.key.size());
+            std::memcpy(p + sizeof(eh) + e.key.size(), e.text.data(), e.text.size());
+            p += sizeof(eh) + shm_align8(e.key.size() + e.text.size());
+            for (int64_t q : e.q) {
+                const double v = lxnode::dequantize(q);
+                std::memcpy(p, &v, sizeof(v));
+                p += sizeof(v);
+            }
+            ++out.entry_count;
+        }
+    }
+
+private:
+    std::vector<Entry> entries_;  // by id
+    std::unordered_map<std::string, uint32_t> ids_;
+    int64_t ts_ms_ = 0;
+    bool synced_ = false;
+
+    bool fail() {
+        clear();
+        return false;
+    }
+
+    static bool read_absolute(lxrec::Reader& r, Entry& e) {
+        const uint64_t count = r.varint();
+        if (count > kNodeMaxValues) return false;
+        e.q.resize(static_cast<size_t>(count));
+        for (auto& q : e.q) q = lxrec::unzigzag(r.varint());
+        return r.ok();
+    }
+};
+
+// Collector side of the connection, driven from the sampler tick (no thread of its own): a
+// non-blocking connect, a hello and a keyframe on every (re)connect, then one delta per tick. A viewer
+// that stops reading for kMaxBacklog bytes is dropped and reconnected with a keyframe, so a slow or
+// gone viewer never blocks the tick. Reconnects back off from 1 s to 30 s.
+class NodeStreamSender {
+public:
+    struct Stats {
+        std::string target;
+        std::string node;
+        std::string last_error;
+        bool active = false;
+        bool connected = false;
+        uint64_t connects = 0;
+        uint64_t failures = 0;   // connects that failed and connections lost
+        uint64_t overflows = 0;  // dropped for a full backlog
+        uint64_t messages = 0;
+        uint64_t keyframes = 0;
+        uint64_t bytes_sent = 0;
+        size_t backlog = 0;
+        size_t last_message = 0;
+        size_t entries = 0;
+    };
+
+    NodeStreamSender() = default;
+    NodeStreamSender(const NodeStreamSender&) = delete;
+    NodeStreamSender& operator=(const NodeStreamSender&) = delete;
+    ~NodeStreamSender() { close(); }
+
+    // host may be a name (the lookup may block; call it outside the tick's lock).
+    static bool resolve(const std::string& host, int port, sockaddr_storage& addr, socklen_t& len, std::string& error) {
+        if (port <= 0 || port > 65535) {
+            error = "port out of range";
+            return false;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICSERV;
+        addrinfo* res = nullptr;
+        const std::string service = std::to_string(port);
+        const int gai = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &res);
+        if (gai != 0) {
+            error = host + ": " + ::gai_strerror(gai);
+            return false;
+        }
+        std::memcpy(&addr, res->ai_addr, res->ai_addrlen);
+        len = static_cast<socklen_t>(res->ai_addrlen);
+        ::freeaddrinfo(res);
+        return true;
+    }
+
+    // Streams to addr from the next ready() on; node "" is the host name.
+    void configure(const sockaddr_storage& addr, socklen_t len, std::string node, std::string token) {
+        close();
+        addr_ = addr;
+        addr_len_ = len;
+        if (node.empty()) {
+            char host[256] = {};
+            node = ::gethostname(host, sizeof(host) - 1) == 0 && host[0] ? host : "node";
+        }
+        stats_ = Stats{};
+        stats_.target = lxnode::endpoint_text(reinterpret_cast<const sockaddr*>(&addr_), addr_len_);
+        stats_.node = std::move(node);
+        stats_.active = true;
+        token_ = std::move(token);
+        retry_delay_ = kMinRetry;
+        next_attempt_ = {};
+    }
+
+    void close() {
+        disconnect();
+        stats_.active = false;
+    }
+
+    bool active() const { return stats_.active; }
+
+    // Drives connecting and flushes what is queued; true when a tick should be encoded and sent now.
+    bool ready(std::chrono::steady_clock::time_point now) {
+        if (!stats_.active) return false;
+        if (state_ == State::Idle) {
+            if (now < next_attempt_) return false;
+            start_connect(now);
+        }
+        if (state_ == State::Connecting) {
+            pollfd pfd{fd_, POLLOUT, 0};
+            if (::poll(&pfd, 1, 0) <= 0) {
+                if (now - connect_started_ > kConnectTimeout) fail("connect timed out", now);
+                return false;
+            }
+            int err = 0;
+            socklen_t elen = sizeof(err);
+            ::getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &elen);
+            if (err != 0) {
+                fail(std::strerror(err), now);
+                return false;
+            }
+            state_ = State::Connected;
+            stats_.connected = true;
+            ++stats_.connects;
+            retry_delay_ = kMinRetry;
+            out_.clear();
+            out_pos_ = 0;
+            NodeStreamEncoder::hello(out_, stats_.node, token_);
+            encoder_.reset();
+        }
+        // The viewer never writes: readable means it closed the connection (or reset it).
+        pollfd pfd{fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, 0) > 0) {
+            char buf[256];
+            const ssize_t got = ::recv(fd_, buf, sizeof(buf), MSG_DONTWAIT);
+            if (got <= 0 && !(got < 0 && (errno == EAGAIN || errno == EINTR))) {
+                fail(got == 0 ? "closed by viewer" : std::strerror(errno), now);
+                return false;
+            }
+        }
+        return flush(now);
+    }
+
+    NodeStreamEncoder& encoder() { return encoder_; }
+
+    // Queues the tick just committed to encoder() and sends what the socket takes.
+    void send_frame(std::chrono::steady_clock::time_point now) {
+        const auto& msg = encoder_.message();
+        out_.insert(out_.end(), msg.begin(), msg.end());
+        ++stats_.messages;
+        if (encoder_.was_keyframe()) ++stats_.keyframes;
+        stats_.last_message = msg.size();
+        stats_.entries = encoder_.entries();
+        if (out_.size() - out_pos_ > kMaxBacklog) {
+            ++stats_.overflows;
+            fail("viewer not reading (backlog full)", now);
+            return;
+        }
+        flush(now);
+    }
+
+    Stats stats() const {
+        Stats s = stats_;
+        s.backlog = out_.size() - out_pos_;
+        return s;
+    }
+
+private:
+    enum class State { Idle, Connecting, Connected };
+
+    static constexpr size_t kMaxBacklog = 256 * 1024;
+    static constexpr std::chrono::seconds kMinRetry{1};
+    static constexpr std::chrono::seconds kMaxRetry{30};
+    static constexpr std::chrono::seconds kConnectTimeout{10};
+
+    sockaddr_storage addr_{};
+    socklen_t addr_len_ = 0;
+    std::string token_;
+    int fd_ = -1;
+    State state_ = State::Idle;
+    std::chrono::steady_clock::time_point connect_started_{};
+    std::chrono::steady_clock::time_point next_attempt_{};
+    std::chrono::seconds retry_delay_ = kMinRetry;
+    std::vector<uint8_t> out_;
+    size_t out_pos_ = 0;
+    NodeStreamEncoder encoder_;
+    Stats stats_;
+
+    void start_connect(std::chrono::steady_clock::time_point now) {
+        fd_ = ::socket(addr_.ss_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (fd_ < 0) {
+            fail(std::string("socket: ") + std::strerror(errno), now);
+            return;
+        }
+        lxnode::tune_socket(fd_);
+        connect_started_ = now;
+        if (::connect(fd_, reinterpret_cast<const sockaddr*>(&addr_), addr_len_) != 0 && errno != EINPROGRESS) {
+            fail(std::strerror(errno), now);
+            return;
+        }
+        state_ = State::Connecting;
+    }
+
+    void disconnect() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        state_ = State::Idle;
+        stats_.connected = false;
+        out_.clear();
+        out_pos_ = 0;
+    }
+
+    void fail(const std::string& reason, std::chrono::steady_clock::time_point now) {
+        disconnect();
+        ++stats_.failures;
+        stats_.last_error = reason;
+        next_attempt_ = now + retry_delay_;
+        retry_delay_ = std::min(kMaxRetry, retry_delay_ * 2);
+    }
+
+    // Sends as much of the queue as the socket takes; false once the connection is gone.
+    bool flush(std::chrono::steady_clock::time_point now) {
+        while (out_pos_ < out_.size()) {
+            const ssize_t sent = ::send(fd_, out_.data() + out_pos_, out_.size() - out_pos_, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                fail(std::strerror(errno), now);
+                return false;
+            }
+            out_pos_ += static_cast<size_t>(sent);
+            stats_.bytes_sent += static_cast<uint64_t>(sent);
+        }
+        if (out_pos_ == out_.size()) {
+            out_.clear();
+            out_pos_ = 0;
+        } else if (out_pos_ >= 64 * 1024) {
+            out_.erase(out_.begin(), out_.begin() + static_cast<std::ptrdiff_t>(out_pos_));
+            out_pos_ = 0;
+        }
+        return true;
+    }
+};
+
+// Viewer side: one thread, one epoll set (listening socket, wake eventfd, every peer), so the cost is
+// the bytes that arrive rather than the number of nodes. Each node keeps its entry table, a summary of
+// the headline fields and a ring of kNodeHistory past summaries; poll() hands out only the nodes that
+// changed since the previous call. Nodes that went silent are reported stale; disconnected ones stay
+// (offline) for kForgetAfter and are then dropped.
+class NodeStreamReceiver {
+public:
+    static constexpr size_t kNodeHistory = 600;
+
+    struct NodeInfo {
+        std::string name;
+        std::string address;
+        bool online = false;
+        bool stale = false;
+        double age_s = 0.0;  // since the last tick arrived
+        uint64_t generation = 0;
+        double timestamp_s = 0.0;
+        double tick_ms = 0.0;
+        double interval_s = 0.0;  // between ticks, smoothed
+        uint32_t sampled = 0;
+        size_t entries = 0;
+        uint64_t connects = 0;
+        uint64_t bytes = 0;
+        double rx_bytes_per_s = 0.0;
+        double values[kNodeFieldCount] = {};
+    };
+
+    struct Stats {
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;   // bad hello (version, token, name), a live node's name or too many peers
+        uint64_t malformed = 0;  // connections dropped on a bad message
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+        uint64_t wakeups = 0;  // epoll_wait returns with events
+        size_t peers = 0;
+        size_t nodes = 0;
+        size_t online = 0;
+    };
+
+    NodeStreamReceiver() = default;
+    NodeStreamReceiver(const NodeStreamReceiver&) = delete;
+    NodeStreamReceiver& operator=(const NodeStreamReceiver&) = delete;
+    ~NodeStreamReceiver() { stop(); }
+
+    // Binds address:port (numeric; port 0 picks one) and starts the event loop; restarts when running.
+    // Peers must send token in their hello when it is not empty. Any address other than loopback needs a
+    // token: without one every host that can reach the port could publish nodes.
+    bool start(const std::string& address, int port, const std::string& token, std::string& error) {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        stop_locked();
+        if (port < 0 || port > 65535) {
+            error = "port out of range";
+            return false;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV | AI_PASSIVE;
+        addrinfo* res = nullptr;
+        const std::string service = std::to_string(port);
+        const int gai = ::getaddrinfo(address.empty() ? nullptr : address.c_str(), service.c_str(), &hints, &res);
+        if (gai != 0) {
+            error = address + ": " + ::gai_strerror(gai);
+            return false;
+        }
+        if (token.empty() && !lxnode::is_loopback(res->ai_addr)) {
+            error = "refusing to accept collectors on non-loopback address " + (address.empty() ? "*" : address) +
+                    " without a token";
+            ::freeaddrinfo(res);
+            return false;
+        }
+        const int fd = ::socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            error = std::string("socket: ") + std::strerror(errno);
+            ::freeaddrinfo(res);
+            return false;
+        }
+        const int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, res->ai_addr, res->ai_addrlen) != 0 || ::listen(fd, 128) != 0) {
+            error = address + ":" + service + ": " + std::strerror(errno);
+            ::close(fd);
+            ::freeaddrinfo(res);
+            return false;
+        }
+        ::freeaddrinfo(res);
+
+        sockaddr_storage bound{};
+        socklen_t len = sizeof(bound);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &len);
+        port_ = ntohs(bound.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                                                  : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+        address_ = address;
+        token_ = token;
+        listen_fd_ = fd;
+        wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (wake_fd_ < 0 || epoll_fd_ < 0 || !watch(listen_fd_, kListenTag) || !watch(wake_fd_, kWakeTag)) {
+            error = std::string("epoll: ") + std::strerror(errno);
+            stop_locked();
+            return false;
+        }
+        stop_.store(false, std::memory_order_relaxed);
+        worker_ = std::thread([this] { serve(); });
+        return true;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        stop_locked();
+    }
+
+    bool running() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        return worker_.joinable();
+    }
+
+    int port() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        return worker_.joinable() ? port_ : 0;
+    }
+
+    std::string address() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        return address_;
+    }
+
+    // Nodes that changed (a tick, connect, disconnect, going stale) since the previous call, or all of
+    // them with full; removed gets the nodes dropped since then.
+    void poll(std::vector<NodeInfo>& changed, std::vector<std::string>& removed, bool full) {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lk(mu_);
+        changed.clear();
+        for (auto& [name, node] : nodes_) {
+            if (!full && !node->dirty) continue;
+            node->dirty = false;
+            changed.push_back(info(*node, now));
+        }
+        removed.swap(removed_);
+        removed_.clear();
+    }
+
+    std::vector<NodeInfo> nodes() {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lk(mu_);
+        std::vector<NodeInfo> out;
+        out.reserve(nodes_.size());
+        for (auto& [name, node] : nodes_) out.push_back(info(*node, now));
+        return out;
+    }
+
+    // The node's latest tick as a segment copy (decode with SnapshotShmCodec); false when unknown.
+    bool snapshot(const std::string& name, ShmFrame& out) {
+        std::lock_guard<std::mutex> lk(mu_);
+        const auto it = nodes_.find(name);
+        if (it == nodes_.end() || !it->second->table.synced()) return false;
+        it->second->table.to_frame(out);
+        return true;
+    }
+
+    // Newest points of field (oldest first) with their timestamps; empty when the node is unknown.
+    void history(const std::string& name, int field, size_t points, std::vector<double>& times, std::vector<float>& values) {
+        times.clear();
+        values.clear();
+        if (field < 0 || field >= kNodeFieldCount) return;
+        std::lock_guard<std::mutex> lk(mu_);
+        const auto it = nodes_.find(name);
+        if (it == nodes_.end()) return;
+        const Node& node = *it->second;
+        const size_t n = std::min(points, node.hist_len);
+        for (size_t i = 0; i < n; ++i) {
+            const size_t slot = (node.hist_head + kNodeHistory - n + i) % kNodeHistory;
+            times.push_back(node.hist_time[slot]);
+            values.push_back(node.hist_values[slot * kNodeFieldCount + static_cast<size_t>(field)]);
+        }
+    }
+
+    // Drops an offline node now; false when it is unknown or still connected.
+    bool forget(const std::string& name) {
+        std::lock_guard<std::mutex> lk(mu_);
+        const auto it = nodes_.find(name);
+        if (it == nodes_.end() || it->second->fd >= 0) return false;
+        nodes_.erase(it);
+        removed_.push_back(name);
+        return true;
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lk(mu_);
+        Stats s = stats_;
+        s.peers = peer_count_;
+        s.nodes = nodes_.size();
+        for (const auto& [name, node] : nodes_) s.online += node->fd >= 0;
+        return s;
+    }
+
+private:
+    static constexpr uint64_t kListenTag = ~uint64_t(0);
+    static constexpr uint64_t kWakeTag = ~uint64_t(1);
+    static constexpr size_t kMaxPeers = 4096;
+    static constexpr size_t kMaxReadPerWake = 1u << 20;  // per peer, so one busy node cannot starve the rest
+    static constexpr double kHelloTimeoutS = 5.0;
+    static constexpr double kStaleMinS = 5.0;
+    static constexpr double kForgetAfterS = 600.0;
+    static constexpr double kRateWindowS = 5.0;
+
+    struct Node {
+        std::string name;
+        std::string address;
+        NodeTable table;
+        int fd = -1;  // peer while connected
+        bool dirty = true;
+        bool stale = false;
+        std::chrono::steady_clock::time_point last_rx{};
+        std::chrono::steady_clock::time_point offline_since{};
+        double interval_s = 0.0;
+        uint64_t connects = 0;
+        uint64_t bytes = 0;
+        uint64_t window_bytes = 0;
+        std::chrono::steady_clock::time_point window_start{};
+        double rx_bytes_per_s = 0.0;
+        double values[kNodeFieldCount] = {};
+        std::vector<double> hist_time = std::vector<double>(kNodeHistory);
+        std::vector<float> hist_values = std::vector<float>(kNodeHistory * kNodeFieldCount);
+        size_t hist_head = 0;
+        size_t hist_len = 0;
+    };
+
+    struct Peer {
+        std::string address;
+        std::vector<uint8_t> in;
+        Node* node = nullptr;
+        std::chrono::steady_clock::time_point accepted{};
+    };
+
+    std::mutex control_mu_;  // start/stop
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;
+    int epoll_fd_ = -1;
+    int port_ = 0;
+    std::string address_;
+    std::string token_;  // fixed while the loop runs
+
+    std::unordered_map<int, Peer> peers_;  // loop thread only
+
+    std::mutex mu_;  // nodes_, removed_, stats_: the loop thread vs the readers
+    std::unordered_map<std::string, std::unique_ptr<Node>> nodes_;
+    std::vector<std::string> removed_;
+    Stats stats_;
+    size_t peer_count_ = 0;
+
+    bool watch(int fd, uint64_t tag) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | (tag == kListenTag || tag == kWakeTag ? 0u : static_cast<uint32_t>(EPOLLRDHUP));
+        ev.data.u64 = tag;
+        return ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    void stop_locked() {
+        if (worker_.joinable()) {
+            stop_.store(true, std::memory_order_relaxed);
+            const uint64_t one = 1;
+            while (::write(wake_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+            }
+            worker_.join();
+        }
+        for (auto& [fd, peer] : peers_) ::close(fd);
+        peers_.clear();
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            nodes_.clear();
+            removed_.clear();
+            stats_ = Stats{};
+            peer_count_ = 0;
+        }
+        if (listen_fd_ >= 0) ::close(listen_fd_);
+        if (wake_fd_ >= 0) ::close(wake_fd_);
+        if (epoll_fd_ >= 0) ::close(epoll_fd_);
+        listen_fd_ = wake_fd_ = epoll_fd_ = -1;
+    }
+
+    static double seconds(std::chrono::steady_clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+    NodeInfo info(const Node& node, std::chrono::steady_clock::time_point now) const {
+        NodeInfo out;
+        out.name = node.name;
+        out.address = node.address;
+        out.online = node.fd >= 0;
+        out.stale = node.stale;
+        out.age_s = node.table.ticks ? seconds(now - node.last_rx) : 0.0;
+        out.generation = node.table.generation;
+        out.timestamp_s = node.table.timestamp_s;
+        out.tick_ms = node.table.tick_ms;
+        out.interval_s = node.interval_s;
+        out.sampled = node.table.sampled;
+        out.entries = node.table.entries();
+        out.connects = node.connects;
+        out.bytes = node.bytes;
+        out.rx_bytes_per_s = node.rx_bytes_per_s;
+        std::copy(std::begin(node.values), std::end(node.values), std::begin(out.values));
+        return out;
+    }
+
+    void serve() {
+        epoll_event events[64];
+        auto next_sweep = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!stop_.load(std::memory_order_relaxed)) {
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_sweep - std::chrono::steady_clock::now()).count();
+            const int n = ::epoll_wait(epoll_fd_, events, 64, static_cast<int>(std::max<int64_t>(0, wait)));
+            if (n < 0 && errno != EINTR) return;
+            if (n > 0) {
+                std::lock_guard<std::mutex> lk(mu_);
+                ++stats_.wakeups;
+            }
+            for (int i = 0; i < n; ++i) {
+                const uint64_t tag = events[i].data.u64;
+                if (tag == kWakeTag) {
+                    uint64_t v;
+                    while (::read(wake_fd_, &v, sizeof(v)) > 0) {
+                    }
+                } else if (tag == kListenTag) {
+                    accept_peers();
+                } else {
+                    const int fd = static_cast<int>(tag);
+                    if (!read_peer(fd)) close_peer(fd);
+                }
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= next_sweep) {
+                sweep(now);
+                next_sweep = now + std::chrono::seconds(1);
+            }
+        }
+    }
+
+    void accept_peers() {
+        for (;;) {
+            sockaddr_storage addr{};
+            socklen_t len = sizeof(addr);
+            const int fd = ::accept4(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                return;
+            }
+            std::lock_guard<std::mutex> lk(mu_);
+            if (peers_.size() >= kMaxPeers || !watch(fd, static_cast<uint64_t>(fd))) {
+                ++stats_.rejected;
+                ::close(fd);
+                continue;
+            }
+            lxnode::tune_socket(fd);
+            Peer& peer = peers_[fd];
+            peer.address = lxnode::endpoint_text(reinterpret_cast<const sockaddr*>(&addr), len);
+            peer.accepted = std::chrono::steady_clock::now();
+            ++stats_.accepted;
+            peer_count_ = peers_.size();
+        }
+    }
+
+    void close_peer(int fd) {
+        const auto it = peers_.find(fd);
+        if (it == peers_.end()) return;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        std::lock_guard<std::mutex> lk(mu_);
+        if (Node* node = it->second.node) {
+            node->fd = -1;
+            node->offline_since = std::chrono::steady_clock::now();
+            node->dirty = true;
+        }
+        peers_.erase(it);
+        peer_count_ = peers_.size();
+    }
+
+    // Reads what arrived and applies every complete message; false when the peer has to go.
+    bool read_peer(int fd) {
+        const auto it = peers_.find(fd);
+        if (it == peers_.end()) return true;
+        Peer& peer = it->second;
+        bool open = true;
+        size_t read = 0;
+        while (read < kMaxReadPerWake) {
+            const size_t have = peer.in.size();
+            peer.in.resize(have + 65536);
+            const ssize_t got = ::recv(fd, peer.in.data() + have, 65536, 0);
+            peer.in.resize(have + static_cast<size_t>(std::max<ssize_t>(0, got)));
+            if (got > 0) {
+                read += static_cast<size_t>(got);
+                continue;
+            }
+            if (got < 0 && errno == EINTR) continue;
+            open = got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lk(mu_);
+        stats_.bytes += read;
+        size_t pos = 0;
+        bool ok = true;
+        while (ok) {
+            lxrec::Reader r(peer.in.data() + pos, peer.in.size() - pos);
+            const uint64_t len = r.varint();
+            if (!r.ok()) {
+                ok = peer.in.size() - pos < 10;  // an unfinished length, or garbage
+                break;
+            }
+            const size_t head = lxnode::varint_size(len);
+            if (len == 0 || len > kNodeMaxMessage) {
+                ok = false;
+                break;
+            }
+            if (peer.in.size() - pos - head < len) break;
+            ok = handle(peer, fd, peer.in.data() + pos + head, static_cast<size_t>(len), now);
+            pos += head + static_cast<size_t>(len);
+        }
+        peer.in.erase(peer.in.begin(), peer.in.begin() + static_cast<std::ptrdiff_t>(pos));
+        if (!ok && peer.node == nullptr) ++stats_.rejected;
+        else if (!ok) ++stats_.malformed;
+        if (peer.in.capacity() > 4 * 65536 && peer.in.size() < 65536) peer.in.shrink_to_fit();
+        return ok && open;
+    }
+
+    // One message under mu_.
+    bool handle(Peer& peer, int fd, const uint8_t* p, size_t n, std::chrono::steady_clock::time_point now) {
+        const uint8_t type = p[0];
+        ++stats_.messages;
+        if (peer.node == nullptr) {
+            if (type != kNodeHello) return false;
+            lxrec::Reader r(p + 1, n - 1);
+            std::string name;
+            std::string token;
+            if (r.varint() != kNodeStreamVersion || !lxnode::get_string(r, name) || !lxnode::get_string(r, token)) return false;
+            if (name.empty() || name.size() > 128 || !lxnode::token_equal(token, token_)) return false;
+            std::unique_ptr<Node>& slot = nodes_[name];
+            if (!slot) {
+                slot = std::make_unique<Node>();
+                slot->name = name;
+            }
+            Node* node = slot.get();
+            if (node->fd >= 0 && node->fd != fd) {
+                // Same node name from a new connection. A restarted collector's old connection is closed by
+                // its kernel or goes stale; while the old one still delivers ticks the newcomer is refused,
+                // so a second host cannot take over a live node. The refused collector retries with backoff.
+                if (!node->stale) return false;
+                const int old = node->fd;
+                const auto pit = peers_.find(old);
+                if (pit != peers_.end()) {
+                    pit->second.node = nullptr;
+                    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, old, nullptr);
+                    ::close(old);
+                    peers_.erase(pit);
+                    peer_count_ = peers_.size();
+                }
+            }
+            node->fd = fd;
+            node->address = peer.address;
+            node->table.clear();
+            node->stale = false;
+            node->dirty = true;
+            node->last_rx = now;
+            node->window_start = now;
+            node->window_bytes = 0;
+            ++node->connects;
+            peer.node = node;
+            return true;
+        }
+        Node& node = *peer.node;
+        if (!node.table.apply(type, p + 1, n - 1)) return false;
+        if (node.table.ticks > 1) {
+            const double gap = seconds(now - node.last_rx);
+            node.interval_s = node.interval_s > 0.0 ? node.interval_s * 0.8 + gap * 0.2 : gap;
+        }
+        node.last_rx = now;
+        node.bytes += n;
+        node.window_bytes += n;
+        node.stale = false;
+        node.dirty = true;
+        for (int f = 0; f < kNodeFieldCount; ++f) node.values[f] = node.table.value(kNodeFields[f].key, kNodeFields[f].index);
+        node.hist_time[node.hist_head] = node.table.timestamp_s;
+        for (int f = 0; f < kNodeFieldCount; ++f) {
+            node.hist_values[node.hist_head * kNodeFieldCount + static_cast<size_t>(f)] = static_cast<float>(node.values[f]);
+        }
+        node.hist_head = (node.hist_head + 1) % kNodeHistory;
+        node.hist_len = std::min(node.hist_len + 1, kNodeHistory);
+        return true;
+    }
+
+    // Once a second: hello timeouts, stale and forgotten nodes, receive rates.
+    void sweep(std::chrono::steady_clock::time_point now) {
+        std::vector<int> expired;
+        for (const auto& [fd, peer] : peers_) {
+            if (!peer.node && seconds(now - peer.accepted) > kHelloTimeoutS) expired.push_back(fd);
+        }
+        for (int fd : expired) close_peer(fd);
+
+        std::lock_guard<std::mutex> lk(mu_);
+        for (auto it = nodes_.begin(); it != nodes_.end();) {
+            Node& node = *it->second;
+            if (node.fd < 0) {
+                if (seconds(now - node.offline_since) > kForgetAfterS) {
+                    removed_.push_back(node.name);
+                    it = nodes_.erase(it);
+                    continue;
+                }
+            } else if (!node.stale && seconds(now - node.last_rx) > std::max(kStaleMinS, 3.0 * node.interval_s)) {
+                node.stale = true;
+                node.dirty = true;
+            }
+            const double window = seconds(now - node.window_start);
+            if (window >= kRateWindowS) {
+                node.rx_bytes_per_s = static_cast<double>(node.window_bytes) / window;
+                node.window_bytes = 0;
+                node.window_start = now;
+            }
+            ++it;
+        }
+    }
+};
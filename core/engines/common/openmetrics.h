@@ -0,0 +1,381 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sampler_snapshot.h"
+
+// OpenMetrics text exposition (also valid Prometheus 0.0.4 text, where "# EOF" is a plain comment) of
+// one SamplerSnapshot. Everything is a gauge in base units: bytes, seconds, watts, percent as 0..100.
+// The output string and the label caches live across renders, so once their capacity is reached a
+// render does not allocate; label sets (disk names, interfaces, power sources, cards, core ids) are
+// escaped once and re-rendered only when the name at that position changes.
+namespace lxom {
+
+// Label value escaping: backslash, double quote and line feed.
+inline void append_escaped(std::string& out, std::string_view v) {
+    for (const char c : v) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '"') out += "\\\"";
+        else if (c == '\n') out += "\\n";
+        else out.push_back(c);
+    }
+}
+
+// Decimal digits of v at the end of buf.
+inline std::string_view uint_text(char (&buf)[24], uint64_t v) {
+    char* p = buf + sizeof(buf);
+    do {
+        *--p = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    return std::string_view(p, static_cast<size_t>(buf + sizeof(buf) - p));
+}
+
+inline void append_uint(std::string& out, uint64_t v) {
+    char buf[24];
+    const std::string_view text = uint_text(buf, v);
+    out.append(text.data(), text.size());
+}
+
+inline constexpr size_t kMaxNumberChars = 32;
+
+// Writes v at p (at most kMaxNumberChars) and returns the end: six decimals at most, trailing zeros
+// trimmed; snprintf only for magnitudes outside [1e-3, 1e12).
+inline char* format_double(char* p, double v) {
+    if (std::isnan(v)) {
+        std::memcpy(p, "NaN", 3);
+        return p + 3;
+    }
+    if (std::isinf(v)) {
+        std::memcpy(p, v > 0 ? "+Inf" : "-Inf", 4);
+        return p + 4;
+    }
+    const double a = std::fabs(v);
+    if (a != 0.0 && (a < 1e-3 || a >= 1e12)) {
+        const int n = std::snprintf(p, kMaxNumberChars, "%.9g", v);
+        return p + (n > 0 ? n : 0);
+    }
+    const uint64_t scaled = static_cast<uint64_t>(std::llround(a * 1e6));
+    if (scaled == 0) {
+        *p = '0';
+        return p + 1;
+    }
+    if (v < 0) *p++ = '-';
+    char buf[24];
+    const std::string_view whole = uint_text(buf, scaled / 1'000'000);
+    std::memcpy(p, whole.data(), whole.size());
+    p += whole.size();
+    uint64_t frac = scaled % 1'000'000;
+    if (!frac) return p;
+    int len = 6;
+    while (frac % 10 == 0) {
+        frac /= 10;
+        --len;
+    }
+    *p = '.';
+    for (int i = len; i > 0; --i) {
+        p[i] = static_cast<char>('0' + frac % 10);
+        frac /= 10;
+    }
+    return p + len + 1;
+}
+
+inline void append_double(std::string& out, double v) {
+    char buf[kMaxNumberChars];
+    out.append(buf, static_cast<size_t>(format_double(buf, v) - buf));
+}
+
+// Label sets of one list, by position. get() compares the values with the ones rendered last time at
+// that index, which holds for every render while devices stay put.
+class LabelCache {
+public:
+    LabelCache(const char* key1, const char* key2 = nullptr, const char* key3 = nullptr) : keys_{key1, key2, key3} {}
+
+    // `k1="v1",k2="v2"...` without braces.
+    const std::string& get(size_t i, std::string_view v1, std::string_view v2 = {}, std::string_view v3 = {}) {
+        if (i >= entries_.size()) entries_.resize(i + 1);
+        Entry& e = entries_[i];
+        if (!e.rendered || e.values[0] != v1 || e.values[1] != v2 || e.values[2] != v3) {
+            const std::string_view values[3] = {v1, v2, v3};
+            e.text.clear();
+            for (int k = 0; k < 3 && keys_[k]; ++k) {
+                e.values[k].assign(values[k]);
+                if (k) e.text.push_back(',');
+                e.text += keys_[k];
+                e.text += "=\"";
+                append_escaped(e.text, values[k]);
+                e.text.push_back('"');
+            }
+            e.rendered = true;
+            ++renders_;
+        }
+        return e.text;
+    }
+
+    size_t renders() const { return renders_; }
+
+private:
+    struct Entry {
+        std::string values[3];
+        std::string text;
+        bool rendered = false;
+    };
+
+    const char* keys_[3];
+    std::vector<Entry> entries_;
+    size_t renders_ = 0;
+};
+
+}  // namespace lxom
+
+class OpenMetricsWriter {
+public:
+    static constexpr const char* kContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    static constexpr const char* kPrometheusContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+    OpenMetricsWriter() { out_.reserve(64 * 1024); }
+
+    // Renders snap; now_s (wall clock) only feeds lxmonitor_snapshot_age_seconds. Valid until the next call.
+    const std::string& render(const SamplerSnapshot& snap, double now_s) {
+        out_.clear();
+        series_ = 0;
+
+        family("lxmonitor_up", "1 once the sampler has published a tick");
+        sample("lxmonitor_up", snap.generation ? 1.0 : 0.0);
+        if (snap.generation) {
+            render_sampler(snap, now_s);
+            if (snap.sampled & kSampleCpu) render_cpu(snap);
+            if (snap.sampled & kSampleRam) {
+                family("lxmonitor_memory_usage_percent", "RAM in use");
+                sample("lxmonitor_memory_usage_percent", snap.ram);
+            }
+            if (snap.sampled & kSampleDisc) render_disks(snap);
+            if (snap.sampled & kSampleNet) render_net(snap);
+            if (snap.sampled & kSamplePsu) render_power(snap.psu_all);
+            if (snap.sampled & (kSampleGpuOthers | kSampleGpuTemp)) render_gpu(snap);
+            if (snap.sampled & kSamplePressure) render_pressure(snap.pressure_all);
+        }
+        out_ += "# EOF\n";
+        return out_;
+    }
+
+    const std::string& text() const { return out_; }
+    size_t series() const { return series_; }
+
+    // Label sets rendered since construction; stays flat while the devices do.
+    size_t label_renders() const {
+        return engines_.renders() + cores_.renders() + disks_.renders() + ifaces_.renders() + sources_.renders() + gpus_.renders();
+    }
+
+private:
+    std::string out_;
+    size_t series_ = 0;
+    lxom::LabelCache engines_{"engine"};
+    lxom::LabelCache cores_{"cpu"};
+    lxom::LabelCache disks_{"disk", "name"};
+    lxom::LabelCache ifaces_{"interface"};
+    lxom::LabelCache sources_{"source"};
+    lxom::LabelCache gpus_{"card", "slot", "driver"};
+
+    static constexpr const char* kCoreModes[kCoreColumns] = {"mode=\"busy\"", "mode=\"user\"", "mode=\"system\"", "mode=\"iowait\"",
+                                                              "mode=\"steal\""};
+    static constexpr double kMiB = 1024.0 * 1024.0;
+    static constexpr double kMbpsToBytes = 1'000'000.0 / 8.0;
+
+    void family(const char* name, const char* help) {
+        out_ += "# TYPE ";
+        out_ += name;
+        out_ += " gauge\n# HELP ";
+        out_ += name;
+        out_.push_back(' ');
+        out_ += help;
+        out_.push_back('\n');
+    }
+
+    // name{labels,extra} value; labels and extra are already rendered (either may be empty). The line is
+    // copied into place in one resize rather than appended piece by piece.
+    void sample(std::string_view name, double value, std::string_view labels = {}, std::string_view extra = {}) {
+        const size_t at = out_.size();
+        out_.resize(at + name.size() + labels.size() + extra.size() + 4 + lxom::kMaxNumberChars);
+        char* const start = &out_[at];
+        char* p = start;
+        std::memcpy(p, name.data(), name.size());
+        p += name.size();
+        if (!labels.empty() || !extra.empty()) {
+            *p++ = '{';
+            std::memcpy(p, labels.data(), labels.size());
+            p += labels.size();
+            if (!labels.empty() && !extra.empty()) *p++ = ',';
+            std::memcpy(p, extra.data(), extra.size());
+            p += extra.size();
+            *p++ = '}';
+        }
+        *p++ = ' ';
+        p = lxom::format_double(p, value);
+        *p++ = '\n';
+        out_.resize(at + static_cast<size_t>(p - start));
+        ++series_;
+    }
+
+    void render_sampler(const SamplerSnapshot& snap, double now_s) {
+        family("lxmonitor_sampler_generation", "Sequence number of the published tick");
+        sample("lxmonitor_sampler_generation", static_cast<double>(snap.generation));
+        family("lxmonitor_sampler_tick_seconds", "Time the engines took for the published tick");
+        sample("lxmonitor_sampler_tick_seconds", snap.tick_ms / 1e3);
+        family("lxmonitor_snapshot_timestamp_seconds", "Wall clock of the published tick");
+        sample("lxmonitor_snapshot_timestamp_seconds", snap.timestamp_s);
+        family("lxmonitor_snapshot_age_seconds", "How old the published tick was when scraped");
+        sample("lxmonitor_snapshot_age_seconds", now_s > snap.timestamp_s ? now_s - snap.timestamp_s : 0.0);
+        family("lxmonitor_engine_fresh", "1 when the engine ran on the published tick, 0 when its values are carried over");
+        for (size_t i = 0; i < kSamplerEngineCount; ++i) {
+            if (!(snap.sampled & kSamplerEngines[i].bit)) continue;
+            sample("lxmonitor_engine_fresh", (snap.fresh & kSamplerEngines[i].bit) ? 1.0 : 0.0,
+                   engines_.get(i, kSamplerEngines[i].name));
+        }
+    }
+
+    void render_cpu(const SamplerSnapshot& snap) {
+        family("lxmonitor_cpu_usage_percent", "CPU busy share over all cores");
+        sample("lxmonitor_cpu_usage_percent", snap.cpu);
+        const CpuCoreTable& cores = snap.cpu_cores;
+        if (!cores.rows) return;
+        family("lxmonitor_cpu_core_usage_percent", "Per-core time share by mode (busy is everything but idle and iowait)");
+        for (size_t row = 0; row < cores.rows; ++row) {
+            if (!cores.online[row]) continue;
+            char id[24];
+            const std::string& labels = cores_.get(row, lxom::uint_text(id, row));
+            for (size_t k = 0; k < kCoreColumns; ++k) {
+                sample("lxmonitor_cpu_core_usage_percent", cores.values[row * kCoreColumns + k], labels, kCoreModes[k]);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void disk_family(const SamplerSnapshot& snap, const char* name, const char* help, Fn&& value) {
+        family(name, help);
+        for (size_t i = 0; i < snap.disc_stats.size(); ++i) {
+            const DiscActivityEngine::DiskRecord& r = snap.disc_stats[i];
+            sample(name, value(r), disks_.get(i, r.disk, r.label));
+        }
+    }
+
+    void render_disks(const SamplerSnapshot& snap) {
+        if (snap.disc_stats.empty()) {
+            family("lxmonitor_disk_usage_percent", "Average busy share of all disks");
+            sample("lxmonitor_disk_usage_percent", snap.disc);
+            return;
+        }
+        using R = DiscActivityEngine::DiskRecord;
+        disk_family(snap, "lxmonitor_disk_busy_percent", "Time the disk had requests in flight (iostat %util)",
+                    [](const R& r) { return r.util_pct; });
+        disk_family(snap, "lxmonitor_disk_read_bytes_per_second", "Read throughput",
+                    [](const R& r) { return r.read_mib_s * kMiB; });
+        disk_family(snap, "lxmonitor_disk_written_bytes_per_second", "Write throughput",
+                    [](const R& r) { return r.write_mib_s * kMiB; });
+        disk_family(snap, "lxmonitor_disk_reads_per_second", "Completed reads", [](const R& r) { return r.read_iops; });
+        disk_family(snap, "lxmonitor_disk_writes_per_second", "Completed writes", [](const R& r) { return r.write_iops; });
+        disk_family(snap, "lxmonitor_disk_read_await_seconds", "Average time per completed read, queueing included",
+                    [](const R& r) { return r.read_await_ms / 1e3; });
+        disk_family(snap, "lxmonitor_disk_write_await_seconds", "Average time per completed write, queueing included",
+                    [](const R& r) { return r.write_await_ms / 1e3; });
+        disk_family(snap, "lxmonitor_disk_queue_depth", "Average requests in flight over the window (iostat aqu-sz)",
+                    [](const R& r) { return r.queue_depth; });
+        disk_family(snap, "lxmonitor_disk_in_flight", "Requests in flight at sample time",
+                    [](const R& r) { return static_cast<double>(r.in_flight); });
+    }
+
+    // One family per counter, rx and tx as direction="receive|transmit".
+    template <typename Fn>
+    void iface_family(const SamplerSnapshot& snap, const char* name, const char* help, Fn&& value) {
+        family(name, help);
+        for (int dir = 0; dir < 2; ++dir) {
+            const std::string_view extra = dir ? "direction=\"transmit\"" : "direction=\"receive\"";
+            for (size_t i = 0; i < snap.net_ifaces.size(); ++i) {
+                const NetActivityEngine::IfRates& r = snap.net_ifaces[i];
+                sample(name, value(r, dir), ifaces_.get(i, r.name), extra);
+            }
+        }
+    }
+
+    void render_net(const SamplerSnapshot& snap) {
+        family("lxmonitor_network_bytes_per_second", "Traffic over all reported interfaces");
+        sample("lxmonitor_network_bytes_per_second", snap.net_rx * kMbpsToBytes, {}, "direction=\"receive\"");
+        sample("lxmonitor_network_bytes_per_second", snap.net_tx * kMbpsToBytes, {}, "direction=\"transmit\"");
+        using R = NetActivityEngine::IfRates;
+        iface_family(snap, "lxmonitor_interface_bytes_per_second", "Traffic per interface",
+                     [](const R& r, int dir) { return (dir ? r.tx_mbps : r.rx_mbps) * kMbpsToBytes; });
+        iface_family(snap, "lxmonitor_interface_packets_per_second", "Packets per interface",
+                     [](const R& r, int dir) { return dir ? r.tx_pps : r.rx_pps; });
+        iface_family(snap, "lxmonitor_interface_errors_per_second", "Packet errors per interface",
+                     [](const R& r, int dir) { return dir ? r.tx_errs : r.rx_errs; });
+        iface_family(snap, "lxmonitor_interface_drops_per_second", "Dropped packets per interface",
+                     [](const R& r, int dir) { return dir ? r.tx_drops : r.rx_drops; });
+    }
+
+    void render_power(const PowerTelemetryEngine::Snapshot& p) {
+        family("lxmonitor_power_watts", "Estimated system power draw");
+        sample("lxmonitor_power_watts", p.total_w);
+        family("lxmonitor_power_class_watts", "Power draw by component class");
+        const std::pair<const char*, double> classes[] = {
+            {"class=\"cpu\"", p.cpu_w},   {"class=\"gpu\"", p.gpu_w},       {"class=\"disk\"", p.disk_w},
+            {"class=\"net\"", p.net_w},   {"class=\"board\"", p.board_w},   {"class=\"memory\"", p.memory_w},
+            {"class=\"other\"", p.other_w},
+        };
+        for (const auto& [labels, w] : classes) sample("lxmonitor_power_class_watts", w, labels);
+        if (!p.sources_w.empty()) {
+            family("lxmonitor_power_source_watts", "Power draw per sensor (RAPL domain, hwmon input, battery)");
+            for (size_t i = 0; i < p.sources_w.size(); ++i) {
+                sample("lxmonitor_power_source_watts", p.sources_w[i].second, sources_.get(i, p.sources_w[i].first));
+            }
+        }
+        if (p.has_battery) {
+            family("lxmonitor_battery_capacity_percent", "Average charge of the batteries");
+            sample("lxmonitor_battery_capacity_percent", p.battery_capacity_avg);
+            family("lxmonitor_battery_watts", "Battery power flow");
+            sample("lxmonitor_battery_watts", p.battery_discharge_w, {}, "direction=\"discharge\"");
+            sample("lxmonitor_battery_watts", p.battery_charge_w, {}, "direction=\"charge\"");
+            family("lxmonitor_ac_online", "1 while on mains power");
+            sample("lxmonitor_ac_online", p.ac_online ? 1.0 : 0.0);
+        }
+    }
+
+    // NaN marks a value the card does not expose; those samples are left out rather than exported as NaN.
+    void render_gpu(const SamplerSnapshot& snap) {
+        if (snap.sampled & kSampleGpuOthers) {
+            family("lxmonitor_gpu_busy_percent", "GPU busy share");
+            for (size_t i = 0; i < snap.gpu_cards.size(); ++i) {
+                const GpuCardReading& c = snap.gpu_cards[i];
+                if (!std::isnan(c.busy_pct)) sample("lxmonitor_gpu_busy_percent", c.busy_pct, gpus_.get(i, c.card, c.slot, c.driver));
+            }
+        }
+        if (snap.sampled & kSampleGpuTemp) {
+            family("lxmonitor_gpu_temperature_celsius", "Hottest temperature sensor of the GPU");
+            for (size_t i = 0; i < snap.gpu_cards.size(); ++i) {
+                const GpuCardReading& c = snap.gpu_cards[i];
+                if (!std::isnan(c.temp_c)) sample("lxmonitor_gpu_temperature_celsius", c.temp_c, gpus_.get(i, c.card, c.slot, c.driver));
+            }
+        }
+    }
+
+    void render_pressure(const PressureEngine::Snapshot& p) {
+        if (!p.has_psi) return;
+        static constexpr const char* kLabels[kPsiResourceCount][2] = {
+            {"resource=\"cpu\",kind=\"some\"", "resource=\"cpu\",kind=\"full\""},
+            {"resource=\"memory\",kind=\"some\"", "resource=\"memory\",kind=\"full\""},
+            {"resource=\"io\",kind=\"some\"", "resource=\"io\",kind=\"full\""},
+        };
+        family("lxmonitor_pressure_stall_percent", "PSI stall share since the previous pressure sample");
+        for (int r = 0; r < kPsiResourceCount; ++r) {
+            const PressureEngine::Resource& res = p.resources[r];
+            if (!res.available) continue;
+            sample("lxmonitor_pressure_stall_percent", res.some_pct, kLabels[r][0]);
+            sample("lxmonitor_pressure_stall_percent", res.full_pct, kLabels[r][1]);
+        }
+    }
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "granted_fds.h"
+
+// Per-thread count of the syscalls PinnedFile issues; engines are timed by diffing it around a call.
+struct PinnedIoCounters {
+    uint64_t opens = 0;
+    uint64_t reads = 0;
+};
+
+inline PinnedIoCounters& pinned_io_counters() {
+    thread_local PinnedIoCounters counters;
+    return counters;
+}
+
+// A /proc or /sys file that stays open between ticks.
+// Each read() re-reads it from offset 0 with pread() into a reusable buffer until pread() returns 0,
+// instead of open+read+close and iostream setup. Record-based seq_files (/proc/net/dev, /proc/diskstats,
+// /proc/vmstat) return about one page per call whatever the buffer size, so a short read is not EOF there.
+class PinnedFile {
+public:
+    // kSingleShow: the kernel renders the whole file in one call, as single_open() procfs files
+    // (/proc/stat, /proc/meminfo, /proc/loadavg, /proc/pressure/*, /proc/<pid>/statm) and sysfs attributes
+    // do. A short read is EOF there, so a steady-state read() costs one pread() instead of two.
+    enum ReadMode { kUntilEof, kSingleShow };
+
+    PinnedFile() = default;
+    explicit PinnedFile(std::string path, ReadMode mode = kUntilEof) : path_(std::move(path)), mode_(mode) {}
+
+    PinnedFile(const PinnedFile&) = delete;
+    PinnedFile& operator=(const PinnedFile&) = delete;
+
+    PinnedFile(PinnedFile&& other) noexcept
+        : path_(std::move(other.path_)), mode_(other.mode_), fd_(other.fd_), buf_(std::move(other.buf_)) {
+        other.fd_ = -1;
+    }
+
+    PinnedFile& operator=(PinnedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            path_ = std::move(other.path_);
+            mode_ = other.mode_;
+            fd_ = other.fd_;
+            buf_ = std::move(other.buf_);
+            other.fd_ = -1;
+        }
+        return *this;
+    }
+
+    ~PinnedFile() { close(); }
+
+    const std::string& path() const { return path_; }
+    bool is_open() const { return fd_ >= 0; }
+
+    // Returns the whole file content. The view stays valid until the next read().
+    // Returns false when the file cannot be opened or read.
+    bool read(std::string_view& out) {
+        out = {};
+        if (fd_ < 0 && !open_fd()) return false;
+
+        ssize_t n = read_all();
+        if (n < 0 && should_reopen(errno)) {
+            // Device went away or the node was recreated (hotplug, driver reload).
+            close();
+            if (!open_fd()) return false;
+            n = read_all();
+        }
+        if (n < 0) return false;
+        out = std::string_view(buf_.data(), static_cast<size_t>(n));
+        return true;
+    }
+
+    // First line without the trailing newline; false when unreadable.
+    bool read_line(std::string_view& out) {
+        if (!read(out)) return false;
+        const auto nl = out.find('\n');
+        if (nl != std::string_view::npos) out = out.substr(0, nl);
+        return true;
+    }
+
+    bool read_u64(unsigned long long& value) {
+        std::string_view text;
+        if (!read(text)) return false;
+        size_t i = 0;
+        while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\n')) i++;
+        const char* first = text.data() + i;
+        const char* last = text.data() + text.size();
+        const auto res = std::from_chars(first, last, value);
+        return res.ec == std::errc() && res.ptr != first;
+    }
+
+    bool read_double(double& value) {
+        std::string_view text;
+        if (!read(text)) return false;
+        // The buffer is kept NUL-terminated.
+        char* end = nullptr;
+        value = std::strtod(text.data(), &end);
+        return end != text.data();
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    std::string path_;
+    ReadMode mode_ = kUntilEof;
+    int fd_ = -1;
+    std::vector<char> buf_ = std::vector<char>(4096);
+
+    static bool should_reopen(int err) {
+        // ENODEV is what sysfs returns for attributes of a removed kobject.
+        return err == ENOENT || err == ESTALE || err == ENODEV;
+    }
+
+    bool open_fd() {
+        if (path_.empty()) return false;
+        ++pinned_io_counters().opens;
+        fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        // Protected attribute: a read-only fd the privileged helper opened for us, if any.
+        if (fd_ < 0 && errno == EACCES) fd_ = granted_fds().dup(path_);
+        return fd_ >= 0;
+    }
+
+    ssize_t read_all() {
+        size_t used = 0;
+        for (;;) {
+            // Keep one spare byte so the content is always NUL-terminated for strtod().
+            if (buf_.size() - used == 1) buf_.resize(buf_.size() * 2);
+            const size_t room = buf_.size() - used - 1;
+            ssize_t n;
+            ++pinned_io_counters().reads;
+            do {
+                n = ::pread(fd_, buf_.data() + used, room, static_cast<off_t>(used));
+            } while (n < 0 && errno == EINTR);
+            if (n < 0) return -1;
+            if (n == 0) break;
+            used += static_cast<size_t>(n);
+            if (mode_ == kSingleShow && static_cast<size_t>(n) < room) break;
+        }
+        buf_[used] = '\0';
+        return static_cast<ssize_t>(used);
+    }
+};
+
+// Path-keyed set of pinned files for engines that read many small sysfs attributes (kSingleShow).
+// Files not read between two sweep() calls are closed, so vanished devices do not leak fds.
+class PinnedFileSet {
+public:
+    bool read(const std::string& path, std::string_view& out) { return file(path).read(out); }
+
+    // First line without the trailing newline (like std::getline); empty when unreadable.
+    std::string read_line(const std::string& path) {
+        std::string_view line;
+        if (!file(path).read_line(line)) return {};
+        return std::string(line);
+    }
+
+    bool read_u64(const std::string& path, unsigned long long& value) { return file(path).read_u64(value); }
+    bool read_double(const std::string& path, double& value) { return file(path).read_double(value); }
+
+    void sweep() {
+        for (auto it = files_.begin(); it != files_.end();) {
+            if (!it->second.used) {
+                it = files_.erase(it);
+            } else {
+                it->second.used = false;
+                ++it;
+            }
+        }
+    }
+
+    size_t size() const { return files_.size(); }
+
+private:
+    struct Entry {
+        PinnedFile file;
+        bool used = false;
+    };
+
+    std::unordered_map<std::string, Entry> files_;
+
+    PinnedFile& file(const std::string& path) {
+        auto it = files_.find(path);
+        if (it == files_.end()) {
+            it = files_.emplace(path, Entry{PinnedFile(path, PinnedFile::kSingleShow), false}).first;
+        }
+        it->second.used = true;
+        return it->second.file;
+    }
+};
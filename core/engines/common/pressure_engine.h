@@ -0,0 +1,237 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "pinned_file.h"
+#include "proc_parse.h"
+#include "psi_trigger.h"
+#include "scan.h"
+#include "source_root.h"
+
+// Saturation rather than utilization: pressure stall information (/proc/pressure/{cpu,memory,io},
+// kernel 4.20+ with CONFIG_PSI) and the reclaim/swap/OOM counters of /proc/vmstat. A box at 95% RAM
+// that does not stall is fine; one at 60% whose memory "some" is 30% is thrashing.
+// All four files stay pinned. /proc/vmstat has ~190 lines in an order fixed for the kernel's lifetime,
+// so the line numbers of the wanted keys are found once and later reads only parse those lines
+// (leaving out the tail after the last one); a key no longer at its line triggers a new lookup.
+class PressureEngine {
+public:
+    struct Resource {
+        bool available = false;
+        lxproc::PsiInfo psi;    // kernel averages (avg10/60/300) and totals
+        double some_pct = 0.0;  // stall share since the previous sample, from the totals
+        double full_pct = 0.0;
+    };
+
+    // Cumulative /proc/vmstat counters. pgscan/pgsteal add up kswapd, direct, khugepaged and proactive
+    // reclaim; allocstall adds up the zones.
+    struct VmCounters {
+        unsigned long long pgmajfault = 0;
+        unsigned long long pswpin = 0;
+        unsigned long long pswpout = 0;
+        unsigned long long pgscan = 0;
+        unsigned long long pgsteal = 0;
+        unsigned long long allocstall = 0;
+        unsigned long long oom_kill = 0;
+    };
+
+    struct Snapshot {
+        Resource resources[kPsiResourceCount];  // indexed by PsiResource
+        bool has_psi = false;
+        bool has_vmstat = false;
+        VmCounters vm;
+        // Per second since the previous sample (pages for swap/scan/steal).
+        double majfault_ps = 0.0;
+        double swapin_ps = 0.0;
+        double swapout_ps = 0.0;
+        double pgscan_ps = 0.0;
+        double pgsteal_ps = 0.0;
+        double allocstall_ps = 0.0;
+        unsigned long long oom_kills = 0;  // since the previous sample
+        double interval_s = 0.0;
+    };
+
+    explicit PressureEngine(const SourceRoot& root = SourceRoot::host()) : vmstat_(root.resolve("/proc/vmstat")) {
+        for (int r = 0; r < kPsiResourceCount; ++r) {
+            psi_[r] = PinnedFile(root.resolve(std::string("/proc/pressure/") + psi_resource_name(r)),
+                                 PinnedFile::kSingleShow);
+        }
+        last_time_ = std::chrono::steady_clock::now();
+        read_all(snap_);
+    }
+
+    PressureEngine(const PressureEngine&) = delete;
+    PressureEngine& operator=(const PressureEngine&) = delete;
+
+    // Reads every source and derives the interval values against the previous call (the first call
+    // diffs against the constructor's read). Valid until the next call.
+    const Snapshot& sample() {
+        const auto now = std::chrono::steady_clock::now();
+        const double dt = std::chrono::duration<double>(now - last_time_).count();
+        if (dt <= 0.001) return snap_;
+        last_time_ = now;
+
+        prev_ = snap_;
+        read_all(snap_);
+        snap_.interval_s = dt;
+        for (int r = 0; r < kPsiResourceCount; ++r) {
+            Resource& cur = snap_.resources[r];
+            const Resource& old = prev_.resources[r];
+            if (!cur.available || !old.available) continue;
+            cur.some_pct = stall_pct(old.psi.some.total_us, cur.psi.some.total_us, dt);
+            cur.full_pct = stall_pct(old.psi.full.total_us, cur.psi.full.total_us, dt);
+        }
+        if (snap_.has_vmstat && prev_.has_vmstat) {
+            const VmCounters& a = prev_.vm;
+            const VmCounters& b = snap_.vm;
+            snap_.majfault_ps = rate(a.pgmajfault, b.pgmajfault, dt);
+            snap_.swapin_ps = rate(a.pswpin, b.pswpin, dt);
+            snap_.swapout_ps = rate(a.pswpout, b.pswpout, dt);
+            snap_.pgscan_ps = rate(a.pgscan, b.pgscan, dt);
+            snap_.pgsteal_ps = rate(a.pgsteal, b.pgsteal, dt);
+            snap_.allocstall_ps = rate(a.allocstall, b.allocstall, dt);
+            snap_.oom_kills = b.oom_kill >= a.oom_kill ? b.oom_kill - a.oom_kill : 0;
+        }
+        return snap_;
+    }
+
+    const Snapshot& last() const { return snap_; }
+
+    // Headline: memory "some" stall % over the last interval (0 without PSI).
+    double get_usage() { return sample().resources[kPsiMemory].some_pct; }
+
+private:
+    enum VmField : uint8_t { kMajfault, kSwapin, kSwapout, kScan, kSteal, kAllocstall, kOomKill };
+
+    struct VmKey {
+        std::string_view name;
+        VmField field;
+    };
+
+    // Exact names, so pgscan_direct_throttle and the per-type pgscan_anon/pgscan_file are not double-counted.
+    static constexpr VmKey kVmKeys[] = {
+        {"pgmajfault", kMajfault},
+        {"pswpin", kSwapin},
+        {"pswpout", kSwapout},
+        {"pgscan_kswapd", kScan},
+        {"pgscan_direct", kScan},
+        {"pgscan_khugepaged", kScan},
+        {"pgscan_proactive", kScan},
+        {"pgsteal_kswapd", kSteal},
+        {"pgsteal_direct", kSteal},
+        {"pgsteal_khugepaged", kSteal},
+        {"pgsteal_proactive", kSteal},
+        {"allocstall_dma", kAllocstall},
+        {"allocstall_dma32", kAllocstall},
+        {"allocstall_normal", kAllocstall},
+        {"allocstall_movable", kAllocstall},
+        {"allocstall_device", kAllocstall},
+        {"oom_kill", kOomKill},
+    };
+
+    struct VmLine {
+        uint32_t line;  // 0-based line number in /proc/vmstat
+        uint8_t key;    // index into kVmKeys
+    };
+
+    PinnedFile psi_[kPsiResourceCount];
+    PinnedFile vmstat_;
+    std::vector<VmLine> vm_layout_;  // ascending line numbers; empty until the first lookup
+    Snapshot snap_;
+    Snapshot prev_;
+    std::chrono::steady_clock::time_point last_time_;
+
+    static double rate(unsigned long long a, unsigned long long b, double dt) {
+        return b >= a ? static_cast<double>(b - a) / dt : 0.0;
+    }
+
+    static double stall_pct(unsigned long long a, unsigned long long b, double dt) {
+        if (b < a) return 0.0;
+        const double pct = static_cast<double>(b - a) / (dt * 1e4);  // us over dt seconds, in percent
+        return pct > 100.0 ? 100.0 : pct;
+    }
+
+    void read_all(Snapshot& s) {
+        s.has_psi = false;
+        for (int r = 0; r < kPsiResourceCount; ++r) {
+            Resource& res = s.resources[r];
+            res = Resource{};
+            std::string_view text;
+            res.available = psi_[r].read(text) && lxproc::parse_psi(text, res.psi);
+            s.has_psi |= res.available;
+        }
+        std::string_view text;
+        s.has_vmstat = vmstat_.read(text) && parse_vmstat(text, s.vm);
+        s.majfault_ps = s.swapin_ps = s.swapout_ps = s.pgscan_ps = s.pgsteal_ps = s.allocstall_ps = 0.0;
+        s.oom_kills = 0;
+    }
+
+    static void add_field(VmCounters& vm, VmField f, unsigned long long v) {
+        switch (f) {
+            case kMajfault: vm.pgmajfault += v; break;
+            case kSwapin: vm.pswpin += v; break;
+            case kSwapout: vm.pswpout += v; break;
+            case kScan: vm.pgscan += v; break;
+            case kSteal: vm.pgsteal += v; break;
+            case kAllocstall: vm.allocstall += v; break;
+            case kOomKill: vm.oom_kill += v; break;
+        }
+    }
+
+    bool parse_vmstat(std::string_view text, VmCounters& vm) {
+        if (!vm_layout_.empty() && parse_known_lines(text, vm)) return true;
+        return lookup_layout(text, vm);
+    }
+
+    // Steady state: only the remembered lines are split (memchr hops over the rest); false when one no
+    // longer holds its key.
+    bool parse_known_lines(std::string_view text, VmCounters& vm) {
+        vm = VmCounters{};
+        const char* p = text.data();
+        const char* const end = p + text.size();
+        uint32_t line_no = 0;
+        for (const VmLine& want : vm_layout_) {
+            for (; line_no < want.line; ++line_no) {
+                const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+                if (!nl) return false;
+                p = static_cast<const char*>(nl) + 1;
+            }
+            const VmKey& key = kVmKeys[want.key];
+            const size_t rest = static_cast<size_t>(end - p);
+            if (rest <= key.name.size() || std::memcmp(p, key.name.data(), key.name.size()) != 0 || p[key.name.size()] != ' ') {
+                return false;
+            }
+            lxscan::Cursor lc(std::string_view(p + key.name.size(), rest - key.name.size()));
+            unsigned long long v = 0;
+            if (!lc.number(v)) return false;
+            add_field(vm, key.field, v);
+        }
+        return true;
+    }
+
+    bool lookup_layout(std::string_view text, VmCounters& vm) {
+        vm = VmCounters{};
+        vm_layout_.clear();
+        lxscan::Cursor c(text);
+        uint32_t line_no = 0;
+        std::string_view line;
+        for (; c.line(line); ++line_no) {
+            lxscan::Cursor lc(line);
+            const std::string_view name = lc.token();
+            for (uint8_t k = 0; k < sizeof(kVmKeys) / sizeof(kVmKeys[0]); ++k) {
+                if (name != kVmKeys[k].name) continue;
+                unsigned long long v = 0;
+                if (lc.number(v)) {
+                    add_field(vm, kVmKeys[k].field, v);
+                    vm_layout_.push_back({line_no, k});
+                }
+                break;
+            }
+        }
+        return !vm_layout_.empty();
+    }
+};
@@ -0,0 +1,448 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Long-lived privileged helper: started once through sudo/pkexec, it runs as root on the other end of
+// a socketpair (its stdin and stdout) and answers one request per line:
+//
+//   helper -> "LXPRIV 1 <pid>"                   once it runs as root
+//   "PING"          -> "OK"
+//   "OPEN <path>"   -> "FD" with a read-only fd (SCM_RIGHTS) | "ERR <reason>"
+//   "GRANT <path>"  -> "OK" | "ERR <reason>"     chmod a+r of one NVIDIA device node
+//   "QUIT" or EOF   -> the helper exits
+//
+// Only paths matching kProtectedPatterns are served, so the socket is no general root shell.
+// NVML opens /dev/nvidia* itself and cannot take an fd, hence GRANT for those nodes alone.
+enum class ProtectedAccess { kOpen, kGrant };
+
+struct ProtectedPattern {
+    const char* glob;
+    ProtectedAccess access;
+};
+
+inline constexpr ProtectedPattern kProtectedPatterns[] = {
+    {"/sys/class/drm/card*/device/gpu_busy_percent", ProtectedAccess::kOpen},
+    {"/sys/class/drm/card*/device/usage", ProtectedAccess::kOpen},
+    {"/sys/class/drm/card*/device/hwmon/hwmon*/temp*_input", ProtectedAccess::kOpen},
+    {"/sys/class/hwmon/hwmon*/device/gpu_busy_percent", ProtectedAccess::kOpen},
+    {"/sys/class/hwmon/hwmon*/temp*_input", ProtectedAccess::kOpen},
+    {"/sys/class/hwmon/hwmon*/power*_input", ProtectedAccess::kOpen},
+    {"/sys/class/hwmon/hwmon*/power*_average", ProtectedAccess::kOpen},
+    {"/sys/class/thermal/thermal_zone*/temp", ProtectedAccess::kOpen},
+    {"/sys/class/thermal/thermal_zone*/type", ProtectedAccess::kOpen},
+    {"/sys/class/powercap/*/energy_uj", ProtectedAccess::kOpen},
+    {"/dev/nvidiactl", ProtectedAccess::kGrant},
+    {"/dev/nvidia[0-9]*", ProtectedAccess::kGrant},
+};
+
+inline constexpr const char* kHelperHello = "LXPRIV 1";
+
+namespace lxpriv {
+
+inline const ProtectedPattern* match_protected(const std::string& path) {
+    if (path.find("/..") != std::string::npos || path.find("/./") != std::string::npos) return nullptr;
+    for (const auto& p : kProtectedPatterns) {
+        if (::fnmatch(p.glob, path.c_str(), FNM_PATHNAME) == 0) return &p;
+    }
+    return nullptr;
+}
+
+inline int ms_left(std::chrono::steady_clock::time_point deadline) {
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    return left > 0 ? static_cast<int>(std::min<long long>(left, INT_MAX)) : 0;
+}
+
+// Writes line + '\n' in one sendmsg, with pass_fd attached when >= 0.
+inline bool send_line(int sock, std::string_view line, int pass_fd = -1) {
+    std::string buf(line);
+    buf.push_back('\n');
+    iovec iov{buf.data(), buf.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    if (pass_fd >= 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* c = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(c), &pass_fd, sizeof(int));
+    }
+    size_t sent = 0;
+    while (sent < buf.size()) {
+        const ssize_t n = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+        iov.iov_base = buf.data() + sent;
+        iov.iov_len = buf.size() - sent;
+        msg.msg_control = nullptr;  // the fd went with the first byte
+        msg.msg_controllen = 0;
+    }
+    return true;
+}
+
+// Line-buffered reads that also collect an fd sent along with the line (SCM_RIGHTS).
+class LineReader {
+public:
+    LineReader() = default;
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+    ~LineReader() { reset(); }
+
+    // Next line without '\n'; timeout_ms < 0 waits forever. false on EOF, error or timeout.
+    bool read(int sock, std::string& line, int timeout_ms) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+        for (;;) {
+            const size_t nl = buf_.find('\n');
+            if (nl != std::string::npos) {
+                line.assign(buf_, 0, nl);
+                buf_.erase(0, nl + 1);
+                return true;
+            }
+            if (buf_.size() > kMaxLine) return false;
+            pollfd pfd{sock, POLLIN, 0};
+            const int n = ::poll(&pfd, 1, timeout_ms < 0 ? -1 : ms_left(deadline));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            char data[1024];
+            iovec iov{data, sizeof(data)};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)];
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            const ssize_t got = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+                if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+                const size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (size_t i = 0; i < count; ++i) {
+                    int fd;
+                    std::memcpy(&fd, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+                    if (fd_ >= 0) ::close(fd_);
+                    fd_ = fd;
+                }
+            }
+            buf_.append(data, static_cast<size_t>(got));
+        }
+    }
+
+    // The fd that came with the last lines, now owned by the caller; -1 when none.
+    int take_fd() {
+        const int fd = fd_;
+        fd_ = -1;
+        return fd;
+    }
+
+    void reset() {
+        buf_.clear();
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    static constexpr size_t kMaxLine = 8192;
+    std::string buf_;
+    int fd_ = -1;
+};
+
+}  // namespace lxpriv
+
+// Helper side, running as root with the socket on fd sock. Returns the process exit code.
+inline int run_privileged_helper(int sock) {
+    if (::geteuid() != 0) return 3;
+    struct stat st{};
+    if (::fstat(sock, &st) != 0 || !S_ISSOCK(st.st_mode)) return 2;
+    if (!lxpriv::send_line(sock, std::string(kHelperHello) + " " + std::to_string(::getpid()))) return 1;
+
+    lxpriv::LineReader reader;
+    std::string line;
+    while (reader.read(sock, line, -1)) {
+        const int stray = reader.take_fd();
+        if (stray >= 0) ::close(stray);
+        if (line == "QUIT") break;
+        if (line == "PING") {
+            if (!lxpriv::send_line(sock, "OK")) break;
+            continue;
+        }
+        const size_t sp = line.find(' ');
+        const std::string verb = line.substr(0, sp);
+        const std::string path = sp == std::string::npos ? std::string() : line.substr(sp + 1);
+        const ProtectedPattern* pattern = lxpriv::match_protected(path);
+        std::string reply;
+        char real[PATH_MAX];
+        if (verb != "OPEN" && verb != "GRANT") {
+            reply = "ERR unknown request";
+        } else if (!pattern || (verb == "OPEN") != (pattern->access == ProtectedAccess::kOpen)) {
+            reply = "ERR path not allowed";
+        } else if (!::realpath(path.c_str(), real)) {
+            reply = std::string("ERR ") + std::strerror(errno);
+        } else if (verb == "OPEN") {
+            // Class symlinks resolve into /sys/devices; anything leaving sysfs is refused.
+            const bool in_sysfs = std::strncmp(real, "/sys/", 5) == 0;
+            const int fd = in_sysfs ? ::open(real, O_RDONLY | O_CLOEXEC | O_NOFOLLOW) : -1;
+            if (fd < 0) {
+                reply = in_sysfs ? std::string("ERR ") + std::strerror(errno) : std::string("ERR path not allowed");
+            } else {
+                const bool ok = lxpriv::send_line(sock, "FD", fd);
+                ::close(fd);
+                if (!ok) break;
+                continue;
+            }
+        } else {
+            struct stat dev{};
+            if (std::strncmp(real, "/dev/nvidia", 11) != 0 || ::stat(real, &dev) != 0 || !S_ISCHR(dev.st_mode)) {
+                reply = "ERR not an NVIDIA device node";
+            } else if (::chmod(real, (dev.st_mode & 07777) | S_IRUSR | S_IRGRP | S_IROTH) != 0) {
+                reply = std::string("ERR ") + std::strerror(errno);
+            } else {
+                reply = "OK";
+            }
+        }
+        if (!lxpriv::send_line(sock, reply)) break;
+    }
+    return 0;
+}
+
+// Client side: owns the helper process and its socket. Requests are serialized.
+class PrivilegedHelperClient {
+public:
+    // Prompt sudo -S writes to stderr before it reads a password line from stdin.
+    static constexpr const char* kSudoPrompt = "[lxmonitor-auth]";
+
+    PrivilegedHelperClient() = default;
+    PrivilegedHelperClient(const PrivilegedHelperClient&) = delete;
+    PrivilegedHelperClient& operator=(const PrivilegedHelperClient&) = delete;
+    ~PrivilegedHelperClient() { stop(); }
+
+    // Runs argv (absolute program path first) with the socket as stdin/stdout and waits for the helper's
+    // hello. With sudo_password, password is written when sudo prompts with kSudoPrompt; a second prompt
+    // means it was wrong, and sudo gets EOF instead of another try. On failure error holds what the
+    // tool printed and code its exit status.
+    bool start(const std::vector<std::string>& argv, const std::string& password, bool sudo_password, int timeout_ms,
+               std::string& error, int& code) {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_locked();
+        code = 1;
+        int sv[2];
+        int errp[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+            error = std::string("socketpair: ") + std::strerror(errno);
+            return false;
+        }
+        if (::pipe2(errp, O_CLOEXEC) != 0) {
+            error = std::string("pipe: ") + std::strerror(errno);
+            ::close(sv[0]);
+            ::close(sv[1]);
+            return false;
+        }
+        // Built before fork(): the child may only make async-signal-safe calls until exec.
+        std::vector<char*> args;
+        for (const auto& a : argv) args.push_back(const_cast<char*>(a.c_str()));
+        args.push_back(nullptr);
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            ::dup2(sv[1], 0);
+            ::dup2(sv[1], 1);
+            ::dup2(errp[1], 2);
+            ::execv(args[0], args.data());
+            ::_exit(127);
+        }
+        ::close(sv[1]);
+        ::close(errp[1]);
+        if (pid < 0) {
+            error = std::string("fork: ") + std::strerror(errno);
+            ::close(sv[0]);
+            ::close(errp[0]);
+            return false;
+        }
+        sock_ = sv[0];
+        pid_ = pid;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        std::string err_text;
+        size_t prompts = 0;
+        bool err_open = true;
+        bool hello = false;
+        for (;;) {
+            pollfd fds[2] = {{sock_, POLLIN, 0}, {err_open ? errp[0] : -1, POLLIN, 0}};
+            const int n = ::poll(fds, 2, lxpriv::ms_left(deadline));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                err_text += "\ntimed out waiting for authentication";
+                break;
+            }
+            if (fds[1].revents) {
+                char buf[512];
+                const ssize_t got = ::read(errp[0], buf, sizeof(buf));
+                if (got > 0) {
+                    err_text.append(buf, static_cast<size_t>(got));
+                } else {
+                    err_open = false;
+                }
+                if (sudo_password) {
+                    size_t seen = 0;
+                    for (size_t at = err_text.find(kSudoPrompt); at != std::string::npos; at = err_text.find(kSudoPrompt, at + 1)) ++seen;
+                    if (seen > prompts) {
+                        if (prompts == 0 && seen == 1) lxpriv::send_line(sock_, password);
+                        else ::shutdown(sock_, SHUT_WR);
+                        prompts = seen;
+                    }
+                }
+            }
+            if (fds[0].revents) {
+                std::string line;
+                if (!reader_.read(sock_, line, lxpriv::ms_left(deadline))) break;
+                if (line.rfind(kHelperHello, 0) == 0) {
+                    hello = true;
+                    break;
+                }
+            }
+        }
+        ::close(errp[0]);
+        if (hello) return true;
+
+        remove_all(err_text, kSudoPrompt);
+        error = trim(err_text);
+        code = stop_locked();
+        if (error.empty()) error = code == 127 ? "cannot run " + argv[0] : "privileged helper exited (" + std::to_string(code) + ")";
+        return false;
+    }
+
+    bool alive() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return alive_locked();
+    }
+
+    int pid() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return alive_locked() ? static_cast<int>(pid_) : 0;
+    }
+
+    bool ping(std::string& error) {
+        std::string reply;
+        return request("PING", reply, nullptr, error);
+    }
+
+    // A read-only fd the helper opened as root (the caller owns it), or -1 with the reason in error.
+    int open(const std::string& path, std::string& error) {
+        std::string reply;
+        int fd = -1;
+        if (!request("OPEN " + path, reply, &fd, error)) return -1;
+        return fd;
+    }
+
+    bool grant(const std::string& path, std::string& error) {
+        std::string reply;
+        return request("GRANT " + path, reply, nullptr, error);
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_locked();
+    }
+
+private:
+    static constexpr int kRequestTimeoutMs = 5000;
+
+    std::mutex mu_;
+    int sock_ = -1;
+    pid_t pid_ = -1;
+    int status_ = 0;
+    lxpriv::LineReader reader_;
+
+    static void remove_all(std::string& s, std::string_view what) {
+        for (size_t at = s.find(what); at != std::string::npos; at = s.find(what, at)) s.erase(at, what.size());
+    }
+
+    static std::string trim(const std::string& s) {
+        const size_t b = s.find_first_not_of(" \t\r\n");
+        if (b == std::string::npos) return {};
+        return s.substr(b, s.find_last_not_of(" \t\r\n") - b + 1);
+    }
+
+    bool alive_locked() {
+        if (pid_ <= 0) return false;
+        int status = 0;
+        if (::waitpid(pid_, &status, WNOHANG) == 0) return true;
+        status_ = status;
+        pid_ = -1;
+        return false;
+    }
+
+    bool request(const std::string& line, std::string& reply, int* fd, std::string& error) {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!alive_locked() || sock_ < 0) {
+            error = "privileged helper not running";
+            return false;
+        }
+        if (line.find('\n') != std::string::npos) {
+            error = "invalid path";
+            return false;
+        }
+        if (!lxpriv::send_line(sock_, line) || !reader_.read(sock_, reply, kRequestTimeoutMs)) {
+            error = "privileged helper stopped responding";
+            stop_locked();
+            return false;
+        }
+        const int got = reader_.take_fd();
+        if (reply == "OK" || (reply == "FD" && got >= 0)) {
+            if (fd) *fd = got;
+            else if (got >= 0) ::close(got);
+            return true;
+        }
+        if (got >= 0) ::close(got);
+        error = reply.rfind("ERR ", 0) == 0 ? reply.substr(4) : "unexpected reply: " + reply;
+        return false;
+    }
+
+    // Ends the helper (QUIT, then EOF) and reaps it; returns its exit status.
+    int stop_locked() {
+        if (sock_ >= 0) {
+            lxpriv::send_line(sock_, "QUIT");
+            ::close(sock_);
+            sock_ = -1;
+        }
+        reader_.reset();
+        int code = 0;
+        if (pid_ > 0) {
+            int status = 0;
+            pid_t done = 0;
+            for (int i = 0; i < 100 && (done = ::waitpid(pid_, &status, WNOHANG)) == 0; ++i) ::usleep(10'000);
+            if (done == 0) {
+                // sudo keeps the caller's real uid, so it can be signalled; it passes SIGTERM on to the helper.
+                ::kill(pid_, SIGTERM);
+                ::waitpid(pid_, &status, 0);
+            }
+            status_ = status;
+            pid_ = -1;
+        }
+        if (WIFEXITED(status_)) code = WEXITSTATUS(status_);
+        else if (WIFSIGNALED(status_)) code = 128 + WTERMSIG(status_);
+        status_ = 0;
+        return code;
+    }
+};
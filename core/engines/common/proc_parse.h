@@ -0,0 +1,227 @@
+#pragma once
+
+#include <string_view>
+
+#include "scan.h"
+
+// Parsers for the procfs files the engines poll every tick.
+// They work on the buffer returned by PinnedFile::read() and never allocate.
+namespace lxproc {
+
+// One "cpu"/"cpuN" line of /proc/stat, in jiffies.
+struct CpuTimes {
+    unsigned long long user = 0;
+    unsigned long long nice = 0;
+    unsigned long long system = 0;
+    unsigned long long idle = 0;
+    unsigned long long iowait = 0;
+    unsigned long long irq = 0;
+    unsigned long long softirq = 0;
+    unsigned long long steal = 0;
+
+    unsigned long long total() const { return user + nice + system + idle + iowait + irq + softirq + steal; }
+    unsigned long long idle_total() const { return idle + iowait; }
+};
+
+// Parses the counters after the "cpu" label. The first four are required; the rest depend on the kernel.
+inline bool parse_cpu_times(lxscan::Cursor& c, CpuTimes& t) {
+    t = CpuTimes{};
+    if (!c.number(t.user) || !c.number(t.nice) || !c.number(t.system) || !c.number(t.idle)) return false;
+    if (c.number(t.iowait) && c.number(t.irq) && c.number(t.softirq)) c.number(t.steal);
+    return true;
+}
+
+// Aggregate first line of /proc/stat.
+inline bool parse_stat_total(std::string_view text, CpuTimes& t) {
+    lxscan::Cursor c(text);
+    if (c.token() != "cpu") return false;
+    return parse_cpu_times(c, t);
+}
+
+// /proc/meminfo fields used for the RAM percentage, in kB. available stays -1 on kernels without MemAvailable.
+struct MemInfo {
+    long long total = 0;
+    long long available = -1;
+    long long free = 0;
+    long long buffers = 0;
+    long long cached = 0;
+    long long sreclaimable = 0;
+    long long shmem = 0;
+};
+
+inline bool parse_meminfo(std::string_view text, MemInfo& m) {
+    m = MemInfo{};
+    lxscan::Cursor c(text);
+    std::string_view line;
+    while (c.line(line)) {
+        lxscan::Cursor lc(line);
+        const std::string_view key = lc.until(':');
+        if (key.size() == line.size()) continue;  // no ':'
+        long long val = 0;
+        if (!lc.number(val)) continue;
+
+        if (key == "MemTotal") m.total = val;
+        else if (key == "MemAvailable") m.available = val;
+        else if (key == "MemFree") m.free = val;
+        else if (key == "Buffers") m.buffers = val;
+        else if (key == "Cached") m.cached = val;
+        else if (key == "SReclaimable") m.sreclaimable = val;
+        else if (key == "Shmem") m.shmem = val;
+
+        // MemAvailable sits near the top, so the long tail of the file is usually skipped.
+        if (m.total > 0 && m.available >= 0) break;
+    }
+    return m.total > 0;
+}
+
+// Per-interface counters of /proc/net/dev.
+struct NetDevCounters {
+    unsigned long long rx_bytes = 0;
+    unsigned long long rx_packets = 0;
+    unsigned long long rx_errs = 0;
+    unsigned long long rx_drop = 0;
+    unsigned long long tx_bytes = 0;
+    unsigned long long tx_packets = 0;
+    unsigned long long tx_errs = 0;
+    unsigned long long tx_drop = 0;
+};
+
+// Calls fn(std::string_view iface, const NetDevCounters&) for every interface line.
+template <typename Fn>
+inline void for_each_net_dev(std::string_view text, Fn&& fn) {
+    lxscan::Cursor c(text);
+    c.skip_line();  // headers
+    c.skip_line();
+
+    std::string_view line;
+    while (c.line(line)) {
+        lxscan::Cursor lc(line);
+        const std::string_view iface = lxscan::trim(lc.until(':'));
+        if (iface.empty() || lc.eof()) continue;
+
+        // rx: bytes packets errs drop fifo frame compressed multicast
+        // tx: bytes packets errs drop fifo colls carrier compressed
+        unsigned long long v[16] = {};
+        if (lc.numbers(v, 16) < 9) continue;
+
+        NetDevCounters n;
+        n.rx_bytes = v[0];
+        n.rx_packets = v[1];
+        n.rx_errs = v[2];
+        n.rx_drop = v[3];
+        n.tx_bytes = v[8];
+        n.tx_packets = v[9];
+        n.tx_errs = v[10];
+        n.tx_drop = v[11];
+        fn(iface, n);
+    }
+}
+
+// One line of /proc/diskstats (the first 11 counters after the name).
+struct DiskStats {
+    unsigned major = 0;
+    unsigned minor = 0;
+    std::string_view name;
+    unsigned long long reads_completed = 0;
+    unsigned long long reads_merged = 0;
+    unsigned long long sectors_read = 0;
+    unsigned long long ms_reading = 0;
+    unsigned long long writes_completed = 0;
+    unsigned long long writes_merged = 0;
+    unsigned long long sectors_written = 0;
+    unsigned long long ms_writing = 0;
+    unsigned long long ios_in_progress = 0;
+    unsigned long long ms_doing_io = 0;
+    unsigned long long weighted_ms_doing_io = 0;
+};
+
+// Calls fn(const DiskStats&) for every well-formed line; name points into text.
+template <typename Fn>
+inline void for_each_diskstats(std::string_view text, Fn&& fn) {
+    lxscan::Cursor c(text);
+    std::string_view line;
+    while (c.line(line)) {
+        lxscan::Cursor lc(line);
+        DiskStats d;
+        if (!lc.number(d.major) || !lc.number(d.minor)) continue;
+        d.name = lc.token();
+        if (d.name.empty()) continue;
+
+        unsigned long long v[11] = {};
+        if (lc.numbers(v, 11) < 11) continue;
+        d.reads_completed = v[0];
+        d.reads_merged = v[1];
+        d.sectors_read = v[2];
+        d.ms_reading = v[3];
+        d.writes_completed = v[4];
+        d.writes_merged = v[5];
+        d.sectors_written = v[6];
+        d.ms_writing = v[7];
+        d.ios_in_progress = v[8];
+        d.ms_doing_io = v[9];
+        d.weighted_ms_doing_io = v[10];
+        fn(d);
+    }
+}
+
+// One line of /proc/pressure/<resource>: the share of wall time (percent, kernel running averages)
+// in which at least one task ("some") or every non-idle task ("full") stalled, and the total in us.
+struct PsiLine {
+    double avg10 = 0.0;
+    double avg60 = 0.0;
+    double avg300 = 0.0;
+    unsigned long long total_us = 0;
+};
+
+// has_full is false for cpu before 5.13, which prints the "some" line only.
+struct PsiInfo {
+    PsiLine some;
+    PsiLine full;
+    bool has_full = false;
+};
+
+// "12.34" as the kernel prints PSI averages (LOAD_INT.LOAD_FRAC); from_chars(double) needs GCC 11.
+inline bool parse_fixed_point(std::string_view s, double& out) {
+    unsigned long long whole = 0;
+    size_t i = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) whole = whole * 10 + static_cast<unsigned>(s[i] - '0');
+    if (i == 0) return false;
+    double frac = 0.0;
+    if (i < s.size() && s[i] == '.') {
+        double scale = 0.1;
+        for (++i; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i, scale *= 0.1) frac += scale * (s[i] - '0');
+    }
+    out = static_cast<double>(whole) + frac;
+    return true;
+}
+
+inline bool parse_psi(std::string_view text, PsiInfo& p) {
+    p = PsiInfo{};
+    bool has_some = false;
+    lxscan::Cursor c(text);
+    std::string_view line;
+    while (c.line(line)) {
+        lxscan::Cursor lc(line);
+        const std::string_view kind = lc.token();
+        PsiLine* dst = kind == "some" ? &p.some : kind == "full" ? &p.full : nullptr;
+        if (!dst) continue;
+        int fields = 0;
+        while (!lc.eof()) {
+            lc.skip_blanks();
+            const std::string_view key = lc.until('=');
+            bool ok = false;
+            if (key == "total") ok = lc.number(dst->total_us);
+            else if (key == "avg10") ok = parse_fixed_point(lc.token(), dst->avg10);
+            else if (key == "avg60") ok = parse_fixed_point(lc.token(), dst->avg60);
+            else if (key == "avg300") ok = parse_fixed_point(lc.token(), dst->avg300);
+            if (!ok) break;
+            ++fields;
+        }
+        if (fields < 4) continue;
+        if (dst == &p.some) has_some = true;
+        else p.has_full = true;
+    }
+    return has_some;
+}
+
+}  // namespace lxproc
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "pinned_file.h"
+#include "rate_kernels.h"
+#include "scan.h"
+#include "source_root.h"
+
+// Per-process CPU, RSS and I/O with top-N selection, for "which process is it" without opening top.
+// Each sample lists /proc with getdents64 into a reused buffer and keeps a PID-indexed table of the
+// previous counters. New PIDs cost an openat() of stat and io; a PID seen twice keeps both fds
+// open (up to a budget under RLIMIT_NOFILE), so long-lived processes cost one pread() per file.
+// RSS comes from stat's rss field, which is statm's resident count, so statm is not read.
+// Short-lived PIDs never take a pinned fd. Top-N uses nth_element and sorts only the N winners.
+class ProcessActivityEngine {
+public:
+    struct ProcSample {
+        int pid = 0;
+        std::string name;  // comm (15 characters for user tasks)
+        char state = '?';
+        uint32_t threads = 0;
+        double cpu_pct = 0.0;  // of one core, like top (a 4-thread spinner shows 400)
+        uint64_t rss_bytes = 0;
+        double read_bps = 0.0;   // storage I/O (read_bytes/write_bytes); 0 when io is not readable
+        double write_bps = 0.0;
+    };
+
+    struct TopLists {
+        std::vector<ProcSample> by_cpu;
+        std::vector<ProcSample> by_rss;
+        std::vector<ProcSample> by_io;
+        size_t processes = 0;
+        size_t threads = 0;
+        size_t pinned_fds = 0;
+    };
+
+    explicit ProcessActivityEngine(const SourceRoot& root = SourceRoot::host()) : proc_path_(root.resolve("/proc")) {
+        const long tck = ::sysconf(_SC_CLK_TCK);
+        const long page = ::sysconf(_SC_PAGESIZE);
+        clk_tck_ = tck > 0 ? static_cast<double>(tck) : 100.0;
+        page_size_ = page > 0 ? static_cast<uint64_t>(page) : 4096;
+        fd_budget_ = pinned_fd_budget();
+        dents_.resize(64 * 1024);
+        buf_.resize(4096);
+        last_time_ = std::chrono::steady_clock::now();
+        if (scan()) commit();
+    }
+
+    ProcessActivityEngine(const ProcessActivityEngine&) = delete;
+    ProcessActivityEngine& operator=(const ProcessActivityEngine&) = delete;
+
+    ~ProcessActivityEngine() {
+        for (auto& s : slots_) close_slot(s);
+        if (dir_fd_ >= 0) ::close(dir_fd_);
+    }
+
+    // Scans /proc and returns the n heaviest processes by CPU, RSS and I/O over the time since the
+    // previous call. The first call after construction or a long gap still works; it diffs against
+    // the constructor's scan. Valid until the next call.
+    const TopLists& sample(size_t n) {
+        try {
+            const auto now = std::chrono::steady_clock::now();
+            const double elapsed_s = std::chrono::duration<double>(now - last_time_).count();
+            if (elapsed_s <= 0.001) return top_;
+            last_time_ = now;
+            if (!scan()) {
+                clear_top();
+                return top_;
+            }
+            select(n, elapsed_s);
+            commit();
+        } catch (...) {
+            clear_top();
+        }
+        return top_;
+    }
+
+    const TopLists& last() const { return top_; }
+
+    // How many stat/io fds may stay open between samples. The default is half of the RLIMIT_NOFILE
+    // soft limit left after a reserve; hosts with 50k+ tasks need a raised limit to pin them all.
+    // Lowering it closes the excess now.
+    void set_fd_budget(size_t budget) {
+        fd_budget_ = budget;
+        for (auto& s : slots_) {
+            if (pinned_ <= fd_budget_) break;
+            close_slot(s);
+        }
+    }
+
+    size_t fd_budget() const { return fd_budget_; }
+
+private:
+    static constexpr size_t kFdBudgetCap = 32768;
+
+    struct Counters {
+        unsigned long long cpu_ticks = 0;  // utime + stime
+        unsigned long long read_bytes = 0;
+        unsigned long long write_bytes = 0;
+    };
+
+    struct Slot {
+        int pid = 0;
+        unsigned long long start_time = 0;  // stat field 22; a different value means the PID was reused
+        int stat_fd = -1;
+        int io_fd = -1;
+        bool io_unreadable = false;  // other users' io needs ptrace access (or no task I/O accounting); not retried
+        bool has_prev = false;
+        bool live = false;
+        uint32_t seen_gen = 0;
+        uint32_t sightings = 0;
+        char state = '?';
+        uint32_t threads = 0;
+        uint64_t rss_pages = 0;
+        std::string name;
+        Counters prev;
+        Counters cur;
+    };
+
+    std::string proc_path_;
+    int dir_fd_ = -1;
+    double clk_tck_ = 100.0;
+    uint64_t page_size_ = 4096;
+    size_t fd_budget_ = 0;
+    size_t pinned_ = 0;
+    uint32_t gen_ = 0;
+    std::chrono::steady_clock::time_point last_time_;
+    std::vector<char> dents_;
+    std::vector<char> buf_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_;
+    std::unordered_map<int, uint32_t> index_;  // pid -> slot
+    std::vector<uint32_t> order_;              // selection scratch
+    std::vector<double> key_;                  // per-slot sort key for the current pass
+    TopLists top_;
+
+    // Half of what is left under the soft limit after a reserve for everything else in the process.
+    static size_t pinned_fd_budget() {
+        rlimit rl{};
+        if (::getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY) return 1024;
+        if (rl.rlim_cur <= 512) return 0;
+        return std::min<size_t>((static_cast<size_t>(rl.rlim_cur) - 256) / 2, kFdBudgetCap);
+    }
+
+    void clear_top() {
+        top_.by_cpu.clear();
+        top_.by_rss.clear();
+        top_.by_io.clear();
+        top_.processes = 0;
+        top_.threads = 0;
+    }
+
+    bool open_dir() {
+        if (dir_fd_ >= 0) return true;
+        ++pinned_io_counters().opens;
+        dir_fd_ = ::open(proc_path_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        return dir_fd_ >= 0;
+    }
+
+    void close_slot(Slot& s) {
+        if (s.stat_fd >= 0) {
+            ::close(s.stat_fd);
+            --pinned_;
+        }
+        if (s.io_fd >= 0) {
+            ::close(s.io_fd);
+            --pinned_;
+        }
+        s.stat_fd = s.io_fd = -1;
+    }
+
+    // Lists /proc and refreshes every numeric entry; slots of PIDs that are gone are recycled.
+    bool scan() {
+        if (!open_dir()) return false;
+        if (::lseek(dir_fd_, 0, SEEK_SET) != 0) return false;
+        ++gen_;
+
+        for (;;) {
+            ++pinned_io_counters().reads;
+            const long n = ::syscall(SYS_getdents64, dir_fd_, dents_.data(), dents_.size());
+            if (n < 0) return false;
+            if (n == 0) break;
+            for (long off = 0; off < n;) {
+                const auto* d = reinterpret_cast<const dirent64*>(dents_.data() + off);
+                off += d->d_reclen;
+                const int pid = parse_pid(d->d_name);
+                if (pid > 0) refresh(pid);
+            }
+        }
+
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            Slot& s = slots_[i];
+            if (!s.live || s.seen_gen == gen_) continue;
+            index_.erase(s.pid);
+            close_slot(s);
+            s.live = false;
+            free_.push_back(i);
+        }
+        return true;
+    }
+
+    static int parse_pid(const char* name) {
+        int pid = 0;
+        for (const char* p = name; *p; ++p) {
+            if (*p < '0' || *p > '9') return 0;
+            pid = pid * 10 + (*p - '0');
+        }
+        return pid;
+    }
+
+    Slot& slot_for(int pid) {
+        const auto it = index_.find(pid);
+        if (it != index_.end()) return slots_[it->second];
+        uint32_t i;
+        if (!free_.empty()) {
+            i = free_.back();
+            free_.pop_back();
+        } else {
+            i = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        Slot& s = slots_[i];
+        std::string name = std::move(s.name);  // keep the capacity, drop the content
+        name.clear();
+        s = Slot{};
+        s.name = std::move(name);
+        s.pid = pid;
+        s.live = true;
+        index_.emplace(pid, i);
+        return s;
+    }
+
+    // "<pid>/<file>" relative to the /proc fd, without building a std::string.
+    int open_pid_file(int pid, const char* file) {
+        char rel[32];
+        char* p = rel + sizeof(rel);
+        *--p = '\0';
+        for (const char* f = file + std::char_traits<char>::length(file); f != file;) *--p = *--f;
+        *--p = '/';
+        do {
+            *--p = static_cast<char>('0' + pid % 10);
+            pid /= 10;
+        } while (pid > 0);
+        ++pinned_io_counters().opens;
+        return ::openat(dir_fd_, p, O_RDONLY | O_CLOEXEC);
+    }
+
+    // Reads fd (or opens file for this read only) into buf_. Returns the text, empty on failure.
+    // A pinned fd of an exited process fails with ESRCH.
+    std::string_view read_pid_file(int pid, const char* file, int& fd, bool keep) {
+        bool opened_now = false;
+        if (fd < 0) {
+            fd = open_pid_file(pid, file);
+            if (fd < 0) return {};
+            opened_now = true;
+        }
+        ssize_t n;
+        ++pinned_io_counters().reads;
+        do {
+            n = ::pread(fd, buf_.data(), buf_.size() - 1, 0);
+        } while (n < 0 && errno == EINTR);
+        if (opened_now && keep && n >= 0 && pinned_ < fd_budget_) {
+            ++pinned_;
+        } else if (opened_now || n < 0) {
+            if (!opened_now) --pinned_;
+            ::close(fd);
+            fd = -1;
+        }
+        if (n <= 0) return {};
+        return std::string_view(buf_.data(), static_cast<size_t>(n));
+    }
+
+    void refresh(int pid) {
+        Slot& s = slot_for(pid);
+        s.seen_gen = gen_;
+        ++s.sightings;
+        const bool keep = s.sightings >= 2;
+
+        const bool pinned_before = s.stat_fd >= 0;
+        std::string_view text = read_pid_file(pid, "stat", s.stat_fd, keep);
+        if (text.empty() && pinned_before) {
+            // Pinned fd of the previous owner of this PID; the directory entry is a new process.
+            close_slot(s);
+            s.has_prev = false;
+            s.io_unreadable = false;
+            text = read_pid_file(pid, "stat", s.stat_fd, keep);
+        }
+        if (text.empty() || !parse_stat(s, text)) {
+            s.seen_gen = 0;  // exited between getdents and the read; recycled at the end of this scan
+            return;
+        }
+
+        if (!s.io_unreadable) {
+            const bool io_pinned = s.io_fd >= 0;
+            text = read_pid_file(pid, "io", s.io_fd, keep);
+            if (!text.empty()) {
+                parse_io(s, text);
+            } else if (!io_pinned && (errno == EACCES || errno == ENOENT)) {
+                s.io_unreadable = true;
+            }
+        }
+    }
+
+    // pid (comm) state ppid ... utime(14) stime(15) ... num_threads(20) itrealvalue starttime(22) vsize rss(24)
+    bool parse_stat(Slot& s, std::string_view text) {
+        const size_t open = text.find('(');
+        const size_t close = text.rfind(')');  // comm may itself contain ')' and spaces
+        if (open == std::string_view::npos || close == std::string_view::npos || close < open) return false;
+
+        const std::string_view comm = text.substr(open + 1, close - open - 1);
+        if (s.name != comm) s.name.assign(comm.data(), comm.size());  // changes at exec()
+
+        lxscan::Cursor c(text.substr(close + 1));
+        const std::string_view state = c.token();
+        long long v[21] = {};  // fields 4..24
+        if (state.empty() || c.numbers(v, 21) < 21) return false;
+
+        const unsigned long long start_time = static_cast<unsigned long long>(v[18]);
+        if (s.has_prev && start_time != s.start_time) s.has_prev = false;  // PID reused between scans
+        s.start_time = start_time;
+        s.state = state[0];
+        s.threads = static_cast<uint32_t>(std::max(0LL, v[16]));
+        s.rss_pages = static_cast<uint64_t>(std::max(0LL, v[20]));
+        s.cur.cpu_ticks = static_cast<unsigned long long>(v[10] + v[11]);
+        return true;
+    }
+
+    static void parse_io(Slot& s, std::string_view text) {
+        lxscan::Cursor c(text);
+        std::string_view line;
+        while (c.line(line)) {
+            lxscan::Cursor lc(line);
+            const std::string_view key = lc.until(':');
+            if (key == "read_bytes") lc.number(s.cur.read_bytes);
+            else if (key == "write_bytes") lc.number(s.cur.write_bytes);
+        }
+    }
+
+    void fill(ProcSample& out, const Slot& s, double elapsed_s) const {
+        out.pid = s.pid;
+        if (out.name != s.name) out.name.assign(s.name);
+        out.state = s.state;
+        out.threads = s.threads;
+        out.cpu_pct = s.has_prev ? lxrate::rate(s.cur.cpu_ticks, s.prev.cpu_ticks, elapsed_s) / clk_tck_ * 100.0 : 0.0;
+        out.rss_bytes = s.rss_pages * page_size_;
+        out.read_bps = s.has_prev ? lxrate::rate(s.cur.read_bytes, s.prev.read_bytes, elapsed_s) : 0.0;
+        out.write_bps = s.has_prev ? lxrate::rate(s.cur.write_bytes, s.prev.write_bytes, elapsed_s) : 0.0;
+    }
+
+    // The n largest key_ entries of order_, descending: O(P) partition plus an O(n log n) sort.
+    // Idle entries (key 0) are left out, so an idle box does not list arbitrary kernel threads.
+    void pick(size_t n, std::vector<ProcSample>& out, double elapsed_s) {
+        size_t k = std::min(n, order_.size());
+        auto heavier = [this](uint32_t a, uint32_t b) { return key_[a] > key_[b]; };
+        if (k < order_.size()) std::nth_element(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(k), order_.end(), heavier);
+        std::sort(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(k), heavier);
+        while (k > 0 && key_[order_[k - 1]] <= 0.0) --k;
+        out.resize(k);
+        for (size_t i = 0; i < k; ++i) fill(out[i], slots_[order_[i]], elapsed_s);
+    }
+
+    void select(size_t n, double elapsed_s) {
+        key_.resize(slots_.size());
+        order_.clear();
+        top_.processes = 0;
+        top_.threads = 0;
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            const Slot& s = slots_[i];
+            if (!s.live || s.seen_gen != gen_) continue;
+            ++top_.processes;
+            top_.threads += s.threads;
+            order_.push_back(i);
+        }
+        top_.pinned_fds = pinned_;
+
+        for (uint32_t i : order_) {
+            const Slot& s = slots_[i];
+            key_[i] = s.has_prev ? static_cast<double>(s.cur.cpu_ticks - std::min(s.cur.cpu_ticks, s.prev.cpu_ticks)) : 0.0;
+        }
+        pick(n, top_.by_cpu, elapsed_s);
+
+        for (uint32_t i : order_) key_[i] = static_cast<double>(slots_[i].rss_pages);
+        pick(n, top_.by_rss, elapsed_s);
+
+        for (uint32_t i : order_) {
+            const Slot& s = slots_[i];
+            key_[i] = s.has_prev ? lxrate::rate(s.cur.read_bytes, s.prev.read_bytes, 1.0) + lxrate::rate(s.cur.write_bytes, s.prev.write_bytes, 1.0) : 0.0;
+        }
+        pick(n, top_.by_io, elapsed_s);
+    }
+
+    // cur becomes prev for every process of the last scan.
+    void commit() {
+        for (auto& s : slots_) {
+            if (!s.live || s.seen_gen != gen_) continue;
+            s.prev = s.cur;
+            s.has_prev = true;
+        }
+    }
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "pinned_file.h"
+#include "source_root.h"
+
+// PSI resources, in the order of /proc/pressure/{cpu,memory,io}.
+enum PsiResource : int { kPsiCpu = 0, kPsiMemory = 1, kPsiIo = 2 };
+inline constexpr int kPsiResourceCount = 3;
+
+inline const char* psi_resource_name(int resource) {
+    static const char* const names[kPsiResourceCount] = {"cpu", "memory", "io"};
+    return resource >= 0 && resource < kPsiResourceCount ? names[resource] : "";
+}
+
+inline int psi_resource_from_name(const std::string& name) {
+    for (int r = 0; r < kPsiResourceCount; ++r) {
+        if (name == psi_resource_name(r)) return r;
+    }
+    return -1;
+}
+
+struct PsiTriggerSpec {
+    int resource = kPsiMemory;
+    bool full = false;               // "full": every non-idle task stalled; "some": at least one
+    uint32_t stall_us = 150'000;     // fire when stalls add up to this much ...
+    uint32_t window_us = 2'000'000;  // ... within any window this long
+};
+
+// PSI triggers (Documentation/accounting/psi.rst): writing "some|full <stall us> <window us>" to an open
+// /proc/pressure/<resource> arms that fd, and poll() reports POLLPRI once the stall time in a window
+// exceeds the threshold, at most once per window. One trigger per fd. Windows are 500 ms .. 10 s;
+// unprivileged processes need a whole multiple of 2 s (kernels before 6.5 need CAP_SYS_RESOURCE).
+// The set is owned by one waiting thread; only interrupt() may be called from others.
+class PsiTriggerSet {
+public:
+    explicit PsiTriggerSet(const SourceRoot& root = SourceRoot::host()) : root_(root) {
+        wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    }
+
+    PsiTriggerSet(const PsiTriggerSet&) = delete;
+    PsiTriggerSet& operator=(const PsiTriggerSet&) = delete;
+
+    ~PsiTriggerSet() {
+        clear();
+        if (wake_fd_ >= 0) ::close(wake_fd_);
+    }
+
+    // Arms one trigger. On failure returns false with the kernel's reason in error.
+    bool add(const PsiTriggerSpec& spec, std::string& error) {
+        drain_wake();
+        const char* name = psi_resource_name(spec.resource);
+        if (!*name) {
+            error = "unknown PSI resource";
+            return false;
+        }
+        const std::string path = root_.resolve(std::string("/proc/pressure/") + name);
+        ++pinned_io_counters().opens;
+        const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        const std::string arm = std::string(spec.full ? "full " : "some ") + std::to_string(spec.stall_us) + " " +
+                                std::to_string(spec.window_us);
+        // The kernel parses a NUL-terminated string.
+        if (::write(fd, arm.c_str(), arm.size() + 1) < 0) {
+            error = path + " '" + arm + "': " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        triggers_.push_back({spec, fd});
+        return true;
+    }
+
+    void clear() {
+        drain_wake();
+        for (const auto& t : triggers_) ::close(t.fd);
+        triggers_.clear();
+    }
+
+    size_t size() const { return triggers_.size(); }
+
+    std::vector<PsiTriggerSpec> specs() const {
+        std::vector<PsiTriggerSpec> out;
+        for (const auto& t : triggers_) out.push_back(t.spec);
+        return out;
+    }
+
+    // Blocks up to timeout_ms (-1: no limit) until a trigger fires or interrupt() is called.
+    // Returns the (1 << PsiResource) bits that fired; 0 on timeout, interrupt or without triggers.
+    // A trigger whose file went away (POLLERR) is dropped.
+    uint32_t wait(int timeout_ms) {
+        fds_.clear();
+        if (wake_fd_ >= 0) fds_.push_back({wake_fd_, POLLIN, 0});
+        for (const auto& t : triggers_) fds_.push_back({t.fd, POLLPRI, 0});
+        if (fds_.empty()) return 0;
+
+        int n;
+        do {
+            n = ::poll(fds_.data(), fds_.size(), timeout_ms);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) return 0;
+
+        const size_t base = wake_fd_ >= 0 ? 1 : 0;
+        if (base && (fds_[0].revents & POLLIN)) drain_wake();
+        uint32_t fired = 0;
+        for (size_t i = triggers_.size(); i-- > 0;) {
+            const short ev = fds_[base + i].revents;
+            if (ev & (POLLERR | POLLNVAL)) {
+                ::close(triggers_[i].fd);
+                triggers_.erase(triggers_.begin() + static_cast<std::ptrdiff_t>(i));
+            } else if (ev & POLLPRI) {
+                fired |= 1u << triggers_[i].spec.resource;
+            }
+        }
+        return fired;
+    }
+
+    // Makes a wait() in progress (or the next one) return at once; add() and clear() drop a pending
+    // interrupt, as it was meant for the wait before them. Safe from any thread.
+    void interrupt() {
+        if (wake_fd_ < 0) return;
+        const uint64_t one = 1;
+        while (::write(wake_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+        }
+    }
+
+private:
+    struct Trigger {
+        PsiTriggerSpec spec;
+        int fd;
+    };
+
+    SourceRoot root_;
+    int wake_fd_ = -1;
+    std::vector<Trigger> triggers_;
+    std::vector<pollfd> fds_;
+
+    void drain_wake() {
+        uint64_t count;
+        if (wake_fd_ >= 0) (void)::read(wake_fd_, &count, sizeof(count));  // an eventfd read resets the counter
+    }
+};
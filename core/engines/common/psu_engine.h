@@ -0,0 +1,743 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+#include "pinned_file.h"
+#include "rate_kernels.h"
+#include "source_root.h"
+#include "topology_watch.h"
+
+namespace fs = std::filesystem;
+
+class PowerTelemetryEngine {
+public:
+    explicit PowerTelemetryEngine(const SourceRoot& root = SourceRoot::host())
+        : root_(root), topology_(std::vector<std::string>{"hwmon", "power_supply", "powercap", "nvme"}, kRediscoverPeriod, root) {}
+
+    struct Snapshot {
+        double total_w = 0.0;
+        std::string total_source = "none";
+        bool has_battery = false;
+        int battery_count = 0;
+        bool ac_online = false;
+        double battery_total_w = 0.0;
+        double battery_discharge_w = 0.0;
+        double battery_charge_w = 0.0;
+        double battery_capacity_avg = 0.0;
+
+        double cpu_w = 0.0;
+        double gpu_w = 0.0;
+        double disk_w = 0.0;
+        double net_w = 0.0;
+        double board_w = 0.0;
+        double memory_w = 0.0;
+        double other_w = 0.0;
+
+        std::vector<std::pair<std::string, double>> sources_w;
+        std::vector<std::string> blocked_sources;
+    };
+
+    // Readings are memoized for kMemoWindow, so the sampler thread and the widget poll share one sysfs pass.
+    double get_usage() {
+        return std::max(0.0, sample().total_w);
+    }
+
+    const Snapshot& get_all_usage() {
+        return sample();
+    }
+
+    // Rebuilds the source index on the next read (after a permission change, driver load, ...).
+    void rescan() {
+        rescan_requested_ = true;
+        has_memo_ = false;
+    }
+
+    // Drops the memoized snapshot so the next read re-reads every source (benchmarks, tests).
+    void invalidate() { has_memo_ = false; }
+
+    struct IndexInfo {
+        size_t power_inputs = 0;
+        size_t rails = 0;
+        size_t rapl_zones = 0;
+        size_t supplies = 0;
+        size_t blocked = 0;
+        uint64_t discoveries = 0;
+        double last_discovery_ms = 0.0;
+    };
+
+    IndexInfo index_info() const {
+        IndexInfo info;
+        info.power_inputs = power_inputs_.size();
+        info.rails = rails_.size();
+        info.rapl_zones = rapl_.size();
+        info.supplies = supplies_.size();
+        info.blocked = blocked_static_.size();
+        info.discoveries = discoveries_;
+        info.last_discovery_ms = last_discovery_ms_;
+        return info;
+    }
+
+private:
+    static std::string sanitize_label(const std::string& in) {
+        std::string s = in;
+        for (char& c : s) {
+            if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+        }
+        while (!s.empty() && s.front() == ' ') s.erase(s.begin());
+        while (!s.empty() && s.back() == ' ') s.pop_back();
+        return s;
+    }
+
+    static std::string to_lower(std::string s) {
+        for (char& c : s) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return s;
+    }
+
+    static bool contains_any(const std::string& s, const std::vector<std::string>& needles) {
+        for (const auto& n : needles) {
+            if (!n.empty() && s.find(n) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    static int parse_sensor_index(const std::string& filename, const std::string& prefix) {
+        if (filename.rfind(prefix, 0) != 0) return -1;
+        const size_t start = prefix.size();
+        size_t pos = start;
+        while (pos < filename.size() && std::isdigit(static_cast<unsigned char>(filename[pos]))) pos++;
+        if (pos == start) return -1;
+        try {
+            return std::stoi(filename.substr(start, pos - start));
+        } catch (...) {
+            return -1;
+        }
+    }
+
+    static bool can_read_file(const fs::path& p) {
+        return fs::exists(p) && (::access(p.c_str(), R_OK) == 0 || granted_fds().has(p.string()));
+    }
+
+    struct SourceMeta {
+        std::string cls;
+        std::string entity;
+        int priority = 0;
+    };
+
+    static std::string extract_token_after(const std::string& s, const std::string& key) {
+        auto pos = s.find(key);
+        if (pos == std::string::npos) return {};
+        pos += key.size();
+        std::string out;
+        while (pos < s.size()) {
+            const char c = s[pos];
+            if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.') {
+                out.push_back(c);
+                pos++;
+            } else {
+                break;
+            }
+        }
+        return out;
+    }
+
+    static SourceMeta source_meta(const std::string& name) {
+        SourceMeta m;
+        const std::string low = to_lower(name);
+
+        if (low.rfind("gpu:", 0) == 0 || contains_any(low, {"amdgpu", "radeon", "nvidia", "nouveau", "i915", "xe", "vddgfx", "ppt"})) {
+            m.cls = "gpu";
+            m.entity = extract_token_after(low, "card");
+            if (m.entity.empty()) {
+                if (low.find("amdgpu") != std::string::npos) m.entity = "amdgpu";
+                else if (low.find("nvidia") != std::string::npos) m.entity = "nvidia";
+                else if (low.find("nouveau") != std::string::npos) m.entity = "nouveau";
+                else if (low.find("i915") != std::string::npos) m.entity = "i915";
+                else if (low.find("xe") != std::string::npos) m.entity = "xe";
+            }
+            if (low.rfind("hwmon:", 0) == 0) m.priority = 30;
+            else if (low.rfind("gpu:", 0) == 0) m.priority = 20;
+            else m.priority = 10;
+            return m;
+        }
+        if (low.rfind("rapl:", 0) == 0 || contains_any(low, {"cpu", "package", "coretemp", "k10temp", "tctl", "tdie"})) {
+            m.cls = "cpu";
+            m.entity = extract_token_after(low, "rapl:");
+            if (m.entity.empty()) m.entity = "cpu";
+            m.priority = (low.rfind("rapl:", 0) == 0) ? 30 : 10;
+            return m;
+        }
+
+        return m;
+    }
+
+    static int dedupe_score(const std::string& name) {
+        const auto m = source_meta(name);
+        int score = m.priority;
+        if (name.rfind("hwmon:", 0) == 0) score += 3;
+        if (name.rfind("rapl:", 0) == 0) score += 3;
+        if (name.rfind("gpu:", 0) == 0) score += 1;
+        if (name.rfind("supply:", 0) == 0) score -= 1;
+        return score;
+    }
+
+    // ---- Source index ----
+    // discover() walks sysfs once and keeps every value file open; a tick only pread()s them.
+
+    enum class PowerClass { kBattery, kGpu, kCpu, kDisk, kNet, kMemory, kBoard, kOther };
+
+    // Everything derived from a source name alone, computed once per discovery.
+    struct SourceInfo {
+        std::string name;
+        PowerClass cls = PowerClass::kOther;
+        SourceMeta meta;
+        int score = 0;
+    };
+
+    struct PowerInput {     // hwmon/nvme powerN_input|_average, microwatts
+        const SourceInfo* info = nullptr;
+        PinnedFile file;
+    };
+
+    struct RailInput {      // hwmon inN_input (mV) x currN_input (mA)
+        const SourceInfo* info = nullptr;
+        PinnedFile in_file;
+        PinnedFile curr_file;
+    };
+
+    struct RaplPrev {
+        unsigned long long energy_uj = 0ULL;
+        std::chrono::steady_clock::time_point ts;
+        bool valid = false;
+    };
+
+    struct RaplZone {
+        const SourceInfo* info = nullptr;
+        PinnedFile energy;
+        unsigned long long max_range = 0ULL;
+        bool has_max = false;
+        RaplPrev* prev = nullptr;  // owned by rapl_prev_, survives rediscovery
+    };
+
+    struct SupplyInput {
+        const SourceInfo* info = nullptr;  // battery:<name> or supply:<name>
+        bool battery = false;
+        bool mains = false;
+        bool perm_blocked = false;         // power files exist but are not readable
+        PinnedFile power_now;
+        PinnedFile current_now;
+        PinnedFile voltage_now;
+        PinnedFile status;
+        PinnedFile capacity;
+        PinnedFile online;
+    };
+
+    struct Reading {
+        const SourceInfo* info;
+        double w;
+    };
+
+    static constexpr auto kMemoWindow = std::chrono::milliseconds(15);
+    static constexpr auto kRediscoverPeriod = std::chrono::seconds(30);
+    static constexpr auto kFailureRediscoverGap = std::chrono::seconds(2);
+
+    std::map<std::string, SourceInfo> infos_;  // node addresses are stable
+    std::vector<PowerInput> power_inputs_;
+    std::vector<RailInput> rails_;
+    std::vector<RaplZone> rapl_;
+    std::vector<SupplyInput> supplies_;
+    std::vector<std::string> blocked_static_;
+    std::unordered_map<std::string, RaplPrev> rapl_prev_;
+
+    SourceRoot root_;
+    TopologyWatch topology_;
+    bool indexed_ = false;
+    bool rescan_requested_ = false;
+    bool read_failed_ = false;
+    std::chrono::steady_clock::time_point last_discovery_;
+    uint64_t discoveries_ = 0;
+    double last_discovery_ms_ = 0.0;
+
+    std::vector<Reading> readings_;
+    Snapshot memo_;
+    std::chrono::steady_clock::time_point memo_time_;
+    bool has_memo_ = false;
+
+    static std::string read_line_once(const fs::path& p) {
+        PinnedFile f(p.string());
+        std::string_view line;
+        return f.read_line(line) ? std::string(line) : std::string();
+    }
+
+    // Only files that exist get a path, so absent attributes cost no syscall per tick.
+    static PinnedFile optional_file(const fs::path& p) {
+        std::error_code ec;
+        return fs::exists(p, ec) ? PinnedFile(p.string(), PinnedFile::kSingleShow) : PinnedFile();
+    }
+
+    static bool read_value(PinnedFile& f, double& v) {
+        return !f.path().empty() && f.read_double(v);
+    }
+
+    static PowerClass classify(const std::string& name) {
+        if (name.rfind("battery:", 0) == 0) return PowerClass::kBattery;
+        const std::string low = to_lower(name);
+        if (low.rfind("gpu:", 0) == 0 || contains_any(low, {"amdgpu", "radeon", "nvidia", "drm", "vddgfx", "gfx"})) {
+            return PowerClass::kGpu;
+        }
+        if (low.rfind("rapl:", 0) == 0 ||
+            contains_any(low, {"cpu", "package", "core", "k10temp", "coretemp", "vddcr_cpu", "vcore", "cpu_vdd", "tctl", "tdie"})) {
+            return PowerClass::kCpu;
+        }
+        if (low.rfind("disk:", 0) == 0 || contains_any(low, {"nvme", "ata", "ssd", "hdd", "sata", "wdc", "seagate", "sandisk"})) {
+            return PowerClass::kDisk;
+        }
+        if (low.rfind("net:", 0) == 0 || contains_any(low, {"ethernet", "wifi", "wlan", "iwlwifi", "r816", "rtl", "ath", "net"})) {
+            return PowerClass::kNet;
+        }
+        if (contains_any(low, {"dram", "memory", "ddr"})) return PowerClass::kMemory;
+        if (low.rfind("supply:", 0) == 0 ||
+            contains_any(low, {"pch", "soc", "board", "chipset", "vrm", "motherboard", "vddcr_soc", "3v", "5v", "12v", "aux"})) {
+            return PowerClass::kBoard;
+        }
+        return PowerClass::kOther;
+    }
+
+    const SourceInfo* intern(const std::string& name) {
+        auto [it, inserted] = infos_.try_emplace(name);
+        if (inserted) {
+            SourceInfo& info = it->second;
+            info.name = name;
+            info.cls = classify(name);
+            info.meta = source_meta(name);
+            info.score = dedupe_score(name);
+        }
+        return &it->second;
+    }
+
+    static bool likely_duplicate_sensor(const Reading& a, const Reading& b) {
+        const SourceMeta& ma = a.info->meta;
+        const SourceMeta& mb = b.info->meta;
+        if (ma.cls.empty() || mb.cls.empty()) return false;
+        if (ma.cls != mb.cls) return false;
+        if (!ma.entity.empty() && !mb.entity.empty() && ma.entity != mb.entity) return false;
+
+        const double max_w = std::max(std::abs(a.w), std::abs(b.w));
+        const double eps = std::max(0.35, max_w * 0.03);
+        return std::abs(a.w - b.w) <= eps;
+    }
+
+    bool needs_discovery(std::chrono::steady_clock::time_point now) {
+        // Drain uevents every tick so a burst does not linger in the socket.
+        const bool topology_changed = topology_.changed();
+        if (!indexed_ || rescan_requested_ || topology_changed) return true;
+        if (now - last_discovery_ >= kRediscoverPeriod) return true;
+        return read_failed_ && now - last_discovery_ >= kFailureRediscoverGap;
+    }
+
+    void discover(std::chrono::steady_clock::time_point now) {
+        infos_.clear();
+        power_inputs_.clear();
+        rails_.clear();
+        rapl_.clear();
+        supplies_.clear();
+        blocked_static_.clear();
+
+        std::unordered_set<std::string> live_zones;
+        discover_hwmon();
+        // DRM GPU power often points to the same hwmon files as discover_hwmon(),
+        // which can double-count AMD PPT on many systems. Keep hwmon as canonical source.
+        discover_nvme();
+        discover_rapl(live_zones);
+        discover_power_supply();
+
+        for (auto it = rapl_prev_.begin(); it != rapl_prev_.end();) {
+            if (live_zones.count(it->first)) ++it;
+            else it = rapl_prev_.erase(it);
+        }
+        std::sort(blocked_static_.begin(), blocked_static_.end());
+        blocked_static_.erase(std::unique(blocked_static_.begin(), blocked_static_.end()), blocked_static_.end());
+
+        indexed_ = true;
+        rescan_requested_ = false;
+        read_failed_ = false;
+        last_discovery_ = now;
+        ++discoveries_;
+        last_discovery_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - now).count();
+    }
+
+    void discover_hwmon() {
+        const fs::path hwmon_root(root_.resolve("/sys/class/hwmon"));
+        if (!fs::exists(hwmon_root)) return;
+
+        for (const auto& hw : fs::directory_iterator(hwmon_root)) {
+            if (!hw.is_directory()) continue;
+
+            const std::string chip = sanitize_label(read_line_once(hw.path() / "name"));
+            const std::string prefix = chip.empty() ? std::string("hwmon:") : "hwmon:" + chip + ":";
+            std::map<int, fs::path> in_input;
+            std::unordered_map<int, fs::path> curr_input;
+            std::unordered_map<int, std::string> in_label;
+            std::unordered_map<int, std::string> curr_label;
+            for (const auto& f : fs::directory_iterator(hw.path())) {
+                const std::string fname = f.path().filename().string();
+                if (!f.is_regular_file()) continue;
+
+                // Direct power files (microwatts in most drivers).
+                if (fname.rfind("power", 0) == 0 &&
+                    (fname.find("_input") != std::string::npos || fname.find("_average") != std::string::npos)) {
+                    const std::string suffix = (fname.find("_input") != std::string::npos) ? "_input" : "_average";
+                    const std::string sensor = fname.substr(0, fname.find(suffix));
+                    std::string label = sanitize_label(read_line_once(hw.path() / (sensor + "_label")));
+                    if (label.empty()) label = sensor;
+                    if (!can_read_file(f.path())) {
+                        blocked_static_.push_back(prefix + label);
+                        continue;
+                    }
+                    power_inputs_.push_back(
+                        {intern(prefix + label), PinnedFile(f.path().string(), PinnedFile::kSingleShow)});
+                    continue;
+                }
+
+                // Voltage/current channels for computed power.
+                if (fname.rfind("in", 0) == 0 && fname.find("_input") != std::string::npos) {
+                    const int idx = parse_sensor_index(fname, "in");
+                    if (idx >= 0) in_input[idx] = f.path();
+                } else if (fname.rfind("curr", 0) == 0 && fname.find("_input") != std::string::npos) {
+                    const int idx = parse_sensor_index(fname, "curr");
+                    if (idx >= 0) curr_input[idx] = f.path();
+                } else if (fname.rfind("in", 0) == 0 && fname.find("_label") != std::string::npos) {
+                    const int idx = parse_sensor_index(fname, "in");
+                    if (idx >= 0) in_label[idx] = sanitize_label(read_line_once(f.path()));
+                } else if (fname.rfind("curr", 0) == 0 && fname.find("_label") != std::string::npos) {
+                    const int idx = parse_sensor_index(fname, "curr");
+                    if (idx >= 0) curr_label[idx] = sanitize_label(read_line_once(f.path()));
+                }
+            }
+
+            // Derived power from V * I channels (common on VRM/board controllers).
+            for (const auto& [idx, in_path] : in_input) {
+                const auto itc = curr_input.find(idx);
+                if (itc == curr_input.end()) continue;
+
+                std::string label = in_label[idx];
+                if (label.empty()) label = curr_label[idx];
+                if (label.empty()) label = "rail" + std::to_string(idx);
+
+                std::string name = "hwmon_vi:";
+                if (!chip.empty()) name += chip + ":";
+                name += label;
+                rails_.push_back({intern(name), PinnedFile(in_path.string(), PinnedFile::kSingleShow),
+                                  PinnedFile(itc->second.string(), PinnedFile::kSingleShow)});
+            }
+        }
+    }
+
+    void discover_nvme() {
+        const fs::path nvme_root(root_.resolve("/sys/class/nvme"));
+        if (!fs::exists(nvme_root)) return;
+
+        for (const auto& e : fs::directory_iterator(nvme_root)) {
+            if (!e.is_directory()) continue;
+            const std::string ctrl = e.path().filename().string();
+            if (ctrl.rfind("nvme", 0) != 0) continue;
+
+            const fs::path hwmon_dir = e.path() / "device" / "hwmon";
+            if (!fs::exists(hwmon_dir)) continue;
+
+            for (const auto& hw : fs::directory_iterator(hwmon_dir)) {
+                if (!hw.is_directory()) continue;
+                for (const auto& f : fs::directory_iterator(hw.path())) {
+                    const std::string fn = f.path().filename().string();
+                    if (fn.rfind("power", 0) != 0 || fn.find("_input") == std::string::npos) continue;
+                    if (!f.is_regular_file()) continue;
+                    const std::string label = "disk:" + ctrl + ":" + fn.substr(0, fn.find("_input"));
+                    if (!can_read_file(f.path())) {
+                        blocked_static_.push_back(label);
+                        continue;
+                    }
+                    power_inputs_.push_back({intern(label), PinnedFile(f.path().string(), PinnedFile::kSingleShow)});
+                }
+            }
+        }
+    }
+
+    void discover_rapl(std::unordered_set<std::string>& live_zones) {
+        const fs::path rapl_root(root_.resolve("/sys/class/powercap"));
+        if (!fs::exists(rapl_root)) return;
+
+        // The class directory lists every zone and subzone as a symlink, so one flat pass finds them all.
+        for (const auto& e : fs::directory_iterator(rapl_root)) {
+            const fs::path zone = e.path();
+            const fs::path energy = zone / "energy_uj";
+            if (!fs::is_regular_file(energy)) continue;
+
+            std::string key = read_line_once(zone / "name");
+            if (key.empty()) key = zone.filename().string();
+            key = sanitize_label(key);
+            if (key.empty()) key = "rapl";
+            const std::string rlabel = "rapl:" + key;
+            if (!can_read_file(energy)) {
+                blocked_static_.push_back(rlabel);
+                continue;
+            }
+
+            RaplZone z;
+            z.info = intern(rlabel);
+            z.energy = PinnedFile(energy.string(), PinnedFile::kSingleShow);
+            PinnedFile max_file((zone / "max_energy_range_uj").string());
+            z.has_max = max_file.read_u64(z.max_range);
+            z.prev = &rapl_prev_[zone.string()];
+            live_zones.insert(zone.string());
+            rapl_.push_back(std::move(z));
+        }
+    }
+
+    void discover_power_supply() {
+        const fs::path root(root_.resolve("/sys/class/power_supply"));
+        if (!fs::exists(root)) return;
+
+        for (const auto& e : fs::directory_iterator(root)) {
+            if (!e.is_directory()) continue;
+            const std::string name = e.path().filename().string();
+            const std::string type = sanitize_label(read_line_once(e.path() / "type"));
+
+            SupplyInput s;
+            s.battery = name.rfind("BAT", 0) == 0 || type == "Battery";
+            s.info = intern((s.battery ? "battery:" : "supply:") + name);
+            const fs::path p_pow = e.path() / "power_now";
+            const fs::path p_cur = e.path() / "current_now";
+            const fs::path p_vol = e.path() / "voltage_now";
+            s.power_now = optional_file(p_pow);
+            s.current_now = optional_file(p_cur);
+            s.voltage_now = optional_file(p_vol);
+            if (s.battery) {
+                s.status = optional_file(e.path() / "status");
+                s.capacity = optional_file(e.path() / "capacity");
+            } else {
+                s.mains = type == "Mains" || type == "USB" || name.rfind("AC", 0) == 0 || name.rfind("ADP", 0) == 0;
+                if (s.mains) s.online = optional_file(e.path() / "online");
+                s.perm_blocked = (fs::exists(p_pow) && !can_read_file(p_pow)) ||
+                                 ((fs::exists(p_cur) || fs::exists(p_vol)) && (!can_read_file(p_cur) || !can_read_file(p_vol)));
+            }
+            supplies_.push_back(std::move(s));
+        }
+    }
+
+    void push_reading(const SourceInfo* info, double watts) {
+        if (watts < 0.0 || watts > 3000.0) return;
+        readings_.push_back({info, watts});
+    }
+
+    void read_power_inputs() {
+        for (auto& in : power_inputs_) {
+            unsigned long long raw = 0ULL;
+            if (!in.file.read_u64(raw)) {
+                read_failed_ = true;
+                continue;
+            }
+            if (raw == 0ULL) continue;
+            push_reading(in.info, static_cast<double>(raw) / 1'000'000.0);
+        }
+    }
+
+    void read_rails() {
+        for (auto& r : rails_) {
+            unsigned long long mv = 0ULL;
+            unsigned long long ma = 0ULL;
+            if (!r.in_file.read_u64(mv) || !r.curr_file.read_u64(ma)) {
+                read_failed_ = true;
+                continue;
+            }
+            if (mv == 0ULL || ma == 0ULL) continue;
+            const double watts = (static_cast<double>(mv) / 1000.0) * (static_cast<double>(ma) / 1000.0);
+            if (watts > 3000.0) continue;
+            push_reading(r.info, watts);
+        }
+    }
+
+    void read_rapl(std::chrono::steady_clock::time_point now) {
+        for (auto& z : rapl_) {
+            unsigned long long energy_uj = 0ULL;
+            if (!z.energy.read_u64(energy_uj)) {
+                read_failed_ = true;
+                continue;
+            }
+
+            RaplPrev& prev = *z.prev;
+            if (!prev.valid) {
+                prev.energy_uj = energy_uj;
+                prev.ts = now;
+                prev.valid = true;
+                continue;
+            }
+
+            const double elapsed_s = std::chrono::duration<double>(now - prev.ts).count();
+            if (elapsed_s <= 0.0001) continue;
+
+            const unsigned long long delta_uj = lxrate::delta_wrapped(energy_uj, prev.energy_uj, z.has_max ? z.max_range : 0ULL);
+
+            prev.energy_uj = energy_uj;
+            prev.ts = now;
+
+            if (delta_uj == 0ULL) continue;
+            push_reading(z.info, (static_cast<double>(delta_uj) / 1'000'000.0) / elapsed_s);
+        }
+    }
+
+    static bool read_supply_power(SupplyInput& s, double& power_uW) {
+        if (read_value(s.power_now, power_uW)) return true;
+        double current_uA = 0.0;
+        double voltage_uV = 0.0;
+        if (read_value(s.current_now, current_uA) && read_value(s.voltage_now, voltage_uV)) {
+            power_uW = (current_uA * voltage_uV) / 1'000'000.0;
+            return true;
+        }
+        return false;
+    }
+
+    // Supply attributes can legitimately fail (ENODATA while idle), so they do not force a rediscovery.
+    void read_power_supply(Snapshot& snap) {
+        double cap_sum = 0.0;
+        int cap_count = 0;
+
+        for (auto& s : supplies_) {
+            double power_uW = 0.0;
+            const bool ok_pow = read_supply_power(s, power_uW);
+
+            if (s.battery) {
+                snap.has_battery = true;
+                snap.battery_count += 1;
+                if (ok_pow && power_uW > 0.0) {
+                    const double w = power_uW / 1'000'000.0;
+                    snap.battery_total_w += w;
+                    std::string_view status;
+                    const std::string st = (!s.status.path().empty() && s.status.read_line(status)) ? to_lower(std::string(status)) : std::string();
+                    if (st.find("discharg") != std::string::npos) snap.battery_discharge_w += w;
+                    if (st.find("charg") != std::string::npos) snap.battery_charge_w += w;
+                    push_reading(s.info, w);
+                }
+
+                double cap = 0.0;
+                if (read_value(s.capacity, cap)) {
+                    cap_sum += cap;
+                    cap_count += 1;
+                }
+                continue;
+            }
+
+            double online = 0.0;
+            if (s.mains && read_value(s.online, online) && online > 0.5) snap.ac_online = true;
+
+            if (ok_pow && power_uW > 0.0) {
+                push_reading(s.info, power_uW / 1'000'000.0);
+            } else if (s.perm_blocked) {
+                snap.blocked_sources.push_back(s.info->name);
+            }
+        }
+
+        if (cap_count > 0) {
+            snap.battery_capacity_avg = cap_sum / static_cast<double>(cap_count);
+        }
+    }
+
+    const Snapshot& sample() {
+        const auto now = std::chrono::steady_clock::now();
+        if (has_memo_ && now - memo_time_ < kMemoWindow) return memo_;
+        if (needs_discovery(now)) discover(now);
+        collect_snapshot(memo_, now);
+        memo_time_ = now;
+        has_memo_ = true;
+        return memo_;
+    }
+
+    void collect_snapshot(Snapshot& snap, std::chrono::steady_clock::time_point now) {
+        auto sources = std::move(snap.sources_w);
+        auto blocked = std::move(snap.blocked_sources);
+        snap = Snapshot{};
+        sources.clear();
+        blocked.assign(blocked_static_.begin(), blocked_static_.end());
+        snap.blocked_sources = std::move(blocked);
+
+        readings_.clear();
+        read_power_inputs();
+        read_rails();
+        read_rapl(now);
+        read_power_supply(snap);
+
+        // Same-name readings (e.g. powerN_input and powerN_average) are summed.
+        std::sort(readings_.begin(), readings_.end(), [](const Reading& a, const Reading& b) {
+            return a.info->name < b.info->name;
+        });
+        size_t merged = 0;
+        for (size_t i = 0; i < readings_.size(); ++i) {
+            if (merged > 0 && readings_[merged - 1].info == readings_[i].info) {
+                readings_[merged - 1].w += readings_[i].w;
+            } else {
+                readings_[merged++] = readings_[i];
+            }
+        }
+        readings_.resize(merged);
+
+        // Deduplicate likely same sensor exposed under multiple paths/names.
+        std::vector<bool> drop(readings_.size(), false);
+        for (size_t i = 0; i < readings_.size(); ++i) {
+            if (drop[i]) continue;
+            for (size_t j = i + 1; j < readings_.size(); ++j) {
+                if (drop[j]) continue;
+                if (!likely_duplicate_sensor(readings_[i], readings_[j])) continue;
+                if (readings_[i].info->score >= readings_[j].info->score) drop[j] = true;
+                else drop[i] = true;
+            }
+        }
+
+        double component_total_w = 0.0;
+        sources.reserve(readings_.size());
+        for (size_t i = 0; i < readings_.size(); ++i) {
+            if (drop[i]) continue;
+            const SourceInfo& info = *readings_[i].info;
+            const double w = readings_[i].w;
+            sources.emplace_back(info.name, w);
+            if (info.cls == PowerClass::kBattery) continue;
+            component_total_w += w;
+            switch (info.cls) {
+                case PowerClass::kGpu: snap.gpu_w += w; break;
+                case PowerClass::kCpu: snap.cpu_w += w; break;
+                case PowerClass::kDisk: snap.disk_w += w; break;
+                case PowerClass::kNet: snap.net_w += w; break;
+                case PowerClass::kMemory: snap.memory_w += w; break;
+                case PowerClass::kBoard: snap.board_w += w; break;
+                default: snap.other_w += w; break;
+            }
+        }
+
+        if (component_total_w > 0.01) {
+            snap.total_w = component_total_w;
+            snap.total_source = "components";
+        } else if (snap.battery_total_w > 0.01) {
+            snap.total_w = snap.battery_total_w;
+            snap.total_source = "battery";
+        } else {
+            snap.total_w = 0.0;
+            snap.total_source = "none";
+        }
+
+        snap.sources_w = std::move(sources);
+        std::sort(snap.blocked_sources.begin(), snap.blocked_sources.end());
+        snap.blocked_sources.erase(std::unique(snap.blocked_sources.begin(), snap.blocked_sources.end()), snap.blocked_sources.end());
+    }
+};
@@ -0,0 +1,561 @@
+#pragma once
+
+// pybind11 conversions shared by the engine bindings and the sampler module.
+// Engine headers stay free of Python types; only the .cpp bindings include this.
+
+#include <pybind11/pybind11.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bt_engine.h"
+#include "cgroup_engine.h"
+#include "cpu_engine.h"
+#include "deferred_engine.h"
+#include "disc_engine.h"
+#include "gpu_cards.h"
+#include "granted_fds.h"
+#include "history_store.h"
+#include "net_engine.h"
+#include "pressure_engine.h"
+#include "process_engine.h"
+#include "psu_engine.h"
+#include "sampler_snapshot.h"
+#include "source_root.h"
+#include "sysinfo_engine.h"
+
+namespace lxpy {
+
+namespace py = pybind11;
+
+// Engine classes (cpu.Engine, net.Engine, ...) read from root="" (the host), a directory (chroot,
+// bind-mounted tree, recorded fixture) or pid=N (the container of process N); see source_root.h.
+inline SourceRoot source_root_arg(const std::string& root, int pid) {
+    if (pid > 0 && !root.empty()) throw std::invalid_argument("pass root or pid, not both");
+    return pid > 0 ? SourceRoot::for_pid(pid) : SourceRoot::at(root);
+}
+
+template <typename Engine>
+inline std::unique_ptr<Engine> make_engine(const std::string& root, int pid) {
+    return std::make_unique<Engine>(source_root_arg(root, pid));
+}
+
+template <typename Engine>
+inline DeferredEngine<Engine>& default_slot() {
+    static DeferredEngine<Engine> slot;
+    return slot;
+}
+
+// Modules call this at import. Discovery runs on its own thread, so the import returns at once,
+// all modules discover concurrently, and by the first call there is a baseline to diff against.
+template <typename Engine>
+inline void start_default_engine() {
+    default_slot<Engine>().start([] { return std::make_unique<Engine>(); });
+}
+
+// Backs each module's ready(): True once the free functions no longer wait for discovery.
+template <typename Engine>
+inline bool default_engine_ready() {
+    return default_slot<Engine>().ready();
+}
+
+// Host instance behind a module's free functions; the first call waits for discovery without the GIL.
+template <typename Engine>
+inline Engine& default_engine() {
+    auto& slot = default_slot<Engine>();
+    if (!slot.started()) start_default_engine<Engine>();
+    if (!slot.ready()) {
+        auto pending = slot.future();
+        py::gil_scoped_release unlocked;
+        pending.wait();
+    }
+    return slot.get();
+}
+
+// Registers m.ready() for a module whose free functions use default_engine<Engine>().
+template <typename Engine>
+inline void def_ready(py::module_& m) {
+    m.def("ready", &default_engine_ready<Engine>, "True once discovery finished; earlier calls wait for it");
+}
+
+// Registers m.adopt_fds() / m.granted_paths() for modules whose engines read files the privileged
+// helper may hold open for them (see granted_fds.h).
+inline void def_granted_fds(py::module_& m) {
+    m.def(
+        "adopt_fds",
+        [](const py::dict& fds) {
+            size_t adopted = 0;
+            for (auto item : fds) {
+                if (granted_fds().adopt(py::cast<std::string>(item.first), py::cast<int>(item.second))) ++adopted;
+            }
+            return adopted;
+        },
+        py::arg("fds"),
+        "Keeps duplicates of {path: fd} (privilege.granted_fds()); reads of those paths use them when open() is denied");
+    m.def(
+        "granted_paths",
+        [] {
+            py::list out;
+            for (const auto& p : granted_fds().paths()) out.append(py::str(p));
+            return out;
+        },
+        "Paths with an adopted fd (requested and canonical form)");
+}
+
+inline std::vector<std::string> strings_from_iterable(const py::iterable& items) {
+    std::vector<std::string> out;
+    for (auto item : items) out.push_back(py::cast<std::string>(item));
+    return out;
+}
+
+inline py::list strings_to_list(const std::vector<std::string>& items) {
+    py::list out;
+    for (const auto& s : items) out.append(py::str(s));
+    return out;
+}
+
+template <typename Pairs>
+inline py::dict pairs_to_dict(const Pairs& pairs) {
+    py::dict out;
+    for (const auto& [key, value] : pairs) out[py::str(key)] = value;
+    return out;
+}
+
+inline py::dict bt_to_dict(const std::vector<BtActivityEngine::AdapterSample>& all) {
+    py::dict out;
+    for (const auto& s : all) {
+        py::dict item;
+        item["name"] = py::str(s.meta.name.empty() ? s.adapter : s.meta.name);
+        item["rx_mbps"] = s.rx_mbps;
+        item["tx_mbps"] = s.tx_mbps;
+        item["mbps"] = s.rx_mbps + s.tx_mbps;
+        item["address"] = py::str(s.meta.address);
+        item["driver"] = py::str(s.meta.driver);
+        item["slot"] = py::str(s.meta.slot);
+        item["vendor_id"] = py::str(s.meta.vendor_id);
+        item["device_id"] = py::str(s.meta.device_id);
+        item["chipset"] = s.meta.chipset.empty() ? py::object(py::none()) : py::object(py::str(s.meta.chipset));
+        item["rfkill_blocked"] = py::bool_(s.meta.rfkill_blocked);
+        item["connected_devices"] = s.meta.connected_devices;
+        out[py::str(s.adapter)] = item;
+    }
+    return out;
+}
+
+inline py::dict disc_stats_to_dict(const std::vector<DiscActivityEngine::DiskRecord>& all) {
+    py::dict out;
+    for (const auto& r : all) {
+        py::dict item;
+        item["disk"] = py::str(r.disk);
+        item["util_pct"] = r.util_pct;
+        item["read_mib_s"] = r.read_mib_s;
+        item["write_mib_s"] = r.write_mib_s;
+        item["read_iops"] = r.read_iops;
+        item["write_iops"] = r.write_iops;
+        item["read_await_ms"] = r.read_await_ms;
+        item["write_await_ms"] = r.write_await_ms;
+        item["await_ms"] = r.await_ms;
+        item["queue_depth"] = r.queue_depth;
+        item["in_flight"] = r.in_flight;
+        out[py::str(r.label)] = item;
+    }
+    return out;
+}
+
+inline py::dict net_rates_to_dict(const std::vector<NetActivityEngine::IfRates>& all) {
+    py::dict out;
+    for (const auto& r : all) {
+        py::dict item;
+        item["rx_mbps"] = r.rx_mbps;
+        item["tx_mbps"] = r.tx_mbps;
+        item["rx_pps"] = r.rx_pps;
+        item["tx_pps"] = r.tx_pps;
+        item["rx_errs"] = r.rx_errs;
+        item["tx_errs"] = r.tx_errs;
+        item["rx_drops"] = r.rx_drops;
+        item["tx_drops"] = r.tx_drops;
+        out[py::str(r.name)] = item;
+    }
+    return out;
+}
+
+inline py::list proc_samples_to_list(const std::vector<ProcessActivityEngine::ProcSample>& all) {
+    py::list out;
+    for (const auto& p : all) {
+        py::dict item;
+        item["pid"] = p.pid;
+        item["name"] = py::str(p.name);
+        item["state"] = py::str(std::string(1, p.state));
+        item["threads"] = p.threads;
+        item["cpu_pct"] = p.cpu_pct;
+        item["rss_bytes"] = p.rss_bytes;
+        item["read_bps"] = p.read_bps;
+        item["write_bps"] = p.write_bps;
+        out.append(item);
+    }
+    return out;
+}
+
+inline py::dict proc_top_to_dict(const ProcessActivityEngine::TopLists& top) {
+    py::dict out;
+    out["cpu"] = proc_samples_to_list(top.by_cpu);
+    out["rss"] = proc_samples_to_list(top.by_rss);
+    out["io"] = proc_samples_to_list(top.by_io);
+    out["processes"] = top.processes;
+    out["threads"] = top.threads;
+    out["pinned_fds"] = top.pinned_fds;
+    return out;
+}
+
+inline py::list cgroup_samples_to_list(const std::vector<CgroupEngine::CgroupSample>& all) {
+    py::list out;
+    for (const auto& c : all) {
+        py::dict item;
+        item["path"] = py::str(c.path);
+        item["depth"] = c.depth;
+        item["cpu_pct"] = c.cpu_pct;
+        item["user_pct"] = c.user_pct;
+        item["system_pct"] = c.system_pct;
+        item["throttled_pct"] = c.throttled_pct;
+        item["memory_bytes"] = c.memory_bytes;
+        item["memory_some_pct"] = c.memory_some_pct;
+        item["memory_full_pct"] = c.memory_full_pct;
+        item["read_bps"] = c.read_bps;
+        item["write_bps"] = c.write_bps;
+        item["read_iops"] = c.read_iops;
+        item["write_iops"] = c.write_iops;
+        item["age_s"] = c.age_s;
+        out.append(item);
+    }
+    return out;
+}
+
+inline py::dict cgroup_top_to_dict(const CgroupEngine::TopLists& top) {
+    py::dict out;
+    out["cpu"] = cgroup_samples_to_list(top.by_cpu);
+    out["memory"] = cgroup_samples_to_list(top.by_memory);
+    out["io"] = cgroup_samples_to_list(top.by_io);
+    out["cgroups"] = top.cgroups;
+    out["read"] = top.read;
+    out["pinned_fds"] = top.pinned_fds;
+    out["available"] = top.available;
+    return out;
+}
+
+// {'cpu'|'memory'|'io': {some, full, some_avg10, ...} or None without PSI, 'vm': {...rates, counters}}.
+inline py::dict pressure_to_dict(const PressureEngine::Snapshot& s) {
+    py::dict out;
+    for (int r = 0; r < kPsiResourceCount; ++r) {
+        const PressureEngine::Resource& res = s.resources[r];
+        if (!res.available) {
+            out[psi_resource_name(r)] = py::none();
+            continue;
+        }
+        py::dict d;
+        d["some"] = res.some_pct;
+        d["full"] = res.full_pct;
+        d["some_avg10"] = res.psi.some.avg10;
+        d["some_avg60"] = res.psi.some.avg60;
+        d["some_avg300"] = res.psi.some.avg300;
+        d["full_avg10"] = res.psi.full.avg10;
+        d["full_avg60"] = res.psi.full.avg60;
+        d["full_avg300"] = res.psi.full.avg300;
+        d["some_total_us"] = res.psi.some.total_us;
+        d["full_total_us"] = res.psi.full.total_us;
+        d["has_full"] = res.psi.has_full;
+        out[psi_resource_name(r)] = d;
+    }
+    if (s.has_vmstat) {
+        py::dict vm;
+        vm["majfault_ps"] = s.majfault_ps;
+        vm["swapin_ps"] = s.swapin_ps;
+        vm["swapout_ps"] = s.swapout_ps;
+        vm["pgscan_ps"] = s.pgscan_ps;
+        vm["pgsteal_ps"] = s.pgsteal_ps;
+        vm["allocstall_ps"] = s.allocstall_ps;
+        vm["oom_kills"] = s.oom_kills;
+        vm["pgmajfault"] = s.vm.pgmajfault;
+        vm["pswpin"] = s.vm.pswpin;
+        vm["pswpout"] = s.vm.pswpout;
+        vm["oom_kill"] = s.vm.oom_kill;
+        out["vm"] = vm;
+    } else {
+        out["vm"] = py::none();
+    }
+    out["interval_s"] = s.interval_s;
+    return out;
+}
+
+// Same keys the worker's Python collectors produce (cpu_temp, sys_*, net_meta), plus gpu_cards identity.
+// Values the host does not expose are None.
+inline py::dict sysinfo_to_dict(const SysInfoEngine::Snapshot& s) {
+    auto opt_str = [](const std::string& v) { return v.empty() ? py::object(py::none()) : py::object(py::str(v)); };
+    auto opt_int = [](long long v) { return v < 0 ? py::object(py::none()) : py::object(py::int_(v)); };
+    py::dict out;
+    out["cpu_temp"] = std::isnan(s.cpu_temp_c) ? py::object(py::none()) : py::object(py::float_(s.cpu_temp_c));
+    out["cpu_temp_source"] = opt_str(s.cpu_temp_source);
+    out["sys_processes_total"] = opt_int(s.processes_total);
+    out["sys_procs_running"] = opt_int(s.procs_running);
+    out["sys_procs_blocked"] = opt_int(s.procs_blocked);
+    out["sys_uptime_s"] = s.uptime_s < 0.0 ? py::object(py::none()) : py::object(py::float_(s.uptime_s));
+    out["sys_load_1m"] = s.has_load ? py::object(py::float_(s.load_1m)) : py::object(py::none());
+    out["sys_load_5m"] = s.has_load ? py::object(py::float_(s.load_5m)) : py::object(py::none());
+    out["sys_load_15m"] = s.has_load ? py::object(py::float_(s.load_15m)) : py::object(py::none());
+    out["sys_mem_total_kb"] = opt_int(s.mem_total_kb);
+    out["sys_mem_available_kb"] = opt_int(s.mem_available_kb);
+    out["sys_swap_total_kb"] = opt_int(s.swap_total_kb);
+    out["sys_swap_free_kb"] = opt_int(s.swap_free_kb);
+    out["sys_cpu_count"] = s.cpu_count > 0 ? py::object(py::int_(s.cpu_count)) : py::object(py::none());
+    out["sys_cpu_vendor"] = opt_str(s.cpu_vendor);
+    out["sys_cpu_packages"] = opt_int(s.cpu_packages);
+    py::dict net;
+    for (const auto& m : s.ifaces) {
+        py::dict d;
+        d["slot"] = opt_str(m.slot);
+        d["driver"] = opt_str(m.driver);
+        d["vendor_id"] = opt_str(m.vendor_id);
+        d["device_id"] = opt_str(m.device_id);
+        d["mac"] = opt_str(m.mac);
+        d["operstate"] = opt_str(m.operstate);
+        d["speed_mbps"] = opt_int(m.speed_mbps);
+        d["physical"] = m.has_device;
+        net[py::str(m.name)] = d;
+    }
+    out["net_meta"] = net;
+    py::list gpus;
+    for (const auto& g : s.gpus) {
+        py::dict d;
+        d["card"] = py::str(g.card);
+        d["slot"] = opt_str(g.slot);
+        d["driver"] = opt_str(g.driver);
+        d["vendor_id"] = opt_str(g.vendor_id);
+        d["device_id"] = opt_str(g.device_id);
+        gpus.append(d);
+    }
+    out["gpu_cards"] = gpus;
+    return out;
+}
+
+inline PsiTriggerSpec psi_trigger_spec(const std::string& resource, const std::string& kind, double stall_ms, double window_ms) {
+    PsiTriggerSpec spec;
+    spec.resource = psi_resource_from_name(resource);
+    if (spec.resource < 0) throw std::invalid_argument("resource must be 'cpu', 'memory' or 'io'");
+    if (kind != "some" && kind != "full") throw std::invalid_argument("kind must be 'some' or 'full'");
+    if (stall_ms <= 0.0 || window_ms <= 0.0) throw std::invalid_argument("stall_ms and window_ms must be positive");
+    spec.full = kind == "full";
+    spec.stall_us = static_cast<uint32_t>(stall_ms * 1000.0);
+    spec.window_us = static_cast<uint32_t>(window_ms * 1000.0);
+    return spec;
+}
+
+// {'resource': 'memory', 'kind': 'some', 'stall_ms': 150, 'window_ms': 2000}; missing keys take these defaults.
+inline PsiTriggerSpec psi_trigger_from_dict(const py::dict& d) {
+    auto get = [&](const char* key, const char* fallback) {
+        return d.contains(key) ? py::cast<std::string>(d[key]) : std::string(fallback);
+    };
+    auto num = [&](const char* key, double fallback) { return d.contains(key) ? py::cast<double>(d[key]) : fallback; };
+    return psi_trigger_spec(get("resource", "memory"), get("kind", "some"), num("stall_ms", 150.0), num("window_ms", 2000.0));
+}
+
+inline std::vector<PsiTriggerSpec> psi_triggers_from_iterable(const py::iterable& items) {
+    std::vector<PsiTriggerSpec> out;
+    for (auto item : items) out.push_back(psi_trigger_from_dict(py::reinterpret_borrow<py::dict>(item)));
+    return out;
+}
+
+inline py::list psi_fired_to_list(uint32_t fired) {
+    py::list out;
+    for (int r = 0; r < kPsiResourceCount; ++r) {
+        if (fired & (1u << r)) out.append(py::str(psi_resource_name(r)));
+    }
+    return out;
+}
+
+// NaN (value not exposed) becomes None.
+inline py::object num_or_none(double v) {
+    return std::isfinite(v) ? py::object(py::float_(v)) : py::object(py::none());
+}
+
+inline py::list gpu_cards_to_list(const std::vector<GpuCardReading>& all) {
+    py::list out;
+    for (const auto& r : all) {
+        py::dict d;
+        d["card"] = r.card;
+        d["slot"] = r.slot;
+        d["driver"] = r.driver;
+        d["busy"] = num_or_none(r.busy_pct);
+        d["temp"] = num_or_none(r.temp_c);
+        out.append(d);
+    }
+    return out;
+}
+
+inline py::dict psu_to_dict(const PowerTelemetryEngine::Snapshot& snap) {
+    py::dict out;
+    out["total_w"] = snap.total_w;
+    out["source"] = snap.total_source;
+    out["has_battery"] = snap.has_battery;
+    out["battery_count"] = snap.battery_count;
+    out["ac_online"] = snap.ac_online;
+    out["battery_total_w"] = snap.battery_total_w;
+    out["battery_discharge_w"] = snap.battery_discharge_w;
+    out["battery_charge_w"] = snap.battery_charge_w;
+    out["battery_capacity_avg"] = snap.battery_capacity_avg;
+
+    out["cpu_w"] = snap.cpu_w;
+    out["gpu_w"] = snap.gpu_w;
+    out["disk_w"] = snap.disk_w;
+    out["net_w"] = snap.net_w;
+    out["board_w"] = snap.board_w;
+    out["memory_w"] = snap.memory_w;
+    out["other_w"] = snap.other_w;
+
+    out["sources"] = pairs_to_dict(snap.sources_w);
+    py::list blocked;
+    for (const auto& name : snap.blocked_sources) {
+        blocked.append(py::str(name));
+    }
+    out["blocked_sources"] = blocked;
+    return out;
+}
+
+// out=None -> a new dict; otherwise the caller's dict, refilled in place.
+inline py::dict dict_or_new(const py::object& out) {
+    if (out.is_none()) return py::dict();
+    return py::reinterpret_borrow<py::dict>(out);
+}
+
+// Refills out in place (same dict object every tick); keys of unsampled engines are dropped.
+inline void fill_snapshot_dict(const SamplerSnapshot& snap, py::dict& out) {
+    out.clear();
+    if (snap.generation == 0) return;
+
+    out["generation"] = snap.generation;
+    out["timestamp"] = snap.timestamp_s;
+    out["tick_ms"] = snap.tick_ms;
+
+    py::list sampled;
+    for (const auto& e : kSamplerEngines) {
+        if (snap.sampled & e.bit) sampled.append(py::str(e.name));
+    }
+    out["sampled"] = sampled;
+
+    py::list fresh;
+    for (const auto& e : kSamplerEngines) {
+        if (snap.fresh & e.bit) fresh.append(py::str(e.name));
+    }
+    out["fresh"] = fresh;
+
+    if (snap.sampled & kSampleCpu) {
+        out["cpu"] = snap.cpu;
+        out["cpu_cores"] = py::cast(snap.cpu_cores);
+    }
+    if (snap.sampled & kSampleRam) out["ram"] = snap.ram;
+
+    if (snap.sampled & kSampleDisc) {
+        if (!snap.disc_all.empty()) {
+            out["disc_all"] = pairs_to_dict(snap.disc_all);
+            out["disc_stats"] = disc_stats_to_dict(snap.disc_stats);
+        } else {
+            out["disc"] = snap.disc;
+        }
+    }
+
+    if (snap.sampled & kSampleNet) {
+        out["net_all"] = pairs_to_dict(snap.net_all);
+        out["net_ifaces"] = net_rates_to_dict(snap.net_ifaces);
+        out["net"] = snap.net;
+        out["net_rx"] = snap.net_rx;
+        out["net_tx"] = snap.net_tx;
+    }
+
+    if (snap.sampled & kSampleBt) out["bt_all"] = bt_to_dict(snap.bt_all);
+
+    if (snap.sampled & kSamplePsu) {
+        out["psu_all"] = psu_to_dict(snap.psu_all);
+        out["psu"] = snap.psu;
+    }
+
+    if (snap.sampled & kSampleGpuOthers) out["gpu_others"] = snap.gpu_others;
+    if (snap.sampled & kSampleGpuTemp) out["gpu_temp"] = snap.gpu_temp;
+    if (snap.sampled & (kSampleGpuOthers | kSampleGpuTemp)) out["gpu_cards"] = gpu_cards_to_list(snap.gpu_cards);
+
+    if (snap.sampled & kSamplePressure) {
+        py::dict p = pressure_to_dict(snap.pressure_all);
+        p["trigger_events"] = snap.pressure_events;
+        p["fired"] = psi_fired_to_list(snap.pressure_fired);
+        out["pressure_all"] = p;
+        out["pressure"] = snap.pressure;
+    }
+}
+
+// Registers CoreTable in m. memoryview(table) is a rows x columns float64 view and
+// numpy.asarray(table) wraps it without a copy; numpy itself is not required.
+// module_local: cpu and sampler both register it.
+inline void bind_core_table(py::module_& m) {
+    py::class_<CpuCoreTable>(m, "CoreTable", py::buffer_protocol(), py::module_local())
+        .def_buffer([](CpuCoreTable& t) -> py::buffer_info {
+            return py::buffer_info(
+                t.values.data(),
+                sizeof(double),
+                py::format_descriptor<double>::format(),
+                2,
+                {static_cast<py::ssize_t>(t.rows), static_cast<py::ssize_t>(kCoreColumns)},
+                {static_cast<py::ssize_t>(sizeof(double) * kCoreColumns), static_cast<py::ssize_t>(sizeof(double))});
+        })
+        .def_readonly("rows", &CpuCoreTable::rows)
+        .def_property_readonly(
+            "online",
+            [](const CpuCoreTable& t) {
+                return py::bytes(reinterpret_cast<const char*>(t.online.data()), t.online.size());
+            },
+            "One byte per cpu id: 1 when the core was in /proc/stat this sample")
+        .def_property_readonly(
+            "columns",
+            [](const CpuCoreTable&) {
+                py::list out;
+                for (const char* name : {"usage", "user", "system", "iowait", "steal"}) out.append(py::str(name));
+                return out;
+            });
+}
+
+// HistoryWindow exposes its avg column through the buffer protocol (numpy.asarray(w) does not copy)
+// and every column as a read-only memoryview over the store's ring.
+inline void bind_history_window(py::module_& m) {
+    auto column = [](const float* data, size_t n) -> py::object {
+        if (!data) return py::none();
+        return py::memoryview::from_buffer(data, {static_cast<py::ssize_t>(n)}, {static_cast<py::ssize_t>(sizeof(float))});
+    };
+    py::class_<HistoryWindow>(m, "HistoryWindow", py::buffer_protocol(), py::module_local())
+        .def_buffer([](HistoryWindow& w) -> py::buffer_info {
+            return py::buffer_info(
+                const_cast<float*>(w.avg),
+                sizeof(float),
+                py::format_descriptor<float>::format(),
+                1,
+                {static_cast<py::ssize_t>(w.points)},
+                {static_cast<py::ssize_t>(sizeof(float))},
+                true);
+        })
+        .def_property_readonly("tier", [](const HistoryWindow& w) { return py::str(kHistoryTiers[w.tier].name); })
+        .def_readonly("points", &HistoryWindow::points)
+        .def_readonly("period", &HistoryWindow::period_s)
+        .def_readonly("first_time", &HistoryWindow::first_time)
+        .def_property_readonly("avg", [column](const HistoryWindow& w) { return column(w.avg, w.points); })
+        .def_property_readonly("min", [column](const HistoryWindow& w) { return column(w.min, w.points); })
+        .def_property_readonly("max", [column](const HistoryWindow& w) { return column(w.max, w.points); })
+        .def_property_readonly(
+            "time",
+            [](const HistoryWindow& w) -> py::object {
+                if (!w.time) return py::none();
+                return py::memoryview::from_buffer(w.time, {static_cast<py::ssize_t>(w.points)}, {static_cast<py::ssize_t>(sizeof(double))});
+            },
+            "Sample timestamps (raw tier only; aggregated tiers are first_time + i * period)")
+        .def("__len__", [](const HistoryWindow& w) { return w.points; });
+}
+
+}  // namespace lxpy
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string_view>
+
+#include "pinned_file.h"
+#include "proc_parse.h"
+#include "source_root.h"
+
+class RamSensing {
+public:
+    explicit RamSensing(const SourceRoot& root = SourceRoot::host())
+        : meminfo_file(root.resolve("/proc/meminfo"), PinnedFile::kSingleShow) {}
+
+    double get_usage() {
+        std::string_view text;
+        if (!meminfo_file.read(text)) return 0.0;
+
+        // Linux przechowuje to w kB (kilobajtach)
+        lxproc::MemInfo mem;
+        if (!lxproc::parse_meminfo(text, mem)) return 0.0;
+        const long long total = mem.total;
+        long long available = mem.available;
+
+        // Older kernels can miss MemAvailable.
+        if (available < 0) {
+            available = mem.free + mem.buffers + mem.cached + mem.sreclaimable - mem.shmem;
+            if (available < 0) available = 0;
+        }
+
+        // Procentowe użycie RAM (to co faktycznie zajęte przez apki)
+        double used = static_cast<double>(total - available);
+        double pct = (used / static_cast<double>(total)) * 100.0;
+        if (pct < 0.0) return 0.0;
+        if (pct > 100.0) return 100.0;
+        return pct;
+    }
+
+private:
+    PinnedFile meminfo_file;
+};
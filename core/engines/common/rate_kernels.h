@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "isa_dispatch.h"
+
+// Counter arithmetic shared by the engines: wrap-safe deltas of monotonic kernel counters, rates,
+// clamping and reductions. The array forms run over flat counter tables (one value per item and
+// field, current and previous sample at the same index) and are compiled per ISA level
+// (LX_MULTIVERSION); the scalar forms give identical results for paths with a handful of items.
+namespace lxrate {
+
+using Counter = unsigned long long;
+
+// A counter that went backwards (device reset, driver reload) counts as no progress rather than as
+// 2^64 minus something. Decided on the sign of the 64-bit difference, so a counter that really
+// wrapped at 2^64 still gives its true delta. A branch-free shift and mask, which vectorizes on
+// every level (even SSE2 has no unsigned 64-bit compare).
+inline Counter delta(Counter cur, Counter prev) {
+    const Counter d = cur - prev;
+    return d & ((d >> 63) - 1ULL);
+}
+
+// For counters with a known wrap point (RAPL energy_uj wraps at max_energy_range_uj): cur < prev
+// is taken as exactly one wrap. Without a usable range it behaves like delta().
+inline Counter delta_wrapped(Counter cur, Counter prev, Counter range) {
+    if (cur >= prev) return cur - prev;
+    return range > prev ? (range - prev) + cur : 0ULL;
+}
+
+// delta() per second; elapsed_s > 0.
+inline double rate(Counter cur, Counter prev, double elapsed_s) { return static_cast<double>(delta(cur, prev)) / elapsed_s; }
+
+inline double clamp(double v, double lo, double hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+// Same value as static_cast<double>(v) (one rounding) from integer and FP ops only, so the loops
+// below vectorize without AVX-512DQ's vcvtuqq2pd: the two 32-bit halves are placed in the mantissas
+// of 2^84 and 2^52, the offsets subtracted exactly and the halves added.
+inline double to_double(Counter v) {
+    Counter hi_bits = (v >> 32) | 0x4530000000000000ULL;          // 2^84 + hi * 2^32
+    Counter lo_bits = (v & 0xFFFFFFFFULL) | 0x4330000000000000ULL;  // 2^52 + lo
+    double hi, lo;
+    std::memcpy(&hi, &hi_bits, sizeof hi);
+    std::memcpy(&lo, &lo_bits, sizeof lo);
+    return (hi - 19342813118337666422669312.0) + lo;  // 2^84 + 2^52
+}
+
+// out[i] = delta(cur[i], prev[i]). out may alias cur or prev.
+LX_MULTIVERSION inline void deltas(const Counter* cur, const Counter* prev, size_t n, Counter* out) {
+    for (size_t i = 0; i < n; ++i) out[i] = delta(cur[i], prev[i]);
+}
+
+// out[i] = delta(cur[i], prev[i]) * scale, scale being unit / elapsed_s (1 / elapsed_s for "per
+// second", 8e-6 / elapsed_s for Mbps from bytes).
+LX_MULTIVERSION inline void scaled_deltas(const Counter* cur, const Counter* prev, size_t n, double scale, double* out) {
+    for (size_t i = 0; i < n; ++i) out[i] = to_double(delta(cur[i], prev[i])) * scale;
+}
+
+// v[i] = clamp(v[i], lo, hi).
+LX_MULTIVERSION inline void clamp_all(double* v, size_t n, double lo, double hi) {
+    for (size_t i = 0; i < n; ++i) {
+        const double x = v[i] < lo ? lo : v[i];
+        v[i] = x > hi ? hi : x;
+    }
+}
+
+struct Reduction {
+    double sum = 0.0;
+    double max = 0.0;  // 0 for an empty range
+    size_t count = 0;
+
+    double avg() const { return count ? sum / static_cast<double>(count) : 0.0; }
+};
+
+// Sum and maximum of v[0..n). The sum is accumulated in eight lanes, so it may differ from a
+// left-to-right sum in the last bits (the same on every ISA level).
+LX_MULTIVERSION inline Reduction reduce(const double* v, size_t n) {
+    constexpr size_t kLanes = 8;
+    const double seed = n ? v[0] : 0.0;
+    double sum[kLanes] = {};
+    double max[kLanes] = {seed, seed, seed, seed, seed, seed, seed, seed};
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (size_t k = 0; k < kLanes; ++k) {
+            sum[k] += v[i + k];
+            max[k] = v[i + k] > max[k] ? v[i + k] : max[k];
+        }
+    }
+    for (size_t k = 0; k < n - i; ++k) {
+        sum[k] += v[i + k];
+        max[k] = v[i + k] > max[k] ? v[i + k] : max[k];
+    }
+    Reduction r;
+    r.count = n;
+    r.max = seed;
+    for (size_t k = 0; k < kLanes; ++k) {
+        r.sum += sum[k];
+        r.max = max[k] > r.max ? max[k] : r.max;
+    }
+    return r;
+}
+
+}  // namespace lxrate
@@ -0,0 +1,1027 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Append-only columnar recording of the dashboard's metric stream: one tick is the leaves of one
+// nested collected_data dict, each leaf a column keyed by (path, type). Written so a night can be
+// looked at afterwards and replayed into the dashboard.
+//
+// A recording is a directory of segments <prefix>-<UTC of the first tick>.lxrec. A segment is mapped
+// once at its maximum size and grown with ftruncate in 1 MiB steps. Ticks are buffered in the open
+// chunk and copied into the mapping when it closes (after chunk_ticks ticks or chunk_ms), so each
+// page is written once and a crash loses at most the open chunk. Past max_files segments or
+// max_total_bytes the oldest ones are deleted.
+//
+// Segment layout (little-endian, offsets in bytes):
+//   0  char[8]  magic "LXMONREC"       32 i64 first_ms (wall clock)
+//   8  u32      version                40 i64 last_ms
+//   12 u32      header_size (64)       48 u64 ticks
+//   16 u64      data_end               56 u32 flags (1 = closed cleanly)
+//   24 u64      chunk_count
+// Chunks follow the header, 8-byte aligned, each decodable on its own:
+//   u32 magic 'LXCK', u32 size (with header and padding), i64 first_ms, i64 last_ms,
+//   u32 ticks, u32 columns, u32 checksum (FNV-1a of the payload), u32 payload_size
+// Payload: zigzag varint delta-of-delta of the tick times after first_ms, then per column:
+//   varint path_len, path, u8 type, u8 encoding, varint present; a tick bitmap unless present == ticks;
+//   the present values:
+//     int/bool        zigzag varint deltas
+//     float           kEncScaled + k: value * 10^k as zigzag varint deltas (exact for up to k decimals),
+//                     kEncXor: XOR with the previous value, one control byte (0x80 | leading << 4 |
+//                     trailing zero bytes; 0 = unchanged) and the bytes between
+//     text            varint 0 = same as the previous value, else length + 1 and the bytes
+//     none/{}/[]      nothing
+// <segment>.idx holds one 32-byte entry per chunk (i64 first_ms, i64 last_ms, u64 offset, u32 ticks,
+// u32 size) for binary-search seeks; a missing or short index is rebuilt from the chunk headers.
+//
+// Paths are segments of a tag byte (kRecKey, kRecIntKey, kRecIndex), a varint length and the bytes.
+
+inline constexpr char kRecMagic[8] = {'L', 'X', 'M', 'O', 'N', 'R', 'E', 'C'};
+inline constexpr uint32_t kRecVersion = 1;
+inline constexpr uint32_t kRecHeaderSize = 64;
+inline constexpr uint32_t kRecChunkMagic = 0x4b43584c;  // "LXCK"
+inline constexpr uint32_t kRecChunkHeaderSize = 40;
+inline constexpr uint32_t kRecIndexEntrySize = 32;
+inline constexpr uint32_t kRecClosed = 1u << 0;
+inline constexpr size_t kRecGrowStep = 1 << 20;
+
+enum RecordType : uint8_t {
+    kRecInt = 1,
+    kRecFloat = 2,
+    kRecBool = 3,
+    kRecNone = 4,
+    kRecText = 5,
+    kRecEmptyDict = 6,
+    kRecEmptyList = 7,
+};
+
+enum RecordPathTag : char {
+    kRecKey = 1,     // str dict key
+    kRecIntKey = 2,  // int dict key, decimal
+    kRecIndex = 3,   // list/tuple index, decimal
+};
+
+inline constexpr uint8_t kEncPlain = 0;
+inline constexpr uint8_t kEncXor = 1;
+inline constexpr uint8_t kEncScaled = 0x80;  // | decimals
+inline constexpr int kRecMaxDecimals = 6;
+
+struct RecFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t data_end;
+    uint64_t chunk_count;
+    int64_t first_ms;
+    int64_t last_ms;
+    uint64_t ticks;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct RecChunkHeader {
+    uint32_t magic;
+    uint32_t size;
+    int64_t first_ms;
+    int64_t last_ms;
+    uint32_t ticks;
+    uint32_t columns;
+    uint32_t checksum;
+    uint32_t payload_size;
+};
+
+struct RecIndexEntry {
+    int64_t first_ms;
+    int64_t last_ms;
+    uint64_t offset;
+    uint32_t ticks;
+    uint32_t size;
+};
+
+static_assert(sizeof(RecFileHeader) == kRecHeaderSize, "RecFileHeader layout");
+static_assert(sizeof(RecChunkHeader) == kRecChunkHeaderSize, "RecChunkHeader layout");
+static_assert(sizeof(RecIndexEntry) == kRecIndexEntrySize, "RecIndexEntry layout");
+
+namespace lxrec {
+
+inline uint32_t fnv1a(const uint8_t* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+inline uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline void put_bytes(std::vector<uint8_t>& out, const void* p, size_t n) {
+    const auto* b = static_cast<const uint8_t*>(p);
+    out.insert(out.end(), b, b + n);
+}
+
+// Bounds-checked reader of one payload; any overrun clears ok() and yields zeros from then on.
+class Reader {
+public:
+    Reader(const uint8_t* p, size_t n) : p_(p), end_(p + n) {}
+
+    bool ok() const { return ok_; }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p_ >= end_) return fail();
+            const uint8_t b = *p_++;
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        return fail();
+    }
+
+    uint8_t byte() {
+        if (p_ >= end_) return static_cast<uint8_t>(fail());
+        return *p_++;
+    }
+
+    const uint8_t* bytes(size_t n) {
+        if (static_cast<size_t>(end_ - p_) < n) {
+            fail();
+            return nullptr;
+        }
+        const uint8_t* b = p_;
+        p_ += n;
+        return b;
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_ = true;
+
+    uint64_t fail() {
+        ok_ = false;
+        p_ = end_;
+        return 0;
+    }
+};
+
+inline uint64_t double_bits(double v) {
+    uint64_t b;
+    std::memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+inline double bits_double(uint64_t b) {
+    double v;
+    std::memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+inline constexpr double kPow10[kRecMaxDecimals + 1] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6};
+
+// Fewest decimals (0..kRecMaxDecimals) that v round-trips through exactly, or -1.
+inline int exact_decimals(double v) {
+    if (!std::isfinite(v)) return -1;
+    for (int k = 0; k <= kRecMaxDecimals; ++k) {
+        const double s = v * kPow10[k];
+        if (std::fabs(s) >= 9.0e15) return -1;
+        const double r = static_cast<double>(std::llround(s)) / kPow10[k];
+        if (double_bits(r) == double_bits(v)) return k;
+    }
+    return -1;
+}
+
+inline double round_decimals(double v, int k) {
+    if (k < 0 || !std::isfinite(v)) return v;
+    const double s = v * kPow10[k];
+    if (std::fabs(s) >= 9.0e15) return v;
+    return static_cast<double>(std::llround(s)) / kPow10[k];
+}
+
+inline bool is_map(const void* p) { return p != MAP_FAILED && p != nullptr; }
+
+// Segment name for a first tick at ms: <prefix>-YYYYmmdd-HHMMSS-mmm.lxrec (UTC), sorting by time.
+inline std::string segment_name(const std::string& prefix, int64_t ms) {
+    const time_t secs = static_cast<time_t>(ms / 1000);
+    std::tm tm{};
+    ::gmtime_r(&secs, &tm);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "-%04d%02d%02d-%02d%02d%02d-%03d.lxrec", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms % 1000));
+    return prefix + buf;
+}
+
+}  // namespace lxrec
+
+struct RecorderConfig {
+    std::string directory;
+    std::string prefix = "lxmon";
+    size_t max_file_bytes = 64u << 20;
+    size_t max_files = 8;
+    size_t max_total_bytes = 0;  // 0: only max_files bounds the directory
+    uint32_t chunk_ticks = 120;  // 30 s at 4 Hz
+    int64_t chunk_ms = 30'000;
+    int float_decimals = -1;  // >= 0: floats rounded to that many decimals (lossy, much smaller)
+};
+
+struct RecorderStats {
+    std::string segment;
+    uint64_t segments_written = 0;
+    uint64_t segments_deleted = 0;
+    uint64_t chunks = 0;
+    uint64_t ticks = 0;
+    uint64_t values = 0;
+    uint64_t bytes = 0;  // chunk bytes written, all segments
+    uint64_t series = 0;  // columns seen in the open segment
+    uint32_t open_ticks = 0;  // buffered in the open chunk
+};
+
+// Single-threaded writer. Per tick: begin_tick(), one add_*() per leaf, end_tick().
+class RecordWriter {
+public:
+    RecordWriter() = default;
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+    ~RecordWriter() {
+        std::string ignored;
+        close(ignored);
+    }
+
+    bool open(const RecorderConfig& config, std::string& error) {
+        std::string ignored;
+        close(ignored);
+        config_ = config;
+        if (config_.directory.empty()) {
+            error = "recording directory not set";
+            return false;
+        }
+        config_.max_file_bytes = std::max<size_t>(config_.max_file_bytes, kRecGrowStep);
+        config_.max_files = std::max<size_t>(config_.max_files, 1);
+        config_.chunk_ticks = std::max<uint32_t>(config_.chunk_ticks, 1);
+        config_.float_decimals = std::min(config_.float_decimals, kRecMaxDecimals);
+        std::error_code ec;
+        fs::create_directories(config_.directory, ec);
+        if (ec) {
+            error = config_.directory + ": " + ec.message();
+            return false;
+        }
+        opened_ = true;
+        return true;
+    }
+
+    bool is_open() const { return opened_; }
+    const RecorderConfig& config() const { return config_; }
+    RecorderStats stats() const {
+        RecorderStats s = stats_;
+        s.series = columns_.size();
+        s.open_ticks = static_cast<uint32_t>(ticks_.size());
+        return s;
+    }
+
+    void begin_tick(int64_t ts_ms) {
+        tick_ = ticks_.size();
+        prev_column_ = kNoColumn;
+        ticks_.push_back(ts_ms);
+    }
+
+    void add_int(std::string_view path, RecordType type, int64_t v) {
+        Column* c = column(path, type);
+        if (!c) return;
+        lxrec::put_varint(c->data, lxrec::zigzag(v - c->last_int));
+        c->last_int = v;
+    }
+
+    void add_float(std::string_view path, double v) {
+        Column* c = column(path, kRecFloat);
+        if (!c) return;
+        c->floats.push_back(lxrec::round_decimals(v, config_.float_decimals));
+    }
+
+    void add_text(std::string_view path, std::string_view v) {
+        Column* c = column(path, kRecText);
+        if (!c) return;
+        if (c->present > 1 && v == c->last_text) {
+            c->data.push_back(0);
+            return;
+        }
+        lxrec::put_varint(c->data, v.size() + 1);
+        lxrec::put_bytes(c->data, v.data(), v.size());
+        c->last_text.assign(v.data(), v.size());
+    }
+
+    // none, {} and [] leaves.
+    void add_marker(std::string_view path, RecordType type) { column(path, type); }
+
+    // Closes the chunk when it is full or old enough; false (error set) when writing it failed.
+    bool end_tick(std::string& error) {
+        ++stats_.ticks;
+        const bool full = ticks_.size() >= config_.chunk_ticks || ticks_.back() - ticks_.front() >= config_.chunk_ms;
+        return !full || flush(error);
+    }
+
+    // Writes the open chunk (if any) to the current segment.
+    bool flush(std::string& error) {
+        if (ticks_.empty()) return true;
+        encode_chunk();
+        const bool ok = write_chunk(error);
+        reset_chunk();
+        return ok;
+    }
+
+    // Flushes and truncates the segment to its data; the recorder can be opened again.
+    bool close(std::string& error) {
+        bool ok = !opened_ || flush(error);
+        close_segment();
+        opened_ = false;
+        return ok;
+    }
+
+private:
+    struct Column {
+        std::string path;
+        RecordType type = kRecNone;
+        uint32_t present = 0;
+        size_t last_tick = SIZE_MAX;
+        std::vector<uint8_t> bitmap;
+        std::vector<uint8_t> data;  // int/bool/text values, encoded as they arrive
+        std::vector<double> floats;  // encoded at chunk close, when the decimals are known
+        int64_t last_int = 0;
+        std::string last_text;
+        uint32_t next = kNoColumn;  // column that followed this one last time
+    };
+
+    static constexpr uint32_t kNoColumn = UINT32_MAX;
+
+    RecorderConfig config_;
+    RecorderStats stats_;
+    bool opened_ = false;
+
+    std::vector<Column> columns_;
+    std::unordered_map<std::string, uint32_t> lookup_;  // path + '\0' + type
+    std::string key_;
+    uint32_t prev_column_ = kNoColumn;  // kNoColumn at the start of a tick
+    uint32_t first_column_ = kNoColumn;
+    bool forget_columns_ = false;
+    std::vector<uint32_t> chunk_columns_;  // columns present in the open chunk, first-seen order
+    std::vector<int64_t> ticks_;
+    size_t tick_ = 0;
+    std::vector<uint8_t> chunk_;
+
+    int fd_ = -1;
+    int index_fd_ = -1;
+    uint8_t* map_ = nullptr;
+    size_t map_size_ = 0;
+    size_t file_size_ = 0;
+    std::string path_;
+
+    RecFileHeader* header() { return reinterpret_cast<RecFileHeader*>(map_); }
+
+    // Ticks walk the same dict in the same order, so the column after the previous one in the last
+    // tick is tried before the hash lookup.
+    Column* column(std::string_view path, RecordType type) {
+        uint32_t id = prev_column_ < columns_.size() ? columns_[prev_column_].next : first_column_;
+        if (id >= columns_.size() || columns_[id].type != type || columns_[id].path != path) {
+            key_.assign(path.data(), path.size());
+            key_.push_back('\0');
+            key_.push_back(static_cast<char>(type));
+            auto it = lookup_.find(key_);
+            if (it == lookup_.end()) {
+                id = static_cast<uint32_t>(columns_.size());
+                columns_.emplace_back();
+                columns_.back().path.assign(path.data(), path.size());
+                columns_.back().type = type;
+                lookup_.emplace(key_, id);
+            } else {
+                id = it->second;
+            }
+            if (prev_column_ < columns_.size()) {
+                columns_[prev_column_].next = id;
+            } else {
+                first_column_ = id;
+            }
+        }
+        prev_column_ = id;
+        Column& c = columns_[id];
+        if (c.last_tick == tick_) return nullptr;  // the same leaf twice in one tick
+        if (c.present == 0) chunk_columns_.push_back(id);
+        c.last_tick = tick_;
+        ++c.present;
+        if (c.bitmap.size() <= tick_ / 8) c.bitmap.resize(tick_ / 8 + 1, 0);
+        c.bitmap[tick_ / 8] |= static_cast<uint8_t>(1u << (tick_ % 8));
+        ++stats_.values;
+        return &c;
+    }
+
+    void encode_floats(const Column& c) {
+        int decimals = 0;
+        for (double v : c.floats) {
+            const int k = lxrec::exact_decimals(v);
+            decimals = k < 0 ? -1 : std::max(decimals, k);
+            if (decimals < 0) break;
+        }
+        // Exact for each value's own decimals is not quite exact for the column's; check again.
+        for (size_t i = 0; decimals >= 0 && i < c.floats.size(); ++i) {
+            const double v = c.floats[i];
+            const double back = static_cast<double>(std::llround(v * lxrec::kPow10[decimals])) / lxrec::kPow10[decimals];
+            if (lxrec::double_bits(back) != lxrec::double_bits(v)) decimals = -1;
+        }
+        if (decimals >= 0) {
+            chunk_.push_back(static_cast<uint8_t>(kEncScaled | decimals));
+            lxrec::put_varint(chunk_, c.present);
+            put_bitmap(c);
+            int64_t prev = 0;
+            for (double v : c.floats) {
+                const int64_t n = std::llround(v * lxrec::kPow10[decimals]);
+                lxrec::put_varint(chunk_, lxrec::zigzag(n - prev));
+                prev = n;
+            }
+            return;
+        }
+        chunk_.push_back(kEncXor);
+        lxrec::put_varint(chunk_, c.present);
+        put_bitmap(c);
+        uint64_t prev = 0;
+        for (double v : c.floats) {
+            const uint64_t bits = lxrec::double_bits(v);
+            const uint64_t x = bits ^ prev;
+            prev = bits;
+            if (x == 0) {
+                chunk_.push_back(0);
+                continue;
+            }
+            const int lead = __builtin_clzll(x) / 8;
+            const int trail = __builtin_ctzll(x) / 8;
+            chunk_.push_back(static_cast<uint8_t>(0x80 | lead << 4 | trail));
+            for (int b = 7 - lead; b >= trail; --b) chunk_.push_back(static_cast<uint8_t>(x >> (b * 8)));
+        }
+    }
+
+    void put_bitmap(const Column& c) {
+        if (c.present == ticks_.size()) return;
+        const size_t bytes = (ticks_.size() + 7) / 8;
+        lxrec::put_bytes(chunk_, c.bitmap.data(), std::min(bytes, c.bitmap.size()));
+        for (size_t i = c.bitmap.size(); i < bytes; ++i) chunk_.push_back(0);
+    }
+
+    void encode_chunk() {
+        chunk_.assign(kRecChunkHeaderSize, 0);
+        int64_t prev_ts = ticks_.front(), prev_delta = 0;
+        for (size_t i = 1; i < ticks_.size(); ++i) {
+            const int64_t delta = ticks_[i] - prev_ts;
+            lxrec::put_varint(chunk_, lxrec::zigzag(delta - prev_delta));
+            prev_ts = ticks_[i];
+            prev_delta = delta;
+        }
+        for (uint32_t id : chunk_columns_) {
+            const Column& c = columns_[id];
+            lxrec::put_varint(chunk_, c.path.size());
+            lxrec::put_bytes(chunk_, c.path.data(), c.path.size());
+            chunk_.push_back(c.type);
+            if (c.type == kRecFloat) {
+                encode_floats(c);
+                continue;
+            }
+            chunk_.push_back(kEncPlain);
+            lxrec::put_varint(chunk_, c.present);
+            put_bitmap(c);
+            lxrec::put_bytes(chunk_, c.data.data(), c.data.size());
+        }
+        const size_t payload = chunk_.size() - kRecChunkHeaderSize;
+        chunk_.resize((chunk_.size() + 7) & ~size_t(7), 0);
+        RecChunkHeader h{};
+        h.magic = kRecChunkMagic;
+        h.size = static_cast<uint32_t>(chunk_.size());
+        h.first_ms = ticks_.front();
+        h.last_ms = ticks_.back();
+        h.ticks = static_cast<uint32_t>(ticks_.size());
+        h.columns = static_cast<uint32_t>(chunk_columns_.size());
+        h.payload_size = static_cast<uint32_t>(payload);
+        h.checksum = lxrec::fnv1a(chunk_.data() + kRecChunkHeaderSize, payload);
+        std::memcpy(chunk_.data(), &h, sizeof(h));
+    }
+
+    void reset_chunk() {
+        for (uint32_t id : chunk_columns_) {
+            Column& c = columns_[id];
+            c.present = 0;
+            c.last_tick = SIZE_MAX;
+            c.bitmap.clear();
+            c.data.clear();
+            c.floats.clear();
+            c.last_int = 0;
+        }
+        chunk_columns_.clear();
+        ticks_.clear();
+        tick_ = 0;
+        if (forget_columns_) {
+            columns_.clear();
+            lookup_.clear();
+            first_column_ = kNoColumn;
+            forget_columns_ = false;
+        }
+    }
+
+    bool write_chunk(std::string& error) {
+        const size_t size = chunk_.size();
+        // Rotate when the chunk would not fit; a chunk larger than a whole segment gets a bigger mapping.
+        if (map_ && header()->data_end + size > map_size_) close_segment();
+        if (!map_ && !open_segment(ticks_.front(), kRecHeaderSize + size, error)) return false;
+
+        RecFileHeader* h = header();
+        const uint64_t offset = h->data_end;
+        if (offset + size > file_size_) {
+            const size_t want = std::min(map_size_, (offset + size + kRecGrowStep - 1) / kRecGrowStep * kRecGrowStep);
+            if (::ftruncate(fd_, static_cast<off_t>(want)) != 0) {
+                error = path_ + ": " + std::strerror(errno);
+                return false;
+            }
+            file_size_ = want;
+        }
+        std::memcpy(map_ + offset, chunk_.data(), size);
+        std::atomic_thread_fence(std::memory_order_release);  // chunk before the header that points past it
+        h->data_end = offset + size;
+        h->chunk_count += 1;
+        h->last_ms = ticks_.back();
+        h->ticks += ticks_.size();
+
+        const RecIndexEntry entry{ticks_.front(), ticks_.back(), offset, static_cast<uint32_t>(ticks_.size()),
+                                  static_cast<uint32_t>(size)};
+        if (index_fd_ >= 0) {
+            const off_t at = static_cast<off_t>((h->chunk_count - 1) * kRecIndexEntrySize);
+            (void)::pwrite(index_fd_, &entry, sizeof(entry), at);  // rebuilt from the chunks when short
+        }
+        ++stats_.chunks;
+        stats_.bytes += size;
+        return true;
+    }
+
+    bool open_segment(int64_t first_ms, size_t min_size, std::string& error) {
+        const std::string base = (fs::path(config_.directory) / lxrec::segment_name(config_.prefix, first_ms)).string();
+        int fd = -1;
+        for (int n = 0; n < 100 && fd < 0; ++n) {
+            // Same millisecond as an existing segment (clock stepped back): <name>-<n>.lxrec
+            path_ = n == 0 ? base : base.substr(0, base.size() - 6) + "-" + std::to_string(n) + ".lxrec";
+            fd = ::open(path_.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+            if (fd < 0 && errno != EEXIST) break;
+        }
+        if (fd < 0) {
+            error = path_ + ": " + std::strerror(errno);
+            return false;
+        }
+        const size_t size = std::max(config_.max_file_bytes, (min_size + kRecGrowStep - 1) / kRecGrowStep * kRecGrowStep);
+        if (::ftruncate(fd, static_cast<off_t>(kRecGrowStep)) != 0) {
+            error = path_ + ": " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (!lxrec::is_map(p)) {
+            error = "mmap(" + path_ + "): " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        fd_ = fd;
+        map_ = static_cast<uint8_t*>(p);
+        map_size_ = size;
+        file_size_ = kRecGrowStep;
+        RecFileHeader* h = header();
+        std::memcpy(h->magic, kRecMagic, sizeof(kRecMagic));
+        h->version = kRecVersion;
+        h->header_size = kRecHeaderSize;
+        h->data_end = kRecHeaderSize;
+        h->first_ms = first_ms;
+        h->last_ms = first_ms;
+        index_fd_ = ::open((path_ + ".idx").c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0644);
+
+        // The series set starts over with each segment (after this chunk), so names that churned away
+        // are forgotten.
+        forget_columns_ = true;
+        stats_.segment = path_;
+        ++stats_.segments_written;
+        enforce_retention();
+        return true;
+    }
+
+    void close_segment() {
+        if (map_) {
+            RecFileHeader* h = header();
+            const uint64_t end = h->data_end;
+            h->flags |= kRecClosed;
+            ::munmap(map_, map_size_);
+            map_ = nullptr;
+            const int rc = ::ftruncate(fd_, static_cast<off_t>(end));
+            (void)rc;  // on failure the zero tail stays; readers stop at data_end
+        }
+        if (fd_ >= 0) ::close(fd_);
+        if (index_fd_ >= 0) ::close(index_fd_);
+        fd_ = index_fd_ = -1;
+        map_size_ = file_size_ = 0;
+    }
+
+    // Deletes the oldest segments (never the open one) past max_files / max_total_bytes.
+    void enforce_retention() {
+        std::vector<std::pair<std::string, uintmax_t>> segments;
+        std::error_code ec;
+        const std::string lead = config_.prefix + "-";
+        for (const auto& e : fs::directory_iterator(config_.directory, ec)) {
+            const std::string name = e.path().filename().string();
+            if (name.compare(0, lead.size(), lead) != 0 || e.path().extension() != ".lxrec") continue;
+            std::error_code size_ec;
+            const uintmax_t size = fs::file_size(e.path(), size_ec);
+            segments.emplace_back(e.path().string(), size_ec ? 0 : size);
+        }
+        std::sort(segments.begin(), segments.end());
+        uintmax_t total = 0;
+        for (const auto& s : segments) total += s.second;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            const bool over_count = segments.size() - i > config_.max_files;
+            const bool over_bytes = config_.max_total_bytes && total > config_.max_total_bytes;
+            if ((!over_count && !over_bytes) || segments[i].first == path_) break;
+            std::error_code rm_ec;
+            fs::remove(segments[i].first, rm_ec);
+            fs::remove(segments[i].first + ".idx", rm_ec);
+            total -= segments[i].second;
+            ++stats_.segments_deleted;
+        }
+    }
+};
+
+// Reads a segment file or a directory of them (sorted by first tick) and iterates ticks from any
+// time. Chunks are found by binary search over the index entries, then decoded whole.
+class RecordReader {
+public:
+    // One leaf of the current tick.
+    struct Value {
+        std::string_view path;
+        RecordType type;
+        int64_t i;
+        double f;
+        std::string_view text;
+    };
+
+    RecordReader() = default;
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+    ~RecordReader() { close(); }
+
+    bool open(const std::string& path, const std::string& prefix, std::string& error) {
+        close();
+        std::error_code ec;
+        std::vector<std::string> files;
+        if (fs::is_directory(path, ec)) {
+            const std::string lead = prefix.empty() ? std::string() : prefix + "-";
+            for (const auto& e : fs::directory_iterator(path, ec)) {
+                const std::string name = e.path().filename().string();
+                if (e.path().extension() == ".lxrec" && name.compare(0, lead.size(), lead) == 0) files.push_back(e.path().string());
+            }
+        } else {
+            files.push_back(path);
+        }
+        for (const auto& f : files) {
+            std::string file_error;
+            if (!open_segment(f, file_error) && files.size() == 1) {
+                error = file_error;
+                return false;
+            }
+        }
+        std::sort(segments_.begin(), segments_.end(),
+                  [](const Segment& a, const Segment& b) { return a.first_ms < b.first_ms; });
+        for (size_t s = 0; s < segments_.size(); ++s) {
+            for (const RecIndexEntry& e : segments_[s].index) chunks_.push_back({e, s});
+        }
+        if (chunks_.empty()) {
+            error = path + ": no recorded chunks";
+            return false;
+        }
+        chunk_ = SIZE_MAX;
+        load(0);
+        return true;
+    }
+
+    void close() {
+        for (auto& s : segments_) {
+            if (lxrec::is_map(s.map)) ::munmap(s.map, s.size);
+        }
+        segments_.clear();
+        chunks_.clear();
+        chunk_ = SIZE_MAX;
+        tick_ = 0;
+        ts_.clear();
+    }
+
+    size_t segment_count() const { return segments_.size(); }
+    size_t chunk_count() const { return chunks_.size(); }
+    size_t corrupt_chunks() const { return corrupt_; }
+
+    uint64_t tick_count() const {
+        uint64_t n = 0;
+        for (const auto& c : chunks_) n += c.entry.ticks;
+        return n;
+    }
+
+    int64_t first_ms() const { return chunks_.empty() ? 0 : chunks_.front().entry.first_ms; }
+    int64_t last_ms() const { return chunks_.empty() ? 0 : chunks_.back().entry.last_ms; }
+
+    bool at_end() const { return chunk_ >= chunks_.size(); }
+
+    // Time of the tick next() returns.
+    int64_t peek_ms() const { return at_end() ? 0 : ts_[tick_]; }
+
+    // Positions at the first tick at or after ts_ms (past the end when there is none).
+    void seek(int64_t ts_ms) {
+        auto it = std::lower_bound(chunks_.begin(), chunks_.end(), ts_ms,
+                                   [](const ChunkRef& c, int64_t t) { return c.entry.last_ms < t; });
+        if (!load(static_cast<size_t>(it - chunks_.begin()))) return;
+        tick_ = static_cast<size_t>(std::lower_bound(ts_.begin(), ts_.end(), ts_ms) - ts_.begin());
+        if (tick_ >= ts_.size()) load(chunk_ + 1);
+    }
+
+    // Calls fn(const Value&) per leaf of the next tick, in column order, and advances. False at the end.
+    template <typename Fn>
+    bool next(int64_t& ts_ms, Fn&& fn) {
+        if (at_end()) return false;
+        ts_ms = ts_[tick_];
+        for (const DecodedColumn& c : cols_) {
+            const int32_t slot = c.slots[tick_];
+            if (slot < 0) continue;
+            Value v{c.path, c.type, 0, 0.0, {}};
+            if (c.type == kRecFloat) {
+                v.f = floats_[c.first + static_cast<size_t>(slot)];
+            } else if (c.type == kRecText) {
+                v.text = texts_[c.first + static_cast<size_t>(slot)];
+            } else {
+                v.i = ints_[c.first + static_cast<size_t>(slot)];
+            }
+            fn(v);
+        }
+        skip();
+        return true;
+    }
+
+    // Moves to the last tick at or before ts_ms, skipping whole chunks by their index entries; stays
+    // put when the next tick is already later.
+    void skip_to_last(int64_t ts_ms) {
+        if (at_end() || ts_[tick_] > ts_ms) return;
+        size_t c = chunk_;
+        while (c + 1 < chunks_.size() && chunks_[c + 1].entry.first_ms <= ts_ms) ++c;
+        if (c != chunk_ && !load(c)) return;
+        while (tick_ + 1 < ts_.size() && ts_[tick_ + 1] <= ts_ms) ++tick_;
+    }
+
+    // Advances past the next tick without visiting it.
+    void skip() {
+        if (at_end()) return;
+        if (++tick_ >= ts_.size()) load(chunk_ + 1);
+    }
+
+private:
+    struct Segment {
+        std::string path;
+        uint8_t* map = nullptr;
+        size_t size = 0;
+        int64_t first_ms = 0;
+        std::vector<RecIndexEntry> index;
+    };
+
+    struct ChunkRef {
+        RecIndexEntry entry;
+        size_t segment;
+    };
+
+    struct DecodedColumn {
+        std::string_view path;
+        RecordType type;
+        size_t first;  // offset into ints_/floats_/texts_
+        std::vector<int32_t> slots;  // per tick: value ordinal or -1
+    };
+
+    std::vector<Segment> segments_;
+    std::vector<ChunkRef> chunks_;
+    size_t corrupt_ = 0;
+
+    size_t chunk_ = SIZE_MAX;
+    size_t tick_ = 0;
+    std::vector<int64_t> ts_;
+    std::vector<DecodedColumn> cols_;
+    std::vector<int64_t> ints_;
+    std::vector<double> floats_;
+    std::vector<std::string_view> texts_;
+
+    bool open_segment(const std::string& path, std::string& error) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kRecHeaderSize)) {
+            error = path + ": not a recording";
+            ::close(fd);
+            return false;
+        }
+        Segment s;
+        s.path = path;
+        s.size = static_cast<size_t>(st.st_size);
+        void* p = ::mmap(nullptr, s.size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (!lxrec::is_map(p)) {
+            error = "mmap(" + path + "): " + std::strerror(errno);
+            return false;
+        }
+        s.map = static_cast<uint8_t*>(p);
+        RecFileHeader h;
+        std::memcpy(&h, s.map, sizeof(h));
+        if (std::memcmp(h.magic, kRecMagic, sizeof(kRecMagic)) != 0 || h.version != kRecVersion) {
+            error = path + ": not a recording (bad magic or version)";
+            ::munmap(s.map, s.size);
+            return false;
+        }
+        s.first_ms = h.first_ms;
+        const uint64_t data_end = std::min<uint64_t>(h.data_end, s.size);
+        load_index(s, data_end);
+        segments_.push_back(std::move(s));
+        return true;
+    }
+
+    // Index entries that point at whole chunks, then whatever the index misses (crash between the
+    // chunk and its entry, deleted .idx) from walking the chunk headers.
+    void load_index(Segment& s, uint64_t data_end) {
+        uint64_t pos = kRecHeaderSize;
+        const int fd = ::open((s.path + ".idx").c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            struct stat st {};
+            if (::fstat(fd, &st) == 0) {
+                s.index.resize(static_cast<size_t>(st.st_size) / kRecIndexEntrySize);
+                const ssize_t want = static_cast<ssize_t>(s.index.size() * kRecIndexEntrySize);
+                if (::pread(fd, s.index.data(), static_cast<size_t>(want), 0) != want) s.index.clear();
+            }
+            ::close(fd);
+        }
+        size_t valid = 0;
+        for (const RecIndexEntry& e : s.index) {
+            if (e.offset != pos || e.offset + e.size > data_end) break;
+            pos += e.size;
+            ++valid;
+        }
+        s.index.resize(valid);
+        while (pos + kRecChunkHeaderSize <= data_end) {
+            RecChunkHeader h;
+            std::memcpy(&h, s.map + pos, sizeof(h));
+            if (h.magic != kRecChunkMagic || h.size < kRecChunkHeaderSize || pos + h.size > data_end) break;
+            s.index.push_back({h.first_ms, h.last_ms, pos, h.ticks, h.size});
+            pos += h.size;
+        }
+    }
+
+    // Decodes chunk i (skipping corrupt ones); false past the end.
+    bool load(size_t i) {
+        tick_ = 0;
+        for (; i < chunks_.size(); ++i) {
+            if (i == chunk_ || decode(chunks_[i])) {
+                chunk_ = i;
+                return true;
+            }
+            ++corrupt_;
+        }
+        chunk_ = chunks_.size();
+        ts_.clear();
+        return false;
+    }
+
+    bool decode(const ChunkRef& ref) {
+        const Segment& seg = segments_[ref.segment];
+        const uint8_t* base = seg.map + ref.entry.offset;
+        RecChunkHeader h;
+        std::memcpy(&h, base, sizeof(h));
+        if (h.magic != kRecChunkMagic || h.ticks == 0 || kRecChunkHeaderSize + static_cast<uint64_t>(h.payload_size) > h.size) {
+            return false;
+        }
+        const uint8_t* payload = base + kRecChunkHeaderSize;
+        if (lxrec::fnv1a(payload, h.payload_size) != h.checksum) return false;
+
+        lxrec::Reader r(payload, h.payload_size);
+        const size_t ticks = h.ticks;
+        ts_.resize(ticks);
+        ts_[0] = h.first_ms;
+        int64_t delta = 0;
+        for (size_t t = 1; t < ticks; ++t) {
+            delta += lxrec::unzigzag(r.varint());
+            ts_[t] = ts_[t - 1] + delta;
+        }
+        cols_.resize(h.columns);
+        ints_.clear();
+        floats_.clear();
+        texts_.clear();
+        for (DecodedColumn& c : cols_) {
+            const size_t len = static_cast<size_t>(r.varint());
+            const uint8_t* path = r.bytes(len);
+            c.path = path ? std::string_view(reinterpret_cast<const char*>(path), len) : std::string_view();
+            c.type = static_cast<RecordType>(r.byte());
+            const uint8_t enc = r.byte();
+            const size_t present = static_cast<size_t>(r.varint());
+            if (!r.ok() || present > ticks) return false;
+            c.slots.assign(ticks, -1);
+            if (present == ticks) {
+                for (size_t t = 0; t < ticks; ++t) c.slots[t] = static_cast<int32_t>(t);
+            } else {
+                const uint8_t* bits = r.bytes((ticks + 7) / 8);
+                if (!bits) return false;
+                int32_t n = 0;
+                for (size_t t = 0; t < ticks; ++t) {
+                    if (bits[t / 8] & (1u << (t % 8))) c.slots[t] = n++;
+                }
+                if (static_cast<size_t>(n) != present) return false;
+            }
+            if (!decode_values(r, c, enc, present)) return false;
+        }
+        return r.ok();
+    }
+
+    bool decode_values(lxrec::Reader& r, DecodedColumn& c, uint8_t enc, size_t present) {
+        switch (c.type) {
+            case kRecInt:
+            case kRecBool: {
+                c.first = ints_.size();
+                int64_t v = 0;
+                for (size_t k = 0; k < present; ++k) {
+                    v += lxrec::unzigzag(r.varint());
+                    ints_.push_back(v);
+                }
+                return true;
+            }
+            case kRecFloat: {
+                c.first = floats_.size();
+                if (enc & kEncScaled) {
+                    const int decimals = enc & ~kEncScaled;
+                    if (decimals > kRecMaxDecimals) return false;
+                    int64_t n = 0;
+                    for (size_t k = 0; k < present; ++k) {
+                        n += lxrec::unzigzag(r.varint());
+                        floats_.push_back(static_cast<double>(n) / lxrec::kPow10[decimals]);
+                    }
+                    return true;
+                }
+                if (enc != kEncXor) return false;
+                uint64_t prev = 0;
+                for (size_t k = 0; k < present; ++k) {
+                    const uint8_t ctl = r.byte();
+                    if (ctl) {
+                        const int lead = (ctl >> 4) & 0x07, trail = ctl & 0x0f;
+                        if (!(ctl & 0x80) || lead + trail > 7) return false;
+                        uint64_t x = 0;
+                        for (int b = 7 - lead; b >= trail; --b) x |= static_cast<uint64_t>(r.byte()) << (b * 8);
+                        prev ^= x;
+                    }
+                    floats_.push_back(lxrec::bits_double(prev));
+                }
+                return true;
+            }
+            case kRecText: {
+                c.first = texts_.size();
+                std::string_view last;
+                for (size_t k = 0; k < present; ++k) {
+                    const uint64_t n = r.varint();
+                    if (n > 0) {
+                        const uint8_t* b = r.bytes(static_cast<size_t>(n - 1));
+                        last = b ? std::string_view(reinterpret_cast<const char*>(b), static_cast<size_t>(n - 1)) : std::string_view();
+                    }
+                    texts_.push_back(last);
+                }
+                return true;
+            }
+            case kRecNone:
+            case kRecEmptyDict:
+            case kRecEmptyList:
+                c.first = ints_.size();
+                ints_.insert(ints_.end(), present, 0);
+                return true;
+        }
+        return false;
+    }
+};
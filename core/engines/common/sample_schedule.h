@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+#include "sampler_snapshot.h"
+
+// Decides which sampler engines run on a tick.
+// Each engine runs at the slowest of: the UI interval, its natural period (kSamplerEngines),
+// and ~20x its measured cost (so no engine takes more than ~5% of a core). On top of that
+// the period doubles (up to 4x) while the engine's headline value stays flat, and is
+// multiplied by kIdleFactor while the UI is hidden. Only called from the sampling thread.
+class SampleScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int kIdleFactor = 4;
+    static constexpr int kMaxFlatBackoff = 4;
+    static constexpr int kFlatRunsToBackoff = 8;
+    static constexpr double kCostToPeriod = 20.0;
+
+    struct EngineStats {
+        double period_ms = 0.0;     // current effective period
+        double cost_us = 0.0;       // EWMA of one run
+        int backoff = 1;            // flat-value multiplier
+        uint64_t runs = 0;
+        uint64_t skips = 0;         // ticks on which the engine was enabled but not due
+    };
+
+    // Subset of mask whose engines are due at now. A new or re-enabled engine is always due.
+    uint32_t due(uint32_t mask, Clock::time_point now, int interval_ms) {
+        interval_ms_ = interval_ms;
+        uint32_t out = 0;
+        for (size_t i = 0; i < kSamplerEngineCount; ++i) {
+            const uint32_t bit = kSamplerEngines[i].bit;
+            State& s = states_[i];
+            if (!(mask & bit)) {
+                s.ever = false;
+                continue;
+            }
+            // Half a tick of slack so a period equal to the interval does not slip by one tick.
+            const auto slack = std::chrono::microseconds(static_cast<int64_t>(interval_ms) * 500);
+            if (!s.ever || now - s.last_run + slack >= period(i)) out |= bit;
+            else ++s.skips;
+        }
+        return out;
+    }
+
+    // Records one run; value is the engine's headline number (NaN disables flat backoff).
+    void ran(uint32_t bit, Clock::time_point now, double cost_us, double value) {
+        const size_t i = index_of(bit);
+        if (i >= kSamplerEngineCount) return;
+        State& s = states_[i];
+        s.cost_us = s.ever ? s.cost_us * 0.8 + cost_us * 0.2 : cost_us;
+        s.last_run = now;
+        ++s.runs;
+
+        if (std::isnan(value) || !s.ever || std::isnan(s.last_value)) {
+            s.flat_runs = 0;
+            s.backoff = 1;
+        } else if (is_flat(s.last_value, value)) {
+            if (++s.flat_runs >= kFlatRunsToBackoff && s.backoff < kMaxFlatBackoff) {
+                s.backoff *= 2;
+                s.flat_runs = 0;
+            }
+        } else {
+            s.flat_runs = 0;
+            s.backoff = 1;
+        }
+        s.last_value = value;
+        s.ever = true;
+    }
+
+    // Earliest time any engine in mask becomes due; now when one already is.
+    Clock::time_point next_due(uint32_t mask, Clock::time_point now) const {
+        auto next = Clock::time_point::max();
+        for (size_t i = 0; i < kSamplerEngineCount; ++i) {
+            if (!(mask & kSamplerEngines[i].bit)) continue;
+            const State& s = states_[i];
+            if (!s.ever) return now;
+            const auto at = s.last_run + std::chrono::duration_cast<Clock::duration>(period(i));
+            next = std::min(next, at);
+        }
+        return next == Clock::time_point::max() ? now + std::chrono::milliseconds(interval_ms_) : std::max(next, now);
+    }
+
+    void set_idle(bool idle) { idle_ = idle; }
+    bool idle() const { return idle_; }
+
+    EngineStats stats(size_t index) const {
+        const State& s = states_[index];
+        EngineStats out;
+        out.period_ms = period(index).count();
+        out.cost_us = s.cost_us;
+        out.backoff = s.backoff;
+        out.runs = s.runs;
+        out.skips = s.skips;
+        return out;
+    }
+
+private:
+    struct State {
+        Clock::time_point last_run;
+        bool ever = false;
+        double cost_us = 0.0;
+        double last_value = std::nan("");
+        int flat_runs = 0;
+        int backoff = 1;
+        uint64_t runs = 0;
+        uint64_t skips = 0;
+    };
+
+    State states_[kSamplerEngineCount];
+    int interval_ms_ = 250;
+    bool idle_ = false;
+
+    static size_t index_of(uint32_t bit) {
+        for (size_t i = 0; i < kSamplerEngineCount; ++i) {
+            if (kSamplerEngines[i].bit == bit) return i;
+        }
+        return kSamplerEngineCount;
+    }
+
+    // Relative 0.5% or absolute 0.05 (percent, W, Mb/s, degC all read as flat below that).
+    static bool is_flat(double prev, double cur) {
+        const double d = std::fabs(cur - prev);
+        return d <= 0.05 || d <= 0.005 * std::max(std::fabs(prev), std::fabs(cur));
+    }
+
+    std::chrono::duration<double, std::milli> period(size_t i) const {
+        const State& s = states_[i];
+        double ms = std::max<double>(interval_ms_, kSamplerEngines[i].natural_ms);
+        ms = std::max(ms, s.cost_us * kCostToPeriod / 1000.0);
+        ms *= s.backoff;
+        if (idle_) ms *= kIdleFactor;
+        return std::chrono::duration<double, std::milli>(ms);
+    }
+};
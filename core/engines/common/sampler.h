@@ -0,0 +1,651 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bt_engine.h"
+#include "cpu_engine.h"
+#include "deferred_engine.h"
+#include "disc_engine.h"
+#include "engine_stats.h"
+#include "gpu_others_engine.h"
+#include "gpu_temp_engine.h"
+#include "history_store.h"
+#include "net_engine.h"
+#include "node_stream.h"
+#include "pressure_engine.h"
+#include "psi_trigger.h"
+#include "psu_engine.h"
+#include "ram_engine.h"
+#include "sample_schedule.h"
+#include "sampler_snapshot.h"
+#include "snapshot_buffer.h"
+#include "snapshot_shm.h"
+#include "source_root.h"
+
+// Background sampler: owns its own engine instances and drives them from a dedicated thread.
+// Each tick is published into a triple buffer, so readers never wait on engine I/O.
+class Sampler {
+public:
+    explicit Sampler(const SourceRoot& root = SourceRoot::host()) : root_(root), pending_root_(root) {}
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    ~Sampler() {
+        stop();
+        std::lock_guard<std::mutex> lk(trigger_control_mu_);
+        stop_pressure_watch();
+    }
+
+    void start(uint32_t mask, int interval_ms) {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            mask_ = mask;
+            interval_ms_ = clamp_interval(interval_ms);
+            stop_requested_ = false;
+            wake_ = true;
+        }
+        if (worker_.joinable()) {
+            cv_.notify_all();
+            return;
+        }
+        worker_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_requested_ = true;
+        }
+        cv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+    }
+
+    void set_interval(int interval_ms) {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            interval_ms_ = clamp_interval(interval_ms);
+            wake_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    void set_engines(uint32_t mask) {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            mask_ = mask;
+            wake_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    bool running() {
+        std::lock_guard<std::mutex> ctl(control_mu_);
+        return worker_.joinable();
+    }
+
+    // Copies the most recent published tick into out.
+    // Returns true when it is newer than what the previous call returned.
+    bool latest(SamplerSnapshot& out) {
+        std::lock_guard<std::mutex> rd(reader_mu_);
+        const bool fresh = buffer_.acquire();
+        out = buffer_.front();
+        return fresh;
+    }
+
+    // Batched on-demand path. Without the thread it samples mask on the calling thread
+    // and publishes that tick; with the thread running it just returns the latest tick
+    // (whose engines come from start()/set_engines()).
+    bool collect(uint32_t mask, SamplerSnapshot& out) {
+        {
+            std::lock_guard<std::mutex> ctl(control_mu_);
+            if (!worker_.joinable()) tick(mask, current_interval(), true);
+        }
+        return latest(out);
+    }
+
+    // Publishes every following tick into a POSIX shared-memory segment (see shm_segment.h).
+    bool publish_shm(const std::string& name, size_t size, std::string& error) {
+        std::lock_guard<std::mutex> lk(shm_mu_);
+        return shm_.open(name, size, error);
+    }
+
+    void unpublish_shm() {
+        std::lock_guard<std::mutex> lk(shm_mu_);
+        shm_.close();
+    }
+
+    std::string shm_name() {
+        std::lock_guard<std::mutex> lk(shm_mu_);
+        return shm_.is_open() ? shm_.name() : std::string();
+    }
+
+    // Streams every following tick to a remote viewer (see node_stream.h), reconnecting on its own.
+    // The host name is resolved here, before the tick's lock is taken.
+    bool stream_to(const std::string& host, int port, const std::string& node, const std::string& token, std::string& error) {
+        sockaddr_storage addr{};
+        socklen_t len = 0;
+        if (!NodeStreamSender::resolve(host, port, addr, len, error)) return false;
+        std::lock_guard<std::mutex> lk(stream_mu_);
+        stream_.configure(addr, len, node, token);
+        return true;
+    }
+
+    void stream_stop() {
+        std::lock_guard<std::mutex> lk(stream_mu_);
+        stream_.close();
+    }
+
+    NodeStreamSender::Stats stream_stats() {
+        std::lock_guard<std::mutex> lk(stream_mu_);
+        return stream_.stats();
+    }
+
+    // Later ticks read from root; every engine is rebuilt there on the next tick, with a clean schedule
+    // and snapshot so no value from the previous root lingers.
+    void set_root(const SourceRoot& root) {
+        std::lock_guard<std::mutex> lk(mu_);
+        pending_root_ = root;
+    }
+
+    SourceRoot root() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return pending_root_;
+    }
+
+    // Interface name prefixes the net engine leaves out (NetActivityEngine::set_skip_prefixes), from the next tick.
+    void set_net_skip_prefixes(std::vector<std::string> prefixes) {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            net_skip_ = std::move(prefixes);
+        }
+        net_skip_dirty_.store(true, std::memory_order_release);
+    }
+
+    // Arms PSI triggers on the current root; each one that fires wakes the sampler and runs the pressure
+    // engine on that tick instead of at its next period. {} disarms. On failure no trigger stays armed.
+    bool set_pressure_triggers(const std::vector<PsiTriggerSpec>& specs, std::string& error) {
+        std::lock_guard<std::mutex> lk(trigger_control_mu_);
+        stop_pressure_watch();
+        if (specs.empty()) return true;
+        auto triggers = std::make_unique<PsiTriggerSet>(root());
+        for (const auto& spec : specs) {
+            if (!triggers->add(spec, error)) return false;
+        }
+        triggers_ = std::move(triggers);
+        pressure_events_.store(0, std::memory_order_relaxed);
+        trigger_stop_.store(false, std::memory_order_relaxed);
+        trigger_worker_ = std::thread([this] { watch_pressure(); });
+        return true;
+    }
+
+    std::vector<PsiTriggerSpec> pressure_triggers() {
+        std::lock_guard<std::mutex> lk(trigger_control_mu_);
+        return triggers_ ? triggers_->specs() : std::vector<PsiTriggerSpec>{};
+    }
+
+    // Device engines rebuild their source index on the next tick (e.g. after sysfs permissions changed).
+    void request_rescan() { rescan_requested_.store(true, std::memory_order_relaxed); }
+
+    // While idle (window hidden/minimized) every engine period is stretched by SampleScheduler::kIdleFactor.
+    void set_idle(bool idle) {
+        schedule_idle_.store(idle, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            wake_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    bool idle() const { return schedule_idle_.load(std::memory_order_relaxed); }
+
+    // Per-engine schedule as of the last tick, indexed like kSamplerEngines.
+    void schedule_stats(SampleScheduler::EngineStats (&out)[kSamplerEngineCount]) {
+        std::lock_guard<std::mutex> lk(stats_mu_);
+        std::copy(std::begin(schedule_stats_), std::end(schedule_stats_), std::begin(out));
+    }
+
+    // Latency histograms and I/O counts per engine ("tick" for a whole tick); Python-timed calls land here too.
+    EngineStatsRegistry& engine_stats() { return stats_; }
+
+    // Every tick is also appended here; series names match the UI metric names.
+    HistoryStore& history() { return history_; }
+
+private:
+    // Control state (guarded by mu_).
+    std::mutex mu_;
+    std::condition_variable cv_;
+    uint32_t mask_ = 0;
+    int interval_ms_ = 250;
+    bool stop_requested_ = false;
+    bool wake_ = false;
+    SourceRoot root_;          // sampling thread (or collect() caller) only
+    SourceRoot pending_root_;  // guarded by mu_
+    std::vector<std::string> net_skip_ = NetActivityEngine::default_skip_prefixes();  // guarded by mu_
+    std::atomic<bool> net_skip_dirty_{false};
+
+    std::mutex trigger_control_mu_;  // serializes set_pressure_triggers
+    std::unique_ptr<PsiTriggerSet> triggers_;  // owned by trigger_worker_ while it runs
+    std::thread trigger_worker_;
+    std::atomic<bool> trigger_stop_{false};
+    std::atomic<uint32_t> pressure_fired_{0};  // (1 << PsiResource) fired since the last tick
+    std::atomic<uint64_t> pressure_events_{0};
+
+    std::mutex control_mu_;  // serializes start/stop
+    std::mutex reader_mu_;   // serializes readers; the writer never takes it
+    std::thread worker_;
+    SnapshotBuffer<SamplerSnapshot> buffer_;
+    uint64_t generation_ = 0;
+    HistoryStore history_;
+    std::vector<std::string> core_names_;  // "cpuN", built once per id
+    std::string name_scratch_;
+    std::mutex shm_mu_;  // publish_shm/unpublish_shm vs the tick
+    ShmWriter shm_;
+    SnapshotShmCodec shm_codec_;
+    std::mutex stream_mu_;  // stream_to/stream_stop vs the tick
+    NodeStreamSender stream_;
+    SnapshotShmCodec stream_codec_;
+    std::atomic<bool> rescan_requested_{false};
+    SamplerSnapshot work_;            // tick under construction; skipped engines keep last values here
+    SampleScheduler schedule_;        // sampler thread only
+    EngineStatsRegistry stats_;
+    std::atomic<bool> schedule_idle_{false};
+    std::mutex stats_mu_;
+    SampleScheduler::EngineStats schedule_stats_[kSamplerEngineCount];
+
+    // Engine instances live on the sampler thread only and are created on first use. Engines with device
+    // discovery construct on their own threads meanwhile; until they are ready the tick skips them.
+    DeferredEngine<CpuSensing> cpu_;
+    DeferredEngine<RamSensing> ram_;
+    DeferredEngine<DiscActivityEngine> disc_;
+    DeferredEngine<NetActivityEngine> net_;
+    DeferredEngine<BtActivityEngine> bt_;
+    DeferredEngine<PowerTelemetryEngine> psu_;
+    DeferredEngine<GpuOthers> gpu_others_;
+    DeferredEngine<GpuTempEngine> gpu_temp_;
+    DeferredEngine<PressureEngine> pressure_;
+    uint32_t constructing_ = 0;  // masked engines still constructing, as of the last tick
+    double disc_avg_ = 0.0;
+    std::vector<GpuCardReading> gpu_busy_cards_;  // last gpu_others pass
+    std::vector<GpuCardReading> gpu_temp_cards_;  // last gpu_temp pass
+
+    static constexpr int kMinGapMs = 10;
+
+    static int clamp_interval(int interval_ms) {
+        if (interval_ms < 20) return 20;
+        if (interval_ms > 60'000) return 60'000;
+        return interval_ms;
+    }
+
+    int current_interval() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return interval_ms_;
+    }
+
+    // Starts the engine of bit when mask has it. Returns true while its construction is still running.
+    template <typename Engine>
+    bool prepare(DeferredEngine<Engine>& slot, uint32_t mask, uint32_t bit, bool in_background) {
+        if (!(mask & bit)) return false;
+        if (!slot.started()) {
+            auto factory = [root = root_] { return std::make_unique<Engine>(root); };
+            if (!in_background) {
+                slot.start_now(factory);
+                return false;
+            }
+            slot.start(factory, [this] {
+                {
+                    std::lock_guard<std::mutex> lk(mu_);
+                    wake_ = true;
+                }
+                cv_.notify_all();
+            });
+        }
+        return !slot.ready();
+    }
+
+    // Cpu, ram, net and pressure open a few fixed files; the others walk sysfs, hwmon or D-Bus first.
+    uint32_t prepare_engines(uint32_t mask) {
+        uint32_t constructing = 0;
+        if (prepare(cpu_, mask, kSampleCpu, false)) constructing |= kSampleCpu;
+        if (prepare(ram_, mask, kSampleRam, false)) constructing |= kSampleRam;
+        if (prepare(net_, mask, kSampleNet, false)) constructing |= kSampleNet;
+        if (prepare(pressure_, mask, kSamplePressure, false)) constructing |= kSamplePressure;
+        if (prepare(disc_, mask, kSampleDisc, true)) constructing |= kSampleDisc;
+        if (prepare(bt_, mask, kSampleBt, true)) constructing |= kSampleBt;
+        if (prepare(psu_, mask, kSamplePsu, true)) constructing |= kSamplePsu;
+        if (prepare(gpu_others_, mask, kSampleGpuOthers, true)) constructing |= kSampleGpuOthers;
+        if (prepare(gpu_temp_, mask, kSampleGpuTemp, true)) constructing |= kSampleGpuTemp;
+        return constructing;
+    }
+
+    void apply_pending_root() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            if (pending_root_ == root_) return;
+            root_ = pending_root_;
+        }
+        cpu_.reset();
+        ram_.reset();
+        disc_.reset();
+        net_.reset();
+        net_skip_dirty_.store(true, std::memory_order_relaxed);  // the new engine starts from the defaults
+        bt_.reset();
+        psu_.reset();
+        gpu_others_.reset();
+        gpu_temp_.reset();
+        pressure_.reset();
+        disc_avg_ = 0.0;
+        gpu_busy_cards_.clear();
+        gpu_temp_cards_.clear();
+        work_ = SamplerSnapshot{};
+        schedule_ = SampleScheduler{};
+    }
+
+    // Caller holds trigger_control_mu_.
+    void stop_pressure_watch() {
+        if (trigger_worker_.joinable()) {
+            trigger_stop_.store(true, std::memory_order_relaxed);
+            triggers_->interrupt();
+            trigger_worker_.join();
+        }
+        triggers_.reset();
+        pressure_fired_.store(0, std::memory_order_relaxed);
+    }
+
+    // Blocks in poll() on the trigger fds; the sampler thread's sleep is a condition variable, so an
+    // event is handed over as pressure_fired_ plus a wakeup.
+    void watch_pressure() {
+        while (!trigger_stop_.load(std::memory_order_relaxed) && triggers_->size() > 0) {
+            const uint32_t fired = triggers_->wait(-1);
+            if (!fired) continue;
+            pressure_fired_.fetch_or(fired, std::memory_order_relaxed);
+            pressure_events_.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                wake_ = true;
+            }
+            cv_.notify_all();
+        }
+    }
+
+    // Cards are few (1-8); a linear match by name keeps the busy entries' order.
+    static void merge_gpu_temps(std::vector<GpuCardReading>& cards, const std::vector<GpuCardReading>& temps) {
+        for (const auto& t : temps) {
+            auto it = std::find_if(cards.begin(), cards.end(), [&](const GpuCardReading& c) { return c.card == t.card; });
+            if (it != cards.end()) it->temp_c = t.temp_c;
+            else cards.push_back(t);
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lk(mu_);
+        while (!stop_requested_) {
+            const uint32_t mask = mask_;
+            const int interval_ms = interval_ms_;
+            wake_ = false;
+            lk.unlock();
+            tick(mask, interval_ms);
+            lk.lock();
+
+            // Sleep until the first engine is due rather than a fixed interval; a tick on which
+            // nothing runs is never scheduled. A slow tick does not turn into catch-up bursts,
+            // since due times are measured from each engine's last run.
+            const auto now = std::chrono::steady_clock::now();
+            // An engine still constructing wakes the loop itself when it is ready.
+            const auto next = std::max(schedule_.next_due(mask & ~constructing_, now), now + std::chrono::milliseconds(kMinGapMs));
+            cv_.wait_until(lk, next, [this] { return stop_requested_ || wake_; });
+        }
+    }
+
+    // Runs one engine when it is due. fn fills snap and returns its headline value (NaN for none),
+    // or nullopt when it produced nothing; its cost and value feed the schedule.
+    template <typename Fn>
+    void run_engine(SamplerSnapshot& snap, uint32_t due, uint32_t bit, Fn&& fn) {
+        if (!(due & bit)) return;
+        const PinnedIoCounters io0 = pinned_io_counters();
+        const auto start = std::chrono::steady_clock::now();
+        double value = std::numeric_limits<double>::quiet_NaN();
+        bool ok = false;
+        try {
+            ok = fn(value);
+        } catch (...) {
+        }
+        const auto end = std::chrono::steady_clock::now();
+        if (ok) {
+            snap.sampled |= bit;
+            snap.fresh |= bit;
+        } else {
+            snap.sampled &= ~bit;
+        }
+        const PinnedIoCounters io1 = pinned_io_counters();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        stats_.record(sampler_engine_name(bit), static_cast<uint64_t>(ns), ok, io1.reads - io0.reads, io1.opens - io0.opens);
+        schedule_.ran(bit, end, static_cast<double>(ns) / 1000.0, value);
+    }
+
+    // wait_for_engines blocks until the engines in mask are constructed (collect() without the thread);
+    // otherwise the ones not yet ready are left out of this tick.
+    void tick(uint32_t mask, int interval_ms, bool wait_for_engines = false) {
+        // Per thread: collect() may tick on the caller's thread while the sampler thread is stopped.
+        thread_local ThreadSyscallCounter syscall_counter;
+        uint64_t sys0 = 0;
+        const bool have_sys = syscall_counter.sample(sys0);
+        const uint64_t cpu0 = thread_cpu_ns();
+        const PinnedIoCounters io0 = pinned_io_counters();
+        apply_pending_root();
+        const auto t0 = std::chrono::steady_clock::now();
+        // Engines that are not due keep their last values, so the tick is built on a persistent snapshot.
+        SamplerSnapshot& snap = work_;
+        snap.sampled &= mask;
+        snap.fresh = 0;
+        if (schedule_idle_.load(std::memory_order_relaxed) != schedule_.idle()) {
+            schedule_.set_idle(schedule_idle_.load(std::memory_order_relaxed));
+        }
+        constructing_ = prepare_engines(mask);
+        if (wait_for_engines) constructing_ = 0;
+        const uint32_t fired = pressure_fired_.exchange(0, std::memory_order_relaxed);
+        uint32_t due = schedule_.due(mask, t0, interval_ms);
+        if (fired) due |= mask & kSamplePressure;
+        due &= ~constructing_;
+        const bool rescan = rescan_requested_.exchange(false, std::memory_order_relaxed);
+        if (rescan) {
+            if (auto* psu = psu_.get_if_ready()) psu->rescan();
+            if (auto* gpu = gpu_others_.get_if_ready()) gpu->rescan();
+            if (auto* gpu = gpu_temp_.get_if_ready()) gpu->rescan();
+            if (auto* bt = bt_.get_if_ready()) bt->rescan();
+        }
+
+        run_engine(snap, due, kSampleCpu, [&](double& value) {
+            // Per-core mode also yields the aggregate, so /proc/stat is read once per tick.
+            auto& cpu = cpu_.get();
+            if (!cpu.sample_cores()) return false;
+            snap.cpu = cpu.cores_total_usage();
+            snap.cpu_cores = cpu.core_table();
+            value = snap.cpu;
+            return true;
+        });
+
+        run_engine(snap, due, kSampleRam, [&](double& value) {
+            value = snap.ram = ram_.get().get_usage();
+            return true;
+        });
+
+        // Slots are reused, so copy-assigning the engine lists keeps their capacity.
+        run_engine(snap, due, kSampleDisc, [&](double& value) {
+            auto& disc = disc_.get();
+            snap.disc_all = disc.get_all_usage();
+            snap.disc_stats = disc.last_stats();
+            if (!snap.disc_all.empty()) {
+                double sum = 0.0;
+                for (const auto& [_, v] : snap.disc_all) sum += v;
+                disc_avg_ = sum / static_cast<double>(snap.disc_all.size());
+            }
+            value = snap.disc = disc_avg_;
+            return true;
+        });
+        if (!(snap.sampled & kSampleDisc)) {
+            snap.disc_all.clear();
+            snap.disc_stats.clear();
+        }
+
+        run_engine(snap, due, kSampleNet, [&](double& value) {
+            auto& net = net_.get();
+            if (net_skip_dirty_.exchange(false, std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lk(mu_);
+                net.set_skip_prefixes(net_skip_);
+            }
+            snap.net_all = net.get_all_usage();
+            snap.net_ifaces = net.last_rates();
+            snap.net = net.get_total_mbps();
+            snap.net_rx = net.get_rx_mbps();
+            snap.net_tx = net.get_tx_mbps();
+            value = snap.net;
+            return true;
+        });
+        if (!(snap.sampled & kSampleNet)) {
+            snap.net_all.clear();
+            snap.net_ifaces.clear();
+        }
+
+        run_engine(snap, due, kSampleBt, [&](double& value) {
+            snap.bt_all = bt_.get().get_all_usage();
+            double total = 0.0;
+            for (const auto& a : snap.bt_all) total += a.rx_mbps + a.tx_mbps;
+            value = total;
+            return true;
+        });
+        if (!(snap.sampled & kSampleBt)) snap.bt_all.clear();
+
+        run_engine(snap, due, kSamplePsu, [&](double& value) {
+            // Reads only the indexed sensor files; get_usage() is the clamped total of the same snapshot.
+            snap.psu_all = psu_.get().get_all_usage();
+            value = snap.psu = std::max(0.0, snap.psu_all.total_w);
+            return true;
+        });
+
+        run_engine(snap, due, kSampleGpuOthers, [&](double& value) {
+            gpu_busy_cards_ = gpu_others_.get().get_all_usage();
+            value = snap.gpu_others = GpuOthers::busiest(gpu_busy_cards_);
+            return true;
+        });
+
+        run_engine(snap, due, kSampleGpuTemp, [&](double& value) {
+            gpu_temp_cards_ = gpu_temp_.get().get_all_usage();
+            value = snap.gpu_temp = GpuTempEngine::hottest(gpu_temp_cards_);
+            return true;
+        });
+
+        run_engine(snap, due, kSamplePressure, [&](double& value) {
+            snap.pressure_all = pressure_.get().sample();
+            snap.pressure_fired = fired;
+            value = snap.pressure = snap.pressure_all.resources[kPsiMemory].some_pct;
+            return snap.pressure_all.has_psi || snap.pressure_all.has_vmstat;
+        });
+        snap.pressure_events = pressure_events_.load(std::memory_order_relaxed);
+
+        // Busy and temp may run on different ticks; the per-card list is rebuilt from both latest passes.
+        snap.gpu_cards.clear();
+        if (snap.sampled & kSampleGpuOthers) snap.gpu_cards = gpu_busy_cards_;
+        if (snap.sampled & kSampleGpuTemp) merge_gpu_temps(snap.gpu_cards, gpu_temp_cards_);
+
+        const auto t1 = std::chrono::steady_clock::now();
+        snap.tick_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        {
+            const PinnedIoCounters io1 = pinned_io_counters();
+            uint64_t sys1 = 0;
+            // The opening probe read is counted in the delta; the closing one is not yet.
+            const uint64_t syscalls = have_sys && syscall_counter.sample(sys1) && sys1 > sys0 ? sys1 - sys0 - 1 : 0;
+            stats_.record_tick("tick", static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()),
+                               io1.reads - io0.reads, io1.opens - io0.opens, syscalls, thread_cpu_ns() - cpu0);
+        }
+        snap.timestamp_s = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        snap.generation = ++generation_;
+        record_history(snap);
+        {
+            std::lock_guard<std::mutex> lk(shm_mu_);
+            if (shm_.is_open()) shm_codec_.encode(snap, shm_);
+        }
+        {
+            std::lock_guard<std::mutex> lk(stream_mu_);
+            const auto now = std::chrono::steady_clock::now();
+            if (stream_.ready(now)) {
+                stream_codec_.encode(snap, stream_.encoder());
+                stream_.send_frame(now);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lk(stats_mu_);
+            for (size_t i = 0; i < kSamplerEngineCount; ++i) schedule_stats_[i] = schedule_.stats(i);
+        }
+        buffer_.back() = snap;
+        buffer_.publish();
+    }
+
+    const std::string& core_name(size_t id) {
+        while (core_names_.size() <= id) core_names_.push_back("cpu" + std::to_string(core_names_.size()));
+        return core_names_[id];
+    }
+
+    const std::string& prefixed(std::string_view prefix, std::string_view name) {
+        name_scratch_.assign(prefix);
+        name_scratch_.append(name);
+        return name_scratch_;
+    }
+
+    // Only engines that ran this tick are appended; carried-over values would add flat duplicates.
+    void record_history(const SamplerSnapshot& snap) {
+        HistoryStore::Batch batch(history_, snap.timestamp_s);
+        if (snap.fresh & kSampleCpu) {
+            batch.add("cpu", snap.cpu);
+            const CpuCoreTable& cores = snap.cpu_cores;
+            for (size_t id = 0; id < cores.rows; ++id) {
+                if (cores.online[id]) batch.add(core_name(id), cores.values[id * kCoreColumns + kCoreUsage]);
+            }
+        }
+        if (snap.fresh & kSampleRam) batch.add("ram", snap.ram);
+        if (snap.fresh & kSampleDisc) {
+            if (snap.disc_all.empty()) batch.add("disk:disk", snap.disc);
+            for (const auto& [name, v] : snap.disc_all) batch.add(prefixed("disk:", name), v);
+            for (const auto& r : snap.disc_stats) {
+                batch.add(prefixed("disk_read:", r.label), r.read_mib_s);
+                batch.add(prefixed("disk_write:", r.label), r.write_mib_s);
+            }
+        }
+        if (snap.fresh & kSampleNet) {
+            batch.add("net_total", snap.net);
+            batch.add("net_rx", snap.net_rx);
+            batch.add("net_tx", snap.net_tx);
+            for (const auto& [name, v] : snap.net_all) batch.add(prefixed("net:", name), v);
+        }
+        if (snap.fresh & kSamplePsu) batch.add("psu", snap.psu);
+        if (snap.fresh & kSampleGpuOthers) batch.add("gpu", snap.gpu_others);
+        if (snap.fresh & kSampleGpuTemp) batch.add("gpu_temp", snap.gpu_temp);
+        if (snap.fresh & kSamplePressure) {
+            for (int r = 0; r < kPsiResourceCount; ++r) {
+                const PressureEngine::Resource& res = snap.pressure_all.resources[r];
+                if (res.available) batch.add(prefixed("psi:", psi_resource_name(r)), res.some_pct);
+            }
+            if (snap.pressure_all.has_vmstat) batch.add("majfault_ps", snap.pressure_all.majfault_ps);
+        }
+        // Per-card series use the UI's gpu:<pci slot> metric names.
+        if (!(snap.fresh & kSampleGpuOthers)) return;
+        for (const auto& c : snap.gpu_cards) {
+            if (c.slot.empty() || std::isnan(c.busy_pct)) continue;
+            batch.add(prefixed("gpu:", c.slot), c.busy_pct);
+        }
+    }
+};
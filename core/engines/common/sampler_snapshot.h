@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bt_engine.h"
+#include "cpu_engine.h"
+#include "disc_engine.h"
+#include "gpu_cards.h"
+#include "net_engine.h"
+#include "pressure_engine.h"
+#include "psu_engine.h"
+
+enum SamplerEngine : uint32_t {
+    kSampleCpu = 1u << 0,
+    kSampleRam = 1u << 1,
+    kSampleDisc = 1u << 2,
+    kSampleNet = 1u << 3,
+    kSampleBt = 1u << 4,
+    kSamplePsu = 1u << 5,
+    kSampleGpuOthers = 1u << 6,
+    kSampleGpuTemp = 1u << 7,
+    kSamplePressure = 1u << 8,
+};
+
+struct SamplerEngineInfo {
+    const char* name;
+    uint32_t bit;
+    int natural_ms;  // shortest useful period; 0 = every tick
+};
+
+// Names match the standalone engine modules, so Python can pass its active_engines list as-is.
+// Natural periods follow how fast the source moves: load/throughput every tick, RAM and
+// power (RAPL/hwmon averaging windows) twice a second, thermals, Bluetooth and pressure stalls once
+// a second (a PSI trigger, Sampler::set_pressure_triggers, runs pressure at once).
+inline constexpr SamplerEngineInfo kSamplerEngines[] = {
+    {"cpu", kSampleCpu, 0},
+    {"ram", kSampleRam, 500},
+    {"disc", kSampleDisc, 0},
+    {"net", kSampleNet, 0},
+    {"bt", kSampleBt, 1000},
+    {"psu", kSamplePsu, 500},
+    {"gpu_others", kSampleGpuOthers, 0},
+    {"gpu_temp", kSampleGpuTemp, 1000},
+    {"pressure", kSamplePressure, 1000},
+};
+
+inline constexpr size_t kSamplerEngineCount = sizeof(kSamplerEngines) / sizeof(kSamplerEngines[0]);
+
+inline uint32_t sampler_engine_bit(const std::string& name) {
+    for (const auto& e : kSamplerEngines) {
+        if (name == e.name) return e.bit;
+    }
+    return 0;
+}
+
+inline const char* sampler_engine_name(uint32_t bit) {
+    for (const auto& e : kSamplerEngines) {
+        if (bit == e.bit) return e.name;
+    }
+    return "";
+}
+
+struct SamplerSnapshot {
+    uint64_t generation = 0;
+    double timestamp_s = 0.0;  // wall clock, comparable with Python time.time()
+    double tick_ms = 0.0;      // how long the engines took for this tick
+    uint32_t sampled = 0;      // SamplerEngine bits with data (fresh or carried over from their last run)
+    uint32_t fresh = 0;        // subset of sampled that actually ran this tick
+
+    double cpu = 0.0;
+    CpuCoreTable cpu_cores;
+    double ram = 0.0;
+
+    double disc = 0.0;
+    std::vector<std::pair<std::string, double>> disc_all;
+    std::vector<DiscActivityEngine::DiskRecord> disc_stats;
+
+    double net = 0.0;
+    double net_rx = 0.0;
+    double net_tx = 0.0;
+    std::vector<std::pair<std::string, double>> net_all;
+    std::vector<NetActivityEngine::IfRates> net_ifaces;  // same interfaces as net_all, per direction
+
+    std::vector<BtActivityEngine::AdapterSample> bt_all;
+
+    double psu = 0.0;
+    PowerTelemetryEngine::Snapshot psu_all;
+
+    double gpu_others = 0.0;
+    double gpu_temp = 0.0;
+    std::vector<GpuCardReading> gpu_cards;  // busy (gpu_others) and temp (gpu_temp) merged per card
+
+    double pressure = 0.0;  // memory "some" stall %
+    PressureEngine::Snapshot pressure_all;
+    uint64_t pressure_events = 0;  // PSI trigger wakeups since the triggers were set
+    uint32_t pressure_fired = 0;   // (1 << PsiResource) of triggers behind this pressure run; 0 for a scheduled one
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+// Allocation-free text scanning for /proc and /sys content.
+// A Cursor walks a std::string_view; every result is a view into the same buffer.
+namespace lxscan {
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t'; }
+
+inline bool is_space(char c) { return is_blank(c) || c == '\n' || c == '\r'; }
+
+inline std::string_view trim(std::string_view s) {
+    size_t b = 0;
+    while (b < s.size() && is_space(s[b])) b++;
+    size_t e = s.size();
+    while (e > b && is_space(s[e - 1])) e--;
+    return s.substr(b, e - b);
+}
+
+inline bool starts_with(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+class Cursor {
+public:
+    Cursor() = default;
+    explicit Cursor(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    bool eof() const { return p_ >= end_; }
+    std::string_view rest() const { return std::string_view(p_, static_cast<size_t>(end_ - p_)); }
+
+    // Spaces and tabs only; newlines are line boundaries.
+    void skip_blanks() {
+        while (p_ < end_ && is_blank(*p_)) ++p_;
+    }
+
+    // Next line without the trailing '\n'. Returns false at EOF.
+    bool line(std::string_view& out) {
+        if (p_ >= end_) return false;
+        const char* start = p_;
+        while (p_ < end_ && *p_ != '\n') ++p_;
+        out = std::string_view(start, static_cast<size_t>(p_ - start));
+        if (p_ < end_) ++p_;
+        return true;
+    }
+
+    void skip_line() {
+        std::string_view ignored;
+        line(ignored);
+    }
+
+    // Next run of non-whitespace characters on the current line.
+    std::string_view token() {
+        skip_blanks();
+        const char* start = p_;
+        while (p_ < end_ && !is_space(*p_)) ++p_;
+        return std::string_view(start, static_cast<size_t>(p_ - start));
+    }
+
+    // Everything up to (not including) c; c itself is consumed. Without c, takes the rest.
+    std::string_view until(char c) {
+        const char* start = p_;
+        while (p_ < end_ && *p_ != c) ++p_;
+        std::string_view out(start, static_cast<size_t>(p_ - start));
+        if (p_ < end_) ++p_;
+        return out;
+    }
+
+    // Leading blanks are skipped. On failure the cursor does not move past the blanks.
+    template <typename T>
+    bool number(T& out) {
+        skip_blanks();
+        const auto res = std::from_chars(p_, end_, out);
+        if (res.ec != std::errc()) return false;
+        p_ = res.ptr;
+        return true;
+    }
+
+    // Reads up to max numbers from the current line; returns how many were parsed.
+    template <typename T>
+    int numbers(T* out, int max) {
+        int n = 0;
+        while (n < max && number(out[n])) n++;
+        return n;
+    }
+
+private:
+    const char* p_ = nullptr;
+    const char* end_ = nullptr;
+};
+
+}  // namespace lxscan
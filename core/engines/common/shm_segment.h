@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Versioned POSIX shared-memory segment carrying one metrics snapshot, guarded by a seqlock.
+// One writer (holds flock(LOCK_EX) on the segment while alive), any number of readers.
+//
+// Layout (little-endian, offsets in bytes):
+//   0  char[8]  magic "LXMONSHM"       40 u64 generation
+//   8  u32      version                48 f64 timestamp_s (wall clock)
+//   12 u32      header_size (128)      56 f64 tick_ms
+//   16 u64      segment_size           64 u32 sampled (SamplerEngine bits)
+//   24 u64      seq (odd = writing)    68 u32 entry_count
+//   32 i32      writer_pid             72 u64 payload_size
+//   36 u32      flags (1 = truncated)
+// Payload at header_size: entry_count entries, each 8-byte aligned:
+//   u32 key_len, u32 text_len, u32 count, u32 reserved, key bytes, text bytes, pad to 8, f64[count].
+// Readers copy header + payload, then re-check seq; a changed or odd seq means retry.
+
+inline constexpr char kShmMagic[8] = {'L', 'X', 'M', 'O', 'N', 'S', 'H', 'M'};
+inline constexpr uint32_t kShmVersion = 1;
+inline constexpr uint32_t kShmHeaderSize = 128;
+inline constexpr size_t kShmDefaultSize = 256 * 1024;
+inline constexpr uint32_t kShmTruncated = 1u << 0;
+inline constexpr const char* kShmDefaultName = "/lxmonitor";
+
+struct ShmHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t segment_size;
+    std::atomic<uint64_t> seq;
+    int32_t writer_pid;
+    uint32_t flags;
+    uint64_t generation;
+    double timestamp_s;
+    double tick_ms;
+    uint32_t sampled;
+    uint32_t entry_count;
+    uint64_t payload_size;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "seqlock counter must be lock-free in shared memory");
+static_assert(offsetof(ShmHeader, seq) == 24 && offsetof(ShmHeader, generation) == 40, "ShmHeader layout");
+static_assert(offsetof(ShmHeader, payload_size) == 72 && sizeof(ShmHeader) <= kShmHeaderSize, "ShmHeader layout");
+
+struct ShmEntryHeader {
+    uint32_t key_len;
+    uint32_t text_len;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+inline size_t shm_align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+// Consistent copy of one published snapshot.
+struct ShmFrame {
+    int32_t writer_pid = 0;
+    uint32_t flags = 0;
+    uint64_t generation = 0;
+    double timestamp_s = 0.0;
+    double tick_ms = 0.0;
+    uint32_t sampled = 0;
+    uint32_t entry_count = 0;
+    std::vector<uint64_t> payload;  // 8-byte aligned copy
+    size_t payload_size = 0;
+};
+
+// Calls fn(std::string_view key, std::string_view text, const double* values, size_t count) per entry.
+template <typename Fn>
+inline void shm_for_each_entry(const ShmFrame& frame, Fn&& fn) {
+    const char* base = reinterpret_cast<const char*>(frame.payload.data());
+    size_t pos = 0;
+    for (uint32_t i = 0; i < frame.entry_count; ++i) {
+        if (pos + sizeof(ShmEntryHeader) > frame.payload_size) return;
+        ShmEntryHeader eh;
+        std::memcpy(&eh, base + pos, sizeof(eh));
+        const size_t strings = shm_align8(static_cast<size_t>(eh.key_len) + eh.text_len);
+        const size_t size = sizeof(eh) + strings + static_cast<size_t>(eh.count) * sizeof(double);
+        if (pos + size > frame.payload_size) return;
+        const char* str = base + pos + sizeof(eh);
+        const auto* values = reinterpret_cast<const double*>(str + strings);
+        fn(std::string_view(str, eh.key_len), std::string_view(str + eh.key_len, eh.text_len), values, static_cast<size_t>(eh.count));
+        pos += size;
+    }
+}
+
+class ShmWriter {
+public:
+    ShmWriter() = default;
+    ShmWriter(const ShmWriter&) = delete;
+    ShmWriter& operator=(const ShmWriter&) = delete;
+    ~ShmWriter() { close(); }
+
+    bool is_open() const { return header_ != nullptr; }
+    const std::string& name() const { return name_; }
+
+    // Creates (or takes over a stale) segment. Fails with a message when another writer holds it.
+    bool open(const std::string& name, size_t size, std::string& error) {
+        close();
+        if (size < kShmHeaderSize + 4096) size = kShmHeaderSize + 4096;
+        // Owner only: the GUI and scripts reading it run as the collector's user, and the snapshot (process and
+        // service names, per-device activity) is not for other users of the host.
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            error = "shm_open(" + name + "): " + std::strerror(errno);
+            return false;
+        }
+        if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            error = "segment " + name + " already has a live writer";
+            ::close(fd);
+            return false;
+        }
+        // A stale segment left by an older writer keeps its size when that is larger: readers that still map
+        // the old size would get SIGBUS past a shrunk end.
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            error = std::string("fstat: ") + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        size = std::max(size, static_cast<size_t>(st.st_size));
+        ::fchmod(fd, 0600);
+        if (static_cast<size_t>(st.st_size) < size && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            error = std::string("ftruncate: ") + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            error = std::string("mmap: ") + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+
+        fd_ = fd;
+        size_ = size;
+        name_ = name;
+        base_ = static_cast<char*>(map);
+        header_ = reinterpret_cast<ShmHeader*>(base_);
+
+        // Odd seq keeps readers away while the header is (re)initialized.
+        const uint64_t seq = header_->seq.load(std::memory_order_relaxed);
+        header_->seq.store((seq | 1u) + 2u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->version = kShmVersion;
+        header_->header_size = kShmHeaderSize;
+        header_->segment_size = size;
+        header_->writer_pid = static_cast<int32_t>(::getpid());
+        header_->flags = 0;
+        header_->generation = 0;
+        header_->entry_count = 0;
+        header_->payload_size = 0;
+        std::memcpy(header_->magic, kShmMagic, sizeof(kShmMagic));
+        header_->seq.store(header_->seq.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+        return true;
+    }
+
+    // Unmaps and removes the name, so readers see the writer is gone.
+    void close() {
+        if (!header_) return;
+        header_->writer_pid = 0;
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+        ::close(fd_);
+        header_ = nullptr;
+        base_ = nullptr;
+        fd_ = -1;
+        size_ = 0;
+    }
+
+    // begin(); add()...; commit(...). Entries that do not fit set the truncated flag.
+    void begin() {
+        const uint64_t seq = header_->seq.load(std::memory_order_relaxed);
+        header_->seq.store(seq + 1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        pos_ = 0;
+        entries_ = 0;
+        flags_ = 0;
+    }
+
+    bool add(std::string_view key, const double* values, size_t count, std::string_view text = {}) {
+        const size_t strings = shm_align8(key.size() + text.size());
+        const size_t need = sizeof(ShmEntryHeader) + strings + count * sizeof(double);
+        if (kShmHeaderSize + pos_ + need > size_) {
+            flags_ |= kShmTruncated;
+            return false;
+        }
+        char* p = base_ + kShmHeaderSize + pos_;
+        const ShmEntryHeader eh{static_cast<uint32_t>(key.size()), static_cast<uint32_t>(text.size()), static_cast<uint32_t>(count), 0};
+        std::memcpy(p, &eh, sizeof(eh));
+        char* str = p + sizeof(eh);
+        std::memcpy(str, key.data(), key.size());
+        std::memcpy(str + key.size(), text.data(), text.size());
+        std::memset(str + key.size() + text.size(), 0, strings - key.size() - text.size());
+        if (count) std::memcpy(str + strings, values, count * sizeof(double));
+        pos_ += need;
+        ++entries_;
+        return true;
+    }
+
+    bool add(std::string_view key, double value, std::string_view text = {}) { return add(key, &value, 1, text); }
+
+    void commit(uint64_t generation, double timestamp_s, double tick_ms, uint32_t sampled) {
+        header_->generation = generation;
+        header_->timestamp_s = timestamp_s;
+        header_->tick_ms = tick_ms;
+        header_->sampled = sampled;
+        header_->entry_count = entries_;
+        header_->payload_size = pos_;
+        header_->flags = flags_;
+        header_->seq.store(header_->seq.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+    }
+
+private:
+    int fd_ = -1;
+    size_t size_ = 0;
+    std::string name_;
+    char* base_ = nullptr;
+    ShmHeader* header_ = nullptr;
+    size_t pos_ = 0;
+    uint32_t entries_ = 0;
+    uint32_t flags_ = 0;
+};
+
+class ShmReader {
+public:
+    ShmReader() = default;
+    ShmReader(const ShmReader&) = delete;
+    ShmReader& operator=(const ShmReader&) = delete;
+    ~ShmReader() { close(); }
+
+    bool is_open() const { return header_ != nullptr; }
+    const std::string& name() const { return name_; }
+
+    bool open(const std::string& name) {
+        close();
+        const int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0) return false;
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kShmHeaderSize) {
+            ::close(fd);
+            return false;
+        }
+        void* map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        fd_ = fd;
+        size_ = static_cast<size_t>(st.st_size);
+        name_ = name;
+        base_ = static_cast<const char*>(map);
+        header_ = reinterpret_cast<const ShmHeader*>(base_);
+        if (std::memcmp(header_->magic, kShmMagic, sizeof(kShmMagic)) != 0 || header_->version != kShmVersion ||
+            header_->header_size != kShmHeaderSize) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (!header_) return;
+        ::munmap(const_cast<char*>(base_), size_);
+        ::close(fd_);
+        header_ = nullptr;
+        base_ = nullptr;
+        fd_ = -1;
+        size_ = 0;
+    }
+
+    // The writer holds LOCK_EX for its whole life; if a shared lock can be taken, nobody is writing.
+    bool writer_alive() const {
+        if (fd_ < 0) return false;
+        if (::flock(fd_, LOCK_SH | LOCK_NB) == 0) {
+            ::flock(fd_, LOCK_UN);
+            return false;
+        }
+        return errno == EWOULDBLOCK;
+    }
+
+    bool read(ShmFrame& out, int attempts = 64) const {
+        if (!header_) return false;
+        for (int i = 0; i < attempts; ++i) {
+            const uint64_t s1 = header_->seq.load(std::memory_order_acquire);
+            if (s1 & 1u) {
+                std::this_thread::yield();
+                continue;
+            }
+            out.writer_pid = header_->writer_pid;
+            out.flags = header_->flags;
+            out.generation = header_->generation;
+            out.timestamp_s = header_->timestamp_s;
+            out.tick_ms = header_->tick_ms;
+            out.sampled = header_->sampled;
+            out.entry_count = header_->entry_count;
+            size_t payload = static_cast<size_t>(header_->payload_size);
+            if (payload > size_ - kShmHeaderSize) payload = size_ - kShmHeaderSize;
+            out.payload.resize((payload + 7) / 8);
+            std::memcpy(out.payload.data(), base_ + kShmHeaderSize, payload);
+            out.payload_size = payload;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->seq.load(std::memory_order_relaxed) == s1) return true;
+        }
+        return false;
+    }
+
+private:
+    int fd_ = -1;
+    size_t size_ = 0;
+    std::string name_;
+    const char* base_ = nullptr;
+    const ShmHeader* header_ = nullptr;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Single-writer triple buffer.
+// The writer fills back() and calls publish(); it never waits for readers.
+// A reader calls acquire() and then reads front() until its next acquire().
+// Every slot is owned by exactly one side at a time, so T can hold strings/vectors.
+template <typename T>
+class SnapshotBuffer {
+public:
+    T& back() { return slots_[back_]; }
+
+    void publish() {
+        const uint32_t prev = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_ = prev & kIndexMask;
+    }
+
+    // Returns false when nothing new was published since the last acquire().
+    bool acquire() {
+        if ((middle_.load(std::memory_order_acquire) & kFresh) == 0) return false;
+        const uint32_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = prev & kIndexMask;
+        return true;
+    }
+
+    const T& front() const { return slots_[front_]; }
+
+private:
+    static constexpr uint32_t kIndexMask = 0x3;
+    static constexpr uint32_t kFresh = 0x4;
+
+    T slots_[3];
+    uint32_t back_ = 0;
+    uint32_t front_ = 1;
+    std::atomic<uint32_t> middle_{2};
+};
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sampler_snapshot.h"
+#include "shm_segment.h"
+
+// SamplerSnapshot <-> shared-memory entries. Keys and values (f64) per entry:
+//   cpu [usage]                    cpu_cores [rows x 5: usage user system iowait steal], text: '1'/'0' online per row
+//   ram [usage]                    disc [average usage]
+//   disc:<label> [usage]           disc_stats:<label> [util read_mib_s write_mib_s read_iops write_iops
+//                                                      read_await_ms write_await_ms await_ms queue_depth in_flight], text: disk
+//   net [total rx tx]              net:<iface> [mbps]
+//   net_if:<iface> [rx_mbps tx_mbps rx_pps tx_pps rx_errs tx_errs rx_drops tx_drops] (per second)
+//   bt:<adapter> [rx_mbps tx_mbps rfkill_blocked connected_devices],
+//                text: name\taddress\tdriver\tslot\tvendor_id\tdevice_id\tchipset
+//   psu [total_w has_battery battery_count ac_online battery_total_w battery_discharge_w battery_charge_w
+//        battery_capacity_avg cpu_w gpu_w disk_w net_w board_w memory_w other_w], text: total source
+//   psu_source:<name> [w]          psu_blocked:<name> []
+//   gpu_others [usage]             gpu_temp [celsius]
+//   gpu_card:<card> [busy_pct temp_c] (NaN: not exposed), text: slot\tdriver
+//   pressure [memory_some interval_s majfault_ps swapin_ps swapout_ps pgscan_ps pgsteal_ps allocstall_ps oom_kills
+//             pgmajfault pswpin pswpout oom_kill has_vmstat trigger_events fired]
+//   psi:<cpu|memory|io> [some_pct full_pct some_avg10 some_avg60 some_avg300 full_avg10 full_avg60 full_avg300
+//                        some_total_us full_total_us has_full]
+// Readers must ignore keys they do not know; new keys do not bump kShmVersion.
+// encode() takes any writer with ShmWriter's begin/add/commit (NodeStreamEncoder streams the same entries).
+class SnapshotShmCodec {
+public:
+    template <typename Writer>
+    void encode(const SamplerSnapshot& snap, Writer& w) {
+        w.begin();
+        if (snap.sampled & kSampleCpu) {
+            w.add("cpu", snap.cpu);
+            const CpuCoreTable& t = snap.cpu_cores;
+            text_.assign(t.rows, '0');
+            for (size_t i = 0; i < t.rows; ++i) {
+                if (t.online[i]) text_[i] = '1';
+            }
+            w.add("cpu_cores", t.values.data(), t.rows * kCoreColumns, text_);
+        }
+        if (snap.sampled & kSampleRam) w.add("ram", snap.ram);
+
+        if (snap.sampled & kSampleDisc) {
+            w.add("disc", snap.disc);
+            for (const auto& [label, v] : snap.disc_all) w.add(key("disc:", label), v);
+            for (const auto& r : snap.disc_stats) {
+                const double v[] = {r.util_pct, r.read_mib_s, r.write_mib_s, r.read_iops, r.write_iops, r.read_await_ms,
+                                    r.write_await_ms, r.await_ms, r.queue_depth, static_cast<double>(r.in_flight)};
+                w.add(key("disc_stats:", r.label), v, sizeof(v) / sizeof(v[0]), r.disk);
+            }
+        }
+
+        if (snap.sampled & kSampleNet) {
+            const double totals[] = {snap.net, snap.net_rx, snap.net_tx};
+            w.add("net", totals, 3);
+            for (const auto& [iface, mbps] : snap.net_all) w.add(key("net:", iface), mbps);
+            for (const auto& r : snap.net_ifaces) {
+                const double v[] = {r.rx_mbps, r.tx_mbps, r.rx_pps, r.tx_pps, r.rx_errs, r.tx_errs, r.rx_drops, r.tx_drops};
+                w.add(key("net_if:", r.name), v, sizeof(v) / sizeof(v[0]));
+            }
+        }
+
+        if (snap.sampled & kSampleBt) {
+            for (const auto& s : snap.bt_all) {
+                const double v[] = {s.rx_mbps, s.tx_mbps, s.meta.rfkill_blocked ? 1.0 : 0.0, static_cast<double>(s.meta.connected_devices)};
+                text_.clear();
+                for (const std::string* field : {&s.meta.name, &s.meta.address, &s.meta.driver, &s.meta.slot, &s.meta.vendor_id, &s.meta.device_id,
+                                                 &s.meta.chipset}) {
+                    if (field != &s.meta.name) text_.push_back('\t');
+                    text_.append(*field);
+                }
+                w.add(key("bt:", s.adapter), v, sizeof(v) / sizeof(v[0]), text_);
+            }
+        }
+
+        if (snap.sampled & kSamplePsu) {
+            const auto& p = snap.psu_all;
+            const double v[] = {p.total_w, p.has_battery ? 1.0 : 0.0, static_cast<double>(p.battery_count), p.ac_online ? 1.0 : 0.0,
+                                p.battery_total_w, p.battery_discharge_w, p.battery_charge_w, p.battery_capacity_avg,
+                                p.cpu_w, p.gpu_w, p.disk_w, p.net_w, p.board_w, p.memory_w, p.other_w};
+            w.add("psu", v, sizeof(v) / sizeof(v[0]), p.total_source);
+            for (const auto& [name, watts] : p.sources_w) w.add(key("psu_source:", name), watts);
+            for (const auto& name : p.blocked_sources) w.add(key("psu_blocked:", name), nullptr, 0);
+        }
+
+        if (snap.sampled & kSampleGpuOthers) w.add("gpu_others", snap.gpu_others);
+        if (snap.sampled & kSampleGpuTemp) w.add("gpu_temp", snap.gpu_temp);
+        for (const auto& c : snap.gpu_cards) {
+            const double v[] = {c.busy_pct, c.temp_c};
+            text_.assign(c.slot);
+            text_.push_back('\t');
+            text_.append(c.driver);
+            w.add(key("gpu_card:", c.card), v, 2, text_);
+        }
+
+        if (snap.sampled & kSamplePressure) {
+            const auto& p = snap.pressure_all;
+            const double v[] = {snap.pressure, p.interval_s, p.majfault_ps, p.swapin_ps, p.swapout_ps, p.pgscan_ps, p.pgsteal_ps,
+                                p.allocstall_ps, static_cast<double>(p.oom_kills), static_cast<double>(p.vm.pgmajfault),
+                                static_cast<double>(p.vm.pswpin), static_cast<double>(p.vm.pswpout), static_cast<double>(p.vm.oom_kill),
+                                p.has_vmstat ? 1.0 : 0.0, static_cast<double>(snap.pressure_events), static_cast<double>(snap.pressure_fired)};
+            w.add("pressure", v, sizeof(v) / sizeof(v[0]));
+            for (int r = 0; r < kPsiResourceCount; ++r) {
+                const PressureEngine::Resource& res = p.resources[r];
+                if (!res.available) continue;
+                const lxproc::PsiInfo& psi = res.psi;
+                const double pv[] = {res.some_pct, res.full_pct, psi.some.avg10, psi.some.avg60, psi.some.avg300,
+                                     psi.full.avg10, psi.full.avg60, psi.full.avg300, static_cast<double>(psi.some.total_us),
+                                     static_cast<double>(psi.full.total_us), psi.has_full ? 1.0 : 0.0};
+                w.add(key("psi:", psi_resource_name(r)), pv, sizeof(pv) / sizeof(pv[0]));
+            }
+        }
+        w.commit(snap.generation, snap.timestamp_s, snap.tick_ms, snap.sampled);
+    }
+
+    static void decode(const ShmFrame& frame, SamplerSnapshot& snap) {
+        snap.generation = frame.generation;
+        snap.timestamp_s = frame.timestamp_s;
+        snap.tick_ms = frame.tick_ms;
+        snap.sampled = frame.sampled;
+        snap.fresh = frame.sampled;  // the frame does not carry the writer's schedule
+        snap.disc_all.clear();
+        snap.disc_stats.clear();
+        snap.net_all.clear();
+        snap.net_ifaces.clear();
+        snap.bt_all.clear();
+        snap.gpu_cards.clear();
+        snap.psu_all = PowerTelemetryEngine::Snapshot{};
+        snap.pressure_all = PressureEngine::Snapshot{};
+
+        shm_for_each_entry(frame, [&](std::string_view key, std::string_view text, const double* v, size_t n) {
+            auto at = [&](size_t i) { return i < n ? v[i] : 0.0; };
+            std::string_view rest;
+            if (key == "cpu") {
+                snap.cpu = at(0);
+            } else if (key == "cpu_cores") {
+                CpuCoreTable& t = snap.cpu_cores;
+                t.rows = n / kCoreColumns;
+                t.values.assign(v, v + t.rows * kCoreColumns);
+                t.online.assign(t.rows, 0);
+                for (size_t i = 0; i < t.rows && i < text.size(); ++i) t.online[i] = text[i] == '1';
+            } else if (key == "ram") {
+                snap.ram = at(0);
+            } else if (key == "disc") {
+                snap.disc = at(0);
+            } else if (strip(key, "disc:", rest)) {
+                snap.disc_all.emplace_back(std::string(rest), at(0));
+            } else if (strip(key, "disc_stats:", rest)) {
+                DiscActivityEngine::DiskRecord r;
+                r.label = std::string(rest);
+                r.disk = std::string(text);
+                r.util_pct = at(0);
+                r.read_mib_s = at(1);
+                r.write_mib_s = at(2);
+                r.read_iops = at(3);
+                r.write_iops = at(4);
+                r.read_await_ms = at(5);
+                r.write_await_ms = at(6);
+                r.await_ms = at(7);
+                r.queue_depth = at(8);
+                r.in_flight = static_cast<unsigned long long>(at(9));
+                snap.disc_stats.push_back(std::move(r));
+            } else if (key == "net") {
+                snap.net = at(0);
+                snap.net_rx = at(1);
+                snap.net_tx = at(2);
+            } else if (strip(key, "net:", rest)) {
+                snap.net_all.emplace_back(std::string(rest), at(0));
+            } else if (strip(key, "net_if:", rest)) {
+                NetActivityEngine::IfRates r;
+                r.name = std::string(rest);
+                r.rx_mbps = at(0);
+                r.tx_mbps = at(1);
+                r.rx_pps = at(2);
+                r.tx_pps = at(3);
+                r.rx_errs = at(4);
+                r.tx_errs = at(5);
+                r.rx_drops = at(6);
+                r.tx_drops = at(7);
+                snap.net_ifaces.push_back(std::move(r));
+            } else if (strip(key, "bt:", rest)) {
+                BtActivityEngine::AdapterSample s;
+                s.adapter = std::string(rest);
+                s.rx_mbps = at(0);
+                s.tx_mbps = at(1);
+                s.meta.rfkill_blocked = at(2) != 0.0;
+                s.meta.connected_devices = static_cast<int>(at(3));
+                std::string* fields[] = {&s.meta.name, &s.meta.address, &s.meta.driver, &s.meta.slot, &s.meta.vendor_id, &s.meta.device_id,
+                                         &s.meta.chipset};
+                size_t f = 0;
+                size_t pos = 0;
+                while (f < 7 && pos <= text.size()) {
+                    size_t end = text.find('\t', pos);
+                    if (end == std::string_view::npos) end = text.size();
+                    fields[f++]->assign(text.substr(pos, end - pos));
+                    pos = end + 1;
+                }
+                snap.bt_all.push_back(std::move(s));
+            } else if (key == "psu") {
+                auto& p = snap.psu_all;
+                p.total_w = at(0);
+                p.has_battery = at(1) != 0.0;
+                p.battery_count = static_cast<int>(at(2));
+                p.ac_online = at(3) != 0.0;
+                p.battery_total_w = at(4);
+                p.battery_discharge_w = at(5);
+                p.battery_charge_w = at(6);
+                p.battery_capacity_avg = at(7);
+                p.cpu_w = at(8);
+                p.gpu_w = at(9);
+                p.disk_w = at(10);
+                p.net_w = at(11);
+                p.board_w = at(12);
+                p.memory_w = at(13);
+                p.other_w = at(14);
+                p.total_source = std::string(text);
+                snap.psu = p.total_w > 0.0 ? p.total_w : 0.0;
+            } else if (strip(key, "psu_source:", rest)) {
+                snap.psu_all.sources_w.emplace_back(std::string(rest), at(0));
+            } else if (strip(key, "psu_blocked:", rest)) {
+                snap.psu_all.blocked_sources.emplace_back(rest);
+            } else if (key == "gpu_others") {
+                snap.gpu_others = at(0);
+            } else if (key == "gpu_temp") {
+                snap.gpu_temp = at(0);
+            } else if (key == "pressure") {
+                auto& p = snap.pressure_all;
+                snap.pressure = at(0);
+                p.interval_s = at(1);
+                p.majfault_ps = at(2);
+                p.swapin_ps = at(3);
+                p.swapout_ps = at(4);
+                p.pgscan_ps = at(5);
+                p.pgsteal_ps = at(6);
+                p.allocstall_ps = at(7);
+                p.oom_kills = static_cast<unsigned long long>(at(8));
+                p.vm.pgmajfault = static_cast<unsigned long long>(at(9));
+                p.vm.pswpin = static_cast<unsigned long long>(at(10));
+                p.vm.pswpout = static_cast<unsigned long long>(at(11));
+                p.vm.oom_kill = static_cast<unsigned long long>(at(12));
+                p.has_vmstat = at(13) != 0.0;
+                snap.pressure_events = static_cast<uint64_t>(at(14));
+                snap.pressure_fired = static_cast<uint32_t>(at(15));
+            } else if (strip(key, "psi:", rest)) {
+                const int r = psi_resource_from_name(std::string(rest));
+                if (r < 0) return;
+                PressureEngine::Resource& res = snap.pressure_all.resources[r];
+                res.available = true;
+                res.some_pct = at(0);
+                res.full_pct = at(1);
+                res.psi.some.avg10 = at(2);
+                res.psi.some.avg60 = at(3);
+                res.psi.some.avg300 = at(4);
+                res.psi.full.avg10 = at(5);
+                res.psi.full.avg60 = at(6);
+                res.psi.full.avg300 = at(7);
+                res.psi.some.total_us = static_cast<unsigned long long>(at(8));
+                res.psi.full.total_us = static_cast<unsigned long long>(at(9));
+                res.psi.has_full = at(10) != 0.0;
+                snap.pressure_all.has_psi = true;
+            } else if (strip(key, "gpu_card:", rest)) {
+                GpuCardReading c;
+                c.card = std::string(rest);
+                c.busy_pct = n > 0 ? v[0] : c.busy_pct;
+                c.temp_c = n > 1 ? v[1] : c.temp_c;
+                const size_t tab = text.find('\t');
+                c.slot = std::string(text.substr(0, tab));
+                if (tab != std::string_view::npos) c.driver = std::string(text.substr(tab + 1));
+                snap.gpu_cards.push_back(std::move(c));
+            }
+        });
+    }
+
+private:
+    std::string key_;
+    std::string text_;
+
+    const std::string& key(std::string_view prefix, std::string_view name) {
+        key_.assign(prefix);
+        key_.append(name);
+        return key_;
+    }
+
+    static bool strip(std::string_view key, std::string_view prefix, std::string_view& rest) {
+        if (key.compare(0, prefix.size(), prefix) != 0) return false;
+        rest = key.substr(prefix.size());
+        return true;
+    }
+};
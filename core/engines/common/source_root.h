@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Where an engine instance reads procfs, sysfs and /dev from. Engines keep writing the host paths
+// they always used ("/proc/stat", "/sys/class/hwmon", ...) and map them through resolve().
+//
+//  - host():       the monitor's own view (identity mapping)
+//  - at(dir):      a chroot, a bind-mounted tree or a recorded fixture: dir/proc, dir/sys, dir/dev
+//  - for_pid(pid): a container seen from the host. Files resolve through /proc/<pid>/root, and /proc/self
+//                  and /proc/net go to /proc/<pid>, so interfaces and mounts are those of the pid's
+//                  network and mount namespaces (its own "self" would point at nothing there).
+// Sysfs symlinks are relative, so canonical paths stay inside the root.
+class SourceRoot {
+public:
+    static SourceRoot host() { return SourceRoot(); }
+
+    static SourceRoot at(std::string dir) {
+        while (dir.size() > 1 && dir.back() == '/') dir.pop_back();
+        if (dir.empty() || dir == "/") return host();
+        SourceRoot r;
+        r.proc_ = dir + "/proc";
+        r.sys_ = dir + "/sys";
+        r.dev_ = dir + "/dev";
+        r.self_ = dir + "/proc/self";
+        r.net_ = dir + "/proc/net";
+        r.label_ = std::move(dir);
+        return r;
+    }
+
+    static SourceRoot for_pid(int pid) {
+        if (pid <= 0) return host();
+        const std::string base = "/proc/" + std::to_string(pid);
+        SourceRoot r = at(base + "/root");
+        r.self_ = base;
+        r.net_ = base + "/net";
+        r.label_ = "pid:" + std::to_string(pid);
+        return r;
+    }
+
+    bool is_host() const { return label_.empty(); }
+
+    // "" for the host, the directory for at(), "pid:N" for for_pid().
+    const std::string& label() const { return label_; }
+
+    // Maps an absolute host path into this root; paths outside /proc, /sys and /dev are returned as is.
+    std::string resolve(std::string_view path) const {
+        if (is_host()) return std::string(path);
+        std::string_view rest;
+        if (strip(path, "/proc/self", rest)) return join(self_, rest);
+        if (strip(path, "/proc/net", rest)) return join(net_, rest);
+        if (strip(path, "/proc", rest)) return join(proc_, rest);
+        if (strip(path, "/sys", rest)) return join(sys_, rest);
+        if (strip(path, "/dev", rest)) return join(dev_, rest);
+        return std::string(path);
+    }
+
+    bool operator==(const SourceRoot& other) const {
+        return proc_ == other.proc_ && sys_ == other.sys_ && dev_ == other.dev_ && self_ == other.self_ && net_ == other.net_;
+    }
+    bool operator!=(const SourceRoot& other) const { return !(*this == other); }
+
+private:
+    std::string proc_ = "/proc";
+    std::string sys_ = "/sys";
+    std::string dev_ = "/dev";
+    std::string self_ = "/proc/self";
+    std::string net_ = "/proc/net";
+    std::string label_;
+
+    // True when path is prefix itself or lies below it; rest keeps the leading '/'.
+    static bool strip(std::string_view path, std::string_view prefix, std::string_view& rest) {
+        if (path.compare(0, prefix.size(), prefix) != 0) return false;
+        if (path.size() > prefix.size() && path[prefix.size()] != '/') return false;
+        rest = path.substr(prefix.size());
+        return true;
+    }
+
+    static std::string join(const std::string& base, std::string_view rest) {
+        std::string out;
+        out.reserve(base.size() + rest.size());
+        out.append(base).append(rest);
+        return out;
+    }
+};
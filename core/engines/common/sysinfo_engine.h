@@ -0,0 +1,451 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <set>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "pinned_file.h"
+#include "scan.h"
+#include "source_root.h"
+#include "topology_watch.h"
+
+namespace fs = std::filesystem;
+
+// The system details the dashboard shows next to the metrics: CPU temperature, load, uptime, task
+// counts, memory/swap totals, CPU vendor/packages, network interface and GPU card identity.
+// Everything is resolved once and re-resolved only on change:
+//  - CPU temperature: the temp*_input files of CPU hwmon chips (k10temp, coretemp, ...) or, without
+//    them, the thermal zones; paths are re-resolved on hwmon/thermal uevents.
+//  - /proc/cpuinfo is parsed once at construction.
+//  - Interface metadata (MAC, operstate, speed, PCI slot/driver/ids) is re-read when an RTM_NEWLINK /
+//    RTM_DELLINK arrives on an RTMGRP_LINK socket (carrier, speed and rename changes included), or
+//    every 5 s without that socket.
+//  - GPU card identity is re-read on drm uevents.
+// A sample then costs four pinned reads (/proc/stat, loadavg, uptime, meminfo) plus the temperatures.
+class SysInfoEngine {
+public:
+    struct IfaceMeta {
+        std::string name;
+        std::string mac;
+        std::string operstate;  // "up", "down", "dormant", ...
+        long long speed_mbps = -1;  // -1 when the link is down or the driver does not report it
+        std::string slot;       // PCI_SLOT_NAME; empty for virtual and non-PCI interfaces
+        std::string driver;
+        std::string vendor_id;
+        std::string device_id;
+        bool has_device = false;  // backed by a device (not a virtual interface)
+    };
+
+    struct GpuIdentity {
+        std::string card;
+        std::string slot;
+        std::string driver;
+        std::string vendor_id;
+        std::string device_id;
+    };
+
+    struct Snapshot {
+        double cpu_temp_c = std::numeric_limits<double>::quiet_NaN();
+        std::string cpu_temp_source;  // "hwmon:<chip>" / "thermal:<type>"
+        long long processes_total = -1;
+        long long procs_running = -1;
+        long long procs_blocked = -1;
+        double uptime_s = -1.0;
+        bool has_load = false;
+        double load_1m = 0.0;
+        double load_5m = 0.0;
+        double load_15m = 0.0;
+        long long mem_total_kb = -1;
+        long long mem_available_kb = -1;
+        long long swap_total_kb = -1;
+        long long swap_free_kb = -1;
+        int cpu_count = 0;
+        std::string cpu_vendor;
+        int cpu_packages = -1;
+        std::vector<IfaceMeta> ifaces;  // sorted by name
+        std::vector<GpuIdentity> gpus;  // sorted by card number
+    };
+
+    explicit SysInfoEngine(const SourceRoot& root = SourceRoot::host())
+        : hwmon_root_(root.resolve("/sys/class/hwmon")),
+          thermal_root_(root.resolve("/sys/class/thermal")),
+          net_root_(root.resolve("/sys/class/net")),
+          drm_root_(root.resolve("/sys/class/drm")),
+          stat_(root.resolve("/proc/stat"), PinnedFile::kSingleShow),
+          loadavg_(root.resolve("/proc/loadavg"), PinnedFile::kSingleShow),
+          uptime_(root.resolve("/proc/uptime"), PinnedFile::kSingleShow),
+          meminfo_(root.resolve("/proc/meminfo"), PinnedFile::kSingleShow),
+          sensors_(std::vector<std::string>{"hwmon", "thermal"}, std::chrono::seconds(30), root),
+          cards_(std::vector<std::string>{"drm"}, std::chrono::seconds(30), root) {
+        parse_cpuinfo(root.resolve("/proc/cpuinfo"));
+        // Link events are per network namespace; a foreign root's interfaces are polled instead.
+        if (root.is_host()) open_link_socket();
+        resolve_temps();
+        read_ifaces();
+        read_gpus();
+        links_at_ = std::chrono::steady_clock::now();
+    }
+
+    SysInfoEngine(const SysInfoEngine&) = delete;
+    SysInfoEngine& operator=(const SysInfoEngine&) = delete;
+
+    ~SysInfoEngine() {
+        if (link_fd_ >= 0) ::close(link_fd_);
+    }
+
+    // Valid until the next call.
+    const Snapshot& sample() {
+        const auto now = std::chrono::steady_clock::now();
+        if (sensors_.changed() || rescan_requested_) resolve_temps();
+        if (cards_.changed() || rescan_requested_) read_gpus();
+        if (links_changed(now) || rescan_requested_) read_ifaces();
+        rescan_requested_ = false;
+
+        read_temp();
+        read_stat();
+        read_loadavg();
+        read_uptime();
+        read_meminfo();
+        const long online = ::sysconf(_SC_NPROCESSORS_ONLN);
+        snap_.cpu_count = online > 0 ? static_cast<int>(online) : 0;
+        return snap_;
+    }
+
+    const Snapshot& last() const { return snap_; }
+
+    // Re-resolves temperature paths, interfaces and cards on the next sample (e.g. after an unlock).
+    void rescan() { rescan_requested_ = true; }
+
+private:
+    static constexpr auto kLinkPollPeriod = std::chrono::seconds(5);
+    // Readings outside this range are a sensor that is not wired up (0, -40, 127.5 placeholders).
+    static constexpr double kMinCpuTemp = 10.0;
+    static constexpr double kMaxCpuTemp = 120.0;
+
+    struct ThermalZone {
+        PinnedFile temp;
+        std::string type;
+        bool preferred = false;
+    };
+
+    fs::path hwmon_root_;
+    fs::path thermal_root_;
+    fs::path net_root_;
+    fs::path drm_root_;
+    PinnedFile stat_;
+    PinnedFile loadavg_;
+    PinnedFile uptime_;
+    PinnedFile meminfo_;
+    TopologyWatch sensors_;
+    TopologyWatch cards_;
+    int link_fd_ = -1;
+    std::chrono::steady_clock::time_point links_at_;
+    bool rescan_requested_ = false;
+
+    std::vector<PinnedFile> cpu_hwmon_temps_;  // inputs of every CPU hwmon chip; the hottest wins
+    std::string cpu_hwmon_chip_;
+    std::vector<ThermalZone> zones_;  // used only without a CPU hwmon chip; preferred types first
+    Snapshot snap_;
+
+    static std::string to_lower(std::string s) {
+        for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return s;
+    }
+
+    static std::string read_line_once(const fs::path& p) {
+        PinnedFile f(p.string());
+        std::string_view line;
+        return f.read_line(line) ? std::string(lxscan::trim(line)) : std::string();
+    }
+
+    static double millidegrees(double v) { return v > 1000.0 ? v / 1000.0 : v; }
+
+    static bool is_cpu_chip(const std::string& driver) {
+        for (const char* tag : {"k10temp", "coretemp", "zenpower", "fam15h_power", "cpu_thermal"}) {
+            if (driver.find(tag) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    static bool is_preferred_zone(const std::string& type) {
+        for (const char* tag : {"x86_pkg_temp", "k10temp", "cpu", "package", "tctl", "tdie"}) {
+            if (type.find(tag) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    static std::vector<fs::path> list_dir(const fs::path& dir) {
+        std::vector<fs::path> out;
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) out.push_back(it->path());
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    // Once per engine: cpuinfo runs to hundreds of kB on large boxes and its fields never change.
+    void parse_cpuinfo(const std::string& path) {
+        std::string whole;
+        std::FILE* fp = std::fopen(path.c_str(), "re");
+        if (!fp) return;
+        char buf[65536];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), fp)) > 0) whole.append(buf, n);
+        std::fclose(fp);
+        std::set<long long> packages;
+        lxscan::Cursor c(whole);
+        std::string_view line;
+        while (c.line(line)) {
+            lxscan::Cursor lc(line);
+            const std::string_view key = lxscan::trim(lc.until(':'));
+            const std::string_view value = lxscan::trim(lc.rest());
+            if (key == "vendor_id") {
+                snap_.cpu_vendor.assign(value);
+            } else if (key == "physical id") {
+                long long id = 0;
+                lxscan::Cursor vc(value);
+                if (vc.number(id)) packages.insert(id);
+            }
+        }
+        if (!packages.empty()) snap_.cpu_packages = static_cast<int>(packages.size());
+        else if (!snap_.cpu_vendor.empty()) snap_.cpu_packages = 1;
+    }
+
+    void resolve_temps() {
+        cpu_hwmon_temps_.clear();
+        cpu_hwmon_chip_.clear();
+        zones_.clear();
+        for (const auto& hw : list_dir(hwmon_root_)) {
+            const std::string driver = to_lower(read_line_once(hw / "name"));
+            if (!is_cpu_chip(driver)) continue;
+            for (const auto& f : list_dir(hw)) {
+                const std::string name = f.filename().string();
+                if (name.rfind("temp", 0) == 0 && name.size() > 10 && name.compare(name.size() - 6, 6, "_input") == 0) {
+                    cpu_hwmon_temps_.emplace_back(f.string(), PinnedFile::kSingleShow);
+                }
+            }
+            if (cpu_hwmon_chip_.empty()) cpu_hwmon_chip_ = driver;
+        }
+        for (const auto& zone : list_dir(thermal_root_)) {
+            if (zone.filename().string().rfind("thermal_zone", 0) != 0) continue;
+            ThermalZone z;
+            z.type = to_lower(read_line_once(zone / "type"));
+            z.preferred = is_preferred_zone(z.type);
+            z.temp = PinnedFile((zone / "temp").string(), PinnedFile::kSingleShow);
+            zones_.push_back(std::move(z));
+        }
+        std::stable_partition(zones_.begin(), zones_.end(), [](const ThermalZone& z) { return z.preferred; });
+    }
+
+    void read_temp() {
+        snap_.cpu_temp_c = std::numeric_limits<double>::quiet_NaN();
+        snap_.cpu_temp_source.clear();
+        double best = std::numeric_limits<double>::quiet_NaN();
+        for (auto& f : cpu_hwmon_temps_) {
+            double v = 0.0;
+            if (!f.read_double(v)) continue;
+            v = millidegrees(v);
+            if (v >= kMinCpuTemp && v <= kMaxCpuTemp && (std::isnan(best) || v > best)) best = v;
+        }
+        if (!std::isnan(best)) {
+            snap_.cpu_temp_c = best;
+            snap_.cpu_temp_source = "hwmon:" + cpu_hwmon_chip_;
+            return;
+        }
+        // A preferred zone wins outright; otherwise the first plausible one.
+        for (auto& z : zones_) {
+            double v = 0.0;
+            if (!z.temp.read_double(v)) continue;
+            v = millidegrees(v);
+            if (v < kMinCpuTemp || v > kMaxCpuTemp) continue;
+            snap_.cpu_temp_c = v;
+            snap_.cpu_temp_source = "thermal:" + z.type;
+            return;
+        }
+    }
+
+    // "processes", "procs_running" and "procs_blocked" follow the long intr/softirq lines, so they are
+    // looked up from the end.
+    void read_stat() {
+        snap_.processes_total = snap_.procs_running = snap_.procs_blocked = -1;
+        std::string_view text;
+        if (!stat_.read(text)) return;
+        auto field = [&](std::string_view key, long long& out) {
+            const size_t at = text.rfind(key);
+            if (at == std::string_view::npos || (at > 0 && text[at - 1] != '\n')) return;
+            lxscan::Cursor c(text.substr(at + key.size()));
+            c.number(out);
+        };
+        field("processes ", snap_.processes_total);
+        field("procs_running ", snap_.procs_running);
+        field("procs_blocked ", snap_.procs_blocked);
+    }
+
+    void read_loadavg() {
+        snap_.has_load = false;
+        std::string_view text;
+        if (!loadavg_.read(text)) return;
+        // The buffer is kept NUL-terminated, so strtod stops at the end of the file at the latest.
+        const char* p = text.data();
+        char* end = nullptr;
+        double v[3];
+        for (double& x : v) {
+            x = std::strtod(p, &end);
+            if (end == p) return;
+            p = end;
+        }
+        snap_.load_1m = v[0];
+        snap_.load_5m = v[1];
+        snap_.load_15m = v[2];
+        snap_.has_load = true;
+    }
+
+    void read_uptime() {
+        double v = 0.0;
+        snap_.uptime_s = uptime_.read_double(v) ? v : -1.0;
+    }
+
+    void read_meminfo() {
+        snap_.mem_total_kb = snap_.mem_available_kb = snap_.swap_total_kb = snap_.swap_free_kb = -1;
+        std::string_view text;
+        if (!meminfo_.read(text)) return;
+        lxscan::Cursor c(text);
+        std::string_view line;
+        int found = 0;
+        while (found < 4 && c.line(line)) {
+            lxscan::Cursor lc(line);
+            const std::string_view key = lc.until(':');
+            long long* out = key == "MemTotal"       ? &snap_.mem_total_kb
+                             : key == "MemAvailable" ? &snap_.mem_available_kb
+                             : key == "SwapTotal"    ? &snap_.swap_total_kb
+                             : key == "SwapFree"     ? &snap_.swap_free_kb
+                                                     : nullptr;
+            if (out && lc.number(*out)) ++found;
+        }
+    }
+
+    void open_link_socket() {
+        const int fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+        if (fd < 0) return;
+        sockaddr_nl addr{};
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = RTMGRP_LINK;
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            return;
+        }
+        link_fd_ = fd;
+    }
+
+    // Any link notification invalidates the metadata: they are rare and a re-read is a few small files.
+    bool links_changed(std::chrono::steady_clock::time_point now) {
+        if (link_fd_ < 0) {
+            if (now - links_at_ < kLinkPollPeriod) return false;
+            links_at_ = now;
+            return true;
+        }
+        bool dirty = false;
+        char buf[8192];
+        for (;;) {
+            const ssize_t n = ::recv(link_fd_, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n > 0) {
+                dirty = true;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == ENOBUFS) {  // overrun: something changed, we do not know what
+                dirty = true;
+                continue;
+            }
+            break;
+        }
+        return dirty;
+    }
+
+    // Slot, driver and ids of a sysfs device directory (net interface or DRM card).
+    static void read_device(const fs::path& dev, std::string& slot, std::string& driver, std::string& vendor_id,
+                            std::string& device_id) {
+        PinnedFile f((dev / "uevent").string());
+        std::string_view text;
+        if (f.read(text)) {
+            lxscan::Cursor c(text);
+            std::string_view line;
+            while (c.line(line)) {
+                if (lxscan::starts_with(line, "PCI_SLOT_NAME=")) slot.assign(line.substr(14));
+                else if (lxscan::starts_with(line, "DRIVER=")) driver.assign(line.substr(7));
+            }
+        }
+        if (driver.empty()) {
+            std::error_code ec;
+            const fs::path drv = fs::read_symlink(dev / "driver", ec);
+            if (!ec) driver = drv.filename().string();
+        }
+        vendor_id = read_line_once(dev / "vendor");
+        device_id = read_line_once(dev / "device");
+    }
+
+    void read_ifaces() {
+        snap_.ifaces.clear();
+        std::error_code ec;
+        for (const auto& path : list_dir(net_root_)) {
+            IfaceMeta m;
+            m.name = path.filename().string();
+            m.mac = read_line_once(path / "address");
+            m.operstate = read_line_once(path / "operstate");
+            // speed is EINVAL while the link is down; virtual links report -1 themselves.
+            const std::string speed = read_line_once(path / "speed");
+            if (!speed.empty()) m.speed_mbps = std::strtoll(speed.c_str(), nullptr, 10);
+            if (m.speed_mbps < 0) m.speed_mbps = -1;
+            const fs::path dev = path / "device";
+            if (fs::exists(dev, ec)) {
+                m.has_device = true;
+                read_device(dev, m.slot, m.driver, m.vendor_id, m.device_id);
+            }
+            snap_.ifaces.push_back(std::move(m));
+        }
+    }
+
+    // card0, card1, ... but not connectors (card0-DP-1).
+    static int card_number(const std::string& name) {
+        if (name.rfind("card", 0) != 0 || name.size() == 4) return -1;
+        for (size_t i = 4; i < name.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(name[i]))) return -1;
+        }
+        return std::atoi(name.c_str() + 4);
+    }
+
+    void read_gpus() {
+        snap_.gpus.clear();
+        std::vector<std::pair<int, fs::path>> drm;
+        for (const auto& path : list_dir(drm_root_)) {
+            const int n = card_number(path.filename().string());
+            if (n >= 0) drm.emplace_back(n, path);
+        }
+        std::sort(drm.begin(), drm.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        std::error_code ec;
+        for (const auto& [n, path] : drm) {
+            const fs::path dev = path / "device";
+            if (!fs::exists(dev, ec)) continue;
+            GpuIdentity g;
+            g.card = path.filename().string();
+            read_device(dev, g.slot, g.driver, g.vendor_id, g.device_id);
+            snap_.gpus.push_back(std::move(g));
+        }
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "source_root.h"
+
+// Tells an engine when its device set may have changed, so it does not rescan every tick.
+// Sources, all checked without blocking:
+//  - kernel uevents (NETLINK_KOBJECT_UEVENT) for add/remove/move in the given subsystems,
+//  - mount table changes: poll() on /proc/self/mounts reports POLLPRI once per change,
+//  - a slow periodic rescan when the netlink socket is unavailable (containers, seccomp).
+class TopologyWatch {
+public:
+    // The mount table is the one of root (for_pid(): the container's); uevents are host-wide either way.
+    explicit TopologyWatch(std::string subsystem, std::chrono::milliseconds fallback_period = std::chrono::seconds(5),
+                           const SourceRoot& root = SourceRoot::host())
+        : TopologyWatch(std::vector<std::string>{std::move(subsystem)}, fallback_period, root) {}
+
+    explicit TopologyWatch(std::vector<std::string> subsystems, std::chrono::milliseconds fallback_period = std::chrono::seconds(5),
+                           const SourceRoot& root = SourceRoot::host())
+        : subsystems_(std::move(subsystems)), fallback_period_(fallback_period) {
+        open_uevent_socket();
+        mounts_fd_ = ::open(root.resolve("/proc/self/mounts").c_str(), O_RDONLY | O_CLOEXEC);
+        if (mounts_fd_ >= 0) mounts_changed();  // consume the initial event
+        last_fallback_ = std::chrono::steady_clock::now();
+    }
+
+    TopologyWatch(const TopologyWatch&) = delete;
+    TopologyWatch& operator=(const TopologyWatch&) = delete;
+
+    ~TopologyWatch() {
+        if (uevent_fd_ >= 0) ::close(uevent_fd_);
+        if (mounts_fd_ >= 0) ::close(mounts_fd_);
+    }
+
+    bool has_uevents() const { return uevent_fd_ >= 0; }
+
+    // True when a rescan is due. Every source is drained, so one call covers a burst of events.
+    bool changed() {
+        bool dirty = false;
+        if (uevent_fd_ >= 0) dirty |= drain_uevents();
+        if (mounts_fd_ >= 0) dirty |= mounts_changed();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (uevent_fd_ < 0 && now - last_fallback_ >= fallback_period_) dirty = true;
+        if (dirty) last_fallback_ = now;
+        return dirty;
+    }
+
+private:
+    std::vector<std::string> subsystems_;
+    std::chrono::milliseconds fallback_period_;
+    std::chrono::steady_clock::time_point last_fallback_;
+    int uevent_fd_ = -1;
+    int mounts_fd_ = -1;
+
+    void open_uevent_socket() {
+        const int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+        if (fd < 0) return;
+        sockaddr_nl addr{};
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1;  // kernel broadcast group (udevd re-broadcasts on group 2)
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            return;
+        }
+        uevent_fd_ = fd;
+    }
+
+    bool mounts_changed() {
+        pollfd p{mounts_fd_, POLLPRI, 0};
+        return ::poll(&p, 1, 0) > 0 && (p.revents & (POLLPRI | POLLERR));
+    }
+
+    // Kernel uevents look like "add@/devices/...\0ACTION=add\0DEVPATH=...\0SUBSYSTEM=block\0...".
+    bool is_relevant(std::string_view msg) const {
+        std::string_view action;
+        std::string_view subsystem;
+        size_t pos = 0;
+        while (pos < msg.size()) {
+            size_t end = msg.find('\0', pos);
+            if (end == std::string_view::npos) end = msg.size();
+            const std::string_view field = msg.substr(pos, end - pos);
+            if (field.compare(0, 7, "ACTION=") == 0) action = field.substr(7);
+            else if (field.compare(0, 10, "SUBSYSTEM=") == 0) subsystem = field.substr(10);
+            pos = end + 1;
+        }
+        if (action != "add" && action != "remove" && action != "move") return false;
+        for (const auto& s : subsystems_) {
+            if (subsystem == s) return true;
+        }
+        return false;
+    }
+
+    bool drain_uevents() {
+        char buf[8192];
+        bool dirty = false;
+        for (;;) {
+            const ssize_t n = ::recv(uevent_fd_, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n > 0) {
+                if (!dirty && is_relevant(std::string_view(buf, static_cast<size_t>(n)))) dirty = true;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            // Dropped events (socket buffer overrun): we cannot know what changed, so rescan.
+            if (n < 0 && errno == ENOBUFS) {
+                dirty = true;
+                continue;
+            }
+            break;
+        }
+        return dirty;
+    }
+};
@@ -1,55 +1,68 @@
 #include <pybind11/pybind11.h>
-#include <nvml.h>
-#include <string>
 
-namespace py = pybind11;
-
-class NvidiaSensing {
-public:
-    NvidiaSensing() {
-        // Inicjalizacja biblioteki NVML
-        nvmlReturn_t result = nvmlInit();
-        if (result == NVML_SUCCESS) {
-            // Pobieramy uchwyt do pierwszej wykrytej karty (index 0)
-            nvmlReturn_t handle_res = nvmlDeviceGetHandleByIndex(0, &device);
-            initialized = (handle_res == NVML_SUCCESS);
-        } else {
-            initialized = false;
-        }
-    }
-
-    ~NvidiaSensing() {
-        if (initialized) {
-            nvmlShutdown();
-        }
-    }
+#include "common/gpu_nvidia_engine.h"
+#include "common/py_convert.h"
 
-    double get_usage() {
-        if (!initialized) return 0.0;
-
-        nvmlUtilization_t utilization;
-        // Pobieramy stopień wykorzystania GPU (rdzeni) i pamięci
-        nvmlReturn_t result = nvmlDeviceGetUtilizationRates(device, &utilization);
-        
-        if (result == NVML_SUCCESS) {
-            // Zwracamy tylko obciążenie rdzeni GPU
-            double v = static_cast<double>(utilization.gpu);
-            if (v < 0.0) return 0.0;
-            if (v > 100.0) return 100.0;
-            return v;
-        }
-        return 0.0;
-    }
+namespace py = pybind11;
 
-private:
-    nvmlDevice_t device;
-    bool initialized = false;
-};
+// Singleton, żeby nie męczyć sterownika ciągłą inicjalizacją; nvmlInit runs on its own thread from import.
+static NvidiaSensing& host_nvidia() { return lxpy::default_engine<NvidiaSensing>(); }
 
-// Singleton, żeby nie męczyć sterownika ciągłą inicjalizacją
-static NvidiaSensing global_nvidia;
+static py::dict device_to_dict(const NvidiaSensing::DeviceRecord& r) {
+    py::dict d;
+    d["index"] = r.index;
+    d["name"] = r.name;
+    d["uuid"] = r.uuid;
+    d["pci_bus_id"] = r.pci_bus_id;
+    d["util_gpu"] = lxpy::num_or_none(r.util_gpu);
+    d["util_mem"] = lxpy::num_or_none(r.util_mem);
+    d["mem_used_mib"] = lxpy::num_or_none(r.mem_used_mib);
+    d["mem_total_mib"] = lxpy::num_or_none(r.mem_total_mib);
+    d["temp_c"] = lxpy::num_or_none(r.temp_c);
+    d["mem_temp_c"] = lxpy::num_or_none(r.mem_temp_c);
+    d["power_w"] = lxpy::num_or_none(r.power_w);
+    d["power_limit_w"] = lxpy::num_or_none(r.power_limit_w);
+    d["energy_j"] = lxpy::num_or_none(r.energy_j);
+    d["clock_graphics_mhz"] = lxpy::num_or_none(r.clock_graphics_mhz);
+    d["clock_sm_mhz"] = lxpy::num_or_none(r.clock_sm_mhz);
+    d["clock_mem_mhz"] = lxpy::num_or_none(r.clock_mem_mhz);
+    d["pcie_tx_mib_s"] = lxpy::num_or_none(r.pcie_tx_mib_s);
+    d["pcie_rx_mib_s"] = lxpy::num_or_none(r.pcie_rx_mib_s);
+    return d;
+}
 
 PYBIND11_MODULE(gpu_nvidia, m) {
     m.doc() = "LxMonitor NVIDIA GPU Engine via NVML";
-    m.def("get_usage", []() { return global_nvidia.get_usage(); }, "Returns NVIDIA GPU load %");
+    lxpy::start_default_engine<NvidiaSensing>();
+    lxpy::def_ready<NvidiaSensing>(m);
+    m.def("get_usage", []() { return host_nvidia().get_usage(); }, "Returns the load % of the busiest NVIDIA GPU");
+    m.def("get_device_count", []() { return host_nvidia().device_count(); }, "Returns the number of NVML devices");
+    m.def(
+        "get_all_usage",
+        []() {
+            py::list out;
+            for (const auto& r : host_nvidia().sample()) out.append(device_to_dict(r));
+            return out;
+        },
+        "Returns one telemetry dict per device (None for metrics the device does not report)");
+    m.def(
+        "get_processes",
+        [](int device) {
+            py::list out;
+            for (const auto& p : host_nvidia().processes(device)) {
+                py::dict d;
+                d["device"] = p.device;
+                d["pid"] = p.pid;
+                d["type"] = p.graphics ? "graphics" : "compute";
+                d["used_mib"] = lxpy::num_or_none(p.used_mib);
+                d["sm_util"] = lxpy::num_or_none(p.sm_util);
+                d["mem_util"] = lxpy::num_or_none(p.mem_util);
+                d["enc_util"] = lxpy::num_or_none(p.enc_util);
+                d["dec_util"] = lxpy::num_or_none(p.dec_util);
+                out.append(d);
+            }
+            return out;
+        },
+        py::arg("device") = -1,
+        "Returns GPU processes with memory and utilization (device -1: all devices)");
 }
@@ -0,0 +1,79 @@
+#include <pybind11/pybind11.h>
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "common/pressure_engine.h"
+#include "common/psi_trigger.h"
+#include "common/py_convert.h"
+
+namespace py = pybind11;
+
+static PressureEngine& host_pressure() { return lxpy::default_engine<PressureEngine>(); }
+
+// Host triggers behind add_trigger()/wait(). wait() holds the mutex while it polls; a reconfiguration
+// raises reconfiguring first and interrupts it, so a pending wait() returns [] early instead of
+// holding the triggers across the change.
+static std::mutex trigger_mu;
+static std::atomic<int> reconfiguring{0};
+static PsiTriggerSet host_triggers;
+
+template <typename Fn>
+static void reconfigure(Fn&& fn) {
+    py::gil_scoped_release release;
+    ++reconfiguring;
+    host_triggers.interrupt();
+    {
+        std::lock_guard<std::mutex> lk(trigger_mu);
+        fn();
+    }
+    --reconfiguring;
+}
+
+PYBIND11_MODULE(pressure, m) {
+    m.doc() = "Pressure stall information (/proc/pressure) and /proc/vmstat reclaim, swap and OOM counters";
+    lxpy::start_default_engine<PressureEngine>();
+    lxpy::def_ready<PressureEngine>(m);
+    py::class_<PressureEngine>(m, "Engine", "PSI and vmstat of one source root")
+        .def(py::init(&lxpy::make_engine<PressureEngine>), py::arg("root") = "", py::arg("pid") = 0)
+        .def("get_usage", &PressureEngine::get_usage, "Returns the memory 'some' stall % since the previous sample")
+        .def("get_all_usage", [](PressureEngine& e) { return lxpy::pressure_to_dict(e.sample()); },
+             "Returns {'cpu', 'memory', 'io': {some, full, *_avg10/60/300, *_total_us, has_full} or None, 'vm': {...}, 'interval_s'}")
+        .def("get_last", [](const PressureEngine& e) { return lxpy::pressure_to_dict(e.last()); }, "Returns the last get_all_usage() result");
+
+    m.def("get_usage", []() { return host_pressure().get_usage(); }, "Returns the memory 'some' stall % since the previous sample");
+    m.def("get_all_usage", []() { return lxpy::pressure_to_dict(host_pressure().sample()); },
+          "Returns {'cpu', 'memory', 'io': {some, full, *_avg10/60/300, *_total_us, has_full} or None, 'vm': {...}, 'interval_s'}");
+    m.def("get_last", []() { return lxpy::pressure_to_dict(host_pressure().last()); }, "Returns the last get_all_usage() result");
+    m.def(
+        "add_trigger",
+        [](const std::string& resource, const std::string& kind, double stall_ms, double window_ms) {
+            const PsiTriggerSpec spec = lxpy::psi_trigger_spec(resource, kind, stall_ms, window_ms);
+            std::string error;
+            bool ok = false;
+            reconfigure([&] { ok = host_triggers.add(spec, error); });
+            if (!ok) throw std::runtime_error(error);
+        },
+        py::arg("resource") = "memory", py::arg("kind") = "some", py::arg("stall_ms") = 150.0, py::arg("window_ms") = 2000.0,
+        "Arms a PSI trigger: wait() returns once stalls add up to stall_ms within a window_ms window "
+        "(unprivileged: window a multiple of 2000); raises with the kernel's reason");
+    m.def(
+        "clear_triggers",
+        []() { reconfigure([] { host_triggers.clear(); }); },
+        "Disarms every trigger");
+    m.def(
+        "wait",
+        [](int timeout_ms) {
+            uint32_t fired = 0;
+            {
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lk(trigger_mu);
+                if (reconfiguring.load() == 0) fired = host_triggers.wait(timeout_ms);
+            }
+            return lxpy::psi_fired_to_list(fired);
+        },
+        py::arg("timeout_ms") = -1,
+        "Blocks (without the GIL) until an armed trigger fires; returns the resources that fired, [] on timeout");
+}
@@ -3,8 +3,16 @@
 #include <array>
 #include <cstdio>
 #include <cstdlib>
+#include <glob.h>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "common/privileged_helper.h"
 
 namespace py = pybind11;
 
@@ -51,34 +59,63 @@ static CmdResult run_capture(const std::string& cmd) {
     return result;
 }
 
-static bool cmd_exists(const std::string& cmd) {
-    auto res = run_capture("command -v " + cmd + " >/dev/null");
-    return res.code == 0;
+// Absolute path of an executable found on PATH, empty when missing. Looked up directly instead of
+// spawning a shell for `command -v`: the helper is exec'd with this path.
+static std::string find_in_path(const char* name) {
+    const char* env = std::getenv("PATH");
+    const std::string path = env && *env ? env : "/usr/local/sbin:/usr/local/bin:/usr/sbin:/usr/bin:/sbin:/bin";
+    size_t start = 0;
+    while (start <= path.size()) {
+        const size_t end = std::min(path.find(':', start), path.size());
+        std::string dir = path.substr(start, end - start);
+        if (!dir.empty()) {
+            const std::string candidate = dir + "/" + name;
+            if (::access(candidate.c_str(), X_OK) == 0) return candidate;
+        }
+        start = end + 1;
+    }
+    return {};
 }
 
-static std::string detect_backend() {
-    if (cmd_exists("sudo")) return "local_sudo";
-    if (cmd_exists("pkexec")) return "local_pkexec";
+struct Backend {
+    std::string name = "none";
+    std::string tool;  // absolute path of sudo/pkexec for local backends
+};
 
-    if (cmd_exists("flatpak-spawn")) {
-        if (run_capture("flatpak-spawn --host sh -lc 'command -v sudo >/dev/null 2>&1'").code == 0) {
-            return "host_sudo";
-        }
-        if (run_capture("flatpak-spawn --host sh -lc 'command -v pkexec >/dev/null 2>&1'").code == 0) {
-            return "host_pkexec";
-        }
+static Backend probe_backend() {
+    Backend b;
+    if (!(b.tool = find_in_path("sudo")).empty()) {
+        b.name = "local_sudo";
+    } else if (!(b.tool = find_in_path("pkexec")).empty()) {
+        b.name = "local_pkexec";
+    } else if (!find_in_path("flatpak-spawn").empty()) {
+        // One host round trip answers both questions.
+        const auto res = run_capture("flatpak-spawn --host sh -c 'command -v sudo || command -v pkexec'");
+        if (res.code == 0 && res.output.find("sudo") != std::string::npos) b.name = "host_sudo";
+        else if (res.code == 0 && res.output.find("pkexec") != std::string::npos) b.name = "host_pkexec";
     }
-    return "none";
+    return b;
 }
 
+std::mutex backend_mu;
+std::optional<Backend> cached_backend;
+
+// Detected once per process; tools do not appear or vanish while the monitor runs.
+static Backend backend(bool refresh = false) {
+    std::lock_guard<std::mutex> lk(backend_mu);
+    if (refresh || !cached_backend) cached_backend = probe_backend();
+    return *cached_backend;
+}
+
+static bool is_host(const Backend& b) { return b.name == "host_sudo" || b.name == "host_pkexec"; }
+
 static CmdResult run_privileged(const std::string& password, const std::string& command) {
-    std::string backend = detect_backend();
-    if (backend == "none") {
+    const Backend b = backend();
+    if (b.name == "none") {
         return {1, "Brak narzędzia podnoszenia uprawnień (sudo/pkexec) lokalnie i na hoście."};
     }
 
-    const bool host = (backend == "host_sudo" || backend == "host_pkexec");
-    const bool sudo_mode = (backend == "local_sudo" || backend == "host_sudo");
+    const bool sudo_mode = (b.name == "local_sudo" || b.name == "host_sudo");
 
     std::string cmd;
     if (sudo_mode) {
@@ -92,7 +129,7 @@ static CmdResult run_privileged(const std::string& password, const std::string&
         cmd = "pkexec sh -lc " + shell_escape(command);
     }
 
-    if (host) {
+    if (is_host(b)) {
         cmd = "flatpak-spawn --host sh -lc " + shell_escape(cmd);
     }
     return run_capture(cmd);
@@ -103,35 +140,183 @@ static py::dict make_result(const CmdResult& res) {
     out["ok"] = (res.code == 0);
     out["error"] = py::str(res.output);
     out["code"] = res.code;
-    out["backend"] = py::str(detect_backend());
+    out["backend"] = py::str(backend().name);
     return out;
 }
 
+// The authenticated helper (local backends) and the fds it opened, kept for the whole session so
+// unlocking, re-checking and engine rescans never prompt or spawn again.
+PrivilegedHelperClient helper;
+std::mutex granted_mu;
+std::map<std::string, int> granted;  // requested path -> read-only fd opened by the helper
+
+constexpr int kSudoStartTimeoutMs = 15000;
+constexpr int kPkexecStartTimeoutMs = 120000;  // the polkit agent waits for the user
+
+// Same interpreter and module, started as root: `python -I -c "...; privilege._helper_main()"`.
+static std::vector<std::string> helper_command(const Backend& b, const std::string& password) {
+    py::gil_scoped_acquire gil;
+    const std::string python = py::module_::import("sys").attr("executable").cast<std::string>();
+    const std::string file = py::module_::import("privilege").attr("__file__").cast<std::string>();
+    const std::string dir = file.substr(0, file.find_last_of('/'));
+    std::string code = "import sys; sys.path.insert(0, ";
+    code += py::repr(py::str(dir)).cast<std::string>();
+    code += "); import privilege; sys.exit(privilege._helper_main())";
+
+    std::vector<std::string> argv{b.tool};
+    if (b.name == "local_sudo") {
+        argv.insert(argv.end(), {"-S", "-k", "-p", PrivilegedHelperClient::kSudoPrompt});
+        if (password.empty()) argv.push_back("-n");
+        argv.push_back("--");
+    }
+    argv.insert(argv.end(), {python, "-I", "-c", code});
+    return argv;
+}
+
+// Starts the helper unless it is already running. Called without the GIL.
+static CmdResult ensure_helper(const Backend& b, const std::string& password) {
+    if (helper.alive()) return {0, ""};
+    const auto argv = helper_command(b, password);
+    const bool sudo = b.name == "local_sudo";
+    CmdResult res;
+    std::string error;
+    if (helper.start(argv, password, sudo && !password.empty(), sudo ? kSudoStartTimeoutMs : kPkexecStartTimeoutMs, error,
+                     res.code)) {
+        res.code = 0;
+    } else {
+        res.output = error;
+        if (res.code == 0) res.code = 1;
+    }
+    return res;
+}
+
+static std::vector<std::string> glob_paths(const char* pattern) {
+    std::vector<std::string> out;
+    glob_t g{};
+    if (::glob(pattern, 0, nullptr, &g) == 0) {
+        for (size_t i = 0; i < g.gl_pathc; ++i) out.emplace_back(g.gl_pathv[i]);
+    }
+    ::globfree(&g);
+    return out;
+}
+
+struct PrepareStats {
+    CmdResult res;
+    int opened = 0;
+    int granted = 0;
+};
+
+// Asks the helper only for what this user cannot read already: fds for sysfs attributes, a+r for
+// the NVIDIA device nodes. Per-file refusals are reported but do not fail the whole unlock.
+static PrepareStats prepare_with_helper(const Backend& b, const std::string& password) {
+    PrepareStats st;
+    st.res = ensure_helper(b, password);
+    if (st.res.code != 0) return st;
+    std::string failures;
+    for (const auto& p : kProtectedPatterns) {
+        for (const auto& path : glob_paths(p.glob)) {
+            if (::access(path.c_str(), R_OK) == 0) continue;
+            std::string error;
+            if (p.access == ProtectedAccess::kGrant) {
+                if (helper.grant(path, error)) ++st.granted;
+                else failures += path + ": " + error + "\n";
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lk(granted_mu);
+                if (granted.count(path)) continue;
+            }
+            const int fd = helper.open(path, error);
+            if (fd < 0) {
+                failures += path + ": " + error + "\n";
+                continue;
+            }
+            std::lock_guard<std::mutex> lk(granted_mu);
+            granted[path] = fd;
+            ++st.opened;
+        }
+    }
+    st.res.output = failures;
+    return st;
+}
+
 }  // namespace
 
 PYBIND11_MODULE(privilege, m) {
-    m.def("detect_backend", []() { return detect_backend(); }, "Detect privilege escalation backend");
+    m.def(
+        "detect_backend", [](bool refresh) { return backend(refresh).name; }, py::arg("refresh") = false,
+        "Detect privilege escalation backend (cached; refresh=True probes again)");
     m.def(
         "verify",
         [](const std::string& password) {
-            return make_result(run_privileged(password, "true"));
+            const Backend b = backend();
+            if (b.name == "none" || is_host(b)) return make_result(run_privileged(password, "true"));
+            CmdResult res;
+            {
+                py::gil_scoped_release nogil;
+                res = ensure_helper(b, password);
+            }
+            return make_result(res);
         },
-        "Verify privileged access");
+        "Verify privileged access (local backends start the persistent helper)");
     m.def(
         "prepare_access",
         [](const std::string& password) {
-            const std::string setup_cmd =
-                "for f in "
-                "/sys/class/drm/card*/device/gpu_busy_percent "
-                "/sys/class/drm/card*/device/usage "
-                "/sys/class/hwmon/hwmon*/device/gpu_busy_percent "
-                "/sys/class/thermal/thermal_zone*/temp "
-                "/sys/class/thermal/thermal_zone*/type "
-                "/sys/class/drm/card*/device/hwmon/hwmon*/temp*_input "
-                "/dev/nvidiactl /dev/nvidia[0-9]*; do "
-                "[ -e \"$f\" ] && chmod a+r \"$f\" 2>/dev/null || true; "
-                "done";
-            return make_result(run_privileged(password, setup_cmd));
+            const Backend b = backend();
+            if (b.name == "none" || is_host(b)) {
+                // Host tools run outside the sandbox, where this module cannot be loaded as a helper.
+                const std::string setup_cmd =
+                    "for f in "
+                    "/sys/class/drm/card*/device/gpu_busy_percent "
+                    "/sys/class/drm/card*/device/usage "
+                    "/sys/class/hwmon/hwmon*/device/gpu_busy_percent "
+                    "/sys/class/thermal/thermal_zone*/temp "
+                    "/sys/class/thermal/thermal_zone*/type "
+                    "/sys/class/drm/card*/device/hwmon/hwmon*/temp*_input "
+                    "/dev/nvidiactl /dev/nvidia[0-9]*; do "
+                    "[ -e \"$f\" ] && chmod a+r \"$f\" 2>/dev/null || true; "
+                    "done";
+                return make_result(run_privileged(password, setup_cmd));
+            }
+            PrepareStats st;
+            {
+                py::gil_scoped_release nogil;
+                st = prepare_with_helper(b, password);
+            }
+            py::dict out = make_result(st.res);
+            out["opened"] = st.opened;
+            out["granted"] = st.granted;
+            std::lock_guard<std::mutex> lk(granted_mu);
+            out["fds"] = granted.size();
+            return out;
+        },
+        "Prepare access to protected metric paths (fds from the helper, or chmod on host backends)");
+    m.def(
+        "granted_fds",
+        []() {
+            py::dict out;
+            std::lock_guard<std::mutex> lk(granted_mu);
+            for (const auto& [path, fd] : granted) out[py::str(path)] = fd;
+            return out;
         },
-        "Prepare readable access to protected metric paths");
+        "Read-only fds opened by the helper, {path: fd}; pass to each engine's adopt_fds()");
+    m.def(
+        "helper_status",
+        []() {
+            py::dict out;
+            const int pid = helper.pid();
+            out["running"] = pid > 0;
+            out["pid"] = pid;
+            out["backend"] = py::str(backend().name);
+            std::lock_guard<std::mutex> lk(granted_mu);
+            out["fds"] = granted.size();
+            return out;
+        },
+        "State of the persistent privileged helper");
+    m.def(
+        "stop_helper", []() { helper.stop(); }, py::call_guard<py::gil_scoped_release>(),
+        "Stop the privileged helper (fds already granted stay valid)");
+    m.def(
+        "_helper_main", []() { return run_privileged_helper(0); }, py::call_guard<py::gil_scoped_release>(),
+        "Helper loop on stdin; only run by verify()/prepare_access() through sudo/pkexec");
 }
@@ -0,0 +1,28 @@
+#include <pybind11/pybind11.h>
+
+#include "common/process_engine.h"
+#include "common/py_convert.h"
+
+namespace py = pybind11;
+
+static ProcessActivityEngine& host_procs() { return lxpy::default_engine<ProcessActivityEngine>(); }
+
+PYBIND11_MODULE(process, m) {
+    m.doc() = "Per-process CPU, RSS and I/O: top-N lists from an incremental /proc scan";
+    lxpy::start_default_engine<ProcessActivityEngine>();
+    lxpy::def_ready<ProcessActivityEngine>(m);
+    py::class_<ProcessActivityEngine>(m, "Engine", "Processes of one source root (pid=N: that process' PID namespace)")
+        .def(py::init(&lxpy::make_engine<ProcessActivityEngine>), py::arg("root") = "", py::arg("pid") = 0)
+        .def("get_top", [](ProcessActivityEngine& e, size_t n) { return lxpy::proc_top_to_dict(e.sample(n)); }, py::arg("n") = 10,
+             "Scans /proc; returns {'cpu', 'rss', 'io': [process dicts], 'processes', 'threads', 'pinned_fds'}")
+        .def("get_last", [](const ProcessActivityEngine& e) { return lxpy::proc_top_to_dict(e.last()); }, "Returns the last get_top() result")
+        .def("set_fd_budget", &ProcessActivityEngine::set_fd_budget, py::arg("budget"), "Caps the stat/io fds kept open between scans")
+        .def("get_fd_budget", &ProcessActivityEngine::fd_budget);
+
+    m.def("get_top", [](size_t n) { return lxpy::proc_top_to_dict(host_procs().sample(n)); }, py::arg("n") = 10,
+          "Scans /proc; returns {'cpu', 'rss', 'io': [process dicts], 'processes', 'threads', 'pinned_fds'}");
+    m.def("get_last", []() { return lxpy::proc_top_to_dict(host_procs().last()); }, "Returns the last get_top() result");
+    m.def("set_fd_budget", [](size_t budget) { host_procs().set_fd_budget(budget); }, py::arg("budget"),
+          "Caps the stat/io fds kept open between scans");
+    m.def("get_fd_budget", []() { return host_procs().fd_budget(); });
+}
@@ -0,0 +1,338 @@
+#include <pybind11/pybind11.h>
+
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/recorder.h"
+
+namespace py = pybind11;
+
+// Leaves deeper than this are stored as their str() (collected_data is 3-4 levels deep).
+static constexpr int kMaxDepth = 16;
+
+static void push_segment(std::string& path, char tag, std::string_view text) {
+    path.push_back(tag);
+    for (uint64_t n = text.size(); ; n >>= 7) {
+        if (n < 0x80) {
+            path.push_back(static_cast<char>(n));
+            break;
+        }
+        path.push_back(static_cast<char>((n & 0x7f) | 0x80));
+    }
+    path.append(text.data(), text.size());
+}
+
+// Parses the segment at pos; false at the end or on a malformed path.
+static bool next_segment(std::string_view path, size_t& pos, char& tag, std::string_view& text) {
+    if (pos >= path.size()) return false;
+    tag = path[pos++];
+    uint64_t n = 0;
+    for (int shift = 0;; shift += 7) {
+        if (pos >= path.size() || shift > 28) return false;
+        const auto b = static_cast<uint8_t>(path[pos++]);
+        n |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) break;
+    }
+    if (n > path.size() - pos) return false;
+    text = path.substr(pos, static_cast<size_t>(n));
+    pos += static_cast<size_t>(n);
+    return true;
+}
+
+// collected_data -> one writer tick. The path buffer grows and shrinks with the walk.
+static void flatten(RecordWriter& w, std::string& path, const py::handle& obj, int depth) {
+    if (obj.is_none()) {
+        w.add_marker(path, kRecNone);
+    } else if (py::isinstance<py::bool_>(obj)) {
+        w.add_int(path, kRecBool, obj.cast<bool>() ? 1 : 0);
+    } else if (py::isinstance<py::int_>(obj)) {
+        try {
+            w.add_int(path, kRecInt, obj.cast<long long>());
+        } catch (const py::cast_error&) {
+            w.add_float(path, obj.cast<double>());  // beyond 64 bits
+        }
+    } else if (py::isinstance<py::float_>(obj)) {
+        w.add_float(path, obj.cast<double>());
+    } else if (py::isinstance<py::str>(obj)) {
+        w.add_text(path, obj.cast<std::string>());
+    } else if (depth < kMaxDepth && py::isinstance<py::dict>(obj)) {
+        const auto d = py::reinterpret_borrow<py::dict>(obj);
+        if (d.size() == 0) {
+            w.add_marker(path, kRecEmptyDict);
+            return;
+        }
+        const size_t len = path.size();
+        for (auto item : d) {
+            const py::handle key = item.first;
+            if (py::isinstance<py::str>(key)) {
+                push_segment(path, kRecKey, key.cast<std::string>());
+            } else if (py::isinstance<py::int_>(key)) {
+                push_segment(path, kRecIntKey, py::str(key).cast<std::string>());
+            } else {
+                push_segment(path, kRecKey, py::str(key).cast<std::string>());
+            }
+            flatten(w, path, item.second, depth + 1);
+            path.resize(len);
+        }
+    } else if (depth < kMaxDepth && (py::isinstance<py::list>(obj) || py::isinstance<py::tuple>(obj))) {
+        const auto items = py::reinterpret_borrow<py::sequence>(obj);
+        if (items.size() == 0) {
+            w.add_marker(path, kRecEmptyList);
+            return;
+        }
+        const size_t len = path.size();
+        size_t i = 0;
+        for (auto item : items) {
+            push_segment(path, kRecIndex, std::to_string(i++));
+            flatten(w, path, item, depth + 1);
+            path.resize(len);
+        }
+    } else {
+        w.add_text(path, py::str(obj).cast<std::string>());
+    }
+}
+
+// One reader tick -> nested dict. Consecutive leaves share most of their path, so the containers of
+// the previous leaf stay on a stack and only the differing tail is walked.
+class Unflattener {
+public:
+    py::dict build(RecordReader& reader, int64_t& ts_ms) {
+        py::dict root;
+        stack_.clear();
+        stack_.push_back({0, root});
+        prev_.clear();
+        reader.next(ts_ms, [&](const RecordReader::Value& v) { add(v); });
+        stack_.clear();
+        return root;
+    }
+
+private:
+    struct Level {
+        size_t end;  // path bytes that address obj
+        py::object obj;
+    };
+
+    std::vector<Level> stack_;
+    std::string prev_;
+
+    static py::object leaf(const RecordReader::Value& v) {
+        switch (v.type) {
+            case kRecInt: return py::int_(v.i);
+            case kRecFloat: return py::float_(v.f);
+            case kRecBool: return py::bool_(v.i != 0);
+            case kRecText: return py::str(v.text.data(), v.text.size());
+            case kRecEmptyDict: return py::dict();
+            case kRecEmptyList: return py::list();
+            case kRecNone: break;
+        }
+        return py::none();
+    }
+
+    static py::object key(char tag, std::string_view text) {
+        if (tag == kRecIntKey) {
+            long long n = 0;
+            std::from_chars(text.data(), text.data() + text.size(), n);
+            return py::int_(n);
+        }
+        return py::str(text.data(), text.size());
+    }
+
+    // Child of container at (tag, text): the existing one when it has the wanted kind, else value.
+    static py::object place(const py::object& container, char tag, std::string_view text, py::object value, bool replace) {
+        if (py::isinstance<py::list>(container)) {
+            auto l = py::reinterpret_borrow<py::list>(container);
+            size_t i = 0;
+            std::from_chars(text.data(), text.data() + text.size(), i);
+            if (i < l.size()) {
+                if (!replace) {
+                    py::object existing = l[i];
+                    if (existing.get_type().is(value.get_type())) return existing;
+                }
+                l[i] = value;
+                return value;
+            }
+            while (l.size() < i) l.append(py::none());
+            l.append(value);
+            return value;
+        }
+        auto d = py::reinterpret_borrow<py::dict>(container);
+        const py::object k = key(tag, text);
+        if (!replace && d.contains(k)) {
+            py::object existing = d[k];
+            if (existing.get_type().is(value.get_type())) return existing;
+        }
+        d[k] = value;
+        return value;
+    }
+
+    void add(const RecordReader::Value& v) {
+        const std::string_view path = v.path;
+        size_t common = 0;
+        while (common < path.size() && common < prev_.size() && path[common] == prev_[common]) ++common;
+        while (stack_.size() > 1 && stack_.back().end > common) stack_.pop_back();
+        prev_.assign(path.data(), path.size());
+
+        size_t pos = stack_.back().end;
+        char tag;
+        std::string_view text;
+        while (next_segment(path, pos, tag, text)) {
+            const py::object& container = stack_.back().obj;
+            if (pos >= path.size()) {
+                place(container, tag, text, leaf(v), true);
+                return;
+            }
+            const bool child_is_list = path[pos] == kRecIndex;
+            py::object fresh = child_is_list ? py::object(py::list()) : py::object(py::dict());
+            stack_.push_back({pos, place(container, tag, text, std::move(fresh), false)});
+        }
+        // Empty path: a leaf at the root (a recorded non-dict) is dropped.
+    }
+};
+
+static int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static int64_t seconds_to_ms(double ts) { return static_cast<int64_t>(std::llround(ts * 1000.0)); }
+
+namespace {
+
+class PyRecorder {
+public:
+    explicit PyRecorder(const RecorderConfig& config) {
+        std::string error;
+        if (!writer_.open(config, error)) throw std::runtime_error(error);
+    }
+
+    void append(const py::dict& data, double ts) {
+        if (!writer_.is_open()) throw std::runtime_error("recorder is closed");
+        writer_.begin_tick(ts >= 0.0 ? seconds_to_ms(ts) : now_ms());
+        path_.clear();
+        flatten(writer_, path_, data, 0);
+        std::string error;
+        if (!writer_.end_tick(error)) throw std::runtime_error(error);
+    }
+
+    void flush() {
+        std::string error;
+        if (!writer_.flush(error)) throw std::runtime_error(error);
+    }
+
+    void close() {
+        std::string error;
+        if (!writer_.close(error)) throw std::runtime_error(error);
+    }
+
+    bool is_open() const { return writer_.is_open(); }
+
+    py::dict stats() const {
+        const RecorderStats s = writer_.stats();
+        py::dict d;
+        d["directory"] = writer_.config().directory;
+        d["segment"] = s.segment;
+        d["segments_written"] = s.segments_written;
+        d["segments_deleted"] = s.segments_deleted;
+        d["chunks"] = s.chunks;
+        d["ticks"] = s.ticks;
+        d["values"] = s.values;
+        d["bytes"] = s.bytes;
+        d["series"] = s.series;
+        d["open_ticks"] = s.open_ticks;
+        const uint64_t written_values = s.values;
+        d["bytes_per_value"] = written_values ? static_cast<double>(s.bytes) / static_cast<double>(written_values) : 0.0;
+        return d;
+    }
+
+private:
+    RecordWriter writer_;
+    std::string path_;
+};
+
+class PyReplay {
+public:
+    PyReplay(const std::string& path, const std::string& prefix) {
+        std::string error;
+        if (!reader_.open(path, prefix, error)) throw std::runtime_error(error);
+    }
+
+    py::tuple span() const {
+        return py::make_tuple(static_cast<double>(reader_.first_ms()) / 1000.0, static_cast<double>(reader_.last_ms()) / 1000.0);
+    }
+
+    py::object peek() const {
+        if (reader_.at_end()) return py::none();
+        return py::float_(static_cast<double>(reader_.peek_ms()) / 1000.0);
+    }
+
+    void seek(double ts) { reader_.seek(seconds_to_ms(ts)); }
+
+    py::object next() {
+        if (reader_.at_end()) return py::none();
+        int64_t ts_ms = 0;
+        py::dict frame = unflatten_.build(reader_, ts_ms);
+        return py::make_tuple(static_cast<double>(ts_ms) / 1000.0, frame);
+    }
+
+    py::object advance(double ts) {
+        const int64_t target = seconds_to_ms(ts);
+        if (reader_.at_end() || reader_.peek_ms() > target) return py::none();
+        reader_.skip_to_last(target);
+        return next();
+    }
+
+    const RecordReader& reader() const { return reader_; }
+
+private:
+    RecordReader reader_;
+    Unflattener unflatten_;
+};
+
+}  // namespace
+
+PYBIND11_MODULE(recorder, m) {
+    m.doc() = "Append-only mmap'd columnar recording of the collected_data stream, with time seeks for replay";
+
+    py::class_<PyRecorder>(m, "Recorder", "Writes one tick per append() into rotating segments of a directory")
+        .def(py::init([](const std::string& directory, const std::string& prefix, double max_file_mb, int max_files,
+                         double max_total_mb, int chunk_ticks, double chunk_s, int decimals) {
+                 if (max_file_mb <= 0.0 || max_files <= 0 || chunk_ticks <= 0 || chunk_s <= 0.0) {
+                     throw std::invalid_argument("max_file_mb, max_files, chunk_ticks and chunk_s must be positive");
+                 }
+                 RecorderConfig c;
+                 c.directory = directory;
+                 c.prefix = prefix;
+                 c.max_file_bytes = static_cast<size_t>(max_file_mb * 1048576.0);
+                 c.max_files = static_cast<size_t>(max_files);
+                 c.max_total_bytes = max_total_mb > 0.0 ? static_cast<size_t>(max_total_mb * 1048576.0) : 0;
+                 c.chunk_ticks = static_cast<uint32_t>(chunk_ticks);
+                 c.chunk_ms = seconds_to_ms(chunk_s);
+                 c.float_decimals = decimals;
+                 return std::make_unique<PyRecorder>(c);
+             }),
+             py::arg("directory"), py::arg("prefix") = "lxmon", py::arg("max_file_mb") = 64.0, py::arg("max_files") = 8,
+             py::arg("max_total_mb") = 0.0, py::arg("chunk_ticks") = 120, py::arg("chunk_s") = 30.0, py::arg("decimals") = -1)
+        .def("append", &PyRecorder::append, py::arg("data"), py::arg("ts") = -1.0,
+             "Records one tick (ts: epoch seconds, default now); nested dicts/lists of numbers, str, bool and None")
+        .def("flush", &PyRecorder::flush, "Writes the open chunk now instead of when it fills")
+        .def("close", &PyRecorder::close, "Flushes and closes the segment")
+        .def("is_open", &PyRecorder::is_open)
+        .def("stats", &PyRecorder::stats,
+             "Returns {directory, segment, segments_written, segments_deleted, chunks, ticks, values, bytes, series, open_ticks, bytes_per_value}");
+
+    py::class_<PyReplay>(m, "Replay", "Reads a segment file or a recording directory")
+        .def(py::init<const std::string&, const std::string&>(), py::arg("path"), py::arg("prefix") = "lxmon")
+        .def("span", &PyReplay::span, "Returns (first_ts, last_ts) in epoch seconds")
+        .def("ticks", [](const PyReplay& r) { return r.reader().tick_count(); })
+        .def("chunks", [](const PyReplay& r) { return r.reader().chunk_count(); })
+        .def("segments", [](const PyReplay& r) { return r.reader().segment_count(); })
+        .def("corrupt_chunks", [](const PyReplay& r) { return r.reader().corrupt_chunks(); }, "Chunks skipped on a bad checksum so far")
+        .def("seek", &PyReplay::seek, py::arg("ts"), "Moves to the first tick at or after ts")
+        .def("peek", &PyReplay::peek, "Time of the next tick, or None at the end")
+        .def("next", &PyReplay::next, "Returns (ts, collected_data) and advances, or None at the end")
+        .def("advance", &PyReplay::advance, py::arg("ts"),
+             "Returns the last tick at or before ts, skipping the ones in between; None while the next tick is later");
+}
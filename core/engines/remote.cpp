@@ -0,0 +1,176 @@
+#include <pybind11/pybind11.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/node_stream.h"
+#include "common/py_convert.h"
+#include "common/snapshot_shm.h"
+
+namespace py = pybind11;
+
+// Viewer side of remote mode: collectors (main.py --headless --stream-to host:port) connect here.
+static NodeStreamReceiver receiver;
+
+static py::dict node_to_dict(const NodeStreamReceiver::NodeInfo& n) {
+    py::dict d;
+    d["name"] = n.name;
+    d["address"] = n.address;
+    d["online"] = n.online;
+    d["stale"] = n.stale;
+    d["age_s"] = n.age_s;
+    d["generation"] = n.generation;
+    d["timestamp"] = n.timestamp_s;
+    d["tick_ms"] = n.tick_ms;
+    d["interval_s"] = n.interval_s;
+    py::list sampled;
+    for (const auto& e : kSamplerEngines) {
+        if (n.sampled & e.bit) sampled.append(py::str(e.name));
+    }
+    d["sampled"] = sampled;
+    d["entries"] = n.entries;
+    d["connects"] = n.connects;
+    d["bytes"] = n.bytes;
+    d["rx_bytes_per_s"] = n.rx_bytes_per_s;
+    for (int f = 0; f < kNodeFieldCount; ++f) d[kNodeFields[f].name] = lxpy::num_or_none(n.values[f]);
+    return d;
+}
+
+PYBIND11_MODULE(remote, m) {
+    m.doc() = "Remote mode viewer: merges the tick streams of many collectors on one epoll thread";
+    lxpy::bind_core_table(m);
+    m.attr("DEFAULT_PORT") = kNodeStreamDefaultPort;
+    m.attr("HISTORY_POINTS") = NodeStreamReceiver::kNodeHistory;
+
+    m.def(
+        "listen",
+        [](int port, const std::string& address, const std::string& token) {
+            std::string error;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = receiver.start(address, port, token, error);
+            }
+            if (!ok) throw std::runtime_error(error);
+            return receiver.port();
+        },
+        py::arg("port") = kNodeStreamDefaultPort,
+        py::arg("address") = "127.0.0.1",
+        py::arg("token") = "",
+        "Accepts collector streams on address:port (port 0 picks one); returns the bound port, raises when it cannot "
+        "bind. With token, collectors must send the same token; a non-loopback address requires one");
+    m.def("stop", []() { receiver.stop(); }, py::call_guard<py::gil_scoped_release>(), "Closes every stream and forgets all nodes");
+    m.def(
+        "status",
+        []() {
+            NodeStreamReceiver::Stats s;
+            int port;
+            {
+                py::gil_scoped_release release;
+                s = receiver.stats();
+                port = receiver.port();
+            }
+            py::dict out;
+            out["running"] = port != 0;
+            out["port"] = port;
+            out["address"] = receiver.address();
+            out["nodes"] = s.nodes;
+            out["online"] = s.online;
+            out["peers"] = s.peers;
+            out["accepted"] = s.accepted;
+            out["rejected"] = s.rejected;
+            out["malformed"] = s.malformed;
+            out["messages"] = s.messages;
+            out["bytes"] = s.bytes;
+            out["wakeups"] = s.wakeups;
+            return out;
+        },
+        "Returns {running, port, address, nodes, online, peers, accepted, rejected, malformed, messages, bytes, wakeups}");
+    m.def(
+        "poll",
+        [](bool full) {
+            std::vector<NodeStreamReceiver::NodeInfo> changed;
+            std::vector<std::string> removed;
+            {
+                py::gil_scoped_release release;
+                receiver.poll(changed, removed, full);
+            }
+            py::dict out;
+            for (const auto& n : changed) out[py::str(n.name)] = node_to_dict(n);
+            for (const auto& name : removed) out[py::str(name)] = py::none();
+            return out;
+        },
+        py::arg("full") = false,
+        "Nodes that changed since the previous call (all of them with full) as {name: summary}; forgotten ones map "
+        "to None. A summary holds cpu, ram, disc, net, net_rx, net_tx, psu, gpu, gpu_temp, pressure (None when the "
+        "collector does not sample it), online, stale, age_s, address, generation, rx_bytes_per_s, ...");
+    m.def(
+        "nodes",
+        []() {
+            std::vector<NodeStreamReceiver::NodeInfo> all;
+            {
+                py::gil_scoped_release release;
+                all = receiver.nodes();
+            }
+            py::list out;
+            for (const auto& n : all) out.append(node_to_dict(n));
+            return out;
+        },
+        "Summaries of every known node");
+    m.def(
+        "node_snapshot",
+        [](const std::string& name, const py::object& out) -> py::object {
+            SamplerSnapshot snap;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ShmFrame frame;
+                ok = receiver.snapshot(name, frame);
+                if (ok) SnapshotShmCodec::decode(frame, snap);
+            }
+            if (!ok) return py::none();
+            py::dict result = lxpy::dict_or_new(out);
+            lxpy::fill_snapshot_dict(snap, result);
+            return result;
+        },
+        py::arg("name"),
+        py::arg("out") = py::none(),
+        "The node's latest tick in the same dict format as sampler.collect(); None when unknown");
+    m.def(
+        "history",
+        [](const std::string& name, const std::string& field, size_t points) {
+            const int f = node_field_from_name(field);
+            if (f < 0) throw std::invalid_argument("unknown field: " + field);
+            std::vector<double> times;
+            std::vector<float> values;
+            {
+                py::gil_scoped_release release;
+                receiver.history(name, f, points, times, values);
+            }
+            py::list t;
+            py::list v;
+            for (size_t i = 0; i < values.size(); ++i) {
+                t.append(times[i]);
+                v.append(lxpy::num_or_none(values[i]));
+            }
+            py::dict out;
+            out["time"] = t;
+            out["values"] = v;
+            return out;
+        },
+        py::arg("name"),
+        py::arg("field") = "cpu",
+        py::arg("points") = NodeStreamReceiver::kNodeHistory,
+        "Last points ticks of one summary field, oldest first, as {time: [...], values: [...]}");
+    m.def("forget", [](const std::string& name) { return receiver.forget(name); }, py::call_guard<py::gil_scoped_release>(),
+          "Drops an offline node now; False when unknown or still connected");
+    m.def(
+        "fields",
+        []() {
+            py::list out;
+            for (const auto& f : kNodeFields) out.append(py::str(f.name));
+            return out;
+        },
+        "Names of the summary fields");
+}
@@ -0,0 +1,455 @@
+#include <pybind11/pybind11.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "common/metrics_http.h"
+#include "common/py_convert.h"
+#include "common/sampler.h"
+
+namespace py = pybind11;
+
+static Sampler global_sampler;
+static SelfUsageProbe self_probe;
+// Declared after global_sampler, so it stops before the sampler is destroyed.
+static MetricsHttpServer metrics_server([](SamplerSnapshot& out) { global_sampler.latest(out); });
+
+// Reader side for attaching to another process' segment (e.g. the headless daemon).
+static std::mutex attach_mu;
+static ShmReader attach_reader;
+static ShmFrame attach_frame;
+
+// Opens (or reopens after the writer restarted) name; true when a live writer is attached.
+static bool attach_locked(const std::string& name) {
+    if (attach_reader.is_open() && (attach_reader.name() != name || !attach_reader.writer_alive())) attach_reader.close();
+    if (!attach_reader.is_open() && !attach_reader.open(name)) return false;
+    return attach_reader.writer_alive();
+}
+
+static uint32_t mask_from_names(const py::iterable& names) {
+    uint32_t mask = 0;
+    for (auto item : names) {
+        mask |= sampler_engine_bit(py::cast<std::string>(item));
+    }
+    return mask;
+}
+
+// Engines as an int bitmask (see engine_bits()) or an iterable of names.
+static uint32_t mask_from_object(const py::handle& engines) {
+    if (py::isinstance<py::int_>(engines)) return py::cast<uint32_t>(engines);
+    return mask_from_names(py::reinterpret_borrow<py::iterable>(engines));
+}
+
+static py::dict engine_cost_to_dict(const EngineCost& c) {
+    const LatencyHistogram& h = c.latency;
+    const double n = static_cast<double>(std::max<uint64_t>(1, h.count()));
+    py::dict d;
+    d["count"] = h.count();
+    d["failures"] = c.failures;
+    d["min_us"] = static_cast<double>(h.min_ns()) / 1e3;
+    d["mean_us"] = h.mean_ns() / 1e3;
+    d["p50_us"] = static_cast<double>(h.percentile_ns(0.50)) / 1e3;
+    d["p90_us"] = static_cast<double>(h.percentile_ns(0.90)) / 1e3;
+    d["p99_us"] = static_cast<double>(h.percentile_ns(0.99)) / 1e3;
+    d["p999_us"] = static_cast<double>(h.percentile_ns(0.999)) / 1e3;
+    d["max_us"] = static_cast<double>(h.max_ns()) / 1e3;
+    d["total_ms"] = static_cast<double>(h.sum_ns()) / 1e6;
+    d["file_reads"] = c.file_reads;
+    d["file_opens"] = c.file_opens;
+    d["reads_per_call"] = static_cast<double>(c.file_reads) / n;
+    if (c.syscalls || c.cpu_ns) {
+        d["syscalls"] = c.syscalls;
+        d["syscalls_per_call"] = static_cast<double>(c.syscalls) / n;
+        d["cpu_ms"] = static_cast<double>(c.cpu_ns) / 1e6;
+    }
+    return d;
+}
+
+// Tier by name ("raw", "1s", "10s", "1m") or index; kTierCount when unknown.
+static HistoryTier tier_from_object(const py::handle& tier) {
+    if (py::isinstance<py::int_>(tier)) {
+        const size_t idx = py::cast<size_t>(tier);
+        return idx < kTierCount ? static_cast<HistoryTier>(idx) : kTierCount;
+    }
+    const std::string name = py::cast<std::string>(tier);
+    for (size_t t = 0; t < kTierCount; ++t) {
+        if (name == kHistoryTiers[t].name) return static_cast<HistoryTier>(t);
+    }
+    return kTierCount;
+}
+
+PYBIND11_MODULE(sampler, m) {
+    m.doc() = "Background sampler thread driving all native engines";
+    lxpy::bind_core_table(m);
+    lxpy::bind_history_window(m);
+    lxpy::def_granted_fds(m);
+    m.def(
+        "start",
+        [](const py::iterable& engines, int interval_ms) {
+            global_sampler.start(mask_from_names(engines), interval_ms);
+        },
+        py::arg("engines"),
+        py::arg("interval_ms") = 250,
+        "Starts (or reconfigures) the sampler thread for the given engine names");
+    m.def("stop", []() { global_sampler.stop(); }, py::call_guard<py::gil_scoped_release>(), "Stops the sampler thread");
+    m.def("set_interval", [](int interval_ms) { global_sampler.set_interval(interval_ms); }, "Changes the sampler tick in ms");
+    m.def(
+        "set_engines",
+        [](const py::iterable& engines) { global_sampler.set_engines(mask_from_names(engines)); },
+        "Changes the set of sampled engines");
+    m.def("is_running", []() { return global_sampler.running(); }, "Returns True when the sampler thread is alive");
+    m.def(
+        "supported_engines",
+        []() {
+            py::list out;
+            for (const auto& e : kSamplerEngines) out.append(py::str(e.name));
+            return out;
+        },
+        "Returns engine names the sampler can drive");
+    m.def(
+        "get_snapshot",
+        [](const py::object& out) {
+            SamplerSnapshot local;
+            {
+                py::gil_scoped_release release;
+                global_sampler.latest(local);
+            }
+            py::dict result = lxpy::dict_or_new(out);
+            lxpy::fill_snapshot_dict(local, result);
+            return result;
+        },
+        py::arg("out") = py::none(),
+        "Returns the latest published tick (empty dict before the first tick); refills out when given");
+    m.def(
+        "collect",
+        [](const py::object& engines, const py::object& out) {
+            const uint32_t mask = mask_from_object(engines);
+            SamplerSnapshot local;
+            {
+                py::gil_scoped_release release;
+                global_sampler.collect(mask, local);
+            }
+            py::dict result = lxpy::dict_or_new(out);
+            lxpy::fill_snapshot_dict(local, result);
+            return result;
+        },
+        py::arg("engines"),
+        py::arg("out") = py::none(),
+        "One crossing for every requested engine: samples now when the thread is stopped, "
+        "otherwise returns the latest tick; refills out when given");
+    m.def(
+        "engine_bits",
+        []() {
+            py::dict out;
+            for (const auto& e : kSamplerEngines) out[py::str(e.name)] = e.bit;
+            return out;
+        },
+        "Returns {engine name: bit} for building collect() masks");
+    m.def(
+        "history_window",
+        [](const std::string& name, const py::object& tier, size_t points) -> py::object {
+            const HistoryTier t = tier_from_object(tier);
+            HistoryWindow w;
+            if (t == kTierCount || !global_sampler.history().window(name, t, points, w)) return py::none();
+            return py::cast(w);
+        },
+        py::arg("name"),
+        py::arg("tier") = "raw",
+        py::arg("points") = 0,
+        "Newest points of one series as a zero-copy HistoryWindow (None for unknown series/tier); points=0 means all");
+    m.def(
+        "history_record",
+        [](const std::string& name, double value, const py::object& timestamp) {
+            const double ts = timestamp.is_none()
+                ? std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count()
+                : py::cast<double>(timestamp);
+            global_sampler.history().record(name, ts, value);
+        },
+        py::arg("name"),
+        py::arg("value"),
+        py::arg("timestamp") = py::none(),
+        "Appends a sample computed in Python (e.g. aggregated GPU load) to the history store");
+    m.def(
+        "history_series",
+        []() {
+            py::list out;
+            for (const auto& name : global_sampler.history().names()) out.append(py::str(name));
+            return out;
+        },
+        "Returns the names of all recorded series");
+    m.def(
+        "history_tiers",
+        []() {
+            py::list out;
+            for (size_t t = 0; t < kTierCount; ++t) {
+                py::dict d;
+                d["name"] = kHistoryTiers[t].name;
+                d["period"] = kHistoryTiers[t].period_s;
+                d["capacity"] = global_sampler.history().capacity(static_cast<HistoryTier>(t));
+                out.append(d);
+            }
+            return out;
+        },
+        "Returns [{name, period, capacity}] for every history tier");
+    m.def("history_memory", []() { return global_sampler.history().memory_bytes(); }, "Bytes held by history rings");
+    m.def(
+        "shm_publish",
+        [](const std::string& name, size_t size) {
+            std::string error;
+            if (!global_sampler.publish_shm(name, size, error)) throw std::runtime_error(error);
+            return true;
+        },
+        py::arg("name") = kShmDefaultName,
+        py::arg("size") = kShmDefaultSize,
+        "Publishes every sampler tick into the POSIX shm segment name (raises if another writer owns it)");
+    m.def(
+        "set_idle",
+        [](bool idle) { global_sampler.set_idle(idle); },
+        py::arg("idle"),
+        "Stretches every engine period while the UI is hidden or minimized");
+    m.def("is_idle", []() { return global_sampler.idle(); }, "Returns True while idle backoff is on");
+    m.def(
+        "schedule_info",
+        []() {
+            SampleScheduler::EngineStats stats[kSamplerEngineCount];
+            global_sampler.schedule_stats(stats);
+            py::dict out;
+            for (size_t i = 0; i < kSamplerEngineCount; ++i) {
+                py::dict d;
+                d["natural_ms"] = kSamplerEngines[i].natural_ms;
+                d["period_ms"] = stats[i].period_ms;
+                d["cost_us"] = stats[i].cost_us;
+                d["backoff"] = stats[i].backoff;
+                d["runs"] = stats[i].runs;
+                d["skips"] = stats[i].skips;
+                out[py::str(kSamplerEngines[i].name)] = d;
+            }
+            return out;
+        },
+        "Returns {engine: {natural_ms, period_ms, cost_us, backoff, runs, skips}} as of the last tick");
+    m.def(
+        "engine_stats",
+        []() {
+            EngineStatsRegistry& stats = global_sampler.engine_stats();
+            py::dict engines;
+            for (const auto& [name, cost] : stats.snapshot()) engines[py::str(name)] = engine_cost_to_dict(cost);
+            py::dict out;
+            out["elapsed_s"] = stats.elapsed_s();
+            out["engines"] = engines;
+            return out;
+        },
+        "Returns {elapsed_s, engines: {name: {count, failures, min/mean/p50/p90/p99/p999/max_us, total_ms, file_reads, "
+        "file_opens, reads_per_call[, syscalls, syscalls_per_call, cpu_ms]}}}; 'tick' covers whole sampler ticks");
+    m.def(
+        "stats_record",
+        [](const std::string& name, uint64_t ns, bool ok) { global_sampler.engine_stats().record(name, ns, ok); },
+        py::arg("name"),
+        py::arg("ns"),
+        py::arg("ok") = true,
+        "Adds one latency sample (ns) measured outside the sampler, e.g. a Python-driven engine call");
+    m.def(
+        "stats_record_batch",
+        [](const py::iterable& items) {
+            EngineStatsRegistry& stats = global_sampler.engine_stats();
+            for (auto item : items) {
+                const auto t = py::reinterpret_borrow<py::tuple>(item);
+                stats.record(py::cast<std::string>(t[0]), py::cast<uint64_t>(t[1]), t.size() > 2 ? py::cast<bool>(t[2]) : true);
+            }
+        },
+        "stats_record() for a list of (name, ns[, ok]) tuples in one crossing");
+    m.def("stats_reset", []() { global_sampler.engine_stats().reset(); }, "Clears every latency histogram");
+    m.def(
+        "self_usage",
+        []() {
+            const SelfUsage u = self_probe.sample();
+            py::dict out;
+            out["rss_bytes"] = u.rss_bytes;
+            out["cpu_s"] = u.cpu_s;
+            out["window_s"] = u.window_s;
+            out["window_cpu_pct"] = u.window_cpu_pct;
+            return out;
+        },
+        "Own RSS and process CPU time; window_cpu_pct is the share of one core since the previous call");
+    m.def("rescan", []() { global_sampler.request_rescan(); }, "Re-indexes device sources on the next tick");
+    m.def(
+        "set_root",
+        [](const std::string& root, int pid) { global_sampler.set_root(lxpy::source_root_arg(root, pid)); },
+        py::arg("root") = "", py::arg("pid") = 0,
+        "Samples another source root from the next tick: a directory (chroot, bind mount, fixture), pid=N (that "
+        "process' container) or the host (no arguments)");
+    m.def(
+        "set_net_skip_prefixes",
+        [](const py::iterable& prefixes) { global_sampler.set_net_skip_prefixes(lxpy::strings_from_iterable(prefixes)); },
+        py::arg("prefixes"), "Interfaces starting with any prefix are not reported from the next tick; [] reports all");
+    m.def(
+        "set_pressure_triggers",
+        [](const py::iterable& triggers) {
+            const std::vector<PsiTriggerSpec> specs = lxpy::psi_triggers_from_iterable(triggers);
+            std::string error;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = global_sampler.set_pressure_triggers(specs, error);
+            }
+            if (!ok) throw std::runtime_error(error);
+        },
+        py::arg("triggers"),
+        "Arms PSI triggers ([{'resource': 'memory', 'kind': 'some', 'stall_ms': 150, 'window_ms': 2000}, ...]); one firing "
+        "runs the pressure engine at once. [] disarms; raises with the kernel's reason (unprivileged: window_ms a multiple of 2000)");
+    m.def("get_root", []() { return global_sampler.root().label(); }, "Returns the source root: '' (host), a directory or 'pid:N'");
+    m.def("shm_unpublish", []() { global_sampler.unpublish_shm(); }, "Stops publishing and removes the segment");
+    m.def(
+        "shm_status",
+        [](const std::string& name) {
+            py::dict out;
+            ShmFrame frame;
+            bool alive = false;
+            bool readable = false;
+            {
+                py::gil_scoped_release release;
+                ShmReader reader;
+                if (reader.open(name)) {
+                    alive = reader.writer_alive();
+                    readable = reader.read(frame);
+                }
+            }
+            out["exists"] = readable;
+            out["alive"] = alive;
+            out["version"] = kShmVersion;
+            out["publishing"] = py::str(global_sampler.shm_name());
+            if (readable) {
+                out["writer_pid"] = frame.writer_pid;
+                out["generation"] = frame.generation;
+                out["timestamp"] = frame.timestamp_s;
+                out["truncated"] = (frame.flags & kShmTruncated) != 0;
+            }
+            return out;
+        },
+        py::arg("name") = kShmDefaultName,
+        "Describes the segment: exists, alive (a writer holds it), writer_pid, generation, timestamp");
+    m.def(
+        "shm_attach",
+        [](const std::string& name, const py::object& out) -> py::object {
+            bool ok = false;
+            int32_t writer_pid = 0;
+            SamplerSnapshot snap;
+            {
+                // The mutex is only taken without the GIL, so the two locks never nest the other way round.
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lk(attach_mu);
+                ok = attach_locked(name) && attach_reader.read(attach_frame);
+                if (ok) {
+                    SnapshotShmCodec::decode(attach_frame, snap);
+                    writer_pid = attach_frame.writer_pid;
+                }
+            }
+            if (!ok) return py::none();
+            py::dict result = lxpy::dict_or_new(out);
+            lxpy::fill_snapshot_dict(snap, result);
+            result["shm_writer_pid"] = writer_pid;
+            return result;
+        },
+        py::arg("name") = kShmDefaultName,
+        py::arg("out") = py::none(),
+        "Latest snapshot published by another process in the same dict format as collect(); None without a live writer");
+    m.def(
+        "metrics_serve",
+        [](int port, const std::string& address) {
+            std::string error;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = metrics_server.start(address, port, error);
+            }
+            if (!ok) throw std::runtime_error(error);
+            return metrics_server.port();
+        },
+        py::arg("port") = 9464,
+        py::arg("address") = "127.0.0.1",
+        "Serves the latest tick as OpenMetrics text on http://address:port/metrics from a native thread (port 0 picks "
+        "one); returns the bound port, raises when it cannot bind");
+    m.def("metrics_stop", []() { metrics_server.stop(); }, py::call_guard<py::gil_scoped_release>(), "Stops the metrics endpoint");
+    m.def(
+        "metrics_status",
+        []() {
+            MetricsHttpServer::Stats s;
+            int port;
+            {
+                py::gil_scoped_release release;
+                s = metrics_server.stats();
+                port = metrics_server.port();
+            }
+            py::dict out;
+            out["running"] = port != 0;
+            out["port"] = port;
+            out["address"] = metrics_server.address();
+            out["scrapes"] = s.scrapes;
+            out["bad_requests"] = s.bad_requests;
+            out["last_render_us"] = s.last_render_us;
+            out["last_bytes"] = s.last_bytes;
+            out["last_series"] = s.last_series;
+            out["label_renders"] = s.label_renders;
+            return out;
+        },
+        "Returns {running, port, address, scrapes, bad_requests, last_render_us, last_bytes, last_series, label_renders}");
+    m.def(
+        "metrics_text",
+        []() {
+            std::string text;
+            {
+                py::gil_scoped_release release;
+                text = metrics_server.render_text();
+            }
+            return text;
+        },
+        "The /metrics body for the latest tick, rendered now (works without the endpoint running)");
+    m.def(
+        "stream_to",
+        [](const std::string& host, int port, const std::string& node, const std::string& token) {
+            std::string error;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = global_sampler.stream_to(host, port, node, token, error);
+            }
+            if (!ok) throw std::runtime_error(error);
+        },
+        py::arg("host"),
+        py::arg("port") = kNodeStreamDefaultPort,
+        py::arg("node") = "",
+        py::arg("token") = "",
+        "Streams every following tick as compact deltas to a remote viewer (remote.listen) at host:port under the "
+        "name node (default: the host name); reconnects on its own, raises when host does not resolve");
+    m.def("stream_stop", []() { global_sampler.stream_stop(); }, py::call_guard<py::gil_scoped_release>(), "Stops streaming");
+    m.def(
+        "stream_status",
+        []() {
+            NodeStreamSender::Stats s;
+            {
+                py::gil_scoped_release release;
+                s = global_sampler.stream_stats();
+            }
+            py::dict out;
+            out["active"] = s.active;
+            out["connected"] = s.connected;
+            out["target"] = s.target;
+            out["node"] = s.node;
+            out["connects"] = s.connects;
+            out["failures"] = s.failures;
+            out["overflows"] = s.overflows;
+            out["messages"] = s.messages;
+            out["keyframes"] = s.keyframes;
+            out["bytes_sent"] = s.bytes_sent;
+            out["backlog"] = s.backlog;
+            out["last_message"] = s.last_message;
+            out["entries"] = s.entries;
+            out["last_error"] = s.last_error;
+            return out;
+        },
+        "Returns {active, connected, target, node, connects, failures, overflows, messages, keyframes, bytes_sent, "
+        "backlog, last_message, entries, last_error}");
+    m.def("ffi_noop", []() {}, "Does nothing; used to measure the cost of one Python -> C++ crossing");
+}
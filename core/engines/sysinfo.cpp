@@ -0,0 +1,30 @@
+#include <pybind11/pybind11.h>
+
+#include "common/py_convert.h"
+#include "common/sysinfo_engine.h"
+
+namespace py = pybind11;
+
+static SysInfoEngine& host_sysinfo() { return lxpy::default_engine<SysInfoEngine>(); }
+
+PYBIND11_MODULE(sysinfo, m) {
+    m.doc() = "System details: CPU temperature, load, uptime, memory totals, CPU/interface/GPU identity";
+    lxpy::start_default_engine<SysInfoEngine>();
+    lxpy::def_ready<SysInfoEngine>(m);
+    lxpy::def_granted_fds(m);
+    py::class_<SysInfoEngine>(m, "Engine", "System details of one source root")
+        .def(py::init(&lxpy::make_engine<SysInfoEngine>), py::arg("root") = "", py::arg("pid") = 0)
+        .def("get_all", [](SysInfoEngine& e) { return lxpy::sysinfo_to_dict(e.sample()); },
+             "Returns {'cpu_temp', 'sys_*', 'net_meta': {iface: {...}}, 'gpu_cards': [...]}")
+        .def("get_last", [](const SysInfoEngine& e) { return lxpy::sysinfo_to_dict(e.last()); }, "Returns the last get_all() result")
+        .def("rescan", &SysInfoEngine::rescan, "Re-resolves temperature paths, interfaces and cards on the next read");
+
+    m.def("get_all", []() { return lxpy::sysinfo_to_dict(host_sysinfo().sample()); },
+          "Returns {'cpu_temp', 'sys_*', 'net_meta': {iface: {...}}, 'gpu_cards': [...]}");
+    m.def("get_last", []() { return lxpy::sysinfo_to_dict(host_sysinfo().last()); }, "Returns the last get_all() result");
+    m.def("get_usage", []() {
+        const double t = host_sysinfo().sample().cpu_temp_c;
+        return std::isnan(t) ? py::object(py::none()) : py::object(py::float_(t));
+    }, "Returns the CPU temperature in degrees C, or None");
+    m.def("rescan", []() { host_sysinfo().rescan(); }, "Re-resolves temperature paths, interfaces and cards on the next read");
+}
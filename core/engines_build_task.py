@@ -34,10 +34,17 @@ def _pybind_includes() -> list[str]:
     return shlex.split(result.stdout.strip())
 
 
+def _shared_headers_mtime() -> float:
+    common = _engines_dir() / "common"
+    if not common.is_dir():
+        return 0.0
+    return max((p.stat().st_mtime for p in common.rglob("*.h") if p.is_file()), default=0.0)
+
+
 def _needs_rebuild(src: Path, so: Path) -> bool:
     if not so.exists():
         return True
-    return src.stat().st_mtime > so.stat().st_mtime
+    return max(src.stat().st_mtime, _shared_headers_mtime()) > so.stat().st_mtime
 
 
 def _has_nvml_headers() -> bool:
@@ -0,0 +1,94 @@
+"""
+Change detection between consecutive worker frames (CppEngineWorker -> data_ready).
+
+Each frame is compared with the values last sent to the UI: a number counts as changed when it
+moved by more than the epsilon of its key (in the metric's own unit), everything else (names,
+net_meta, driver info, nested metadata) only when it is not equal. The emitted frame holds the
+changed keys plus:
+
+    _gen      generation counter, +1 per frame
+    _full     True when the frame carries every key (first frame, after reset())
+    _removed  keys present in the previous frame and missing from this one
+
+Comparison is against the last *sent* value, so a slow drift below the epsilon still goes out once
+it adds up. The recorder keeps receiving the full frames; replayed frames have no _gen and the
+dashboard takes them as full.
+"""
+
+_MISSING = object()
+
+
+def _snapshot(value):
+    # Copied, since a collector may hand out the same dict again, updated in place.
+    if isinstance(value, dict):
+        return {key: _snapshot(item) for key, item in value.items()}
+    if isinstance(value, (list, tuple)):
+        return [_snapshot(item) for item in value]
+    if isinstance(value, (str, bytes, int, float)) or value is None:
+        return value
+    # Native buffers (CoreTable) are refilled in place by the engine: compare their rows.
+    try:
+        view = memoryview(value)
+    except TypeError:
+        return value
+    return (view.tolist(), bytes(getattr(value, "online", b"")))
+
+
+def _close(old, new, eps):
+    if type(old) is float or type(new) is float:
+        if isinstance(old, (int, float)) and isinstance(new, (int, float)) and not isinstance(old, bool):
+            return old == new or abs(new - old) <= eps
+        return False
+    if isinstance(old, dict):
+        if not isinstance(new, dict) or len(old) != len(new):
+            return False
+        for key, item in new.items():
+            prev = old.get(key, _MISSING)
+            if prev is _MISSING or not _close(prev, item, eps):
+                return False
+        return True
+    if isinstance(old, (list, tuple)):
+        if not isinstance(new, (list, tuple)) or len(old) != len(new):
+            return False
+        return all(_close(a, b, eps) for a, b in zip(old, new))
+    try:
+        return bool(old == new)
+    except Exception:
+        return False
+
+
+class FrameDelta:
+    """Turns full frames into delta frames; one instance per worker."""
+
+    def __init__(self, epsilon=None):
+        # Key -> threshold; keys without one (and ints, strings, metadata) compare exactly.
+        self.epsilon = dict(epsilon or {})
+        self.generation = 0
+        self._sent = None
+
+    def reset(self):
+        """The next frame goes out in full (new dashboard binding, live loop restarted after a replay)."""
+        self._sent = None
+
+    def diff(self, frame):
+        self.generation += 1
+        out = {"_gen": self.generation}
+        sent = self._sent
+        if sent is None:
+            out["_full"] = True
+            out.update(frame)
+            self._sent = {key: _snapshot(value) for key, value in frame.items()}
+            return out
+        for key, value in frame.items():
+            snap = _snapshot(value)
+            prev = sent.get(key, _MISSING)
+            if prev is _MISSING or not _close(prev, snap, self.epsilon.get(key, 0.0)):
+                out[key] = value
+                sent[key] = snap
+        removed = [key for key in sent if key not in frame]
+        for key in removed:
+            del sent[key]
+        if removed:
+            out["_removed"] = removed
+        return out
+
@@ -5,6 +5,13 @@ import glob
 from typing import Set
 
 class CppHandler1:
+    # PSI triggers armed on the native sampler: memory/io stalls adding up to 150 ms within 2 s wake it
+    # at once instead of at the next pressure period. 2 s windows are allowed for unprivileged users.
+    PRESSURE_TRIGGERS = [
+        {"resource": "memory", "kind": "some", "stall_ms": 150, "window_ms": 2000},
+        {"resource": "io", "kind": "some", "stall_ms": 150, "window_ms": 2000},
+    ]
+
     def __init__(self, console_logic=None):
         self.console = console_logic
         # Uwzględniamy strukturę: core/handlers/cpp_handler1.py -> wychodzimy do core/
@@ -67,6 +74,7 @@ class CppHandler1:
                 output_dir=self.engines_dir,
                 compile_only=True,
                 policy="prefer_cache",
+                profile="auto",
             )
             ready = self._engine_binary_exists(engine_name)
             expected = len(glob.glob(os.path.join(self.engines_dir, "*.cpp")))
@@ -177,6 +185,33 @@ class CppHandler1:
         if has_psu_paths:
             self._append_engine_if_available(to_load, "psu", "Hardware: Power telemetry paths detected.")
 
+        # 6. Per-process top-N (CPU, RSS, I/O)
+        if os.path.isdir("/proc/self"):
+            self._append_engine_if_available(to_load, "process", "Runtime: Process table ready.", missing_level="INFO")
+
+        # 7. Pressure stalls (PSI) + vmstat reclaim/swap/OOM counters
+        if self._is_readable("/proc/pressure/memory") or self._is_readable("/proc/vmstat"):
+            self._append_engine_if_available(to_load, "pressure", "Runtime: Pressure stall telemetry ready.", missing_level="INFO")
+        else:
+            self._log("Runtime: /proc/pressure not readable (kernel without CONFIG_PSI?).", "INFO")
+
+        # 8. System details (CPU temperature, load, uptime, CPU/interface/GPU identity)
+        if os.path.isdir("/proc/self"):
+            self._append_engine_if_available(to_load, "sysinfo", "Runtime: System details collector ready.", missing_level="INFO")
+
+        # 9. Per-service/container usage (cgroup v2)
+        if os.path.exists("/sys/fs/cgroup/cgroup.controllers") or os.path.exists("/sys/fs/cgroup/unified/cgroup.controllers"):
+            self._append_engine_if_available(to_load, "cgroup", "Runtime: cgroup v2 hierarchy detected.", missing_level="INFO")
+
+        # 10. Native background sampler (drives the engines above from its own thread)
+        if to_load:
+            self._append_engine_if_available(
+                to_load,
+                "sampler",
+                "Runtime: Native background sampler ready.",
+                missing_level="INFO",
+            )
+
         if to_load:
             self._log(f"Discovery complete. Target engines: {', '.join(to_load)}", "SUCCESS")
         else:
@@ -222,3 +257,65 @@ class CppHandler1:
                 self._log(f"Runtime: Error in {engine_name}::{method_name}() -> {str(e)}", "ERROR")
                 return None
         return None
+
+    def arm_pressure_triggers(self, triggers=None):
+        """Arms PSI triggers on the sampler; False (logged) without PSI or when the kernel refuses them."""
+        if not self._is_readable("/proc/pressure/memory"):
+            return False
+        specs = self.PRESSURE_TRIGGERS if triggers is None else triggers
+        engine = self.loaded_engines.get("sampler")
+        if engine is None or not hasattr(engine, "set_pressure_triggers"):
+            return False
+        try:
+            engine.set_pressure_triggers(specs)
+        except Exception as e:
+            self._log(f"Runtime: PSI triggers unavailable ({e}); pressure is polled.", "INFO")
+            return False
+        self._log(f"Runtime: {len(specs)} PSI trigger(s) armed on the sampler.", "INFO")
+        return True
+
+    def serve_metrics(self, port=9464, address="127.0.0.1"):
+        """
+        OpenMetrics endpoint served by the native sampler's own thread (GET /metrics, latest tick,
+        no Python on the scrape path). Returns the bound port, 0 (logged) when it cannot bind.
+        """
+        engine = self.loaded_engines.get("sampler")
+        if engine is None or not hasattr(engine, "metrics_serve"):
+            self._log("Runtime: metrics endpoint needs the native sampler.", "WARN")
+            return 0
+        try:
+            bound = int(engine.metrics_serve(int(port), str(address)))
+        except Exception as e:
+            self._log(f"Runtime: metrics endpoint unavailable ({e}).", "ERROR")
+            return 0
+        host = f"[{address}]" if ":" in address else address
+        self._log(f"Runtime: OpenMetrics on http://{host}:{bound}/metrics", "INFO")
+        return bound
+
+    def stop_metrics(self):
+        engine = self.loaded_engines.get("sampler")
+        if engine is not None and hasattr(engine, "metrics_stop"):
+            engine.metrics_stop()
+
+    def stream_to(self, host, port=9470, node="", token=""):
+        """
+        Remote mode: the native sampler sends every tick as a delta to a viewer listening on host:port
+        (reconnects on its own). node defaults to the hostname. False (logged) when host does not resolve.
+        """
+        engine = self.loaded_engines.get("sampler")
+        if engine is None or not hasattr(engine, "stream_to"):
+            self._log("Runtime: remote streaming needs the native sampler.", "WARN")
+            return False
+        try:
+            engine.stream_to(str(host), int(port), str(node or ""), str(token or ""))
+        except Exception as e:
+            self._log(f"Runtime: remote stream unavailable ({e}).", "ERROR")
+            return False
+        target = f"[{host}]" if ":" in host else host
+        self._log(f"Runtime: streaming ticks to {target}:{int(port)}", "INFO")
+        return True
+
+    def stop_stream(self):
+        engine = self.loaded_engines.get("sampler")
+        if engine is not None and hasattr(engine, "stream_stop"):
+            engine.stream_stop()
@@ -6,6 +6,9 @@ import shutil
 import subprocess
 import re
 
+from core.frame_delta import FrameDelta
+from core.overhead import OverheadMonitor
+
 class CppEngineWorker(QObject):
     """
     Logika zbierania danych działająca w tle. 
@@ -35,6 +38,43 @@ class CppEngineWorker(QObject):
         self._fb_disk_prev_io = {}
         self._fb_net_prev_time = None
         self._fb_net_prev_bytes = {}
+        self._sampler_supported = None
+        self._sampler_engines = None
+        self._sampler_out = {}
+        # Segment of a headless collector (main.py --headless); when live, its ticks replace local sampling.
+        self.shm_name = os.environ.get("LXMONITOR_SHM_NAME", "/lxmonitor")
+        self.shm_attached = False
+        # Natural periods (s) of slow engines polled from Python; faster ticks reuse their last payload.
+        # Same table as kSamplerEngines in the native sampler.
+        # process scans every /proc/<pid>; its top-N lists only feed details text and the 'top' command.
+        # sysinfo: load/uptime/temperature for the details panel, 1 s like the Python collectors it replaces.
+        # cgroup: per-service/container top-N; each call reads a bounded slice of the hierarchy.
+        self.engine_periods_s = {
+            "ram": 0.5, "bt": 1.0, "psu": 0.5, "gpu_temp": 1.0, "pressure": 1.0, "process": 2.0, "sysinfo": 1.0, "cgroup": 2.0,
+        }
+        self._engine_last_poll = {}
+        self._engine_cached = {}
+        self._engine_cached_cards = {}
+        # Moduły budują domyślny silnik w tle od importu; do czasu ready() są pomijane (bez watchdoga).
+        self._engines_ready = set()
+        # Per-engine latency for the F12 'stats' command; stored in the sampler's native histograms when loaded.
+        self.overhead = OverheadMonitor()
+        # recorder.Recorder (CppHandler2.start_recording): każda klatka trafia do pliku przed wysłaniem do UI.
+        self.recorder = None
+        # Moduł remote (CppHandler2.start_remote): do klatki dochodzą węzły zmienione od poprzedniej.
+        self.remote = None
+        # Do UI idą tylko klucze, które zmieniły się o więcej niż próg (w jednostce metryki, poniżej
+        # rozdzielczości wyświetlania); reszta i metadane (net_meta, nazwy, sterowniki) tylko przy zmianie.
+        # sys_time zmienia się co klatkę, a UI go nie czyta: trafia do nagrań, do UI tylko raz.
+        self.change_epsilon = {
+            "cpu": 0.05, "ram": 0.05, "gpu": 0.05, "gpu_nvidia": 0.05, "gpu_others": 0.05, "gpu_all": 0.05,
+            "disc": 0.05, "disc_all": 0.05, "pressure": 0.01, "pressure_all": 0.01,
+            "net": 0.002, "net_rx": 0.002, "net_tx": 0.002, "net_all": 0.002, "bt_all": 0.0005,
+            "psu": 0.005, "psu_all": 0.005, "cpu_temp": 0.05, "gpu_temp": 0.05,
+            "sys_load_1m": 0.002, "sys_load_5m": 0.002, "sys_load_15m": 0.002,
+            "sys_cpu_cores_usage": 0.05, "proc_top": 0.05, "cgroup_top": 0.05, "sys_time": float("inf"),
+        }
+        self.frame_delta = FrameDelta(self.change_epsilon)
 
     def _emit(self, level, message):
         self.error_signal.emit(f"[{level}] {message}")
@@ -84,19 +124,121 @@ class CppEngineWorker(QObject):
         self._engine_fail_streak[engine_name] = self._heal_threshold - 1
         self._emit("ERROR", f"Watchdog: relink failed for '{engine_name}'.")
 
+    def sampler_targets(self):
+        """Aktywne silniki, które natywny sampler potrafi obsłużyć we własnym wątku."""
+        if "sampler" not in self.active_engines:
+            return []
+        if self._sampler_supported is None:
+            supported = self.bridge1.invoke_method("sampler", "supported_engines")
+            if supported is None:
+                return []
+            self._sampler_supported = set(supported)
+        return [e for e in self.active_engines if e in self._sampler_supported]
+
+    def _collect_from_sampler(self, collected_data):
+        targets = tuple(self.sampler_targets())
+        if targets != self._sampler_engines:
+            self.bridge1.invoke_method("sampler", "set_engines", list(targets))
+            self._sampler_engines = targets
+
+        owned = set(targets)
+        snap = self._attach_shm_snapshot()
+        if snap is not None:
+            # Engines the collector does not sample fall through to the per-engine path.
+            owned &= set(snap.get("sampled") or [])
+        else:
+            # One crossing per frame: the sampler thread already did the /proc and /sys reads
+            # (or collect() samples right here if the thread is not running). The dict is refilled in place.
+            snap = self.bridge1.invoke_method("sampler", "collect", list(targets), self._sampler_out)
+            if snap is None:
+                snap = self.bridge1.invoke_method("sampler", "get_snapshot")
+        if not isinstance(snap, dict):
+            self._mark_engine_fail("sampler", "no sampler snapshot")
+            return set()
+        self._mark_engine_ok("sampler")
+        if not snap:
+            # Sampler owns these engines; skip them until the first tick is published.
+            return owned
+
+        for engine_name in snap.get("sampled") or []:
+            self._mark_engine_ok(engine_name)
+        for key in (
+            "cpu",
+            "cpu_cores",
+            "ram",
+            "disc",
+            "disc_all",
+            "disc_stats",
+            "net",
+            "net_rx",
+            "net_tx",
+            "net_all",
+            "bt_all",
+            "psu",
+            "psu_all",
+            "gpu_others",
+            "gpu_temp",
+            "gpu_cards",
+            "pressure",
+            "pressure_all",
+        ):
+            if key in snap:
+                collected_data[key] = snap[key]
+        if isinstance(snap.get("net_all"), dict):
+            collected_data["net_meta"] = self._read_net_iface_meta(list(snap["net_all"].keys()))
+        return owned
+
+    def _attach_shm_snapshot(self):
+        """Latest tick of a live headless collector in another process, or None."""
+        if not self.shm_name:
+            return None
+        snap = self.bridge1.invoke_method("sampler", "shm_attach", self.shm_name, self._sampler_out)
+        attached = isinstance(snap, dict) and snap.get("shm_writer_pid") != os.getpid()
+        if attached != self.shm_attached:
+            self.shm_attached = attached
+            if attached:
+                self._emit("INFO", f"Attached to headless collector (pid {snap.get('shm_writer_pid')}) via {self.shm_name}.")
+            else:
+                self._emit("WARN", f"Headless collector on {self.shm_name} is gone; sampling locally.")
+        return snap if attached else None
+
     def perform_check(self):
         """Pojedynczy cykl odpytania wszystkich aktywnych silników."""
         if not self.is_active:
             return
 
         collected_data = {}
+        clock = time.perf_counter_ns
+        frame_t0 = clock()
+        self.overhead.native = self.bridge1.loaded_engines.get("sampler") if "sampler" in self.active_engines else None
         try:
+            sampled_engines = set()
+            if "sampler" in self.active_engines:
+                t0 = clock()
+                sampled_engines = self._collect_from_sampler(collected_data)
+                self.overhead.record("py:sampler", clock() - t0, self._engine_fail_streak.get("sampler", 0) == 0)
+
+            now_mono = time.monotonic()
             for engine_name in self.active_engines:
+                if engine_name == "sampler" or engine_name in sampled_engines:
+                    continue
+                if not self._engine_ready(engine_name):
+                    continue
+                if not self._engine_due(engine_name, now_mono):
+                    self._replay_engine(engine_name, collected_data)
+                    continue
+                before = dict(collected_data)
+                self._engine_cached_cards.pop(engine_name, None)
+                t0 = clock()
                 # Wywołujemy metodę z cpp_handler1.py
                 if engine_name == "disc":
                     all_disks = self.bridge1.invoke_method(engine_name, "get_all_usage")
                     if isinstance(all_disks, dict) and all_disks:
                         collected_data["disc_all"] = all_disks
+                        # Throughput/IOPS/await from the same diskstats pass (no resample).
+                        disc_stats = self.bridge1.invoke_method(engine_name, "get_last_stats")
+                        if isinstance(disc_stats, dict):
+                            collected_data["disc_stats"] = disc_stats
                         self._mark_engine_ok(engine_name)
                     else:
                         val = self.bridge1.invoke_method(engine_name, "get_usage")
@@ -109,7 +251,8 @@ class CppEngineWorker(QObject):
                     all_ifaces = self.bridge1.invoke_method(engine_name, "get_all_usage")
                     if isinstance(all_ifaces, dict):
                         collected_data["net_all"] = all_ifaces
-                        collected_data["net_meta"] = self._read_net_iface_meta(list(all_ifaces.keys()))
+                        if "sysinfo" not in self.active_engines:
+                            collected_data["net_meta"] = self._read_net_iface_meta(list(all_ifaces.keys()))
                     total_mbps = self.bridge1.invoke_method(engine_name, "get_total_mbps")
                     rx_mbps = self.bridge1.invoke_method(engine_name, "get_rx_mbps")
                     tx_mbps = self.bridge1.invoke_method(engine_name, "get_tx_mbps")
@@ -141,6 +284,59 @@ class CppEngineWorker(QObject):
                         self._mark_engine_ok(engine_name)
                     else:
                         self._mark_engine_fail(engine_name, "no power telemetry")
+                elif engine_name in ("gpu_others", "gpu_temp"):
+                    # Per-card readings from the same pass; busy (gpu_others) and temp (gpu_temp) merge by card.
+                    cards = self.bridge1.invoke_method(engine_name, "get_all_usage")
+                    if isinstance(cards, list):
+                        self._engine_cached_cards[engine_name] = cards
+                        self._merge_gpu_cards(collected_data, engine_name, cards)
+                    val = self.bridge1.invoke_method(engine_name, "get_usage")
+                    if val is not None:
+                        collected_data[engine_name] = val
+                        self._mark_engine_ok(engine_name)
+                    else:
+                        self._mark_engine_fail(engine_name, "get_usage returned None")
+                elif engine_name == "pressure":
+                    pressure_all = self.bridge1.invoke_method(engine_name, "get_all_usage")
+                    if isinstance(pressure_all, dict):
+                        collected_data["pressure_all"] = pressure_all
+                        memory = pressure_all.get("memory")
+                        collected_data["pressure"] = memory.get("some", 0.0) if isinstance(memory, dict) else 0.0
+                        self._mark_engine_ok(engine_name)
+                    else:
+                        self._mark_engine_fail(engine_name, "no pressure telemetry")
+                elif engine_name == "sysinfo":
+                    info = self.bridge1.invoke_method(engine_name, "get_all")
+                    if isinstance(info, dict):
+                        collected_data["sysinfo"] = info
+                        self._mark_engine_ok(engine_name)
+                    else:
+                        self._mark_engine_fail(engine_name, "no system details")
+                elif engine_name == "process":
+                    top = self.bridge1.invoke_method(engine_name, "get_top", 5)
+                    if isinstance(top, dict):
+                        collected_data["proc_top"] = top
+                        self._mark_engine_ok(engine_name)
+                    else:
+                        self._mark_engine_fail(engine_name, "no process table")
+                elif engine_name == "cgroup":
+                    top = self.bridge1.invoke_method(engine_name, "get_top", 5)
+                    if isinstance(top, dict) and top.get("available"):
+                        collected_data["cgroup_top"] = top
+                        self._mark_engine_ok(engine_name)
+                    else:
+                        self._mark_engine_fail(engine_name, "no cgroup v2 hierarchy")
+                elif engine_name == "gpu_nvidia":
+                    # Per-device NVML records are merged into gpu_all below.
+                    nvml_all = self.bridge1.invoke_method(engine_name, "get_all_usage")
+                    if isinstance(nvml_all, list):
+                        collected_data["gpu_nvidia_all"] = nvml_all
+                    val = self.bridge1.invoke_method(engine_name, "get_usage")
+                    if val is not None:
+                        collected_data[engine_name] = val
+                        self._mark_engine_ok(engine_name)
+                    else:
+                        self._mark_engine_fail(engine_name, "get_usage returned None")
                 else:
                     val = self.bridge1.invoke_method(engine_name, "get_usage")
                     if val is not None:
@@ -148,18 +344,37 @@ class CppEngineWorker(QObject):
                         self._mark_engine_ok(engine_name)
                     else:
                         self._mark_engine_fail(engine_name, "get_usage returned None")
-
-            # Dodatkowe statystyki z systemu (Python fallback)
-            cpu_temp = self._read_cpu_temp_c()
+                self.overhead.record("py:" + engine_name, clock() - t0, self._engine_fail_streak.get(engine_name, 0) == 0)
+                self._remember_engine(engine_name, before, collected_data, now_mono)
+
+            # Dodatkowe statystyki z systemu: silnik sysinfo, a bez niego Python fallback.
+            t0 = clock()
+            sysinfo = collected_data.pop("sysinfo", None)
+            if isinstance(sysinfo, dict):
+                cpu_temp = sysinfo.get("cpu_temp")
+            else:
+                cpu_temp = self._read_cpu_temp_c()
             if cpu_temp is not None:
                 collected_data["cpu_temp"] = cpu_temp
 
-            gpu_all = self._read_gpu_stats_all()
+            gpu_all = self._read_gpu_stats_all(
+                collected_data.pop("gpu_nvidia_all", None),
+                collected_data.pop("gpu_cards", None),
+                native_busy="gpu_others" in collected_data,
+                native_temp="gpu_temp" in collected_data,
+                identity=sysinfo.get("gpu_cards") if isinstance(sysinfo, dict) else None,
+            )
             if gpu_all:
                 collected_data["gpu_all"] = gpu_all
 
+            # Per-core table: from the sampler tick, else straight from the cpu engine.
+            core_table = collected_data.pop("cpu_cores", None)
+            if core_table is None and "cpu" in self.active_engines:
+                core_table = self.bridge1.invoke_method("cpu", "get_core_usage")
+
             # Dodatkowe statystyki systemowe.
-            collected_data.update(self._read_system_stats())
+            collected_data.update(self._read_system_stats(core_table, sysinfo))
+            self.overhead.record("py:system", clock() - t0)
 
             # Core metric fallbacks (cross-distro compatibility when C++ engines are unavailable).
             if "cpu" not in collected_data:
@@ -178,7 +393,7 @@ class CppEngineWorker(QObject):
                 net_fb = self._fallback_net_usage()
                 if net_fb:
                     collected_data.update(net_fb)
-                    if isinstance(net_fb.get("net_all"), dict):
+                    if isinstance(net_fb.get("net_all"), dict) and "net_meta" not in collected_data:
                         collected_data["net_meta"] = self._read_net_iface_meta(list(net_fb["net_all"].keys()))
 
             # Bluetooth adapters (Python fallback telemetry).
@@ -187,14 +402,90 @@ class CppEngineWorker(QObject):
                 if isinstance(bt_all, dict) and bt_all:
                     collected_data["bt_all"] = bt_all
 
-            # Jeśli zebraliśmy jakiekolwiek dane, ślemy do UI
+            self.overhead.record("py:frame", clock() - frame_t0)
+            if collected_data and self.recorder is not None:
+                t0 = clock()
+                self._record_frame(collected_data)
+                self.overhead.record("py:record", clock() - t0)
+            frame = None
             if collected_data:
-                self.data_ready.emit(collected_data)
+                t0 = clock()
+                frame = self.frame_delta.diff(collected_data)
+                self.overhead.record("py:delta", clock() - t0)
+            if frame is not None and self.remote is not None:
+                t0 = clock()
+                self._attach_remote_nodes(frame)
+                self.overhead.record("py:remote", clock() - t0)
+            self.overhead.flush()
+
+            # Jeśli zebraliśmy jakiekolwiek dane, ślemy do UI (same zmiany, patrz FrameDelta)
+            if frame is not None:
+                self.data_ready.emit(frame)
                 
         except Exception as e:
             # Przekazujemy błąd wyżej, żeby trafił do konsoli
             self._emit("ERROR", f"Worker Runtime Error: {e}")
 
+    def _record_frame(self, collected_data):
+        try:
+            self.recorder.append(collected_data)
+        except Exception as e:
+            # Pełny dysk / usunięty katalog: nagrywanie się wyłącza, monitoring działa dalej.
+            self.recorder = None
+            self._emit("WARN", f"Recording stopped: {e}")
+
+    def _attach_remote_nodes(self, frame):
+        # Węzły nie trafiają do nagrań ani do FrameDelta: poll() sam zwraca tylko zmienione
+        # (wszystkie przy pełnej klatce), zapomniane jako None.
+        try:
+            nodes = self.remote.poll(bool(frame.get("_full")))
+        except Exception as e:
+            self.remote = None
+            self._emit("WARN", f"Remote mode stopped: {e}")
+            return
+        if nodes:
+            frame["nodes"] = nodes
+
+    def _engine_ready(self, engine_name):
+        """True once the module's default engine is constructed; modules without ready() count as ready."""
+        if engine_name in self._engines_ready:
+            return True
+        ready = self.bridge1.invoke_method(engine_name, "ready")
+        if ready is False:
+            return False
+        self._engines_ready.add(engine_name)
+        return True
+
+    def _engine_due(self, engine_name, now_mono):
+        period = self.engine_periods_s.get(engine_name)
+        if not period:
+            return True
+        last = self._engine_last_poll.get(engine_name)
+        return last is None or (now_mono - last) >= period
+
+    def _remember_engine(self, engine_name, before, collected_data, now_mono):
+        if engine_name not in self.engine_periods_s:
+            return
+        self._engine_last_poll[engine_name] = now_mono
+        # gpu_cards is shared between engines; it is replayed through _merge_gpu_cards instead.
+        self._engine_cached[engine_name] = {
+            k: v for k, v in collected_data.items() if k != "gpu_cards" and (k not in before or before[k] is not v)
+        }
+
+    def _replay_engine(self, engine_name, collected_data):
+        collected_data.update(self._engine_cached.get(engine_name) or {})
+        cards = self._engine_cached_cards.get(engine_name)
+        if cards:
+            self._merge_gpu_cards(collected_data, engine_name, cards)
+
+    def _merge_gpu_cards(self, collected_data, engine_name, cards):
+        field = "busy" if engine_name == "gpu_others" else "temp"
+        merged = {c.get("card"): c for c in collected_data.get("gpu_cards") or []}
+        for card in cards:
+            entry = merged.setdefault(card.get("card"), dict(card))
+            entry[field] = card.get(field)
+        collected_data["gpu_cards"] = list(merged.values())
+
     def _fallback_cpu_usage(self):
         try:
             with open("/proc/stat", "r", encoding="utf-8", errors="ignore") as f:
@@ -423,7 +714,9 @@ class CppEngineWorker(QObject):
                 continue
         return best
 
-    def _read_system_stats(self):
+    def _read_system_stats(self, core_table=None, sysinfo=None):
+        if isinstance(sysinfo, dict):
+            return self._system_stats_from_native(core_table, sysinfo)
         stats = {}
         try:
             with open("/proc/stat", "r", encoding="utf-8", errors="ignore") as f:
@@ -484,7 +777,8 @@ class CppEngineWorker(QObject):
         if cpu_count is not None:
             stats["sys_cpu_count"] = int(cpu_count)
 
-        core_usage = self._read_cpu_core_usage()
+        # Native CoreTable (buffer protocol) when the cpu engine provides it; Python parsing only as fallback.
+        core_usage = core_table if core_table is not None else self._read_cpu_core_usage()
         if core_usage:
             stats["sys_cpu_cores_usage"] = core_usage
 
@@ -498,6 +792,17 @@ class CppEngineWorker(QObject):
         stats["sys_time"] = time.time()
         return stats
 
+    def _system_stats_from_native(self, core_table, sysinfo):
+        stats = {k: v for k, v in sysinfo.items() if k.startswith("sys_") and v is not None}
+        net_meta = sysinfo.get("net_meta")
+        if isinstance(net_meta, dict):
+            stats["net_meta"] = net_meta
+        core_usage = core_table if core_table is not None else self._read_cpu_core_usage()
+        if core_usage:
+            stats["sys_cpu_cores_usage"] = core_usage
+        stats["sys_time"] = time.time()
+        return stats
+
     def _read_cpu_metadata(self):
         vendor = None
         packages = set()
@@ -649,21 +954,18 @@ class CppEngineWorker(QObject):
         out["cards"] = sorted(cards)
         return out
 
-    def _read_gpu_stats_all(self):
-        by_gpu = {}
+    def _gpu_identity_from_sysfs(self):
+        out = []
         for card in sorted(glob.glob("/sys/class/drm/card[0-9]*")):
             dev = os.path.join(card, "device")
             if not os.path.isdir(dev):
                 continue
-
-            card_id = os.path.basename(card)
             uevent = self._read_text(os.path.join(dev, "uevent"))
             slot = ""
             for line in uevent.splitlines():
                 if line.startswith("PCI_SLOT_NAME="):
                     slot = line.split("=", 1)[1].strip()
                     break
-            gpu_name = self._gpu_name_from_slot(slot) or card_id
             gpu_driver = None
             drv_link = os.path.join(dev, "driver")
             if os.path.islink(drv_link):
@@ -671,14 +973,45 @@ class CppEngineWorker(QObject):
                     gpu_driver = os.path.basename(os.path.realpath(drv_link))
                 except Exception:
                     gpu_driver = None
-            vendor_id = self._read_text(os.path.join(dev, "vendor")) or None
-            device_id = self._read_text(os.path.join(dev, "device")) or None
+            out.append({
+                "card": os.path.basename(card),
+                "slot": slot,
+                "driver": gpu_driver,
+                "vendor_id": self._read_text(os.path.join(dev, "vendor")) or None,
+                "device_id": self._read_text(os.path.join(dev, "device")) or None,
+            })
+        return out
+
+    def _read_gpu_stats_all(self, nvml_devices=None, native_cards=None, native_busy=False, native_temp=False, identity=None):
+        # Native per-card readings (resolved, pinned sysfs files) replace the busy/temp reads below
+        # for whichever of gpu_others (busy) / gpu_temp (temp) produced them.
+        native = {c.get("card"): c for c in native_cards or [] if isinstance(c, dict)}
+        by_gpu = {}
+        # Card identity from sysinfo (cached until a drm uevent), else read from sysfs every tick.
+        cards = identity if isinstance(identity, list) else self._gpu_identity_from_sysfs()
+        for ident in cards:
+            if not isinstance(ident, dict):
+                continue
+            card_id = str(ident.get("card") or "")
+            dev = os.path.join("/sys/class/drm", card_id, "device")
+            slot = ident.get("slot") or ""
+            gpu_name = self._gpu_name_from_slot(slot) or card_id
+            gpu_driver = ident.get("driver")
+            vendor_id = ident.get("vendor_id")
+            device_id = ident.get("device_id")
 
             load = None
-            for p in (
+            temp = None
+            card_native = native.get(card_id) or {}
+            if native_busy:
+                load = card_native.get("busy")
+            if native_temp:
+                temp = card_native.get("temp")
+            busy_paths = () if native_busy else (
                 os.path.join(dev, "gpu_busy_percent"),
                 os.path.join(dev, "usage"),
-            ):
+            )
+            for p in busy_paths:
                 raw = self._read_text(p)
                 if raw:
                     try:
@@ -686,8 +1019,7 @@ class CppEngineWorker(QObject):
                         break
                     except Exception:
                         pass
-            temp = None
-            hw_paths = glob.glob(os.path.join(dev, "hwmon", "hwmon*", "temp*_input"))
+            hw_paths = [] if native_temp else glob.glob(os.path.join(dev, "hwmon", "hwmon*", "temp*_input"))
             for p in hw_paths:
                 raw = self._read_text(p)
                 if not raw:
@@ -716,6 +1048,25 @@ class CppEngineWorker(QObject):
             prev = by_gpu.get(gpu_id)
             by_gpu[gpu_id] = self._merge_gpu_item(prev, item)
 
+        # NVIDIA exposes no busy/temp files in sysfs; NVML fills them in, keyed by the same PCI slot.
+        for dev in nvml_devices or []:
+            if not isinstance(dev, dict):
+                continue
+            slot = str(dev.get("pci_bus_id") or "").lower()
+            gpu_id = self._gpu_key(f"nvml{dev.get('index', 0)}", slot, None, None)
+            item = {
+                "id": gpu_id,
+                "name": dev.get("name") or gpu_id,
+                "load": dev.get("util_gpu"),
+                "temp": dev.get("temp_c"),
+                "slot": slot or None,
+                "driver": "nvidia",
+                "cards": [],
+            }
+            merged = self._merge_gpu_item(by_gpu.get(gpu_id), item)
+            merged["nvml"] = dev
+            by_gpu[gpu_id] = merged
+
         out = list(by_gpu.values())
         out.sort(key=lambda x: str(x.get("id") or ""))
         return out
@@ -905,6 +1256,12 @@ class CppEngineWorker(QObject):
         return out
 
 class CppHandler2(QObject):
+    # Nagrania klatek (rotowane segmenty .lxrec); cleanup_old_logs() nie schodzi do podkatalogów.
+    RECORDINGS_DIR = os.path.join(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))), "assets", "logs", "recordings")
+    RECORD_SEGMENTS = 8
+    # Replay timer floor; faster speeds skip recorded ticks instead of emitting more often.
+    REPLAY_MIN_INTERVAL_MS = 40
+
     def __init__(self, bridge1, console_logic=None):
         super().__init__()
         self.bridge1 = bridge1
@@ -918,7 +1275,19 @@ class CppHandler2(QObject):
         # Timer sterujący częstotliwością odświeżania
         self.refresh_timer = QTimer()
         self.refresh_timer.timeout.connect(self.worker.perform_check)
-        
+        self.interval_ms = 1000
+        self.idle = False
+
+        # Odtwarzanie nagrania zamiast pętli na żywo (start_replay).
+        self.replay_timer = QTimer()
+        self.replay_timer.timeout.connect(self._replay_tick)
+        self._replay = None
+        self._replay_path = ""
+        self._replay_speed = 1.0
+        self._replay_origin = (0.0, 0.0)  # (monotonic, recorded ts) of the last seek
+        self._replay_pos = None
+        self._replay_resume_live = False
+
         self._log("CppHandler2: Execution Manager ready.", "BOOT")
 
     def _log(self, message, level="SYSTEM"):
@@ -947,27 +1316,263 @@ class CppHandler2(QObject):
         self.worker.active_engines = engines_list
         self._log(f"Monitoring active for: {', '.join(engines_list)}", "INFO")
 
+    def _start_sampler(self, interval_ms):
+        targets = self.worker.sampler_targets()
+        if not targets:
+            return
+        status = self.bridge1.invoke_method("sampler", "shm_status", self.worker.shm_name)
+        if isinstance(status, dict) and status.get("alive") and status.get("writer_pid") != os.getpid():
+            # A headless collector already samples this machine; read its segment instead.
+            self._log(f"Headless collector found on {self.worker.shm_name} (pid {status.get('writer_pid')}); local sampler idle.", "INFO")
+            return
+        self.bridge1.invoke_method("sampler", "start", targets, int(interval_ms))
+        self.worker._sampler_engines = tuple(targets)
+        if "pressure" in targets:
+            self.bridge1.arm_pressure_triggers()
+        self._log(f"Native sampler thread running for: {', '.join(targets)}", "INFO")
+
+    IDLE_FACTOR = 4
+    IDLE_MAX_INTERVAL_MS = 5000
+
+    def _timer_interval(self):
+        if not self.idle:
+            return self.interval_ms
+        return max(self.interval_ms, min(self.interval_ms * self.IDLE_FACTOR, self.IDLE_MAX_INTERVAL_MS))
+
+    def set_idle(self, idle):
+        """Okno ukryte/zminimalizowane: rzadsze odświeżanie i wolniejszy sampler."""
+        idle = bool(idle)
+        if idle == self.idle:
+            return
+        self.idle = idle
+        if "sampler" in self.worker.active_engines:
+            self.bridge1.invoke_method("sampler", "set_idle", idle)
+        if self.refresh_timer.isActive():
+            self.refresh_timer.start(self._timer_interval())
+        state = "on" if idle else "off"
+        self._log(f"Idle backoff {state} [{self._timer_interval()}ms]", "INFO")
+
     def start(self, interval_ms=1000):
         """Uruchamia pętlę monitoringu."""
+        if self._replay is not None:
+            # Odtwarzanie trwa: pętla ruszy po stop_replay() z nowym interwałem.
+            self.interval_ms = int(interval_ms)
+            self._replay_resume_live = True
+            return
         if not self.worker.active_engines:
             self._log("No linked engines: running Python fallback collectors.", "WARN")
 
+        self.interval_ms = int(interval_ms)
+        self._start_sampler(interval_ms)
+        if "sampler" in self.worker.active_engines:
+            self.bridge1.invoke_method("sampler", "set_idle", self.idle)
         self.worker.is_active = True
-        self.refresh_timer.start(interval_ms)
+        # Po odtwarzaniu UI ma stan z nagrania: pierwsza klatka na żywo idzie w całości.
+        self.worker.frame_delta.reset()
+        self.refresh_timer.start(self._timer_interval())
         self._log(f"Real-time data stream started [{interval_ms}ms]", "SUCCESS")
 
     def stop(self):
         """Zatrzymuje pętlę."""
         self.worker.is_active = False
         self.refresh_timer.stop()
+        if "sampler" in self.worker.active_engines:
+            self.bridge1.invoke_method("sampler", "stop")
+        if self.worker.recorder is not None:
+            try:
+                self.worker.recorder.flush()
+            except Exception as e:
+                self._log(f"Recorder flush: {e}", "WARN")
         self._log("Data stream paused.", "WARN")
 
     def set_speed(self, interval_ms):
         """Dynamiczna zmiana prędkości odświeżania (np. z ustawień UI)."""
         if self.refresh_timer.isActive():
-            self.refresh_timer.start(interval_ms)
+            self.interval_ms = int(interval_ms)
+            if "sampler" in self.worker.active_engines:
+                self.bridge1.invoke_method("sampler", "set_interval", int(interval_ms))
+            self.refresh_timer.start(self._timer_interval())
             self._log(f"Update interval changed to {interval_ms}ms", "INFO")
 
+    def overhead_report(self):
+        """Koszt własny monitora: opóźnienia silników, odczyty plików, RSS i CPU."""
+        return self.worker.overhead.report()
+
     def bind_to_dashboard(self, callback_function):
         """Łączy sygnał danych bezpośrednio z funkcją update_widgets w UI."""
         self.worker.data_ready.connect(callback_function)
+        self.worker.frame_delta.reset()
+
+    def _recorder_module(self):
+        module = self.bridge1.loaded_engines.get("recorder")
+        if module is None and self.bridge1.link_engine("recorder"):
+            module = self.bridge1.loaded_engines.get("recorder")
+        if module is None:
+            self._log("Recorder unavailable: core/engines/recorder.so not built.", "WARN")
+        return module
+
+    def start_recording(self, directory=None, max_total_mb=512, decimals=3):
+        """
+        Nagrywa każdą klatkę collected_data (rotowane segmenty, najstarsze usuwane ponad max_total_mb).
+        decimals: floaty zaokrąglane do tylu miejsc (-1: bez strat, ~2x większe pliki).
+        """
+        module = self._recorder_module()
+        if module is None:
+            return False
+        directory = directory or self.RECORDINGS_DIR
+        max_total_mb = max(8, int(max_total_mb))
+        try:
+            recorder = module.Recorder(
+                directory,
+                max_file_mb=max_total_mb / self.RECORD_SEGMENTS,
+                max_files=self.RECORD_SEGMENTS,
+                max_total_mb=max_total_mb,
+                decimals=int(decimals),
+            )
+        except Exception as e:
+            self._log(f"Recorder: {e}", "ERROR")
+            return False
+        self.stop_recording()
+        self.worker.recorder = recorder
+        self._log(f"Recording metrics to {directory} (max {max_total_mb} MB).", "INFO")
+        return True
+
+    def stop_recording(self):
+        """Zapisuje otwarty chunk i zamyka segment."""
+        recorder, self.worker.recorder = self.worker.recorder, None
+        if recorder is None:
+            return
+        try:
+            recorder.close()
+        except Exception as e:
+            self._log(f"Recorder close: {e}", "WARN")
+            return
+        self._log("Recording stopped.", "INFO")
+
+    def recording_status(self):
+        recorder = self.worker.recorder
+        return recorder.stats() if recorder is not None else None
+
+    def start_remote(self, port=9470, address="127.0.0.1", token=""):
+        """
+        Tryb zdalny: przyjmuje strumienie kolektorów (main.py --headless --stream-to host:port) na jednym
+        wątku epoll modułu remote; ich podsumowania idą do UI w klatkach jako "nodes". Zwraca port, 0 przy błędzie.
+        """
+        module = self.bridge1.loaded_engines.get("remote")
+        if module is None and self.bridge1.link_engine("remote"):
+            module = self.bridge1.loaded_engines.get("remote")
+        if module is None:
+            self._log("Remote mode unavailable: core/engines/remote.so not built.", "WARN")
+            return 0
+        try:
+            bound = int(module.listen(int(port), str(address), str(token or "")))
+        except Exception as e:
+            self._log(f"Remote mode: {e}", "ERROR")
+            return 0
+        self.worker.remote = module
+        self.worker.frame_delta.reset()
+        self._log(f"Remote mode: accepting collectors on {address}:{bound}.", "INFO")
+        return bound
+
+    def stop_remote(self):
+        """Zamyka strumienie; karty węzłów znikają przy następnej pełnej klatce."""
+        module, self.worker.remote = self.worker.remote, None
+        if module is None:
+            return
+        module.stop()
+        self.worker.frame_delta.reset()
+        self._log("Remote mode stopped.", "INFO")
+
+    def remote_status(self):
+        module = self.worker.remote
+        if module is None:
+            return None
+        status = module.status()
+        status["nodes_list"] = module.nodes()
+        return status
+
+    def start_replay(self, path, speed=1.0, start_ts=None):
+        """
+        Odtwarza nagranie (plik .lxrec lub katalog) przez data_ready, czyli do tych samych callbacków
+        co bind_to_dashboard. Czas płynie speed razy szybciej; przy dużych prędkościach klatki pomiędzy
+        tickami timera są pomijane. Pętla na żywo stoi do stop_replay().
+        """
+        module = self._recorder_module()
+        if module is None:
+            return False
+        try:
+            replay = module.Replay(path)
+            if start_ts is not None:
+                replay.seek(float(start_ts))
+        except Exception as e:
+            self._log(f"Replay: {e}", "ERROR")
+            return False
+        first = replay.peek()
+        if first is None:
+            self._log(f"Replay: nothing recorded after the requested time in {path}.", "WARN")
+            return False
+
+        resume_live = self.refresh_timer.isActive() or self._replay_resume_live
+        self.stop_replay(resume=False)
+        if self.refresh_timer.isActive():
+            self.stop()
+        self._replay = replay
+        self._replay_path = path
+        self._replay_speed = max(0.01, float(speed))
+        self._replay_resume_live = resume_live
+        self._replay_origin = (time.monotonic(), first)
+        self._replay_pos = None
+        interval = int(self.interval_ms / self._replay_speed)
+        self.replay_timer.start(max(self.REPLAY_MIN_INTERVAL_MS, min(self.interval_ms, interval)))
+        span_h = (replay.span()[1] - first) / 3600.0
+        since = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(first))
+        self._log(f"Replaying {path}: {replay.ticks()} ticks, {span_h:.2f} h from {since} at {self._replay_speed:g}x.", "INFO")
+        return True
+
+    def seek_replay(self, ts):
+        """Przeskok odtwarzania do czasu ts (epoch s)."""
+        if self._replay is None:
+            return False
+        self._replay.seek(float(ts))
+        nxt = self._replay.peek()
+        if nxt is None:
+            self.stop_replay()
+            return False
+        self._replay_origin = (time.monotonic(), nxt)
+        return True
+
+    def stop_replay(self, resume=True):
+        """Kończy odtwarzanie; pętla na żywo wraca, jeśli działała przed start_replay()."""
+        self.replay_timer.stop()
+        if self._replay is None:
+            return
+        self._replay = None
+        self._log(f"Replay of {self._replay_path} stopped.", "INFO")
+        if resume and self._replay_resume_live:
+            self._replay_resume_live = False
+            self.start(self.interval_ms)
+
+    def replay_status(self):
+        if self._replay is None:
+            return None
+        first, last = self._replay.span()
+        return {"path": self._replay_path, "position": self._replay_pos, "first": first, "last": last, "speed": self._replay_speed}
+
+    def _replay_tick(self):
+        replay = self._replay
+        if replay is None:
+            return
+        started_mono, started_ts = self._replay_origin
+        target = started_ts + (time.monotonic() - started_mono) * self._replay_speed
+        try:
+            frame = replay.advance(target)
+        except Exception as e:
+            self._log(f"Replay: {e}", "ERROR")
+            self.stop_replay()
+            return
+        if frame is not None:
+            self._replay_pos, data = frame
+            self.worker.data_ready.emit(data)
+        if replay.peek() is None:
+            self._log("Replay reached the end of the recording.", "INFO")
+            self.stop_replay()
@@ -0,0 +1,154 @@
+"""
+Headless collector: runs the native sampler without PyQt6 and publishes every tick into a
+POSIX shared-memory segment, so the GUI, core/shm_reader.py and other agents read it instead of sampling.
+
+    python main.py --headless [--interval-ms 250] [--shm-name /lxmonitor] [--engines cpu,ram,...] [--no-build]
+                              [--stats-file overhead.json] [--metrics-port 9464] [--metrics-address 127.0.0.1]
+                              [--stream-to viewer:9470] [--node-name NAME] [--stream-token SECRET]
+
+With --stream-to every tick also goes to a GUI viewer in remote mode ("remote_listen_port" in its config)
+as a compact delta over TCP.
+"""
+
+import argparse
+import json
+import os
+import signal
+import threading
+
+from core.handlers.cpp_handler1 import CppHandler1
+from core.overhead import OverheadMonitor
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_SHM_NAME = "/lxmonitor"
+DEFAULT_STREAM_PORT = 9470
+
+
+def _log(message, level="SYSTEM"):
+    print(f"[{level}] {message}", flush=True)
+
+
+def _load_config():
+    try:
+        with open(os.path.join(PROJECT_DIR, "config.json"), "r", encoding="utf-8") as f:
+            data = json.load(f)
+        return data if isinstance(data, dict) else {}
+    except Exception:
+        return {}
+
+
+def _split_target(target):
+    """host:port, [v6]:port or a bare host (default port) -> (host, port)."""
+    target = target.strip()
+    if target.startswith("["):
+        host, _, rest = target[1:].partition("]")
+        return host, int(rest[1:]) if rest.startswith(":") else DEFAULT_STREAM_PORT
+    if target.count(":") == 1:
+        host, port = target.split(":")
+        return host, int(port)
+    return target, DEFAULT_STREAM_PORT
+
+
+def _build_engines():
+    engines_src = os.path.join(PROJECT_DIR, "core", "engines")
+    try:
+        from lxbinman import builder as binman_builder
+
+        result = binman_builder.build_all(
+            source_dir=engines_src,
+            output_dir=engines_src,
+            compile_only=True,
+            policy="prefer_cache",
+            profile="auto",
+        )
+        ready = len(result) if isinstance(result, dict) else 0
+        _log(f"Engine build: {ready} engines ready", "BOOT")
+    except Exception as e:
+        _log(f"Builder Error: {e}", "WARN")
+
+
+def main(argv=None):
+    cfg = _load_config()
+    parser = argparse.ArgumentParser(prog="main.py --headless", description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--headless", action="store_true", help=argparse.SUPPRESS)
+    parser.add_argument("--interval-ms", type=int, default=int(cfg.get("poll_interval_ms", 250) or 250))
+    parser.add_argument("--shm-name", default=str(cfg.get("shm_name") or DEFAULT_SHM_NAME))
+    parser.add_argument("--engines", default="", help="comma-separated subset (default: auto-discovery)")
+    parser.add_argument("--no-build", action="store_true", help="use the existing core/engines/*.so")
+    parser.add_argument("--stats-file", default="", help="rewrite this JSON overhead report every minute")
+    parser.add_argument("--metrics-port", type=int, default=int(cfg.get("metrics_port", 0) or 0),
+                        help="serve OpenMetrics on this port (0: off)")
+    parser.add_argument("--metrics-address", default=str(cfg.get("metrics_address") or "127.0.0.1"))
+    parser.add_argument("--stream-to", default=str(cfg.get("stream_to") or ""),
+                        help="stream every tick to a remote-mode viewer at host[:port]")
+    parser.add_argument("--node-name", default=str(cfg.get("node_name") or ""), help="default: hostname")
+    parser.add_argument("--stream-token", default=str(cfg.get("stream_token") or ""))
+    args = parser.parse_args(argv)
+
+    stream_target = None
+    if args.stream_to:
+        try:
+            stream_target = _split_target(args.stream_to)
+        except ValueError:
+            parser.error(f"--stream-to: expected host:port, got {args.stream_to!r}")
+
+    if not args.no_build:
+        _build_engines()
+
+    # Only the sampler module is linked: it owns its own engine instances.
+    h1 = CppHandler1()
+    discovered = h1.auto_discover_hardware()
+    if "sampler" not in discovered or not h1.link_engine("sampler"):
+        _log("Headless mode needs the native sampler (core/engines/sampler.so).", "ERROR")
+        return 1
+    sampler = h1.loaded_engines["sampler"]
+
+    supported = set(sampler.supported_engines())
+    wanted = [e.strip() for e in args.engines.split(",") if e.strip()] or discovered
+    engines = [e for e in wanted if e in supported]
+    if not engines:
+        _log("No engines to sample.", "ERROR")
+        return 1
+
+    try:
+        sampler.shm_publish(args.shm_name)
+    except RuntimeError as e:
+        _log(f"Shared memory: {e}", "ERROR")
+        return 1
+
+    stop = threading.Event()
+    for sig in (signal.SIGINT, signal.SIGTERM):
+        signal.signal(sig, lambda *_: stop.set())
+
+    interval_ms = max(20, int(args.interval_ms))
+    sampler.start(engines, interval_ms)
+    if "pressure" in engines:
+        h1.arm_pressure_triggers()
+    if args.metrics_port > 0:
+        h1.serve_metrics(args.metrics_port, args.metrics_address)
+    if stream_target is not None:
+        h1.stream_to(stream_target[0], stream_target[1], args.node_name, args.stream_token)
+    _log(f"Headless collector: {', '.join(engines)} every {interval_ms}ms -> /dev/shm{args.shm_name}", "SUCCESS")
+    overhead = OverheadMonitor(sampler)
+    overhead.report()  # opens the CPU window of the first report
+    try:
+        while not stop.wait(60.0):
+            snap = sampler.get_snapshot()
+            report = overhead.report()
+            _log(
+                f"gen {snap.get('generation', 0)} tick {float(snap.get('tick_ms', 0.0)):.2f}ms "
+                f"cpu {float(report['self'].get('window_cpu_pct', 0.0)):.3f}%",
+                "INFO",
+            )
+            if args.stats_file:
+                try:
+                    overhead.write_dump(report, args.stats_file)
+                except OSError as e:
+                    _log(f"Stats file: {e}", "WARN")
+    finally:
+        h1.stop_metrics()
+        h1.stop_stream()
+        sampler.stop()
+        sampler.shm_unpublish()
+        _log("Headless collector stopped.", "INFO")
+    return 0
@@ -0,0 +1,169 @@
+"""
+Self-overhead report: what LxMonitor itself costs per engine and in total.
+
+Native numbers come from the sampler module (steady_clock timing into log-linear histograms,
+core/engines/common/engine_stats.h): every sampler engine, whole ticks ("tick", with syscalls and
+thread CPU time) and engine calls made from Python ("py:<engine>"). Without the sampler module
+the Python-side calls are still aggregated here (count/mean/max only).
+"""
+
+import json
+import os
+import time
+
+CPU_BUDGET_PCT = 0.5
+
+
+def _read_rss_bytes():
+    try:
+        with open("/proc/self/statm", "r", encoding="utf-8") as f:
+            return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except Exception:
+        return 0
+
+
+class OverheadMonitor:
+    """Collects engine timings of one frame and builds the report shown by the F12 'stats' command."""
+
+    def __init__(self, native=None):
+        # Sampler module (or None); timings are forwarded to its histograms once per frame.
+        self.native = native
+        self._pending = []
+        self._py = {}
+        self._py_started = time.monotonic()
+        self._prev_self = None
+
+    def record(self, name, ns, ok=True):
+        self._pending.append((name, int(ns), bool(ok)))
+
+    def flush(self):
+        if not self._pending:
+            return
+        items, self._pending = self._pending, []
+        if self.native is not None:
+            try:
+                self.native.stats_record_batch(items)
+                return
+            except Exception:
+                pass
+        for name, ns, ok in items:
+            entry = self._py.setdefault(name, [0, 0, 0, 0])
+            entry[0] += 1
+            entry[1] += ns
+            entry[2] = max(entry[2], ns)
+            if not ok:
+                entry[3] += 1
+
+    def reset(self):
+        self._pending = []
+        self._py = {}
+        self._py_started = time.monotonic()
+        if self.native is not None:
+            try:
+                self.native.stats_reset()
+            except Exception:
+                pass
+
+    def _python_engines(self):
+        out = {}
+        for name, (count, total_ns, max_ns, failures) in self._py.items():
+            out[name] = {
+                "count": count,
+                "failures": failures,
+                "mean_us": (total_ns / count) / 1e3 if count else 0.0,
+                "max_us": max_ns / 1e3,
+                "total_ms": total_ns / 1e6,
+            }
+        return out
+
+    def _self_usage(self):
+        if self.native is not None:
+            try:
+                return dict(self.native.self_usage())
+            except Exception:
+                pass
+        t = os.times()
+        now = time.monotonic()
+        cpu_s = t.user + t.system
+        out = {"rss_bytes": _read_rss_bytes(), "cpu_s": cpu_s, "window_s": 0.0, "window_cpu_pct": 0.0}
+        if self._prev_self is not None:
+            prev_cpu, prev_wall = self._prev_self
+            out["window_s"] = now - prev_wall
+            if out["window_s"] > 0:
+                out["window_cpu_pct"] = 100.0 * (cpu_s - prev_cpu) / out["window_s"]
+        self._prev_self = (cpu_s, now)
+        return out
+
+    def report(self):
+        self.flush()
+        source = "python"
+        engines = {}
+        elapsed_s = time.monotonic() - self._py_started
+        if self.native is not None:
+            try:
+                stats = self.native.engine_stats()
+                engines = dict(stats.get("engines") or {})
+                elapsed_s = float(stats.get("elapsed_s") or elapsed_s)
+                source = "native"
+            except Exception:
+                engines = {}
+        if source == "python":
+            engines = self._python_engines()
+
+        # Collection cost: sampler thread CPU plus the wall time of engine calls made from Python
+        # (an upper bound for their CPU time). UI painting is only in the process-wide figure.
+        collect_ms = float((engines.get("tick") or {}).get("cpu_ms", 0.0))
+        collect_ms += sum(float(v.get("total_ms", 0.0)) for k, v in engines.items() if k.startswith("py:") and k != "py:frame")
+        collect_pct = (collect_ms / 10.0) / elapsed_s if elapsed_s > 0 else 0.0
+
+        return {
+            "timestamp": time.time(),
+            "source": source,
+            "elapsed_s": elapsed_s,
+            "engines": engines,
+            "self": self._self_usage(),
+            "collect_cpu_pct": collect_pct,
+            "budget_pct": CPU_BUDGET_PCT,
+            "within_budget": collect_pct <= CPU_BUDGET_PCT,
+        }
+
+    @staticmethod
+    def format(report):
+        """Plain-text table for the F12 console."""
+        me = report.get("self") or {}
+        lines = [
+            f"Overhead ({report.get('source')}, {float(report.get('elapsed_s', 0.0)):.0f} s): "
+            f"collect {float(report.get('collect_cpu_pct', 0.0)):.3f}% of a core "
+            f"[budget {report.get('budget_pct')}%: {'OK' if report.get('within_budget') else 'OVER'}]",
+            f"Process: RSS {float(me.get('rss_bytes', 0)) / 1048576.0:.1f} MiB | CPU {float(me.get('cpu_s', 0.0)):.2f} s | "
+            f"{float(me.get('window_cpu_pct', 0.0)):.2f}% of a core over the last {float(me.get('window_s', 0.0)):.1f} s",
+        ]
+        engines = report.get("engines") or {}
+        tick = engines.get("tick")
+        if tick:
+            lines.append(
+                f"Sampler tick: p50 {float(tick.get('p50_us', 0.0)):.0f} us, p99 {float(tick.get('p99_us', 0.0)):.0f} us, "
+                f"{float(tick.get('syscalls_per_call', 0.0)):.1f} syscalls, {float(tick.get('reads_per_call', 0.0)):.1f} file reads per tick"
+            )
+        lines.append(f"{'engine':<16}{'calls':>8}{'p50 us':>10}{'p99 us':>10}{'max us':>10}{'reads':>8}{'fail':>6}")
+        for name in sorted(engines):
+            if name == "tick":
+                continue
+            e = engines[name]
+            p50 = e.get("p50_us", e.get("mean_us", 0.0))
+            p99 = e.get("p99_us")
+            reads = e.get("reads_per_call")
+            lines.append(
+                f"{name:<16}{int(e.get('count', 0)):>8}{float(p50):>10.1f}"
+                f"{(f'{float(p99):.1f}' if p99 is not None else '-'):>10}{float(e.get('max_us', 0.0)):>10.1f}"
+                f"{(f'{float(reads):.1f}' if reads is not None else '-'):>8}{int(e.get('failures', 0)):>6}"
+            )
+        return "\n".join(lines)
+
+    @staticmethod
+    def write_dump(report, path):
+        tmp = f"{path}.tmp"
+        with open(tmp, "w", encoding="utf-8") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+        os.replace(tmp, path)
+        return path
@@ -0,0 +1,192 @@
+"""
+Reader for the shared-memory segment published by the native sampler (layout: core/engines/common/shm_segment.h).
+
+Uses only the standard library, so agents and scripts can attach without PyQt6 or the C++ modules:
+
+    python -m core.shm_reader [--name /lxmonitor] [--watch SECONDS] [--json]
+"""
+
+import argparse
+import fcntl
+import json
+import mmap
+import os
+import struct
+import sys
+import time
+
+SHM_DIR = "/dev/shm"
+DEFAULT_NAME = "/lxmonitor"
+MAGIC = b"LXMONSHM"
+VERSION = 1
+HEADER_SIZE = 128
+FLAG_TRUNCATED = 1
+
+_HEADER = struct.Struct("<8sIIQQiIQddIIQ")
+_SEQ = struct.Struct("<Q")
+_SEQ_OFFSET = 24
+_ENTRY = struct.Struct("<IIII")
+
+
+def _align8(n):
+    return (n + 7) & ~7
+
+
+class ShmSnapshotReader:
+    """Attaches to one segment; read() returns a consistent copy of the latest tick or None."""
+
+    def __init__(self, name=DEFAULT_NAME):
+        self.name = name
+        self.path = os.path.join(SHM_DIR, name.lstrip("/"))
+        self._fd = None
+        self._map = None
+        self._inode = None
+
+    def open(self):
+        self.close()
+        try:
+            fd = os.open(self.path, os.O_RDONLY | os.O_CLOEXEC)
+        except OSError:
+            return False
+        try:
+            st = os.fstat(fd)
+            if st.st_size < HEADER_SIZE:
+                raise OSError("segment too small")
+            mapped = mmap.mmap(fd, st.st_size, mmap.MAP_SHARED, mmap.PROT_READ)
+        except (OSError, ValueError):
+            os.close(fd)
+            return False
+        magic, version, header_size = struct.unpack_from("<8sII", mapped, 0)
+        if magic != MAGIC or version != VERSION or header_size != HEADER_SIZE:
+            mapped.close()
+            os.close(fd)
+            return False
+        self._fd = fd
+        self._map = mapped
+        self._inode = st.st_ino
+        return True
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+            self._map = None
+        if self._fd is not None:
+            os.close(self._fd)
+            self._fd = None
+
+    def writer_alive(self):
+        """The writer holds an exclusive flock for its whole life."""
+        if self._fd is None:
+            return False
+        try:
+            fcntl.flock(self._fd, fcntl.LOCK_SH | fcntl.LOCK_NB)
+        except BlockingIOError:
+            return True
+        fcntl.flock(self._fd, fcntl.LOCK_UN)
+        return False
+
+    def _ensure_open(self):
+        if self._map is not None and self.writer_alive():
+            return True
+        # Writer gone or restarted (new inode): remap.
+        try:
+            inode = os.stat(self.path).st_ino
+        except OSError:
+            self.close()
+            return False
+        if self._map is None or inode != self._inode:
+            if not self.open():
+                return False
+        return self.writer_alive()
+
+    def read(self, attempts=64):
+        if not self._ensure_open():
+            return None
+        mapped = self._map
+        for _ in range(attempts):
+            (seq1,) = _SEQ.unpack_from(mapped, _SEQ_OFFSET)
+            if seq1 & 1:
+                time.sleep(0)
+                continue
+            header = _HEADER.unpack_from(mapped, 0)
+            payload_size = min(int(header[12]), len(mapped) - HEADER_SIZE)
+            payload = mapped[HEADER_SIZE : HEADER_SIZE + payload_size]
+            (seq2,) = _SEQ.unpack_from(mapped, _SEQ_OFFSET)
+            if seq1 == seq2:
+                return self._decode(header, payload)
+        return None
+
+    @staticmethod
+    def _decode(header, payload):
+        _, _, _, _, _, writer_pid, flags, generation, timestamp, tick_ms, sampled, entry_count, _ = header
+        entries = {}
+        pos = 0
+        for _ in range(entry_count):
+            if pos + _ENTRY.size > len(payload):
+                break
+            key_len, text_len, count, _ = _ENTRY.unpack_from(payload, pos)
+            strings = _align8(key_len + text_len)
+            start = pos + _ENTRY.size
+            end = start + strings + count * 8
+            if end > len(payload):
+                break
+            key = payload[start : start + key_len].decode("utf-8", "replace")
+            text = payload[start + key_len : start + key_len + text_len].decode("utf-8", "replace")
+            values = struct.unpack_from(f"<{count}d", payload, start + strings)
+            entries[key] = (values, text)
+            pos = end
+        return {
+            "writer_pid": writer_pid,
+            "generation": generation,
+            "timestamp": timestamp,
+            "tick_ms": tick_ms,
+            "sampled": sampled,
+            "truncated": bool(flags & FLAG_TRUNCATED),
+            "entries": entries,
+        }
+
+
+def _format_entry(values, text):
+    shown = ", ".join(f"{v:.2f}" for v in values[:16])
+    if len(values) > 16:
+        shown += f", ... ({len(values)} values)"
+    return f"[{shown}]" + (f"  {text}" if text else "")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Print snapshots from the LxMonitor shared-memory segment.")
+    parser.add_argument("--name", default=DEFAULT_NAME)
+    parser.add_argument("--watch", type=float, default=0.0, help="repeat every N seconds")
+    parser.add_argument("--json", action="store_true")
+    args = parser.parse_args(argv)
+
+    reader = ShmSnapshotReader(args.name)
+    last_generation = None
+    try:
+        while True:
+            snap = reader.read()
+            if snap is None:
+                print(f"No live writer on {reader.path}", file=sys.stderr)
+                if not args.watch:
+                    return 1
+            elif snap["generation"] != last_generation:
+                last_generation = snap["generation"]
+                if args.json:
+                    print(json.dumps(snap), flush=True)
+                else:
+                    age = time.time() - snap["timestamp"]
+                    print(f"# gen {snap['generation']} pid {snap['writer_pid']} age {age:.2f}s tick {snap['tick_ms']:.2f}ms")
+                    for key in sorted(snap["entries"]):
+                        print(f"{key:32s} {_format_entry(*snap['entries'][key])}")
+                    print(flush=True)
+            if not args.watch:
+                return 0
+            time.sleep(args.watch)
+    except KeyboardInterrupt:
+        return 0
+    finally:
+        reader.close()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
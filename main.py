@@ -12,12 +12,27 @@ lxbinman_local = os.path.join(current_dir, "LxBinMan")
 if os.path.isdir(lxbinman_local) and lxbinman_local not in sys.path:
     sys.path.insert(0, lxbinman_local)
 
+# Headless collector: engines + shared-memory publisher, PyQt6 is never imported.
+if __name__ == "__main__" and "--headless" in sys.argv[1:]:
+    from core.headless import main as headless_main
+
+    sys.exit(headless_main(sys.argv[1:]))
+
 # 2. Szybkie importy do Splasha
 from PyQt6.QtWidgets import QApplication, QWidget, QVBoxLayout, QLabel
 from PyQt6.QtGui import QFontMetrics, QIcon, QPixmap
 from PyQt6.QtCore import Qt, QPropertyAnimation
 
 
+def argv_value(flag, default=None):
+    """Value after flag in sys.argv ('--replay PATH'), or default."""
+    args = sys.argv[1:]
+    if flag in args:
+        i = args.index(flag)
+        if i + 1 < len(args):
+            return args[i + 1]
+    return default
+
 def load_startup_config():
     cfg_path = os.path.join(current_dir, "config.json")
     try:
@@ -225,6 +240,7 @@ def main():
                     output_dir=engines_src,
                     compile_only=True,
                     policy="prefer_cache",
+                    profile="auto",
                 )
                 source_names = {
                     os.path.splitext(os.path.basename(p))[0]
@@ -283,6 +299,18 @@ def main():
                 app.processEvents()
                 time.sleep(0.02)
 
+        app.aboutToQuit.connect(window.h2.stop_recording)
+        app.aboutToQuit.connect(window.h1.stop_metrics)
+        app.aboutToQuit.connect(window.h2.stop_remote)
+        # --replay PATH [--replay-speed N]: nagranie (assets/logs/recordings) zamiast danych na żywo.
+        replay_path = argv_value("--replay")
+        if replay_path:
+            try:
+                replay_speed = float(argv_value("--replay-speed", "1") or 1)
+            except ValueError:
+                replay_speed = 1.0
+            window.h2.start_replay(replay_path, replay_speed)
+
         log_boot("System Ready.")
         window.show()
         
@@ -113,6 +113,9 @@ class LxMainWindow(
             "sys_processes_total": None,
             "sys_procs_running": None,
             "sys_procs_blocked": None,
+            "proc_top": None,
+            "cgroup_top": None,
+            "pressure_all": None,
             "sys_uptime_s": None,
             "sys_load_1m": None,
             "sys_load_5m": None,
@@ -144,6 +147,18 @@ class LxMainWindow(
         self.theme_manager.apply_theme(self.theme_preference)
         self.apply_theme_overrides()
         self.h2.start(self.poll_interval_ms)
+        if bool(self.user_config.get("record_enabled", False)):
+            self.h2.start_recording(max_total_mb=int(self.user_config.get("record_max_mb", 512) or 512))
+        metrics_port = int(self.user_config.get("metrics_port", 0) or 0)
+        if metrics_port > 0:
+            self.h1.serve_metrics(metrics_port, str(self.user_config.get("metrics_address") or "127.0.0.1"))
+        remote_port = int(self.user_config.get("remote_listen_port", 0) or 0)
+        if remote_port > 0:
+            self.h2.start_remote(
+                remote_port,
+                str(self.user_config.get("remote_listen_address") or "127.0.0.1"),
+                str(self.user_config.get("remote_token") or ""),
+            )
         self.console_logic.log(
             f"Power mode '{self.power_mode_preference}' resolved to '{self.get_power_mode_resolved()}'.",
             "INFO",
@@ -35,9 +35,9 @@ class GraphWidget(QWidget):
         self.blocked_message = "Blocked: no permissions"
 
     def add_value(self, value):
-        """Dodaje nową wartość i przesuwa wykres."""
+        """Dodaje nową wartość i przesuwa wykres. False, gdy obraz się nie zmienił (bez odmalowania)."""
         if self.blocked:
-            return
+            return False
         raw = float(value)
         if self.peak_window > 1:
             self.recent_raw.append(raw)
@@ -46,9 +46,36 @@ class GraphWidget(QWidget):
             plotted = max(self.recent_raw)
         else:
             plotted = raw
-        self.data.append(plotted)
-        if len(self.data) > self.max_points:
-            self.data.pop(0)
+        # Płaska linia na całym oknie (bezczynny interfejs/dysk) po przesunięciu wygląda tak samo.
+        data = self.data
+        unchanged = (
+            len(data) >= self.max_points
+            and data[-1] == plotted
+            and data[0] == plotted
+            and min(data) == max(data)
+        )
+        data.append(plotted)
+        if len(data) > self.max_points:
+            data.pop(0)
+        if unchanged:
+            return False
+        self.update()
+        return True
+
+    def set_history(self, values):
+        """Replaces the plot with a window of past samples (e.g. a native HistoryWindow), oldest first."""
+        raw = []
+        for val in values:
+            val = float(val)
+            raw.append(val if val == val else 0.0)  # NaN = bucket without samples
+        raw = raw[-(self.max_points + self.peak_window - 1):]
+        plotted = []
+        for idx in range(len(raw)):
+            # Same peak-hold as add_value(), applied over the history.
+            plotted.append(max(raw[max(0, idx - self.peak_window + 1) : idx + 1]))
+        plotted = plotted[-self.max_points :]
+        self.data = [0.0] * (self.max_points - len(plotted)) + plotted
+        self.recent_raw = raw[-self.peak_window :] if self.peak_window > 1 else []
         self.update()
 
     def set_blocked(self, blocked, message=None):
@@ -4,11 +4,20 @@ import os
 
 class EnginePrivilegedMixin:
     def _is_any_readable(self, paths):
+        granted = self._granted_paths()
         for p in paths:
+            if p in granted:
+                return True
             if os.path.exists(p) and os.access(p, os.R_OK):
                 return True
         return False
 
+    def _granted_paths(self):
+        if "privilege" not in self.h1.loaded_engines:
+            return set()
+        fds = self.h1.invoke_method("privilege", "granted_fds")
+        return set(fds) if isinstance(fds, dict) else set()
+
     def _is_cpu_temp_readable(self):
         candidates = []
         # hwmon
@@ -68,8 +77,22 @@ class EnginePrivilegedMixin:
         ok = bool(res.get("ok"))
         if not ok:
             self.console_logic.log(f"Privileged setup warning: {res.get('error', '')}", "WARN")
+        elif res.get("opened") or res.get("granted"):
+            self.console_logic.log(
+                f"Privileged helper: {res.get('opened', 0)} file(s) opened, {res.get('granted', 0)} device node(s) granted",
+                "INFO",
+            )
         return ok
 
+    def _share_granted_fds(self):
+        # Deskryptory otwarte przez helpera trafiają do każdego silnika, który czyta chronione pliki.
+        fds = self.h1.invoke_method("privilege", "granted_fds") if "privilege" in self.h1.loaded_engines else None
+        if not isinstance(fds, dict) or not fds:
+            return
+        for eng in ("sampler", "psu", "gpu_others", "gpu_temp", "sysinfo"):
+            if eng in self.h1.loaded_engines:
+                self.h1.invoke_method(eng, "adopt_fds", fds)
+
     def get_unlock_status_text(self):
         tr = self.lang_handler.tr
         if getattr(self, "_auth_verified_this_session", False):
@@ -155,7 +178,7 @@ class EnginePrivilegedMixin:
                 msg = self.lang_handler.tr("unlock_tty_required")
             elif "command not found" in err_l or "no such file" in err_l or "brak narzędzia" in err_l:
                 msg = self.lang_handler.tr("unlock_no_priv_tool")
-            elif "authentication failed" in err_l or "wrong password" in err_l:
+            elif "authentication failed" in err_l or "wrong password" in err_l or "incorrect password" in err_l:
                 msg = self.lang_handler.tr("unlock_wrong_password")
             elif "cancelled" in err_l or "anulowano" in err_l:
                 msg = self.lang_handler.tr("unlock_auth_cancelled")
@@ -170,9 +193,13 @@ class EnginePrivilegedMixin:
             self._auth_verified_this_session = True
         self.console_logic.log(self.lang_handler.tr("unlock_password_ok_configuring"), "INFO")
         self._prepare_system_access(password)
-
         gpu_ok = self._try_activate_metric_engine("gpu")
         gpu_temp_ok = self._try_activate_metric_engine("gpu_temp")
+        self._share_granted_fds()
+        # Sensor indexes were built with the old permissions; blocked sources may be readable now.
+        for eng in ("psu", "sampler", "gpu_others", "gpu_temp", "sysinfo"):
+            if eng in self.h1.loaded_engines:
+                self.h1.invoke_method(eng, "rescan")
 
         self.metric_locks["gpu"] = not gpu_ok
         self.metric_locks["cpu_temp"] = not self._is_cpu_temp_readable()
@@ -261,4 +288,7 @@ class EnginePrivilegedMixin:
                 parts["value"].setText(blocked_msg)
             elif not parts.get("seen", False):
                 parts["value"].setText(na_msg)
+            else:
+                # update_widgets writes the text only when the value changes; restore the last one.
+                parts["value"].setText(self._format_value(parts["last"], parts["unit"]))
         self.primary_graph.set_blocked(self._metric_locked(self.selected_metric), blocked_msg)
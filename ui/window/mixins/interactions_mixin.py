@@ -4,7 +4,7 @@ import json
 import os
 import platform
 
-from PyQt6.QtCore import Qt
+from PyQt6.QtCore import QEvent, Qt
 from PyQt6.QtWidgets import QApplication, QFileDialog, QMainWindow
 
 from ui.about import AboutDialog
@@ -52,6 +52,33 @@ class InteractionsMixin:
         except AttributeError:
             QMainWindow.keyPressEvent(self, event)
 
+    def _update_sampling_idle(self):
+        # Nothing on screen to refresh: let the engines back off until the window is visible again.
+        if hasattr(self, "h2") and self.h2:
+            self.h2.set_idle(not self.isVisible() or self.isMinimized())
+
+    def changeEvent(self, event):
+        if event.type() == QEvent.Type.WindowStateChange:
+            self._update_sampling_idle()
+        try:
+            super().changeEvent(event)
+        except AttributeError:
+            QMainWindow.changeEvent(self, event)
+
+    def hideEvent(self, event):
+        self._update_sampling_idle()
+        try:
+            super().hideEvent(event)
+        except AttributeError:
+            QMainWindow.hideEvent(self, event)
+
+    def showEvent(self, event):
+        self._update_sampling_idle()
+        try:
+            super().showEvent(event)
+        except AttributeError:
+            QMainWindow.showEvent(self, event)
+
     def set_language(self, lang_code):
         if not self.lang_handler.set_language(lang_code):
             return
@@ -111,6 +111,8 @@ class MetricsMixin:
             return tr("graph_net_iface")
         if metric_name.startswith("bt:"):
             return tr("graph_bt_iface")
+        if metric_name.startswith("node:"):
+            return tr("graph_node_cpu")
         return metric_name
 
     def _metric_card_subtitle(self, metric_name):
@@ -167,8 +169,20 @@ class MetricsMixin:
                         return f"{bt_name} ({addr})"
                     return f"{bt_name} ({adapter})"
             return adapter
+        if metric_name.startswith("node:"):
+            name = metric_name.split(":", 1)[1]
+            node = getattr(self, "remote_nodes", {}).get(name)
+            return f"{name} · {self._node_state_text(node)}" if node else name
         return self._metric_device_info(metric_name)
 
+    def _node_state_text(self, node):
+        tr = self.lang_handler.tr
+        if not node.get("online"):
+            return tr("node_state_offline")
+        if node.get("stale"):
+            return tr("node_state_stale")
+        return tr("node_state_online")
+
     def _net_iface_kind(self, iface):
         tr = self.lang_handler.tr
         wireless_path = f"/sys/class/net/{iface}/wireless"
@@ -203,6 +217,8 @@ class MetricsMixin:
             return "#c99dff"
         if metric_name.startswith("bt:"):
             return "#7cc4ff"
+        if metric_name.startswith("node:"):
+            return "#6fd6c0"
         return "#4ec9b0"
 
     def _metric_locked(self, metric_name):
@@ -257,6 +273,10 @@ class MetricsMixin:
                 if bt_name:
                     return bt_name
             return adapter
+        if metric_name.startswith("node:"):
+            name = metric_name.split(":", 1)[1]
+            address = (getattr(self, "remote_nodes", {}).get(name) or {}).get("address")
+            return f"{name} ({address})" if address else name
         return "System"
 
     def _format_value(self, value, unit):
@@ -377,6 +397,26 @@ class MetricsMixin:
                     pass
         return "GPU"
 
+    def _native_history(self, metric_name, points, tier="raw"):
+        """Newest points of a metric from the native sampler's history store, or None."""
+        h1 = getattr(self, "h1", None)
+        if metric_name.startswith("node:"):
+            # Remote nodes keep their own per-node ring in the remote module.
+            remote = getattr(h1, "loaded_engines", {}).get("remote") if h1 is not None else None
+            if remote is None:
+                return None
+            try:
+                values = remote.history(metric_name.split(":", 1)[1], "cpu", int(points))["values"]
+            except Exception:
+                return None
+            return [float("nan") if v is None else v for v in values] or None
+        if h1 is None or "sampler" not in getattr(h1, "loaded_engines", {}):
+            return None
+        window = h1.invoke_method("sampler", "history_window", metric_name, tier, int(points))
+        if window is None or len(window) == 0:
+            return None
+        return window
+
     def _is_dynamic_metric(self, metric_name):
         return metric_name.startswith("disk:") or metric_name.startswith("net:") or metric_name.startswith("bt:")
 
@@ -408,21 +448,26 @@ class MetricsMixin:
         parts = self.metric_cards.get(metric_name)
         if not parts:
             return
+        value = float(value)
         now = time.time()
         self.metric_last_seen[metric_name] = now
         if self._is_value_active(metric_name, value):
             self.metric_last_active[metric_name] = now
-        parts["last"] = float(value)
-        parts["seen"] = True
-        self._set_card_subtitle(metric_name, self._metric_card_subtitle(metric_name))
-        parts["spark"].add_value(float(value))
-        parts["value"].setText(self._format_value(value, parts["unit"]))
-
-        if self.selected_metric == metric_name:
+        selected = self.selected_metric == metric_name
+        if parts["spark"].add_value(value) and selected:
             self.primary_graph.data = list(parts["spark"].data)
             self.primary_graph.recent_raw = list(parts["spark"].recent_raw)
             self.primary_graph.update()
-            self._refresh_primary_info(metric_name)
+        # Same value as last frame (FrameDelta held it back): the plot moves on, card text and details stay.
+        if parts["seen"] and value == parts["last"]:
+            return
+        if not parts["seen"]:
+            self._set_card_subtitle(metric_name, self._metric_card_subtitle(metric_name))
+        parts["last"] = value
+        parts["seen"] = True
+        parts["value"].setText(self._format_value(value, parts["unit"]))
+        if selected:
+            self._primary_info_dirty = True
 
     def _select_metric(self, metric_name):
         if metric_name not in self.metric_cards:
@@ -518,25 +563,45 @@ class MetricsMixin:
             self.cpu_cores_layout.addWidget(self.power_sensor_graphs[sensor_name], row, col)
             idx += 1
 
+    def _core_usage_items(self, core_usage):
+        """(name, usage) pairs from the native CoreTable buffer or the Python fallback list of dicts."""
+        if isinstance(core_usage, list):
+            items = []
+            for item in core_usage:
+                if not isinstance(item, dict):
+                    continue
+                core_name = str(item.get("name", "")).strip()
+                if core_name:
+                    items.append((core_name, float(item.get("usage", 0.0))))
+            return items
+        try:
+            view = memoryview(core_usage)
+        except TypeError:
+            return None
+        if view.ndim != 2 or view.format != "d":
+            return None
+        online = bytes(getattr(core_usage, "online", b""))
+        items = []
+        for idx, row in enumerate(view.tolist()):
+            core_name = f"cpu{idx}"
+            # Offline cores keep a zero plot only if they were shown before (same as the Python path).
+            if (idx < len(online) and online[idx]) or core_name in self.cpu_core_graphs:
+                items.append((core_name, row[0]))
+        return items
+
     def _update_cpu_core_graphs(self, core_usage):
-        if not isinstance(core_usage, list):
+        items = self._core_usage_items(core_usage)
+        if items is None:
             return
-        incoming_names = [str(item.get("name")) for item in core_usage if isinstance(item, dict) and item.get("name")]
-        incoming_set = set(incoming_names)
+        incoming_set = {name for name, _ in items}
         existing_set = set(self.cpu_core_graphs.keys())
 
+        relayout = incoming_set != existing_set
         for name in list(existing_set - incoming_set):
             widget = self.cpu_core_graphs.pop(name)
             widget.setParent(None)
 
-        for item in core_usage:
-            if not isinstance(item, dict):
-                continue
-            core_name = str(item.get("name", "")).strip()
-            if not core_name:
-                continue
-            usage = float(item.get("usage", 0.0))
-
+        for core_name, usage in items:
             graph = self.cpu_core_graphs.get(core_name)
             if graph is None:
                 graph = GraphWidget(label=core_name, unit="%", max_value=100.0, peak_window=1, max_points=40)
@@ -545,10 +610,13 @@ class MetricsMixin:
                 graph.setStyleSheet(self._spark_style())
                 graph.set_accent_color("#42c7f5")
                 graph.update_theme(self._theme_is_dark())
+                history = self._native_history(core_name, graph.max_points)
+                if history is not None:
+                    graph.set_history(history)
                 self.cpu_core_graphs[core_name] = graph
             graph.add_value(usage)
 
-        if self.selected_metric == "cpu":
+        if relayout and self.selected_metric == "cpu":
             self._render_cpu_core_graphs()
 
     def _update_power_sensor_graphs(self, psu_all):
@@ -599,6 +667,7 @@ class MetricsMixin:
 
         existing = set(self.power_sensor_graphs.keys())
         incoming_set = set(incoming.keys())
+        relayout = incoming_set != existing
         for removed in list(existing - incoming_set):
             widget = self.power_sensor_graphs.pop(removed)
             widget.setParent(None)
@@ -617,15 +686,32 @@ class MetricsMixin:
                 graph.set_accent_color(self._power_sensor_accent(label))
                 graph.update_theme(self._theme_is_dark())
                 self.power_sensor_graphs[sensor_name] = graph
-            else:
+            elif graph.label != label:
                 graph.label = label
+                graph.update()
             graph.set_blocked(is_blocked, self.lang_handler.tr("metric_password_required"))
             if not is_blocked:
                 graph.add_value(watts)
 
-        if self.selected_metric == "psu":
+        if relayout and self.selected_metric == "psu":
             self._render_power_sensor_graphs()
 
+    def _pressure_text(self, resource):
+        """'some X% / full Y% (avg10 Z%)' for one PSI resource, None without PSI data."""
+        item = (self.latest_sensor_values.get("pressure_all") or {}).get(resource)
+        if not isinstance(item, dict):
+            return None
+        text = f"some {float(item.get('some', 0.0)):.1f}%"
+        if item.get("has_full", True):
+            text += f" / full {float(item.get('full', 0.0)):.1f}%"
+        return f"{text} (avg10 {float(item.get('some_avg10', 0.0)):.1f}%)"
+
+    @staticmethod
+    def _cgroup_label(item):
+        """Last component of a cgroup path (sshd.service), shortened for container scopes with long ids."""
+        name = str(item.get("path") or "").rsplit("/", 1)[-1]
+        return name if len(name) <= 28 else name[:27] + "…"
+
     def _refresh_primary_info(self, metric_name):
         tr = self.lang_handler.tr
         parts = self.metric_cards.get(metric_name)
@@ -714,6 +800,25 @@ class MetricsMixin:
                 swap_used_gb = float(swap_used_kb) / 1024.0 / 1024.0
                 swap_total_gb = float(swap_total_kb) / 1024.0 / 1024.0
                 right_lines.append(f"{tr('details_swap_used')}: {swap_used_gb:.1f}/{swap_total_gb:.1f} GB")
+            mem_pressure = self._pressure_text("memory")
+            if advanced and mem_pressure:
+                right_lines.append(f"{tr('details_pressure_memory')}: {mem_pressure}")
+            vm = (self.latest_sensor_values.get("pressure_all") or {}).get("vm")
+            if advanced and isinstance(vm, dict):
+                right_lines.append(
+                    f"{tr('details_majfaults')}: {float(vm.get('majfault_ps', 0.0)):.0f}/s, "
+                    f"{tr('details_swap_io')}: {float(vm.get('swapin_ps', 0.0)):.0f}/{float(vm.get('swapout_ps', 0.0)):.0f} pages/s"
+                )
+                if int(vm.get("oom_kill", 0) or 0) > 0:
+                    right_lines.append(f"{tr('details_oom_kills')}: {int(vm.get('oom_kill', 0))}")
+            top_rss = (self.latest_sensor_values.get("proc_top") or {}).get("rss") or []
+            if advanced and top_rss:
+                procs = ", ".join(f"{p['name']} {p['rss_bytes'] / 1024.0 ** 3:.1f} GB" for p in top_rss[:3])
+                right_lines.append(f"{tr('details_top_rss')}: {procs}")
+            top_cg_mem = (self.latest_sensor_values.get("cgroup_top") or {}).get("memory") or []
+            if advanced and top_cg_mem:
+                groups = ", ".join(f"{self._cgroup_label(c)} {c['memory_bytes'] / 1024.0 ** 3:.1f} GB" for c in top_cg_mem[:3])
+                right_lines.append(f"{tr('details_top_cgroup_rss')}: {groups}")
         elif metric_name == "psu":
             psu_all = self.latest_sensor_values.get("psu_all") or {}
             if isinstance(psu_all, dict):
@@ -780,6 +885,10 @@ class MetricsMixin:
                     names = ", ".join(merge.get("adapters", [])[:3])
                     if names:
                         right_lines.append(f"{tr('details_bt_adapters')}: {names}")
+        elif metric_name.startswith("disk:"):
+            io_pressure = self._pressure_text("io")
+            if advanced and io_pressure:
+                right_lines.append(f"{tr('details_pressure_io')}: {io_pressure}")
         elif metric_name.startswith("bt:"):
             adapter = metric_name.split(":", 1)[1]
             bt_all = self.latest_sensor_values.get("bt_all") or {}
@@ -833,6 +942,17 @@ class MetricsMixin:
                 right_lines.append(
                     f"{tr('details_loadavg')}: {load_1m:.2f} / {load_5m:.2f} / {load_15m:.2f}"
                 )
+            cpu_pressure = self._pressure_text("cpu")
+            if advanced and cpu_pressure:
+                right_lines.append(f"{tr('details_pressure_cpu')}: {cpu_pressure}")
+            top_cpu = (self.latest_sensor_values.get("proc_top") or {}).get("cpu") or []
+            if advanced and top_cpu:
+                procs = ", ".join(f"{p['name']} {p['cpu_pct']:.0f}%" for p in top_cpu[:3])
+                right_lines.append(f"{tr('details_top_cpu')}: {procs}")
+            top_cg_cpu = (self.latest_sensor_values.get("cgroup_top") or {}).get("cpu") or []
+            if advanced and top_cg_cpu:
+                groups = ", ".join(f"{self._cgroup_label(c)} {c['cpu_pct']:.0f}%" for c in top_cg_cpu[:3])
+                right_lines.append(f"{tr('details_top_cgroup_cpu')}: {groups}")
             # Intentionally omitted: per-core "top usage" text is noisy when
             # dedicated per-core graphs are visible in CPU tab.
 
@@ -841,10 +961,109 @@ class MetricsMixin:
             if gpu_all:
                 right_lines.append(f"{tr('details_gpus_count')}: {len(gpu_all)}")
 
+        if metric_name.startswith("node:"):
+            node = getattr(self, "remote_nodes", {}).get(metric_name.split(":", 1)[1]) or {}
+            if node:
+                left_lines.append(f"{tr('details_node_state')}: {self._node_state_text(node)}")
+                for key, label, unit in (
+                    ("ram", "gauge_ram", "%"),
+                    ("disc", "graph_disk_usage", "%"),
+                    ("net_rx", "details_net_rx", "Mbps"),
+                    ("net_tx", "details_net_tx", "Mbps"),
+                    ("psu", "graph_psu_power", "W"),
+                    ("gpu", "graph_gpu_load", "%"),
+                    ("gpu_temp", "graph_gpu_temp", "C"),
+                ):
+                    if node.get(key) is not None:
+                        left_lines.append(f"{tr(label)}: {self._format_value(node[key], unit)}")
+                if advanced and node.get("pressure") is not None:
+                    right_lines.append(f"{tr('details_pressure_memory')}: {node['pressure']:.1f}%")
+                if advanced:
+                    right_lines.append(
+                        f"{tr('details_node_updates')}: {node['generation']} / {node['age_s']:.1f} s"
+                    )
+                    right_lines.append(
+                        f"{tr('details_node_bandwidth')}: {node['rx_bytes_per_s'] / 1024.0:.2f} KiB/s"
+                    )
+
         self.info_left.setText("\n".join(left_lines))
         self.info_right.setText("\n".join(right_lines))
 
+    # Keys shown only on their own card: a change refreshes the details panel only when that card is selected.
+    _CARD_VALUE_KEYS = frozenset(("cpu", "ram", "psu", "gpu", "gpu_nvidia", "gpu_others", "net", "disc", "nodes"))
+
+    def _subtitle_signature(self):
+        """Inputs of _metric_card_subtitle; card subtitles are rebuilt only when this changes."""
+        values = self.latest_sensor_values
+        psu_all = values.get("psu_all")
+        bt_all = values.get("bt_all")
+        gpus = tuple((g.get("id"), g.get("name")) for g in values.get("gpu_all") or [] if isinstance(g, dict))
+        merged = tuple(sorted(i for i, m in (values.get("net_bt_merge") or {}).items() if m.get("merged")))
+        bts = ()
+        if isinstance(bt_all, dict):
+            bts = tuple((a, b.get("name"), b.get("address")) for a, b in bt_all.items() if isinstance(b, dict))
+        psu_source = psu_all.get("source") if isinstance(psu_all, dict) else None
+        return (values.get("sys_mem_total_kb"), psu_source, self.gpu_name, gpus, merged, bts)
+
+    def _merge_frame(self, data):
+        """
+        Worker frame (FrameDelta: changed keys plus _gen) -> full view of the latest values and the set
+        of changed keys (None = everything). Frames without _gen (recording replay) are full.
+        """
+        if "_gen" not in data or data.get("_full"):
+            self._frame_state = {k: v for k, v in data.items() if not k.startswith("_")}
+            return self._frame_state, None
+        state = getattr(self, "_frame_state", None)
+        if state is None:
+            state = self._frame_state = {}
+        removed = data.get("_removed") or ()
+        for key in removed:
+            state.pop(key, None)
+        changed = set(removed)
+        for key, value in data.items():
+            if not key.startswith("_"):
+                state[key] = value
+                changed.add(key)
+        return state, changed
+
+    def _update_node_cards(self, nodes, full):
+        """
+        Remote mode: nodes holds only the collectors that changed since the previous frame (all of them
+        when full), a forgotten one maps to None. Only their cards are touched.
+        """
+        known = self.remote_nodes = getattr(self, "remote_nodes", {})
+        if full:
+            for name in [n for n in known if n not in nodes]:
+                del known[name]
+                self._remove_metric_card(f"node:{name}", "cpu")
+        for name, node in nodes.items():
+            metric_name = f"node:{name}"
+            if node is None:
+                known.pop(name, None)
+                self._remove_metric_card(metric_name, "cpu")
+                continue
+            prev = known.get(name)
+            known[name] = node
+            if metric_name not in self.metric_cards:
+                self._add_metric_card(metric_name, "graph_node_cpu", "%", 100.0, peak_window=4, protected=False)
+            elif prev is None or (prev.get("address"), prev.get("online"), prev.get("stale")) != (
+                node.get("address"), node.get("online"), node.get("stale")
+            ):
+                self._set_card_subtitle(metric_name, self._metric_card_subtitle(metric_name))
+            if node.get("cpu") is not None:
+                self._set_metric_value(metric_name, float(node["cpu"]))
+            if self.selected_metric == metric_name:
+                self._primary_info_dirty = True
+
     def update_widgets(self, data):
+        data, changed = self._merge_frame(data)
+        # Per-frame changes, not state: taken out so the next delta frame does not replay them.
+        nodes = data.pop("nodes", None)
+
+        def dirty(*keys):
+            return changed is None or any(key in changed for key in keys)
+
+        self._primary_info_dirty = changed is None or bool(changed - self._CARD_VALUE_KEYS)
         now = time.time()
         can_rebuild_dynamic = (now - float(getattr(self, "_dynamic_last_rebuild_ts", 0.0))) >= float(
             getattr(self, "dynamic_rebuild_interval_s", 1.0)
@@ -860,11 +1079,9 @@ class MetricsMixin:
         psu_all = data.get("psu_all")
         if isinstance(psu_all, dict):
             self.latest_sensor_values["psu_all"] = psu_all
-            if hasattr(self, "_update_auto_power_profile"):
+            if dirty("psu_all") and hasattr(self, "_update_auto_power_profile"):
                 self._update_auto_power_profile(psu_all)
             self._update_power_sensor_graphs(psu_all)
-            if self.selected_metric == "psu":
-                self._refresh_primary_info("psu")
 
         gpu_all = data.get("gpu_all")
         if isinstance(gpu_all, list):
@@ -883,7 +1100,7 @@ class MetricsMixin:
             # Keep base "gpu" card as single/aggregate view.
             if valid_gpus:
                 # Refresh primary GPU label from live data if available.
-                first_name = valid_gpus[0].get("name")
+                first_name = valid_gpus[0].get("name") if dirty("gpu_all") else None
                 if first_name:
                     self.gpu_name = self._normalize_gpu_name(first_name)
                 loads = [float(item["load"]) for item in telemetry_gpus if item.get("load") is not None]
@@ -923,7 +1140,6 @@ class MetricsMixin:
                         parts = self.metric_cards.get(metric_name)
                         if parts:
                             parts["value"].setText(self.lang_handler.tr("graph_blocked_no_permissions"))
-                    self._set_card_subtitle(metric_name, self._metric_card_subtitle(metric_name))
 
         gpu = data.get("gpu_nvidia") or data.get("gpu_others") or data.get("gpu")
         if gpu is not None and not self.metric_locks.get("gpu", True):
@@ -936,17 +1152,16 @@ class MetricsMixin:
             for metric_name in [name for name in self.metric_cards.keys() if name.startswith("gpu:")]:
                 self._remove_metric_card(metric_name, "gpu")
 
+        if nodes is not None or (changed is None and getattr(self, "remote_nodes", None)):
+            self._update_node_cards(nodes or {}, changed is None)
+
         cpu_temp = data.get("cpu_temp")
         if cpu_temp is not None:
             self.latest_sensor_values["cpu_temp"] = float(cpu_temp)
-            if self.selected_metric == "cpu":
-                self._refresh_primary_info("cpu")
 
         gpu_temp = data.get("gpu_temp")
         if gpu_temp is not None:
             self.latest_sensor_values["gpu_temp"] = float(gpu_temp)
-            if self.selected_metric == "gpu":
-                self._refresh_primary_info("gpu")
 
         net_total = data.get("net")
         if net_total is not None:
@@ -967,9 +1182,11 @@ class MetricsMixin:
         if isinstance(bt_all, dict):
             self.latest_sensor_values["bt_all"] = bt_all
 
-        merged_bt_adapters = set()
-        net_bt_merge = {}
-        if isinstance(net_all, dict) and net_all and isinstance(bt_all, dict) and bt_all:
+        # The BT -> NET mapping depends only on net_all/bt_all/net_meta; otherwise last frame's is kept.
+        merge_dirty = dirty("net_all", "bt_all", "net_meta") or not hasattr(self, "_merged_bt_adapters")
+        merged_bt_adapters = set() if merge_dirty else self._merged_bt_adapters
+        net_bt_merge = {} if merge_dirty else self.latest_sensor_values.get("net_bt_merge") or {}
+        if merge_dirty and isinstance(net_all, dict) and net_all and isinstance(bt_all, dict) and bt_all:
             # Merge BT telemetry into NET tab when both share same PCI slot (2-in-1 cards).
             slot_to_iface = {}
             for iface_name in net_all.keys():
@@ -995,6 +1212,7 @@ class MetricsMixin:
                 bucket["adapters"].append(bt_label)
                 merged_bt_adapters.add(bt_adapter)
         self.latest_sensor_values["net_bt_merge"] = net_bt_merge
+        self._merged_bt_adapters = merged_bt_adapters
 
         if isinstance(net_all, dict) and net_all:
             for iface_name, iface_val in net_all.items():
@@ -1051,12 +1269,13 @@ class MetricsMixin:
             "sys_cpu_vendor",
             "sys_cpu_packages",
             "sys_cpu_cores_usage",
+            "proc_top",
+            "cgroup_top",
+            "pressure_all",
         ):
             if key in data:
                 self.latest_sensor_values[key] = data[key]
         self._update_cpu_core_graphs(self.latest_sensor_values.get("sys_cpu_cores_usage") or [])
-        if self.selected_metric in self.metric_cards:
-            self._refresh_primary_info(self.selected_metric)
 
         all_disks = data.get("disc_all")
         if isinstance(all_disks, dict) and all_disks:
@@ -1105,3 +1324,11 @@ class MetricsMixin:
                     fallback = "net_total" if metric_name.startswith(("net:", "bt:")) else "cpu"
                     self._remove_metric_card(metric_name, fallback)
             self._dynamic_last_rebuild_ts = now
+
+        signature = self._subtitle_signature()
+        if signature != getattr(self, "_subtitle_sig", None):
+            self._subtitle_sig = signature
+            for metric_name in self.metric_cards:
+                self._set_card_subtitle(metric_name, self._metric_card_subtitle(metric_name))
+        if self._primary_info_dirty and self.selected_metric in self.metric_cards:
+            self._refresh_primary_info(self.selected_metric)
@@ -385,6 +385,10 @@ class UiSetupMixin:
         spark.setMaximumWidth(74)
         spark.setStyleSheet(self._spark_style())
         spark.set_accent_color(self._metric_accent(metric_name))
+        # Cards re-added for a returning disk/iface pick up where their native history left off.
+        history = self._native_history(metric_name, spark.max_points)
+        if history is not None:
+            spark.set_history(history)
 
         text_col = QVBoxLayout()
         text_col.setContentsMargins(0, 0, 0, 0)